@@ -0,0 +1,58 @@
+#include "core/arena.h"
+#include "benchmark.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define FRAME_COUNT 1000
+#define ALLOCATIONS_PER_FRAME 10000
+
+void benchmark_arena_against_malloc(void);
+
+int main(void) {
+    benchmark_arena_against_malloc();
+    return 0;
+}
+
+/**
+ * Simulates per-frame scratch data, many small allocations that all die at the end of the frame.
+ */
+void benchmark_arena_against_malloc(void) {
+    static void * blocks[ALLOCATIONS_PER_FRAME];
+    uint64_t random_state = 0x2545F4914F6CDD1DULL;
+    volatile uint8_t sink = 0;
+
+    uint64_t start = benchmark_now_ns();
+    for (int frame = 0; frame < FRAME_COUNT; frame++) {
+        for (int index = 0; index < ALLOCATIONS_PER_FRAME; index++) {
+            blocks[index] = malloc(8 + (size_t)(benchmark_random(&random_state) & 63));
+            *(uint8_t *)blocks[index] = (uint8_t)index;
+        }
+        for (int index = 0; index < ALLOCATIONS_PER_FRAME; index++) {
+            sink += *(uint8_t *)blocks[index];
+            free(blocks[index]);
+        }
+    }
+    uint64_t malloc_elapsed = benchmark_now_ns() - start;
+
+    Arena arena;
+    arena_init(&arena, 0);
+    start = benchmark_now_ns();
+    for (int frame = 0; frame < FRAME_COUNT; frame++) {
+        ArenaMarker marker = arena_save(&arena);
+        for (int index = 0; index < ALLOCATIONS_PER_FRAME; index++) {
+            blocks[index] = arena_push(&arena, 8 + (size_t)(benchmark_random(&random_state) & 63));
+            *(uint8_t *)blocks[index] = (uint8_t)index;
+        }
+        for (int index = 0; index < ALLOCATIONS_PER_FRAME; index++)
+            sink += *(uint8_t *)blocks[index];
+        arena_restore(&arena, marker);
+    }
+    uint64_t arena_elapsed = benchmark_now_ns() - start;
+    arena_destroy(&arena);
+
+    double operations = (double)FRAME_COUNT * ALLOCATIONS_PER_FRAME;
+    printf("%d frames of %d small allocations:\n", FRAME_COUNT, ALLOCATIONS_PER_FRAME);
+    printf("  malloc/free:         %6.2f ns per allocation\n", (double)malloc_elapsed / operations);
+    printf("  arena push/restore:  %6.2f ns per allocation (%.1fx)\n", (double)arena_elapsed / operations, (double)malloc_elapsed / (double)arena_elapsed);
+    (void)sink;
+}
@@ -0,0 +1,38 @@
+#ifndef ORIGINALIS_BENCHMARKS_CORE_BENCHMARK_H
+#define ORIGINALIS_BENCHMARKS_CORE_BENCHMARK_H
+
+#include "core/time.h"
+#include <stdint.h>
+
+/**
+ * @author Ronald Tavarez
+ * @file benchmark.h
+ * @date 2026-10-17
+ * @brief Timing and random number helpers shared by the Originalis benchmarks.
+ */
+
+/**
+ * @brief Reads a monotonic clock.
+ * 
+ * @return uint64_t The current time in nanoseconds from an arbitrary epoch.
+ */
+static inline uint64_t benchmark_now_ns(void) {
+    return time_now_ns();
+}
+
+/**
+ * @brief Advances a xorshift64 generator, used to randomize benchmark access patterns.
+ * 
+ * @param state The generator state, must not be zero.
+ * @return uint64_t The next pseudo-random value.
+ */
+static inline uint64_t benchmark_random(uint64_t * state) {
+    uint64_t value = *state;
+    value ^= value << 13;
+    value ^= value >> 7;
+    value ^= value << 17;
+    *state = value;
+    return value;
+}
+
+#endif  // ORIGINALIS_BENCHMARKS_CORE_BENCHMARK_H
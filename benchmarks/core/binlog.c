@@ -0,0 +1,56 @@
+#include "core/binlog.h"
+#include "core/log.h"
+#include "benchmark.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+/**
+ * Console lines go to stdout and results to stderr, run with stdout redirected, e.g. `binlog_bench > /dev/null`.
+ */
+
+#define MESSAGE_COUNT 1000000
+
+void benchmark_binlog_against_console(void);
+
+int main(void) {
+    benchmark_binlog_against_console();
+    return 0;
+}
+
+/**
+ * Logs the same formatted message through snprintf and the console logger, and through BINLOG.
+ */
+void benchmark_binlog_against_console(void) {
+    uint64_t random_state = 0x9E3779B97F4A7C15ULL;
+
+    uint64_t start = benchmark_now_ns();
+    for (int index = 0; index < MESSAGE_COUNT; index++) {
+        char message[1024];
+        snprintf(message, sizeof(message), "Frame %d took %.3f ms, %u draw calls, scene %s.",
+            index, (double)(benchmark_random(&random_state) & 1023) / 64.0, (unsigned)(index & 4095), "level_01");
+        LOG_CONSOLE_INFO(message);
+    }
+    uint64_t console_elapsed = benchmark_now_ns() - start;
+
+    binlog_open("binlog_bench.binlog");
+    start = benchmark_now_ns();
+    for (int index = 0; index < MESSAGE_COUNT; index++) {
+        BINLOG_INFO("Frame %d took %.3f ms, %u draw calls, scene %s.",
+            index, (double)(benchmark_random(&random_state) & 1023) / 64.0, (unsigned)(index & 4095), "level_01");
+    }
+    uint64_t binlog_elapsed = benchmark_now_ns() - start;
+    start = benchmark_now_ns();
+    binlog_close();
+    uint64_t close_elapsed = benchmark_now_ns() - start;
+
+    FILE * file = fopen("binlog_bench.binlog", "rb");
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fclose(file);
+    remove("binlog_bench.binlog");
+
+    fprintf(stderr, "Per message cost:\n");
+    fprintf(stderr, "  snprintf + console: %7.1f ns\n", (double)console_elapsed / MESSAGE_COUNT);
+    fprintf(stderr, "  BINLOG:             %7.1f ns, %.1f bytes per message, %.1f ms to flush at close\n",
+        (double)binlog_elapsed / MESSAGE_COUNT, (double)size / MESSAGE_COUNT, (double)close_elapsed / 1e6);
+}
@@ -0,0 +1,265 @@
+#include "core/debug.h"
+#include "core/log.h"
+#include "core/thread.h"
+#include "benchmark.h"
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+void benchmark_debug_free_scaling(void);
+void benchmark_debug_thread_scaling(void);
+void benchmark_debug_sampling_overhead(void);
+void benchmark_debug_realloc_growth(void);
+void benchmark_debug_page_guard_overhead(void);
+void benchmark_debug_tracking_modes(void);
+
+int main(void) {
+    benchmark_debug_free_scaling();
+    benchmark_debug_thread_scaling();
+    benchmark_debug_sampling_overhead();
+    benchmark_debug_realloc_growth();
+    benchmark_debug_page_guard_overhead();
+    benchmark_debug_tracking_modes();
+    return 0;
+}
+
+#define FREE_SCALING_HOT_BLOCKS 64
+
+/**
+ * Helper function to free and reallocate random blocks among the first window of a live set.
+ */
+static double churn_live_blocks(void ** blocks, size_t window, bool tracked, size_t iterations) {
+    uint64_t random_state = 0x9E3779B97F4A7C15ULL;
+    uint64_t start = benchmark_now_ns();
+    for (size_t iteration = 0; iteration < iterations; iteration++) {
+        size_t index = (size_t)(benchmark_random(&random_state) % window);
+        if (tracked) {
+            debug_free(blocks[index]);
+            blocks[index] = debug_malloc(32, __FILE__, __LINE__);
+        } else {
+            free(blocks[index]);
+            blocks[index] = malloc(32);
+        }
+    }
+    return (double)(benchmark_now_ns() - start) / (double)iterations;
+}
+
+/**
+ * Frees a live block and allocates a replacement, keeping the live-block count constant.
+ *
+ * Replacing a random block of the whole set grows with the live-block count, for free and malloc
+ * as well: past the caches each pair misses on the block, its allocator metadata and, for the
+ * debug pair, its guard bytes, table slot and record. Replacing blocks among the first
+ * FREE_SCALING_HOT_BLOCKS only, while the others stay tracked, keeps those in cache and leaves
+ * the table cost, which should stay flat, as the load factor and so the probes do not change.
+ */
+void benchmark_debug_free_scaling(void) {
+    static const size_t LIVE_COUNTS[] = { 1000, 10000, 100000, 300000 };
+    const size_t iterations = 100000;
+
+    printf("debug_free + debug_malloc with N live blocks, ns per pair:\n");
+    for (size_t test = 0; test < sizeof(LIVE_COUNTS) / sizeof(LIVE_COUNTS[0]); test++) {
+        size_t live_count = LIVE_COUNTS[test];
+        void ** blocks = (void **)malloc(live_count * sizeof(void *));
+
+        for (size_t index = 0; index < live_count; index++)
+            blocks[index] = debug_malloc(32, __FILE__, __LINE__);
+        double hot = churn_live_blocks(blocks, FREE_SCALING_HOT_BLOCKS, true, iterations);
+        double random = churn_live_blocks(blocks, live_count, true, iterations);
+        for (size_t index = 0; index < live_count; index++)
+            debug_free(blocks[index]);
+
+        for (size_t index = 0; index < live_count; index++)
+            blocks[index] = malloc(32);
+        double plain = churn_live_blocks(blocks, live_count, false, iterations);
+        for (size_t index = 0; index < live_count; index++)
+            free(blocks[index]);
+
+        printf("  %7zu live: %d hot blocks %7.1f | random block %7.1f | random block with free + malloc %7.1f\n",
+            live_count, FREE_SCALING_HOT_BLOCKS, hot, random, plain);
+        free(blocks);
+    }
+}
+
+#define STRESS_OPERATIONS_PER_THREAD 200000
+#define STRESS_LIVE_BLOCKS_PER_THREAD 64
+#define STRESS_MAX_THREADS 16
+
+/**
+ * Each stress thread keeps a small window of live blocks and replaces one at random per operation.
+ */
+static void stress_thread(void * argument) {
+    uint64_t random_state = (uint64_t)(uintptr_t)argument | 1;
+    void * blocks[STRESS_LIVE_BLOCKS_PER_THREAD];
+    for (size_t index = 0; index < STRESS_LIVE_BLOCKS_PER_THREAD; index++)
+        blocks[index] = debug_malloc(48, __FILE__, __LINE__);
+
+    for (size_t operation = 0; operation < STRESS_OPERATIONS_PER_THREAD; operation++) {
+        size_t index = (size_t)(benchmark_random(&random_state) % STRESS_LIVE_BLOCKS_PER_THREAD);
+        debug_free(blocks[index]);
+        blocks[index] = debug_malloc(16 + (size_t)(random_state & 127), __FILE__, __LINE__);
+    }
+
+    for (size_t index = 0; index < STRESS_LIVE_BLOCKS_PER_THREAD; index++)
+        debug_free(blocks[index]);
+}
+
+/**
+ * Runs the alloc/free stress on 1 to 16 threads. Aggregate throughput should grow close to
+ * linearly with the thread count, up to the number of cores.
+ */
+void benchmark_debug_thread_scaling(void) {
+#if !DEBUG_MEMORY_THREAD_SAFE
+    printf("Thread scaling skipped, build debug.c with -DDEBUG_MEMORY_THREAD_SAFE=1.\n");
+#else
+    static const size_t THREAD_COUNTS[] = { 1, 2, 4, 8, STRESS_MAX_THREADS };
+    Thread threads[STRESS_MAX_THREADS];
+    double single_thread_rate = 0.0;
+
+    printf("debug_free + debug_malloc stress, %d operations per thread:\n", STRESS_OPERATIONS_PER_THREAD);
+    for (size_t test = 0; test < sizeof(THREAD_COUNTS) / sizeof(THREAD_COUNTS[0]); test++) {
+        size_t thread_count = THREAD_COUNTS[test];
+        uint64_t start = benchmark_now_ns();
+        for (size_t index = 0; index < thread_count; index++)
+            thread_create(&threads[index], stress_thread, (void *)(uintptr_t)(0x9E3779B97F4A7C15ULL * (index + 1)));
+        for (size_t index = 0; index < thread_count; index++)
+            thread_join(&threads[index]);
+        uint64_t elapsed = benchmark_now_ns() - start;
+
+        double rate = (double)(thread_count * STRESS_OPERATIONS_PER_THREAD) * 1e3 / (double)elapsed;
+        if (thread_count == 1)
+            single_thread_rate = rate;
+        printf("  %2zu threads: %8.2f M pairs/s (%.2fx)\n", thread_count, rate, rate / single_thread_rate);
+    }
+#endif
+}
+
+/**
+ * Measures the cost the sampling heap profiler adds to a malloc/free pair at several rates.
+ */
+void benchmark_debug_sampling_overhead(void) {
+    static const size_t SAMPLE_RATES[] = { 0, DEBUG_MEMORY_DEFAULT_SAMPLE_RATE, 64 * 1024, 4 * 1024 };
+    const size_t iterations = 1000000;
+    void * blocks[64] = { 0 };
+    uint64_t random_state = 0xD1B54A32D192ED03ULL;
+
+    printf("Sampling heap profiler overhead:\n");
+    for (size_t test = 0; test < sizeof(SAMPLE_RATES) / sizeof(SAMPLE_RATES[0]); test++) {
+        debug_memory_set_sample_rate(SAMPLE_RATES[test]);
+        uint64_t start = benchmark_now_ns();
+        for (size_t iteration = 0; iteration < iterations; iteration++) {
+            size_t index = iteration & 63;
+            debug_free(blocks[index]);
+            blocks[index] = debug_malloc(16 + (size_t)(benchmark_random(&random_state) & 255), __FILE__, __LINE__);
+        }
+        uint64_t elapsed = benchmark_now_ns() - start;
+        printf("  rate %7zu bytes: %6.1f ns per free/malloc pair\n", SAMPLE_RATES[test], (double)elapsed / (double)iterations);
+    }
+    debug_memory_set_sample_rate(0);
+    for (size_t index = 0; index < 64; index++)
+        debug_free(blocks[index]);
+}
+
+/**
+ * Grows buffers the way dynamic arrays and string builders do, comparing debug_realloc with realloc.
+ */
+void benchmark_debug_realloc_growth(void) {
+    const size_t rounds = 200;
+    const size_t byte_growth_limit = 4096;
+    const size_t doubling_limit = 1 << 20;
+
+    printf("Realloc growth patterns:\n");
+    for (int tracked = 0; tracked < 2; tracked++) {
+        // Append one byte at a time, the common string building pattern.
+        uint64_t start = benchmark_now_ns();
+        size_t calls = 0;
+        for (size_t round = 0; round < rounds; round++) {
+            uint8_t * buffer = NULL;
+            for (size_t size = 1; size <= byte_growth_limit; size++, calls++) {
+                buffer = (uint8_t *)(tracked ? debug_realloc(buffer, size, __FILE__, __LINE__) : realloc(buffer, size));
+                buffer[size - 1] = (uint8_t)size;
+            }
+            tracked ? debug_free(buffer) : free(buffer);
+        }
+        uint64_t byte_elapsed = benchmark_now_ns() - start;
+
+        // Double the capacity each time, the common dynamic array pattern.
+        start = benchmark_now_ns();
+        size_t doubling_calls = 0;
+        for (size_t round = 0; round < rounds; round++) {
+            uint8_t * buffer = NULL;
+            for (size_t size = 16; size <= doubling_limit; size *= 2, doubling_calls++) {
+                buffer = (uint8_t *)(tracked ? debug_realloc(buffer, size, __FILE__, __LINE__) : realloc(buffer, size));
+                buffer[size - 1] = (uint8_t)size;
+            }
+            tracked ? debug_free(buffer) : free(buffer);
+        }
+        uint64_t doubling_elapsed = benchmark_now_ns() - start;
+
+        printf("  %-13s +1 byte to 4 KiB: %7.1f ns per call | doubling to 1 MiB: %8.1f ns per call\n",
+            tracked ? "debug_realloc" : "realloc",
+            (double)byte_elapsed / (double)calls, (double)doubling_elapsed / (double)doubling_calls);
+    }
+}
+
+/**
+ * Measures the same free/malloc churn as the sampling benchmark with page guards picking every or some blocks.
+ */
+void benchmark_debug_page_guard_overhead(void) {
+    static const size_t SAMPLE_INTERVALS[] = { 0, 1024, 64, 1 };
+    const size_t iterations = 200000;
+    void * blocks[64] = { 0 };
+    uint64_t random_state = 0xD1B54A32D192ED03ULL;
+
+    printf("Page guard overhead:\n");
+    for (size_t test = 0; test < sizeof(SAMPLE_INTERVALS) / sizeof(SAMPLE_INTERVALS[0]); test++) {
+        debug_memory_set_page_guard(0, SAMPLE_INTERVALS[test]);
+        uint64_t start = benchmark_now_ns();
+        for (size_t iteration = 0; iteration < iterations; iteration++) {
+            size_t index = iteration & 63;
+            debug_free(blocks[index]);
+            blocks[index] = debug_malloc(16 + (size_t)(benchmark_random(&random_state) & 255), __FILE__, __LINE__);
+        }
+        uint64_t elapsed = benchmark_now_ns() - start;
+        if (SAMPLE_INTERVALS[test])
+            printf("  one in %4zu blocks: %7.1f ns per free/malloc pair\n", SAMPLE_INTERVALS[test], (double)elapsed / (double)iterations);
+        else
+            printf("  disabled:           %7.1f ns per free/malloc pair\n", (double)elapsed / (double)iterations);
+    }
+    debug_memory_set_page_guard(0, 0);
+    for (size_t index = 0; index < 64; index++)
+        debug_free(blocks[index]);
+}
+
+/**
+ * Runs the same free/malloc churn through what MEMORY_ALLOC and MEMORY_FREE expand to in each MEMORY_TRACKING_MODE.
+ */
+void benchmark_debug_tracking_modes(void) {
+    static const char * MODE_NAMES[] = { "none", "counters", "full" };
+    const size_t iterations = 1000000;
+
+    printf("MEMORY_TRACKING_MODE churn:\n");
+    for (int mode = MEMORY_TRACKING_NONE; mode <= MEMORY_TRACKING_FULL; mode++) {
+        void * blocks[64] = { 0 };
+        uint64_t random_state = 0xD1B54A32D192ED03ULL;
+        uint64_t start = benchmark_now_ns();
+        for (size_t iteration = 0; iteration < iterations; iteration++) {
+            size_t index = iteration & 63;
+            size_t size = 16 + (size_t)(benchmark_random(&random_state) & 255);
+            if (mode == MEMORY_TRACKING_NONE) {
+                free(blocks[index]);
+                blocks[index] = malloc(size);
+            } else if (mode == MEMORY_TRACKING_COUNTERS) {
+                counted_free(blocks[index]);
+                blocks[index] = counted_malloc(size);
+            } else {
+                debug_free(blocks[index]);
+                blocks[index] = debug_malloc(size, __FILE__, __LINE__);
+            }
+        }
+        uint64_t elapsed = benchmark_now_ns() - start;
+        printf("  %-9s %6.1f ns per free/malloc pair\n", MODE_NAMES[mode], (double)elapsed / (double)iterations);
+        for (size_t index = 0; index < 64; index++)
+            mode == MEMORY_TRACKING_NONE ? free(blocks[index]) : mode == MEMORY_TRACKING_COUNTERS ? counted_free(blocks[index]) : debug_free(blocks[index]);
+    }
+}
@@ -0,0 +1,47 @@
+#include "core/format.h"
+#include "benchmark.h"
+#include <stdio.h>
+
+#define FORMAT_ITERATIONS 2000000
+
+void benchmark_format_mixes(void);
+
+int main(void) {
+    benchmark_format_mixes();
+    return 0;
+}
+
+/**
+ * Measures format_string against snprintf for the argument mixes log calls use most.
+ * The compiler turns snprintf of a format without conversions into a copy, so text only is not a fair race.
+ */
+#define BENCHMARK_FORMAT_MIX(name, ...) do { \
+        char text[256]; \
+        volatile char sink = 0; \
+        uint64_t start = benchmark_now_ns(); \
+        for (int index = 0; index < FORMAT_ITERATIONS; index++) { \
+            format_string(text, sizeof(text), __VA_ARGS__); \
+            sink += text[0]; \
+        } \
+        uint64_t custom = benchmark_now_ns() - start; \
+        start = benchmark_now_ns(); \
+        for (int index = 0; index < FORMAT_ITERATIONS; index++) { \
+            snprintf(text, sizeof(text), __VA_ARGS__); \
+            sink += text[0]; \
+        } \
+        uint64_t libc = benchmark_now_ns() - start; \
+        printf("  %-28s format_string %7.2f ns, snprintf %7.2f ns, %5.2fx\n", name, \
+            (double)custom / FORMAT_ITERATIONS, (double)libc / FORMAT_ITERATIONS, (double)libc / (double)custom); \
+        (void)sink; \
+    } while (0)
+
+void benchmark_format_mixes(void) {
+    int value = 0;
+    printf("Formatting cost per call:\n");
+    BENCHMARK_FORMAT_MIX("text only", "Renderer initialized.");
+    BENCHMARK_FORMAT_MIX("string and integers", "Loaded %d assets from %s in %u passes.", 1834, "textures.pak", 3u);
+    BENCHMARK_FORMAT_MIX("64-bit integers", "Frame %llu, allocated %lld bytes.", 123456789012ULL, -9876543210LL);
+    BENCHMARK_FORMAT_MIX("hex and pointer", "Handle %#010x at %p.", 0xBEEFu, (void *)&value);
+    BENCHMARK_FORMAT_MIX("floats", "Frame took %.3f ms, %.1f fps.", 16.667, 59.99);
+    BENCHMARK_FORMAT_MIX("mixed", "[%s:%d] %s %zu bytes at %p, %.2f%%.", "debug.c", 1582, "leaked", (size_t)4096, (void *)&value, 12.5);
+}
@@ -0,0 +1,135 @@
+#include "core/hash.h"
+#include "benchmark.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BENCHMARK_BYTES (256ULL * 1024 * 1024)
+#define BENCHMARK_MAX_CALLS 20000000ULL
+
+void benchmark_hash_bytes(void);
+void benchmark_hash_stream(void);
+void benchmark_hash_integers(void);
+
+static const STRING_SIMD SIMD_LEVELS[] = { STRING_SIMD_NONE, STRING_SIMD_SSE2, STRING_SIMD_AVX2, STRING_SIMD_NEON };
+static const char * SIMD_NAMES[] = { "scalar", "SSE2", "AVX2", "NEON" };
+static const size_t STREAM_PIECES[] = { 100, 4096 };
+static const size_t LENGTHS[] = { 8, 16, 32, 64, 256, 1024, 4096, 65536, 1024 * 1024 };
+
+int main(void) {
+    benchmark_hash_bytes();
+    benchmark_hash_stream();
+    benchmark_hash_integers();
+    return 0;
+}
+
+/**
+ * Calls to make for a length, enough to hash BENCHMARK_BYTES.
+ */
+static uint64_t get_call_count(size_t length) {
+    uint64_t calls = BENCHMARK_BYTES / length;
+    return calls < BENCHMARK_MAX_CALLS ? calls : BENCHMARK_MAX_CALLS;
+}
+
+/**
+ * Allocates bytes of a length, not aligned on purpose.
+ */
+static unsigned char * create_bytes(size_t length) {
+    unsigned char * buffer = (unsigned char *)malloc(length + 1);
+    for (size_t index = 0; index <= length; index++)
+        buffer[index] = (unsigned char)(index * 131 + 7);
+    return buffer + 1;
+}
+
+/**
+ * Prints one row of a table, the time per call and the throughput.
+ */
+static void print_hash_result(const char * name, size_t length, uint64_t calls, uint64_t elapsed) {
+    printf("  %-7s %8zu bytes %12.2f ns per call %8.2f GB per second\n", name, length,
+        (double)elapsed / (double)calls, (double)length * (double)calls / (double)elapsed);
+}
+
+/**
+ * Measures hash_bytes on each instructions the CPU supports against FNV-1a, from 8 bytes to 1 MB.
+ * Up to HASH_SHORT_BYTES the instructions do not matter, only the scalar row is printed.
+ */
+void benchmark_hash_bytes(void) {
+    STRING_SIMD detected = hash_simd();
+    printf("hash_bytes:\n");
+    for (size_t test = 0; test < sizeof(LENGTHS) / sizeof(LENGTHS[0]); test++) {
+        size_t length = LENGTHS[test];
+        unsigned char * bytes = create_bytes(length);
+        uint64_t calls = get_call_count(length);
+        volatile uint64_t sink = 0;
+        for (size_t level = 0; level < sizeof(SIMD_LEVELS) / sizeof(SIMD_LEVELS[0]); level++) {
+            if (!hash_set_simd(SIMD_LEVELS[level]) || (level > 0 && length <= HASH_SHORT_BYTES))
+                continue;
+            uint64_t start = benchmark_now_ns();
+            for (uint64_t call = 0; call < calls; call++)
+                sink += hash_bytes((unsigned char * volatile)bytes, length, 0);
+            print_hash_result(SIMD_NAMES[level], length, calls, benchmark_now_ns() - start);
+        }
+        uint64_t start = benchmark_now_ns();
+        for (uint64_t call = 0; call < calls; call++)
+            sink += hash_fnv1a((unsigned char * volatile)bytes, length);
+        print_hash_result("fnv1a", length, calls, benchmark_now_ns() - start);
+        free(bytes - 1);
+        (void)sink;
+    }
+    hash_set_simd(detected);
+}
+
+/**
+ * Measures hashing 1 MB fed in small and large pieces, against hashing it at once.
+ */
+void benchmark_hash_stream(void) {
+    size_t length = 1024 * 1024;
+    unsigned char * bytes = create_bytes(length);
+    uint64_t calls = get_call_count(length);
+    volatile uint64_t sink = 0;
+    HashState state;
+    printf("hash_stream_update in pieces, %s:\n", SIMD_NAMES[hash_simd()]);
+    for (size_t test = 0; test < sizeof(STREAM_PIECES) / sizeof(STREAM_PIECES[0]); test++) {
+        size_t piece = STREAM_PIECES[test];
+        char name[16];
+        snprintf(name, sizeof(name), "%zu B", piece);
+        uint64_t start = benchmark_now_ns();
+        for (uint64_t call = 0; call < calls; call++) {
+            hash_stream_init(&state, 0);
+            for (size_t offset = 0; offset < length; offset += piece)
+                hash_stream_update(&state, bytes + offset, length - offset < piece ? length - offset : piece);
+            sink += hash_stream_final(&state);
+        }
+        print_hash_result(name, length, calls, benchmark_now_ns() - start);
+    }
+
+    uint64_t start = benchmark_now_ns();
+    for (uint64_t call = 0; call < calls; call++)
+        sink += hash_bytes((unsigned char * volatile)bytes, length, 0);
+    print_hash_result("at once", length, calls, benchmark_now_ns() - start);
+    free(bytes - 1);
+    (void)sink;
+}
+
+/**
+ * Measures mixing integers and addresses, as hash table lookups do.
+ */
+void benchmark_hash_integers(void) {
+    printf("mixing integers:\n");
+    volatile uint64_t sink = 0;
+    uint64_t start = benchmark_now_ns();
+    for (uint64_t call = 0; call < BENCHMARK_MAX_CALLS; call++)
+        sink += hash_u64(call);
+    printf("  %-24s %8.2f ns per call\n", "hash_u64", (double)(benchmark_now_ns() - start) / BENCHMARK_MAX_CALLS);
+
+    start = benchmark_now_ns();
+    for (uint64_t call = 0; call < BENCHMARK_MAX_CALLS; call++)
+        sink += hash_pointer((const void *)(uintptr_t)(call * 16));
+    printf("  %-24s %8.2f ns per call\n", "hash_pointer", (double)(benchmark_now_ns() - start) / BENCHMARK_MAX_CALLS);
+
+    start = benchmark_now_ns();
+    for (uint64_t call = 0; call < BENCHMARK_MAX_CALLS; call++)
+        sink += hash_bytes(&call, sizeof(call), 0);
+    printf("  %-24s %8.2f ns per call\n", "hash_bytes of 8 bytes", (double)(benchmark_now_ns() - start) / BENCHMARK_MAX_CALLS);
+    (void)sink;
+}
@@ -0,0 +1,119 @@
+#include "core/intern.h"
+#include "core/string.h"
+#include "core/thread.h"
+#include "benchmark.h"
+#include <stdio.h>
+#include <string.h>
+
+#define ITERATIONS 10000000
+#define BENCHMARK_THREADS 4
+#define FILE_NAMES 64
+
+void benchmark_intern_hits(void);
+void benchmark_intern_equality(void);
+void benchmark_intern_threads(void);
+
+static char file_names[FILE_NAMES][64];
+
+int main(void) {
+    for (int index = 0; index < FILE_NAMES; index++)
+        snprintf(file_names[index], sizeof(file_names[index]), "source/game/systems/module_%02d/implementation.c", index);
+    benchmark_intern_hits();
+    benchmark_intern_equality();
+    benchmark_intern_threads();
+    return 0;
+}
+
+/**
+ * Prints the time per call of one measurement.
+ */
+static void print_intern_result(const char * name, uint64_t elapsed, uint64_t calls) {
+    printf("  %-44s %8.2f ns per call\n", name, (double)elapsed / (double)calls);
+}
+
+/**
+ * Measures interning strings that are already interned, by content and by address, 48-byte file names.
+ */
+void benchmark_intern_hits(void) {
+    printf("interning %d file names already interned:\n", FILE_NAMES);
+    for (int index = 0; index < FILE_NAMES; index++)
+        intern_static(file_names[index]);
+    volatile InternHandle sink = 0;
+
+    uint64_t start = benchmark_now_ns();
+    for (int index = 0; index < ITERATIONS; index++)
+        sink += intern_static(file_names[index % FILE_NAMES]);
+    print_intern_result("intern_static, remembered address", benchmark_now_ns() - start, ITERATIONS);
+
+    start = benchmark_now_ns();
+    for (int index = 0; index < ITERATIONS; index++)
+        sink += intern_string(file_names[index % FILE_NAMES]);
+    print_intern_result("intern_string, hashed content", benchmark_now_ns() - start, ITERATIONS);
+
+    StringView missing = STRING_VIEW_LITERAL("source/game/systems/module_99/implementation.c");
+    start = benchmark_now_ns();
+    for (int index = 0; index < ITERATIONS; index++)
+        sink += intern_lookup(missing);
+    print_intern_result("intern_lookup, not interned", benchmark_now_ns() - start, ITERATIONS);
+    printf("  %zu strings in %zu bytes\n", intern_count(), intern_memory_bytes());
+    (void)sink;
+}
+
+/**
+ * Measures the equality test interning replaces, two equal file names in different buffers.
+ */
+void benchmark_intern_equality(void) {
+    printf("comparing two equal file names:\n");
+    char copy[64];
+    strcpy(copy, file_names[7]);
+    const char * volatile one = file_names[7];
+    const char * volatile two = copy;
+    InternHandle volatile handle_one = intern_string(one);
+    InternHandle volatile handle_two = intern_string(two);
+    volatile int sink = 0;
+
+    uint64_t start = benchmark_now_ns();
+    for (int index = 0; index < ITERATIONS; index++)
+        sink += string_compare(one, two) == 0;
+    print_intern_result("string_compare", benchmark_now_ns() - start, ITERATIONS);
+
+    start = benchmark_now_ns();
+    for (int index = 0; index < ITERATIONS; index++)
+        sink += handle_one == handle_two;
+    print_intern_result("handle compare", benchmark_now_ns() - start, ITERATIONS);
+    (void)sink;
+}
+
+typedef struct InternReader {
+    Thread thread;
+    uint64_t elapsed;
+} InternReader;
+
+/**
+ * Interns the file names by address over and over, every lookup takes no lock.
+ */
+static void run_intern_reader(void * argument) {
+    InternReader * reader = (InternReader *)argument;
+    volatile InternHandle sink = 0;
+    uint64_t start = benchmark_now_ns();
+    for (int index = 0; index < ITERATIONS / BENCHMARK_THREADS; index++)
+        sink += intern_string(file_names[index % FILE_NAMES]);
+    reader->elapsed = benchmark_now_ns() - start;
+    (void)sink;
+}
+
+/**
+ * Measures lookups by content from several threads at once.
+ */
+void benchmark_intern_threads(void) {
+    printf("intern_string from %d threads at once:\n", BENCHMARK_THREADS);
+    InternReader readers[BENCHMARK_THREADS];
+    for (int index = 0; index < BENCHMARK_THREADS; index++)
+        thread_create(&readers[index].thread, run_intern_reader, &readers[index]);
+    uint64_t elapsed = 0;
+    for (int index = 0; index < BENCHMARK_THREADS; index++) {
+        thread_join(&readers[index].thread);
+        elapsed += readers[index].elapsed;
+    }
+    print_intern_result("intern_string, per thread", elapsed, ITERATIONS);
+}
@@ -0,0 +1,271 @@
+#include "core/log.h"
+#include "core/log_file.h"
+#include "core/log_flight.h"
+#include "core/log_limit.h"
+#include "core/thread.h"
+#include "core/color.h"
+#include "benchmark.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/**
+ * Log lines go to stdout and results to stderr, run with stdout redirected, e.g. `log_bench > /dev/null`,
+ * so terminal speed does not decide the synchronous numbers. The console sink numbers depend on
+ * where stdout goes, run it on a terminal and through a pipe, `log_bench | cat > /dev/null`, too.
+ */
+
+#define MESSAGES_PER_THREAD 20000
+
+void benchmark_log_producer_latency(void);
+void benchmark_log_filtered_level(void);
+void benchmark_log_file_sink(void);
+void benchmark_log_rate_limit(void);
+void benchmark_log_console_sink(void);
+void benchmark_log_flight_recorder(void);
+
+int main(void) {
+    benchmark_log_producer_latency();
+    benchmark_log_filtered_level();
+    benchmark_log_file_sink();
+    benchmark_log_rate_limit();
+    benchmark_log_console_sink();
+    benchmark_log_flight_recorder();
+    return 0;
+}
+
+typedef struct LogProducer {
+    Thread thread;
+    uint64_t elapsed;
+    uint64_t slowest;
+} LogProducer;
+
+static void run_log_producer(void * argument) {
+    LogProducer * producer = (LogProducer *)argument;
+    uint64_t start = benchmark_now_ns();
+    for (int index = 0; index < MESSAGES_PER_THREAD; index++)
+        LOG_CONSOLE_INFO("Benchmark message with a typical length for a log line in the engine.");
+    producer->elapsed = benchmark_now_ns() - start;
+}
+
+static void run_timed_log_producer(void * argument) {
+    LogProducer * producer = (LogProducer *)argument;
+    producer->elapsed = 0;
+    producer->slowest = 0;
+    for (int index = 0; index < MESSAGES_PER_THREAD; index++) {
+        uint64_t start = benchmark_now_ns();
+        LOG_CONSOLE_INFO("Benchmark message with a typical length for a log line in the engine.");
+        uint64_t elapsed = benchmark_now_ns() - start;
+        producer->elapsed += elapsed;
+        if (elapsed > producer->slowest)
+            producer->slowest = elapsed;
+    }
+}
+
+/**
+ * Measures the time a log call keeps the calling thread busy, synchronous against the asynchronous
+ * ring with each overflow policy, as more threads log at once.
+ */
+void benchmark_log_producer_latency(void) {
+    static const int THREAD_COUNTS[] = { 1, 2, 4, 8 };
+    static const char * MODE_NAMES[] = { "synchronous", "async block", "async drop newest", "async drop oldest" };
+    LogProducer producers[8];
+
+    fprintf(stderr, "Log call latency on the producer thread:\n");
+    for (int mode = 0; mode < 4; mode++) {
+        for (size_t test = 0; test < sizeof(THREAD_COUNTS) / sizeof(THREAD_COUNTS[0]); test++) {
+            int thread_count = THREAD_COUNTS[test];
+            uint64_t dropped = log_async_dropped_count();
+            if (mode > 0)
+                log_async_start(1 << 16, (LOG_OVERFLOW_POLICY)(mode - 1));
+            for (int index = 0; index < thread_count; index++)
+                thread_create(&producers[index].thread, run_log_producer, &producers[index]);
+            uint64_t elapsed = 0;
+            for (int index = 0; index < thread_count; index++) {
+                thread_join(&producers[index].thread);
+                elapsed += producers[index].elapsed;
+            }
+            log_async_stop();
+            fprintf(stderr, "  %-17s %d threads: %8.1f ns per call, %llu dropped\n", MODE_NAMES[mode], thread_count,
+                (double)elapsed / (double)(thread_count * MESSAGES_PER_THREAD),
+                (unsigned long long)(log_async_dropped_count() - dropped));
+        }
+    }
+}
+
+/**
+ * Measures a LOG_CONSOLE_DEBUG call filtered out by the run time minimum level.
+ */
+void benchmark_log_filtered_level(void) {
+    const int iterations = 100000000;
+    log_set_level(LOG_LEVEL_ERROR);
+    uint64_t start = benchmark_now_ns();
+    for (int index = 0; index < iterations; index++)
+        LOG_CONSOLE_DEBUG("Filtered benchmark message.");
+    uint64_t elapsed = benchmark_now_ns() - start;
+    log_set_level(LOG_LEVEL_DEBUG);
+    fprintf(stderr, "Filtered log call: %.2f ns per call\n", (double)elapsed / (double)iterations);
+}
+
+/**
+ * Measures synchronous log calls writing only to the file sink, with a rotation every megabyte,
+ * for each sync policy. The slowest call shows what a buffer write or rotation costs the thread
+ * that triggers it.
+ */
+void benchmark_log_file_sink(void) {
+    static const int THREAD_COUNTS[] = { 1, 4 };
+    static const char * POLICY_NAMES[] = { "never", "on rotate", "on error", "always" };
+    LogProducer producers[4];
+
+    log_remove_sink(&log_console_sink);
+    fprintf(stderr, "File sink log call latency, 1 MB rotation, 256 KB buffer:\n");
+    for (int policy = 0; policy < 4; policy++) {
+        for (size_t test = 0; test < sizeof(THREAD_COUNTS) / sizeof(THREAD_COUNTS[0]); test++) {
+            int thread_count = THREAD_COUNTS[test];
+            LogFileSinkOptions options = { 0 };
+            options.buffer_size = 256 * 1024;
+            options.rotate_size = 1024 * 1024;
+            options.keep_count = 2;
+            options.sync_policy = (LOG_FILE_SYNC_POLICY)policy;
+            LogFileSink sink;
+            if (!log_file_sink_open(&sink, "log_bench.log", &options))
+                return;
+            log_add_sink(&sink.sink);
+            for (int index = 0; index < thread_count; index++)
+                thread_create(&producers[index].thread, run_timed_log_producer, &producers[index]);
+            uint64_t elapsed = 0;
+            uint64_t slowest = 0;
+            for (int index = 0; index < thread_count; index++) {
+                thread_join(&producers[index].thread);
+                elapsed += producers[index].elapsed;
+                if (producers[index].slowest > slowest)
+                    slowest = producers[index].slowest;
+            }
+            log_remove_sink(&sink.sink);
+            log_file_sink_close(&sink);
+            fprintf(stderr, "  sync %-9s %d threads: %8.1f ns per call, slowest %8.1f us\n", POLICY_NAMES[policy], thread_count,
+                (double)elapsed / (double)(thread_count * MESSAGES_PER_THREAD), (double)slowest / 1000.0);
+        }
+    }
+    log_add_sink(&log_console_sink);
+    remove("log_bench.log");
+    remove("log_bench.log.1");
+    remove("log_bench.log.2");
+}
+
+/**
+ * Measures a rate limited call site flooding with an error, the first calls fill the burst and
+ * the rest are suppressed, against the same flood written in full.
+ */
+void benchmark_log_rate_limit(void) {
+    const int iterations = 10000000;
+    LogRateLimit limit = LOG_RATE_LIMIT_INIT(LOG_RATE_LIMIT_PER_SECOND, LOG_RATE_LIMIT_BURST);
+    volatile int allowed = 0;
+    uint64_t start = benchmark_now_ns();
+    for (int index = 0; index < iterations; index++)
+        allowed += log_rate_limit_acquire(&limit);
+    uint64_t elapsed = benchmark_now_ns() - start;
+    fprintf(stderr, "Rate limit check: %.2f ns per call, %d of %d let through\n", (double)elapsed / (double)iterations, allowed, iterations);
+
+    const int flood = 100000;
+    start = benchmark_now_ns();
+    for (int index = 0; index < flood; index++)
+        LOG_CONSOLE_ERROR_LIMITED("Buffer overrun detected in flood %d.", index);
+    elapsed = benchmark_now_ns() - start;
+    fprintf(stderr, "Flooding error, rate limited: %8.1f ns per call\n", (double)elapsed / (double)flood);
+
+    start = benchmark_now_ns();
+    for (int index = 0; index < flood; index++)
+        LOG_CONSOLE_ERRORF("Buffer overrun detected in flood %d.", index);
+    elapsed = benchmark_now_ns() - start;
+    fprintf(stderr, "Flooding error, written:      %8.1f ns per call\n", (double)elapsed / (double)flood);
+
+    log_set_coalescing(true);
+    start = benchmark_now_ns();
+    for (int index = 0; index < flood; index++)
+        LOG_CONSOLE_ERROR("Buffer overrun detected in flood.");
+    elapsed = benchmark_now_ns() - start;
+    log_set_coalescing(false);
+    fprintf(stderr, "Flooding error, coalesced:    %8.1f ns per call\n", (double)elapsed / (double)flood);
+}
+
+static const char * STDIO_LEVEL_COLORS[] = {
+    TERMINAL_COLOR_FG_BLUE, TERMINAL_COLOR_FG_WHITE, TERMINAL_COLOR_FG_GREEN,
+    TERMINAL_COLOR_FG_YELLOW, TERMINAL_COLOR_FG_RED, TERMINAL_COLOR_FG_MAGENTA
+};
+
+/**
+ * The console sink as it was, colors always, printed with fprintf into stdio's buffer.
+ */
+static void write_stdio_line(LogSink * sink, const LogLine * line) {
+    (void)sink;
+    size_t label_end = line->label_start + line->label_length;
+    fprintf(stdout, "%.*s%s%s%.*s%s%.*s", (int)line->label_start, line->text, TERMINAL_COLOR_BG_BLACK, STDIO_LEVEL_COLORS[line->level],
+        (int)line->label_length, line->text + line->label_start, TERMINAL_MODIFIER_RESET, (int)(line->length - label_end), line->text + label_end);
+}
+
+static void flush_stdio(LogSink * sink) {
+    (void)sink;
+    fflush(stdout);
+}
+
+/**
+ * Measures synchronous log calls to stdout through the console sink, with and without colors,
+ * against the stdio sink it replaced, wherever stdout goes.
+ */
+void benchmark_log_console_sink(void) {
+    LogSink stdio_sink = { write_stdio_line, flush_stdio, LOG_LEVEL_DEBUG };
+    LogProducer producer;
+
+    fprintf(stderr, "Console log call latency:\n");
+    for (int mode = 0; mode < 3; mode++) {
+        if (mode == 2) {
+            log_remove_sink(&log_console_sink);
+            log_add_sink(&stdio_sink);
+        } else {
+            log_set_console_colors(mode == 1);
+        }
+        run_timed_log_producer(&producer);
+        fflush(stdout);
+        fprintf(stderr, "  %-24s %8.1f ns per call, slowest %8.1f us\n", mode == 0 ? "console sink" : mode == 1 ? "console sink, colored" : "stdio sink, colored",
+            (double)producer.elapsed / (double)MESSAGES_PER_THREAD, (double)producer.slowest / 1000.0);
+    }
+    log_remove_sink(&stdio_sink);
+    log_add_sink(&log_console_sink);
+}
+
+/**
+ * Records a formatted message the way written log calls do.
+ */
+static void log_flight_record_formatted(LOG_LEVEL level, const char * format, ...) {
+    va_list arguments;
+    va_start(arguments, format);
+    log_flight_record_va(level, __FUNCTION__, __FILE__, __LINE__, format, arguments);
+    va_end(arguments);
+}
+
+/**
+ * Measures recording into the flight recorder alone, a literal and a copied message as filtered
+ * calls record them, and a formatted one as written calls do.
+ */
+void benchmark_log_flight_recorder(void) {
+    const int iterations = 10000000;
+    const char * message = "Benchmark message with a typical length for a log line in the engine.";
+    uint64_t start = benchmark_now_ns();
+    for (int index = 0; index < iterations; index++)
+        log_flight_record_literal(LOG_LEVEL_DEBUG, __FUNCTION__, __FILE__, __LINE__, message);
+    uint64_t elapsed = benchmark_now_ns() - start;
+    fprintf(stderr, "Flight recorder, literal:   %6.2f ns per record\n", (double)elapsed / (double)iterations);
+
+    start = benchmark_now_ns();
+    for (int index = 0; index < iterations; index++)
+        log_flight_record(LOG_LEVEL_DEBUG, __FUNCTION__, __FILE__, __LINE__, message);
+    elapsed = benchmark_now_ns() - start;
+    fprintf(stderr, "Flight recorder, copied:    %6.2f ns per record\n", (double)elapsed / (double)iterations);
+
+    start = benchmark_now_ns();
+    for (int index = 0; index < iterations; index++)
+        log_flight_record_formatted(LOG_LEVEL_DEBUG, "Loaded %d textures in %.2f ms.", index, 16.5);
+    elapsed = benchmark_now_ns() - start;
+    fprintf(stderr, "Flight recorder, formatted: %6.2f ns per record\n", (double)elapsed / (double)iterations);
+}
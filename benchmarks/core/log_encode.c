@@ -0,0 +1,142 @@
+#include "core/log_encode.h"
+#include "core/log.h"
+#include "core/time.h"
+#include "benchmark.h"
+#include <stdio.h>
+#include <string.h>
+
+#define ENCODE_RECORDS 1000000
+
+void benchmark_log_encode_records(void);
+void benchmark_log_encode_escaping(void);
+void benchmark_log_structured_lines(void);
+
+int main(void) {
+    benchmark_log_encode_records();
+    benchmark_log_encode_escaping();
+    benchmark_log_structured_lines();
+    return 0;
+}
+
+static const LogField BENCHMARK_FIELDS[] = {
+    LOG_FIELD_STRING("pack", "textures.pak"),
+    LOG_FIELD_INTEGER("count", 1834),
+    LOG_FIELD_FLOAT("ms", 16.5),
+};
+
+/**
+ * Measures encoding a whole record with three fields into one reused buffer, in each encoding.
+ */
+void benchmark_log_encode_records(void) {
+    static const LOG_ENCODING ENCODINGS[] = { LOG_ENCODING_JSON, LOG_ENCODING_LOGFMT };
+    static const char * ENCODING_NAMES[] = { "JSON", "logfmt" };
+    const char * message = "Loaded the texture pack for the main menu.";
+    size_t message_length = strlen(message);
+    uint64_t wall = time_now_wall_ns();
+    char buffer[1024];
+    volatile size_t sink = 0;
+
+    printf("Record encoding, three fields:\n");
+    for (size_t encoding = 0; encoding < sizeof(ENCODINGS) / sizeof(ENCODINGS[0]); encoding++) {
+        uint64_t start = benchmark_now_ns();
+        for (int index = 0; index < ENCODE_RECORDS; index++) {
+            char fields[LOG_MAX_FIELDS_BYTES];
+            LogEncoder encoder;
+            log_encoder_init(&encoder, fields, sizeof(fields));
+            log_encode_fields(&encoder, ENCODINGS[encoding], BENCHMARK_FIELDS, 3);
+            size_t fields_length = encoder.length;
+
+            log_encoder_init(&encoder, buffer, sizeof(buffer));
+            log_encode_record(&encoder, ENCODINGS[encoding], wall + (uint64_t)index * 1000, LOG_LEVEL_INFO, "load_pack", "source/assets/pack.c", 128,
+                message, message_length, fields, fields_length);
+            sink += encoder.length;
+        }
+        uint64_t elapsed = benchmark_now_ns() - start;
+        printf("  %-8s %8.1f ns per record, %6.2f M records per second\n", ENCODING_NAMES[encoding],
+            (double)elapsed / ENCODE_RECORDS, (double)ENCODE_RECORDS * 1e3 / (double)elapsed);
+    }
+    (void)sink;
+}
+
+/**
+ * Escapes one byte at a time, the scan the vectorized one replaces.
+ */
+static size_t escape_bytewise(char * output, const char * text, size_t length) {
+    size_t written = 0;
+    for (size_t index = 0; index < length; index++) {
+        unsigned char byte = (unsigned char)text[index];
+        if (byte < 0x20 || byte == '"' || byte == '\\') {
+            output[written++] = '\\';
+            output[written++] = byte == '\n' ? 'n' : (char)byte;
+        } else {
+            output[written++] = (char)byte;
+        }
+    }
+    return written;
+}
+
+/**
+ * Measures the throughput of escaping a long message with a quote every 200 bytes.
+ */
+void benchmark_log_encode_escaping(void) {
+    char text[4096];
+    char buffer[8192];
+    for (size_t index = 0; index < sizeof(text); index++)
+        text[index] = index % 200 == 199 ? '"' : (char)('a' + index % 26);
+    volatile size_t sink = 0;
+    int iterations = ENCODE_RECORDS / 10;
+
+    printf("String escaping, 4 KB with a quote every 200 bytes:\n");
+    uint64_t start = benchmark_now_ns();
+    for (int index = 0; index < iterations; index++) {
+        LogEncoder encoder;
+        log_encoder_init(&encoder, buffer, sizeof(buffer));
+        log_encode_json_string(&encoder, text, sizeof(text));
+        sink += encoder.length;
+    }
+    uint64_t elapsed = benchmark_now_ns() - start;
+    printf("  log_encode_json_string %8.2f GB per second\n", (double)sizeof(text) * iterations / (double)elapsed);
+
+    start = benchmark_now_ns();
+    for (int index = 0; index < iterations; index++)
+        sink += escape_bytewise(buffer, text, sizeof(text));
+    elapsed = benchmark_now_ns() - start;
+    printf("  byte by byte           %8.2f GB per second\n", (double)sizeof(text) * iterations / (double)elapsed);
+    (void)sink;
+}
+
+static void write_null_line(LogSink * sink, const LogLine * line) {
+    (void)sink;
+    (void)line;
+}
+
+static void flush_null(LogSink * sink) {
+    (void)sink;
+}
+
+/**
+ * Measures whole log calls with fields in each encoding, to a sink that drops the lines.
+ */
+void benchmark_log_structured_lines(void) {
+    static const LOG_ENCODING ENCODINGS[] = { LOG_ENCODING_TEXT, LOG_ENCODING_JSON, LOG_ENCODING_LOGFMT };
+    static const char * ENCODING_NAMES[] = { "text", "JSON", "logfmt" };
+    LogSink null_sink = { write_null_line, flush_null, LOG_LEVEL_DEBUG };
+    log_remove_sink(&log_console_sink);
+    log_add_sink(&null_sink);
+
+    printf("LOG_CONSOLE_FIELDS to a null sink, three fields:\n");
+    for (size_t encoding = 0; encoding < sizeof(ENCODINGS) / sizeof(ENCODINGS[0]); encoding++) {
+        log_set_encoding(ENCODINGS[encoding]);
+        uint64_t start = benchmark_now_ns();
+        for (int index = 0; index < ENCODE_RECORDS; index++)
+            LOG_CONSOLE_FIELDS(LOG_LEVEL_INFO, "Loaded the texture pack for the main menu.",
+                LOG_FIELD_STRING("pack", "textures.pak"), LOG_FIELD_INTEGER("count", index), LOG_FIELD_FLOAT("ms", 16.5));
+        uint64_t elapsed = benchmark_now_ns() - start;
+        printf("  %-8s %8.1f ns per call, %6.2f M records per second\n", ENCODING_NAMES[encoding],
+            (double)elapsed / ENCODE_RECORDS, (double)ENCODE_RECORDS * 1e3 / (double)elapsed);
+    }
+
+    log_set_encoding(LOG_ENCODING_TEXT);
+    log_remove_sink(&null_sink);
+    log_add_sink(&log_console_sink);
+}
@@ -0,0 +1,132 @@
+#include "core/string.h"
+#include "core/log.h"
+#include "benchmark.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BENCHMARK_BYTES (256ULL * 1024 * 1024)
+#define BENCHMARK_MAX_CALLS 20000000ULL
+
+void benchmark_string_length(void);
+void benchmark_string_compare(void);
+void benchmark_string_to_log_level(void);
+
+static const STRING_SIMD SIMD_LEVELS[] = { STRING_SIMD_NONE, STRING_SIMD_SSE2, STRING_SIMD_AVX2, STRING_SIMD_NEON };
+static const char * SIMD_NAMES[] = { "scalar", "SSE2", "AVX2", "NEON" };
+static const size_t LENGTHS[] = { 1, 8, 16, 64, 256, 4096, 65536, 1024 * 1024 };
+
+int main(void) {
+    benchmark_string_length();
+    benchmark_string_compare();
+    benchmark_string_to_log_level();
+    return 0;
+}
+
+/**
+ * Calls to make for a string length, enough to move BENCHMARK_BYTES.
+ */
+static uint64_t get_call_count(size_t length) {
+    uint64_t calls = BENCHMARK_BYTES / length;
+    return calls < BENCHMARK_MAX_CALLS ? calls : BENCHMARK_MAX_CALLS;
+}
+
+/**
+ * Allocates a string of a length, not aligned on purpose.
+ */
+static char * create_string(size_t length) {
+    char * buffer = (char *)malloc(length + 2);
+    memset(buffer + 1, 's', length);
+    buffer[length + 1] = '\0';
+    return buffer + 1;
+}
+
+/**
+ * Prints one row of a table, the time per call and the throughput.
+ */
+static void print_string_result(const char * name, size_t length, uint64_t calls, uint64_t elapsed) {
+    printf("  %-7s %8zu bytes %12.2f ns per call %8.2f GB per second\n", name, length,
+        (double)elapsed / (double)calls, (double)length * (double)calls / (double)elapsed);
+}
+
+/**
+ * Measures string_length on each instructions the CPU supports against the C library, from 1 byte to 1 MB.
+ */
+void benchmark_string_length(void) {
+    STRING_SIMD detected = string_simd();
+    printf("string_length:\n");
+    for (size_t test = 0; test < sizeof(LENGTHS) / sizeof(LENGTHS[0]); test++) {
+        size_t length = LENGTHS[test];
+        char * string = create_string(length);
+        uint64_t calls = get_call_count(length);
+        volatile size_t sink = 0;
+        for (size_t level = 0; level < sizeof(SIMD_LEVELS) / sizeof(SIMD_LEVELS[0]); level++) {
+            if (!string_set_simd(SIMD_LEVELS[level]))
+                continue;
+            uint64_t start = benchmark_now_ns();
+            for (uint64_t call = 0; call < calls; call++)
+                sink += (size_t)string_length((char * volatile)string);
+            print_string_result(SIMD_NAMES[level], length, calls, benchmark_now_ns() - start);
+        }
+        uint64_t start = benchmark_now_ns();
+        for (uint64_t call = 0; call < calls; call++)
+            sink += strlen((char * volatile)string);
+        print_string_result("strlen", length, calls, benchmark_now_ns() - start);
+        free(string - 1);
+        (void)sink;
+    }
+    string_set_simd(detected);
+}
+
+/**
+ * Measures string_compare of two equal strings, the whole of both is read, against the C library.
+ */
+void benchmark_string_compare(void) {
+    STRING_SIMD detected = string_simd();
+    printf("string_compare, equal strings:\n");
+    for (size_t test = 0; test < sizeof(LENGTHS) / sizeof(LENGTHS[0]); test++) {
+        size_t length = LENGTHS[test];
+        char * one = create_string(length);
+        char * two = create_string(length);
+        uint64_t calls = get_call_count(length);
+        volatile int sink = 0;
+        for (size_t level = 0; level < sizeof(SIMD_LEVELS) / sizeof(SIMD_LEVELS[0]); level++) {
+            if (!string_set_simd(SIMD_LEVELS[level]))
+                continue;
+            uint64_t start = benchmark_now_ns();
+            for (uint64_t call = 0; call < calls; call++)
+                sink += string_compare((char * volatile)one, two);
+            print_string_result(SIMD_NAMES[level], length, calls, benchmark_now_ns() - start);
+        }
+        uint64_t start = benchmark_now_ns();
+        for (uint64_t call = 0; call < calls; call++)
+            sink += strcmp((char * volatile)one, two);
+        print_string_result("strcmp", length, calls, benchmark_now_ns() - start);
+        free(one - 1);
+        free(two - 1);
+        (void)sink;
+    }
+    string_set_simd(detected);
+}
+
+/**
+ * Measures string_to_log_level on every level name and an unknown one, six string_compare calls for the worst.
+ */
+void benchmark_string_to_log_level(void) {
+    static const char * NAMES[] = { "DEBUG", "INFO", "SUCCESS", "WARNING", "ERROR", "FATAL", "VERBOSE" };
+    const int iterations = 10000000;
+    STRING_SIMD detected = string_simd();
+    printf("string_to_log_level, all level names:\n");
+    for (size_t level = 0; level < sizeof(SIMD_LEVELS) / sizeof(SIMD_LEVELS[0]); level++) {
+        if (!string_set_simd(SIMD_LEVELS[level]))
+            continue;
+        volatile int sink = 0;
+        uint64_t start = benchmark_now_ns();
+        for (int index = 0; index < iterations; index++)
+            sink += string_to_log_level(NAMES[index % 7]);
+        uint64_t elapsed = benchmark_now_ns() - start;
+        printf("  %-7s %8.2f ns per call\n", SIMD_NAMES[level], (double)elapsed / (double)iterations);
+        (void)sink;
+    }
+    string_set_simd(detected);
+}
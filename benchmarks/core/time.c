@@ -0,0 +1,87 @@
+#include "core/time.h"
+#include "benchmark.h"
+#include <stdio.h>
+#include <time.h>
+
+#define TIME_ITERATIONS 10000000
+
+void benchmark_time_clocks(void);
+void benchmark_time_format(void);
+
+int main(void) {
+    benchmark_time_clocks();
+    benchmark_time_format();
+    return 0;
+}
+
+/**
+ * Measures one read of each clock, the sum keeps the reads from being optimized away.
+ */
+void benchmark_time_clocks(void) {
+    volatile uint64_t sink = 0;
+    uint64_t start, elapsed;
+
+    printf("Clock read cost:\n");
+    start = benchmark_now_ns();
+    for (int index = 0; index < TIME_ITERATIONS; index++)
+        sink += time_now_ns();
+    elapsed = benchmark_now_ns() - start;
+    printf("  time_now_ns:           %6.2f ns\n", (double)elapsed / TIME_ITERATIONS);
+
+    start = benchmark_now_ns();
+    for (int index = 0; index < TIME_ITERATIONS; index++)
+        sink += time_now_coarse_ns();
+    elapsed = benchmark_now_ns() - start;
+    printf("  time_now_coarse_ns:    %6.2f ns\n", (double)elapsed / TIME_ITERATIONS);
+
+    start = benchmark_now_ns();
+    for (int index = 0; index < TIME_ITERATIONS; index++)
+        sink += time_now_wall_ns();
+    elapsed = benchmark_now_ns() - start;
+    printf("  time_now_wall_ns:      %6.2f ns\n", (double)elapsed / TIME_ITERATIONS);
+
+    start = benchmark_now_ns();
+    for (int index = 0; index < TIME_ITERATIONS; index++)
+        sink += time_ticks();
+    elapsed = benchmark_now_ns() - start;
+    printf("  time_ticks:            %6.2f ns (%llu ticks per second)\n", (double)elapsed / TIME_ITERATIONS, (unsigned long long)time_ticks_per_second());
+
+    start = benchmark_now_ns();
+    for (int index = 0; index < TIME_ITERATIONS; index++)
+        sink += time_ticks_to_wall_ns(time_ticks());
+    elapsed = benchmark_now_ns() - start;
+    printf("  time_ticks_to_wall_ns: %6.2f ns, ticks read included\n", (double)elapsed / TIME_ITERATIONS);
+    (void)sink;
+}
+
+/**
+ * Measures formatting a timestamp with the per-second cache against localtime and strftime on every call,
+ * for timestamps 1 microsecond apart as in a busy log.
+ */
+void benchmark_time_format(void) {
+    char text[64];
+    volatile char sink = 0;
+    uint64_t wall = time_now_wall_ns();
+
+    printf("Timestamp formatting cost:\n");
+    uint64_t start = benchmark_now_ns();
+    for (int index = 0; index < TIME_ITERATIONS; index++) {
+        time_format_wall(wall + (uint64_t)index * 1000, text);
+        sink += text[25];
+    }
+    uint64_t elapsed = benchmark_now_ns() - start;
+    printf("  time_format_wall:      %6.2f ns\n", (double)elapsed / TIME_ITERATIONS);
+
+    start = benchmark_now_ns();
+    for (int index = 0; index < TIME_ITERATIONS; index++) {
+        uint64_t now = wall + (uint64_t)index * 1000;
+        time_t seconds = (time_t)(now / 1000000000ULL);
+        struct tm * calendar = localtime(&seconds);
+        size_t length = strftime(text, sizeof(text), "%Y-%m-%d %H:%M:%S", calendar);
+        snprintf(text + length, sizeof(text) - length, ".%06u", (unsigned int)(now % 1000000000ULL / 1000));
+        sink += text[25];
+    }
+    elapsed = benchmark_now_ns() - start;
+    printf("  localtime + strftime:  %6.2f ns\n", (double)elapsed / TIME_ITERATIONS);
+    (void)sink;
+}
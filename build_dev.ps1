@@ -3,6 +3,7 @@ $ROOT_DIR = "."
 $INCLUDE_DIR = "$ROOT_DIR"
 $SRC_DIR = "$ROOT_DIR\source"
 $TEST_DIR = "$ROOT_DIR\tests"
+$BENCH_DIR = "$ROOT_DIR\benchmarks"
 $BIN_DIR = "$ROOT_DIR\binary"
 $BUILD_DIR = "$ROOT_DIR\build"
 
@@ -10,11 +11,42 @@ $BUILD_DIR = "$ROOT_DIR\build"
 if (-not (Test-Path -Path $BIN_DIR)) { New-Item -Path $BIN_DIR -ItemType Directory }
 if (-not (Test-Path -Path $BUILD_DIR)) { New-Item -Path $BUILD_DIR -ItemType Directory }
 
+# Core sources linked into every test and benchmark
+$CORE_SOURCES = "$SRC_DIR\core\arena.c", "$SRC_DIR\core\binlog.c", "$SRC_DIR\core\debug.c", "$SRC_DIR\core\format.c", "$SRC_DIR\core\hash.c", "$SRC_DIR\core\intern.c", "$SRC_DIR\core\log.c", "$SRC_DIR\core\log_encode.c", "$SRC_DIR\core\log_file.c", "$SRC_DIR\core\log_flight.c", "$SRC_DIR\core\log_limit.c", "$SRC_DIR\core\pool.c", "$SRC_DIR\core\string.c", "$SRC_DIR\core\thread.c", "$SRC_DIR\core\time.c"
+
 # Include directories
-$INCLUDE_DIRS = "-I$INCLUDE_DIR"
+$INCLUDE_DIRS = "-I$INCLUDE_DIR", "-I$INCLUDE_DIR\include"
 
 # Compile with GCC
-gcc "$TEST_DIR\core\log.c" "$SRC_DIR\core\log.c" "$SRC_DIR\core\string.c" -o "$BIN_DIR\log_test_gcc.exe" $INCLUDE_DIRS
+gcc "$TEST_DIR\core\log.c" $CORE_SOURCES -o "$BIN_DIR\log_test_gcc.exe" $INCLUDE_DIRS
+gcc "$TEST_DIR\core\debug.c" $CORE_SOURCES -o "$BIN_DIR\debug_test_gcc.exe" $INCLUDE_DIRS
+gcc "$TEST_DIR\core\arena.c" $CORE_SOURCES -o "$BIN_DIR\arena_test_gcc.exe" $INCLUDE_DIRS
+gcc "$TEST_DIR\core\pool.c" $CORE_SOURCES -o "$BIN_DIR\pool_test_gcc.exe" $INCLUDE_DIRS
+gcc "$TEST_DIR\core\binlog.c" $CORE_SOURCES -o "$BIN_DIR\binlog_test_gcc.exe" $INCLUDE_DIRS
+gcc "$TEST_DIR\core\log_file.c" $CORE_SOURCES -o "$BIN_DIR\log_file_test_gcc.exe" $INCLUDE_DIRS
+gcc "$TEST_DIR\core\time.c" $CORE_SOURCES -o "$BIN_DIR\time_test_gcc.exe" $INCLUDE_DIRS
+gcc "$TEST_DIR\core\format.c" $CORE_SOURCES -o "$BIN_DIR\format_test_gcc.exe" $INCLUDE_DIRS
+gcc "$TEST_DIR\core\log_encode.c" $CORE_SOURCES -o "$BIN_DIR\log_encode_test_gcc.exe" $INCLUDE_DIRS
+gcc "$TEST_DIR\core\log_limit.c" $CORE_SOURCES -o "$BIN_DIR\log_limit_test_gcc.exe" $INCLUDE_DIRS
+gcc "$TEST_DIR\core\log_flight.c" $CORE_SOURCES -o "$BIN_DIR\log_flight_test_gcc.exe" $INCLUDE_DIRS
+gcc "$TEST_DIR\core\string.c" $CORE_SOURCES -o "$BIN_DIR\string_test_gcc.exe" $INCLUDE_DIRS
+gcc "$TEST_DIR\core\intern.c" $CORE_SOURCES -o "$BIN_DIR\intern_test_gcc.exe" $INCLUDE_DIRS
+gcc "$TEST_DIR\core\hash.c" $CORE_SOURCES -o "$BIN_DIR\hash_test_gcc.exe" $INCLUDE_DIRS
+
+# Compile tools
+gcc -O2 "$ROOT_DIR\tools\binlog_decode.c" $CORE_SOURCES -o "$BIN_DIR\binlog_decode.exe" $INCLUDE_DIRS
+
+# Compile benchmarks with optimizations
+gcc -O2 -DDEBUG_MEMORY_THREAD_SAFE=1 "$BENCH_DIR\core\debug.c" $CORE_SOURCES -o "$BIN_DIR\debug_bench_gcc.exe" $INCLUDE_DIRS
+gcc -O2 "$BENCH_DIR\core\arena.c" $CORE_SOURCES -o "$BIN_DIR\arena_bench_gcc.exe" $INCLUDE_DIRS
+gcc -O2 "$BENCH_DIR\core\log.c" $CORE_SOURCES -o "$BIN_DIR\log_bench_gcc.exe" $INCLUDE_DIRS
+gcc -O2 "$BENCH_DIR\core\binlog.c" $CORE_SOURCES -o "$BIN_DIR\binlog_bench_gcc.exe" $INCLUDE_DIRS
+gcc -O2 "$BENCH_DIR\core\time.c" $CORE_SOURCES -o "$BIN_DIR\time_bench_gcc.exe" $INCLUDE_DIRS
+gcc -O2 "$BENCH_DIR\core\format.c" $CORE_SOURCES -o "$BIN_DIR\format_bench_gcc.exe" $INCLUDE_DIRS
+gcc -O2 "$BENCH_DIR\core\log_encode.c" $CORE_SOURCES -o "$BIN_DIR\log_encode_bench_gcc.exe" $INCLUDE_DIRS
+gcc -O2 "$BENCH_DIR\core\string.c" $CORE_SOURCES -o "$BIN_DIR\string_bench_gcc.exe" $INCLUDE_DIRS
+gcc -O2 "$BENCH_DIR\core\intern.c" $CORE_SOURCES -o "$BIN_DIR\intern_bench_gcc.exe" $INCLUDE_DIRS
+gcc -O2 "$BENCH_DIR\core\hash.c" $CORE_SOURCES -o "$BIN_DIR\hash_bench_gcc.exe" $INCLUDE_DIRS
 Move-Item -Path *.o -Destination $BUILD_DIR
 
 Write-Output "Compilation complete!"
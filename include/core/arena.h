@@ -0,0 +1,162 @@
+#ifndef ORIGINALIS_CORE_ARENA_H
+#define ORIGINALIS_CORE_ARENA_H
+
+#include <stddef.h>
+#include <stdbool.h>
+
+/**
+ * @author Ronald Tavarez
+ * @file arena.h
+ * @date 2026-10-17
+ * @brief Linear arena allocator for the Originalis codebase.
+ * 
+ * An arena hands out memory by bumping a position inside large chunks. Individual
+ * allocations are never freed, instead the position is moved back with a pop, a
+ * saved marker or a full reset, releasing everything pushed after it in O(1).
+ * Arenas grow by chaining new chunks, so pointers handed out stay valid until the
+ * position is moved back past them.
+ */
+
+#define ARENA_DEFAULT_CHUNK_SIZE (64 * 1024)
+#define ARENA_DEFAULT_ALIGNMENT 16
+
+/**
+ * @brief Header of a chunk of arena memory, the usable bytes follow it.
+ */
+typedef struct ArenaChunk {
+    struct ArenaChunk * previous;   /** Chunk that was current before this one. */
+    size_t base;                    /** Arena position of the first usable byte. */
+    size_t capacity;                /** Number of usable bytes. */
+    size_t used;                    /** Number of bytes pushed, including alignment padding. */
+} ArenaChunk;
+
+/**
+ * @brief A chain of chunks with a single bump position.
+ */
+typedef struct Arena {
+    ArenaChunk * current;           /** Chunk that pushes are served from, NULL until the first push. */
+    ArenaChunk * spare;             /** One released chunk kept to avoid malloc churn around chunk edges. */
+    size_t chunk_size;              /** Minimum usable size of new chunks. */
+    const char * file;              /** File passed to debug_malloc for tracked arenas. */
+    int line;                       /** Line passed to debug_malloc for tracked arenas. */
+    bool tracked;                   /** Chunks come from debug_malloc, so leaked arenas show up in report_memory_leaks. */
+} Arena;
+
+/**
+ * @brief A saved arena position, see arena_save and arena_restore.
+ */
+typedef struct ArenaMarker {
+    size_t position;                /** Arena position when the marker was taken. */
+} ArenaMarker;
+
+/**
+ * @brief Initializes an arena whose chunks come from malloc. No memory is allocated until the first push.
+ * 
+ * @param arena The arena to initialize.
+ * @param chunk_size The minimum usable size of each chunk, 0 selects ARENA_DEFAULT_CHUNK_SIZE.
+ */
+void arena_init(Arena * arena, size_t chunk_size);
+
+/**
+ * @brief Initializes an arena whose chunks are tracked by the debug allocator.
+ * 
+ * @param arena The arena to initialize.
+ * @param chunk_size The minimum usable size of each chunk, 0 selects ARENA_DEFAULT_CHUNK_SIZE.
+ * @param file The source file reported for leaked chunks.
+ * @param line The line number reported for leaked chunks.
+ */
+void arena_init_tracked(Arena * arena, size_t chunk_size, const char * file, int line);
+
+/**
+ * @def ARENA_INIT_TRACKED(arena, chunk_size)
+ * @brief Initializes a tracked arena, leaked chunks are reported at the calling line.
+ */
+#define ARENA_INIT_TRACKED(arena, chunk_size) arena_init_tracked(arena, chunk_size, __FILE__, __LINE__)
+
+/**
+ * @brief Releases every chunk owned by the arena.
+ * 
+ * @param arena The arena to destroy.
+ */
+void arena_destroy(Arena * arena);
+
+/**
+ * @brief Allocates memory aligned to ARENA_DEFAULT_ALIGNMENT.
+ * 
+ * @param arena The arena to allocate from.
+ * @param size The number of bytes to allocate.
+ * @return void * A pointer to the uninitialized memory, or NULL on failure.
+ */
+void * arena_push(Arena * arena, size_t size);
+
+/**
+ * @brief Allocates memory with the given alignment.
+ * 
+ * @param arena The arena to allocate from.
+ * @param size The number of bytes to allocate.
+ * @param alignment The required alignment, must be a power of two.
+ * @return void * A pointer to the uninitialized memory, or NULL on failure.
+ */
+void * arena_push_aligned(Arena * arena, size_t size, size_t alignment);
+
+/**
+ * @brief Allocates zero-initialized memory aligned to ARENA_DEFAULT_ALIGNMENT.
+ * 
+ * @param arena The arena to allocate from.
+ * @param size The number of bytes to allocate.
+ * @return void * A pointer to the zeroed memory, or NULL on failure.
+ */
+void * arena_push_zero(Arena * arena, size_t size);
+
+/**
+ * @brief Grows or shrinks the last allocation in place, when the current chunk has room.
+ * 
+ * @param arena The arena the memory was pushed to.
+ * @param memory The last memory pushed, nothing may have been pushed after it.
+ * @param size Its current size.
+ * @param new_size The size it should have.
+ * @return true if the memory now has new_size bytes,
+ * @return false if it is not the last push or the chunk is too small, nothing changes.
+ */
+bool arena_extend(Arena * arena, void * memory, size_t size, size_t new_size);
+
+/**
+ * @brief Moves the arena position back by the given number of bytes.
+ * 
+ * @param arena The arena to pop from.
+ * @param size The number of bytes to release, including any alignment padding pushed.
+ */
+void arena_pop(Arena * arena, size_t size);
+
+/**
+ * @brief Returns the current arena position.
+ * 
+ * @param arena The arena.
+ * @return size_t The position, the total of bytes pushed plus bytes skipped at chunk edges.
+ */
+size_t arena_position(const Arena * arena);
+
+/**
+ * @brief Saves the current arena position.
+ * 
+ * @param arena The arena.
+ * @return ArenaMarker A marker to pass to arena_restore.
+ */
+ArenaMarker arena_save(const Arena * arena);
+
+/**
+ * @brief Releases everything pushed since the marker was saved.
+ * 
+ * @param arena The arena.
+ * @param marker A marker saved from the same arena, not older than the last reset.
+ */
+void arena_restore(Arena * arena, ArenaMarker marker);
+
+/**
+ * @brief Releases everything pushed to the arena, keeping one chunk for reuse.
+ * 
+ * @param arena The arena to reset.
+ */
+void arena_reset(Arena * arena);
+
+#endif  // ORIGINALIS_CORE_ARENA_H
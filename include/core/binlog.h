@@ -0,0 +1,145 @@
+#ifndef ORIGINALIS_CORE_BINLOG_H
+#define ORIGINALIS_CORE_BINLOG_H
+
+#include "core/context.h"
+#include "core/log.h"
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+
+/**
+ * @author Ronald Tavarez
+ * @file binlog.h
+ * @date 2026-10-17
+ * @brief Deferred-format binary logging for the Originalis codebase.
+ *
+ * In the style of NanoLog, a BINLOG call never formats its message. The first time a callsite
+ * runs, its format string, file, function, line and level are written once to the log file as a
+ * dictionary record. After that a call only appends the callsite id, a time_ticks delta and the raw
+ * argument bytes to a buffer owned by the calling thread. Buffers are written to the file in
+ * chunks when they fill up or on binlog_flush. The decoder, binlog_decode or the binlog_decode
+ * tool, turns the file back into the text format of the console logger.
+ *
+ * Arguments are captured from the printf conversions of the format string, %n and wide
+ * characters are not supported. Strings are copied at the call, pointers are logged by value.
+ */
+
+#define BINLOG_MAX_ARGUMENTS 32         /** Most arguments a format string may consume, '*' widths and precisions included. */
+#define BINLOG_BUFFER_SIZE (64 * 1024)  /** Size of each thread's buffer, and the largest chunk in the file. */
+#define BINLOG_MAX_RECORD_BYTES 4096    /** Largest encoded message, long string arguments are truncated to fit. */
+
+/**
+ * @brief Static description of one BINLOG call, one instance lives at every callsite.
+ */
+typedef struct BinlogCallsite {
+    LOG_LEVEL level;                            /** Severity of the call. */
+    const char * format;                        /** printf format string. */
+    const char * file;                          /** File of the call. */
+    const char * func;                          /** Function of the call. */
+    int line;                                   /** Line of the call. */
+    atomic_uint generation;                     /** Log file the callsite is registered in, 0 until its first call. */
+    uint32_t id;                                /** Id written with every message, assigned on first registration. */
+    uint8_t argument_count;                     /** Number of arguments the format consumes. */
+    uint8_t arguments[BINLOG_MAX_ARGUMENTS];    /** How to read and encode each argument. */
+} BinlogCallsite;
+
+/**
+ * @brief Opens a binary log file and starts sending BINLOG calls to it.
+ *
+ * While no file is open BINLOG calls are formatted and sent to log_message_to_console.
+ *
+ * @param path The path of the file, it is truncated.
+ * @return true on success,
+ * @return false if a file is already open or the file could not be created.
+ */
+bool binlog_open(const char * path);
+
+/**
+ * @brief Writes every thread's buffer and closes the binary log file.
+ *
+ * No other thread may log while this runs.
+ */
+void binlog_close(void);
+
+/**
+ * @brief Writes every thread's buffer to the binary log file.
+ */
+void binlog_flush(void);
+
+/**
+ * @brief Encodes one message, called by the BINLOG macros.
+ *
+ * @param callsite The callsite of the call.
+ * @param ... The arguments of the format string.
+ */
+void binlog_write(BinlogCallsite * callsite, ...);
+
+/**
+ * @brief Turns a binary log back into text in the console log format.
+ *
+ * Messages are written in file order, which is per-thread chunk order when several threads log.
+ *
+ * @param input The binary log, opened in binary mode.
+ * @param output The stream to write the text to.
+ * @param timestamps true to prefix each line with its local date and time, as log_set_timestamps does.
+ * @return true if the whole file was decoded,
+ * @return false if it is not a binary log or is corrupt, lines decoded before the damage are written.
+ */
+bool binlog_decode(FILE * input, FILE * output, bool timestamps);
+
+static inline FORMAT_PRINTF(1, 2) void binlog_check_format(const char * format, ...) { (void)format; }
+
+/**
+ * @def BINLOG(log_level, log_format, ...)
+ * @brief Logs a printf-style message to the binary log, filtered like the LOG_CONSOLE_* macros.
+ *
+ * The format must be a string literal, the compiler checks it against the arguments.
+ * @param log_level The log level.
+ * @param log_format The printf format string.
+ */
+#define BINLOG(log_level, log_format, ...) do { \
+        static BinlogCallsite binlog_callsite = { .level = (log_level), .format = (log_format), .file = __FILE__, .func = __FUNCTION__, .line = __LINE__ }; \
+        if (LOG_IS_ENABLED(log_level)) { \
+            if (0) binlog_check_format(log_format, ##__VA_ARGS__); \
+            binlog_write(&binlog_callsite, ##__VA_ARGS__); \
+        } \
+    } while (0)
+
+#if LOG_COMPILE_LEVEL <= 0
+    #define BINLOG_DEBUG(format, ...) BINLOG(LOG_LEVEL_DEBUG, format, ##__VA_ARGS__)
+#else
+    #define BINLOG_DEBUG(format, ...) ((void)0)
+#endif
+
+#if LOG_COMPILE_LEVEL <= 1
+    #define BINLOG_INFO(format, ...) BINLOG(LOG_LEVEL_INFO, format, ##__VA_ARGS__)
+#else
+    #define BINLOG_INFO(format, ...) ((void)0)
+#endif
+
+#if LOG_COMPILE_LEVEL <= 2
+    #define BINLOG_SUCCESS(format, ...) BINLOG(LOG_LEVEL_SUCCESS, format, ##__VA_ARGS__)
+#else
+    #define BINLOG_SUCCESS(format, ...) ((void)0)
+#endif
+
+#if LOG_COMPILE_LEVEL <= 3
+    #define BINLOG_WARNING(format, ...) BINLOG(LOG_LEVEL_WARNING, format, ##__VA_ARGS__)
+#else
+    #define BINLOG_WARNING(format, ...) ((void)0)
+#endif
+
+#if LOG_COMPILE_LEVEL <= 4
+    #define BINLOG_ERROR(format, ...) BINLOG(LOG_LEVEL_ERROR, format, ##__VA_ARGS__)
+#else
+    #define BINLOG_ERROR(format, ...) ((void)0)
+#endif
+
+#if LOG_COMPILE_LEVEL <= 5
+    #define BINLOG_FATAL(format, ...) BINLOG(LOG_LEVEL_FATAL, format, ##__VA_ARGS__)
+#else
+    #define BINLOG_FATAL(format, ...) ((void)0)
+#endif
+
+#endif  // ORIGINALIS_CORE_BINLOG_H
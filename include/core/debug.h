@@ -2,9 +2,12 @@
 #define ORIGINALIS_CORE_DEBUG_H
 
 #include "core/log.h"
+#include "core/log_flight.h"
 #include "core/color.h"
 #include <stdarg.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
 #include <stdbool.h>
 
 /**
@@ -18,6 +21,45 @@
 
 #define DEBUG_MEMORY_GUARD_SIZE 16
 #define DEBUG_MEMORY_INIT_VALUE 0xCC
+#define DEBUG_MEMORY_FREE_VALUE 0xDD
+
+/**
+ * @def DEBUG_MEMORY_THREAD_SAFE
+ * @brief Set to 1 when building debug.c to make the debug allocator safe to call from several threads.
+ * 
+ * Tracking state is split into shards by address hash, each with its own lock, so threads
+ * allocating different blocks rarely wait on each other.
+ */
+#if !defined(DEBUG_MEMORY_THREAD_SAFE)
+    #define DEBUG_MEMORY_THREAD_SAFE 0
+#endif
+
+/**
+ * @def DEBUG_MEMORY_INLINE_HEADERS
+ * @brief Set to 1 when building debug.c to store each tracking record in front of its block.
+ * 
+ * The block is laid out as [MemoryAllocation][front guard][user memory][back guard] in a single
+ * malloc, so free finds its record by pointer arithmetic and underruns are caught as well as overruns.
+ */
+#if !defined(DEBUG_MEMORY_INLINE_HEADERS)
+    #define DEBUG_MEMORY_INLINE_HEADERS 0
+#endif
+
+/**
+ * @def DEBUG_MEMORY_PROFILER
+ * @brief Set to 0 when building debug.c to stop aggregating allocation statistics per callsite.
+ */
+#if !defined(DEBUG_MEMORY_PROFILER)
+    #define DEBUG_MEMORY_PROFILER 1
+#endif
+
+#define DEBUG_MEMORY_CALLSITE_CAPACITY 4096
+#define DEBUG_MEMORY_HISTOGRAM_BUCKETS 16
+#define DEBUG_MEMORY_SAMPLE_MAX_DEPTH 32
+#define DEBUG_MEMORY_DEFAULT_SAMPLE_RATE (512 * 1024)
+
+#define DEBUG_MEMORY_FLAG_SAMPLED 0x1      /** The block was picked by the sampling heap profiler. */
+#define DEBUG_MEMORY_FLAG_PAGE_GUARD 0x2   /** The block ends against an inaccessible page. */
 
 /**
  * @brief Helper function to check the memory guard bytes for a buffer overrun.
@@ -29,15 +71,42 @@
  */
 bool is_memory_guard_intact(void * address, size_t size);
 
+/**
+ * @brief Set the memory guard bytes to a known value to detect buffer overruns.
+ * 
+ * @param address The address of the allocated memory block.
+ * @param size The size of the allocated memory block, DEBUG_MEMORY_GUARD_SIZE bytes must follow it.
+ */
+void set_memory_guard_bytes(void * address, size_t size);
+
+#if DEBUG_MEMORY_INLINE_HEADERS
+/**
+ * @brief Helper function to check the front memory guard bytes for a buffer underrun.
+ * 
+ * @param address The address of the allocated memory block.
+ * @return true if the front guard bytes are intact,
+ * @return false if they have been overwritten.
+ */
+bool is_memory_front_guard_intact(void * address);
+#endif
+
 /**
  * @brief Structure to track memory allocations. 
+ * 
+ * Live records are indexed by address in an open-addressing hash table inside debug.c,
+ * or with DEBUG_MEMORY_INLINE_HEADERS they sit in front of their block and are linked per shard.
  */
 typedef struct MemoryAllocation {
-    void * address;                 /** Address of the allocated memory. */
-    int size;                       /** Size of the allocated memory. */
-    const char * file;              /** File where the memory was allocated. */
-    int line;                       /** Line number where the memory was allocated. */
-    struct MemoryAllocation * next; /** Pointer to the next memory allocation. */
+    void * address;                     /** Address of the allocated memory. */
+    int size;                           /** Size of the allocated memory. */
+    const char * file;                  /** File where the memory was allocated. */
+    int line;                           /** Line number where the memory was allocated. */
+    unsigned int flags;                 /** DEBUG_MEMORY_FLAG_* bits. */
+#if DEBUG_MEMORY_INLINE_HEADERS
+    uint64_t magic;                     /** Marks a live inline header. */
+    struct MemoryAllocation * previous; /** Previous block in the same shard. */
+    struct MemoryAllocation * next;     /** Next block in the same shard. */
+#endif
 } MemoryAllocation;
 
 /**
@@ -82,27 +151,244 @@ void debug_free(void * address);
 void report_memory_leaks(void);
 
 /**
- * @brief Prints a message to the console with the given log level using the given format and arguments.
+ * @brief Process-wide allocation counters kept by the counters-only tracking mode.
+ */
+typedef struct MemoryCounters {
+    uint64_t allocation_count;  /** Number of allocations made. */
+    uint64_t free_count;        /** Number of blocks freed. */
+    uint64_t live_bytes;        /** Bytes currently allocated and not freed. */
+    uint64_t peak_live_bytes;   /** Highest value live_bytes has reached. */
+} MemoryCounters;
+
+/**
+ * Counters-only version of malloc. Keeps the block size in a 16-byte header and updates atomic counters.
+ * @param size The size of the memory to allocate.
+ * @return A pointer to the allocated memory block, or NULL on failure.
+ */
+void * counted_malloc(size_t size);
+
+/**
+ * Counters-only version of realloc.
+ * @param address The current address of the memory block, from counted_malloc, counted_calloc or counted_realloc.
+ * @param size The new size of the memory block.
+ * @return A pointer to the reallocated memory block, or NULL on failure.
+ */
+void * counted_realloc(void * address, size_t size);
+
+/**
+ * Counters-only version of calloc.
+ * @param count Number of elements to allocate.
+ * @param size The size of each element.
+ * @return A pointer to the allocated memory block, or NULL on failure.
+ */
+void * counted_calloc(size_t count, size_t size);
+
+/**
+ * Counters-only version of free.
+ * @param address The address of the memory block to free.
+ */
+void counted_free(void * address);
+
+/**
+ * @brief Reads the counters kept by counted_malloc and friends.
  * 
- * @param func The name of the function where the message is being printed.
- * @param file The name of the source file where the message is being printed.
- * @param line The line number in the source file where the message is being printed. 
- * @param format The format string for the message.
- * @param ...  The arguments for the format string.
+ * @param counters Receives the counters.
  */
-static void log_assert_message(const char * func, const char * file, int line, const char * format, ...) {
-    char buffer[1024];
-    va_list arguments;
-    va_start(arguments, format);
-    vsnprintf(buffer, sizeof(buffer), format, arguments);
-    va_end(arguments);
-    log_message_to_console(LOG_LEVEL_ERROR, func, file, line, buffer);
-}
+void get_memory_counters(MemoryCounters * counters);
+
+#define MEMORY_TRACKING_NONE 0      /** MEMORY_* macros call the C allocator directly. */
+#define MEMORY_TRACKING_COUNTERS 1  /** MEMORY_* macros keep process-wide counters only. */
+#define MEMORY_TRACKING_FULL 2      /** MEMORY_* macros use the debug allocator with guards, leak tracking and profiling. */
+
+/**
+ * @def MEMORY_TRACKING_MODE
+ * @brief Selects what the MEMORY_ALLOC, MEMORY_CALLOC, MEMORY_REALLOC and MEMORY_FREE macros expand to.
+ * 
+ * Defaults to MEMORY_TRACKING_NONE when NDEBUG is defined and MEMORY_TRACKING_FULL otherwise. In
+ * MEMORY_TRACKING_NONE the macros are the plain C allocator calls, no file and line are passed
+ * and nothing is added. Blocks must be freed in the mode they were allocated in, so build every
+ * translation unit with the same mode.
+ */
+#if !defined(MEMORY_TRACKING_MODE)
+    #if defined(NDEBUG)
+        #define MEMORY_TRACKING_MODE MEMORY_TRACKING_NONE
+    #else
+        #define MEMORY_TRACKING_MODE MEMORY_TRACKING_FULL
+    #endif
+#endif
+
+#if MEMORY_TRACKING_MODE == MEMORY_TRACKING_FULL
+    #define MEMORY_ALLOC(size) debug_malloc((size), __FILE__, __LINE__)
+    #define MEMORY_CALLOC(count, size) debug_calloc((count), (size), __FILE__, __LINE__)
+    #define MEMORY_REALLOC(address, size) debug_realloc((address), (size), __FILE__, __LINE__)
+    #define MEMORY_FREE(address) debug_free(address)
+#elif MEMORY_TRACKING_MODE == MEMORY_TRACKING_COUNTERS
+    #define MEMORY_ALLOC(size) counted_malloc(size)
+    #define MEMORY_CALLOC(count, size) counted_calloc((count), (size))
+    #define MEMORY_REALLOC(address, size) counted_realloc((address), (size))
+    #define MEMORY_FREE(address) counted_free(address)
+#else
+    #define MEMORY_ALLOC(size) malloc(size)
+    #define MEMORY_CALLOC(count, size) calloc((count), (size))
+    #define MEMORY_REALLOC(address, size) realloc((address), (size))
+    #define MEMORY_FREE(address) free(address)
+#endif
+
+/**
+ * @brief Allocation statistics aggregated for one (file, line) callsite.
+ * 
+ * Histogram bucket 0 counts allocations of up to 16 bytes, bucket i counts sizes in
+ * (2^(i+3), 2^(i+4)] and the last bucket also counts everything larger.
+ */
+typedef struct MemoryCallsiteStats {
+    const char * file;                                      /** File of the callsite. */
+    int line;                                               /** Line of the callsite. */
+    uint64_t allocation_count;                              /** Number of allocations made. */
+    uint64_t total_bytes;                                   /** Bytes allocated over the whole run. */
+    uint64_t live_bytes;                                    /** Bytes currently allocated and not freed. */
+    uint64_t peak_live_bytes;                               /** Highest value live_bytes has reached. */
+    uint64_t size_histogram[DEBUG_MEMORY_HISTOGRAM_BUCKETS]; /** Allocation counts by power-of-two size class. */
+} MemoryCallsiteStats;
+
+/**
+ * @enum memory_profile_format
+ * @brief Output format of debug_memory_profile_dump.
+ */
+typedef enum memory_profile_format {
+    MEMORY_PROFILE_FORMAT_TABLE = 0,    /**< Aligned human readable table. */
+    MEMORY_PROFILE_FORMAT_CSV   = 1     /**< Comma separated values with a header row, histogram included. */
+} MEMORY_PROFILE_FORMAT;
+
+/**
+ * @enum memory_profile_sort
+ * @brief Column debug_memory_profile_dump sorts by, largest first.
+ */
+typedef enum memory_profile_sort {
+    MEMORY_PROFILE_SORT_TOTAL_BYTES = 0,
+    MEMORY_PROFILE_SORT_LIVE_BYTES  = 1,
+    MEMORY_PROFILE_SORT_PEAK_BYTES  = 2,
+    MEMORY_PROFILE_SORT_COUNT       = 3
+} MEMORY_PROFILE_SORT;
+
+/**
+ * @brief Copies the statistics of every callsite seen so far.
+ * 
+ * Counters are read without stopping other threads, so a snapshot taken while
+ * allocations are in flight may be slightly inconsistent between columns. Callsites that
+ * found no room in the table of DEBUG_MEMORY_CALLSITE_CAPACITY share one last entry,
+ * with the file "(other callsites)" and line 0.
+ * 
+ * @param stats The array to fill, may be NULL when capacity is 0.
+ * @param capacity The number of entries stats can hold.
+ * @return size_t The number of callsites recorded, which may exceed capacity.
+ */
+size_t debug_memory_profile_snapshot(MemoryCallsiteStats * stats, size_t capacity);
+
+/**
+ * @brief Writes the statistics of every callsite to a stream, sorted by the given column.
+ * 
+ * @param stream The stream to write to.
+ * @param format The output format.
+ * @param sort The column to sort by.
+ */
+void debug_memory_profile_dump(FILE * stream, MEMORY_PROFILE_FORMAT format, MEMORY_PROFILE_SORT sort);
+
+/**
+ * @brief Enables the sampling heap profiler.
+ * 
+ * Allocations are sampled with a Poisson process over allocated bytes, like tcmalloc: on
+ * average one stack trace is captured every sample_rate bytes, so large blocks are almost
+ * always sampled and the cost per byte stays constant. Samples are kept while their block
+ * is live. Stack traces use backtrace() on Linux and macOS and CaptureStackBackTrace on Windows.
+ * 
+ * @param sample_rate The mean number of bytes between samples, 0 disables sampling.
+ * DEBUG_MEMORY_DEFAULT_SAMPLE_RATE is a good value for always-on use.
+ */
+void debug_memory_set_sample_rate(size_t sample_rate);
+
+/**
+ * @brief Writes the live sampled allocations as a legacy pprof heap profile (heap_v2).
+ * 
+ * The output can be read with `pprof <binary> <file>`, pprof unsamples the counts from the
+ * rate in the header. On Linux the process memory map is appended for symbolization.
+ * 
+ * @param stream The stream to write to.
+ */
+void debug_memory_write_heap_profile(FILE * stream);
+
+/**
+ * @brief Writes the live sampled allocations in collapsed-stack format for flamegraph tools.
+ * 
+ * Each line is a semicolon separated stack, root first, followed by the estimated live bytes.
+ * Frames are named with backtrace_symbols where available, link with -rdynamic to get
+ * names for functions of the main executable, other frames are written as addresses.
+ * 
+ * @param stream The stream to write to.
+ */
+void debug_memory_write_collapsed_stacks(FILE * stream);
+
+/**
+ * @brief Enables guard pages, electric-fence style, for some allocations.
+ * 
+ * A picked block gets its own pages and is placed at their end, right before a page that cannot
+ * be accessed, so an overrun faults at the offending instruction instead of being found at free.
+ * Only the up to 15 bytes of padding that keep the block 16-byte aligned are still checked at free.
+ * Freed mappings are made inaccessible and cached for reuse, so use after free faults too and most
+ * allocations cost a protection change rather than a map and an unmap. Uses mmap/mprotect on
+ * POSIX systems and VirtualAlloc/VirtualProtect on Windows, when pages cannot be mapped the block
+ * falls back to the C allocator.
+ * 
+ * Every picked block costs at least two pages, so pick few: a size threshold suits large buffers,
+ * sampling bounds the overhead of catching overruns anywhere on large workloads.
+ * 
+ * @param minimum_size Blocks of at least this many bytes are always picked, 0 disables the threshold.
+ * @param sample_interval On average one in this many other allocations per thread is picked, 0 disables sampling.
+ */
+void debug_memory_set_page_guard(size_t minimum_size, size_t sample_interval);
+
+/**
+ * @brief Enables the quarantine that holds freed blocks back to catch use after free.
+ * 
+ * debug_free fills a block with DEBUG_MEMORY_FREE_VALUE and keeps it in a FIFO instead of
+ * returning it to the C allocator. When the block is evicted to make room its poison and guards
+ * are verified, and a write through a stale pointer is reported with the callsite that allocated
+ * the block. Each shard keeps its own ring of at most 256 blocks and byte_budget / 64 bytes, so
+ * the memory held stays bounded and blocks larger than a shard's share are released right away.
+ * Page-guarded blocks are not held, their pages already fault once freed.
+ * 
+ * @param byte_budget The total bytes of freed blocks to hold, 0 disables the quarantine.
+ * Blocks already held stay until they are evicted or flushed.
+ */
+void debug_memory_set_quarantine_size(size_t byte_budget);
+
+/**
+ * @brief Verifies and releases every block held in the quarantine.
+ * 
+ * Call it before report_memory_leaks or exit so leak checkers do not see held blocks.
+ * 
+ * @return size_t The number of blocks that were written after being freed.
+ */
+size_t debug_memory_flush_quarantine(void);
+
+/**
+ * @brief Gets the bytes of freed blocks the quarantine holds, at most the budget.
+ * 
+ * @return size_t The sum of the sizes of the held blocks.
+ */
+size_t debug_memory_quarantine_bytes(void);
 
 #define STATEMENT(statement) do { statement; } while (0) 
 
+/**
+ * @def ASSERT_BREAK()
+ * @brief Stops the process after a failed assertion, dumping the flight recorder first, see log_flight.h.
+ */
 #if !defined(ASSERT_BREAK)
-    #define ASSERT_BREAK() (*(int*)0 = 0)
+    #if LOG_FLIGHT_RECORDER
+        #define ASSERT_BREAK() (log_flight_crash(), *(int*)0 = 0)
+    #else
+        #define ASSERT_BREAK() (*(int*)0 = 0)
+    #endif
 #endif
 
 #define STATIC_ASSERT(condition, message) typedef char static_assertion_##message[(condition) ? 1 : -1]
@@ -116,10 +402,12 @@ static void log_assert_message(const char * func, const char * file, int line, c
 
 #define ASSERT_FORMAT(condition, format, ...) STATEMENT( \
     if (!(condition)) { \
-        log_assert_message(__FUNCTION__, \
+        log_format_to_console(LOG_LEVEL_ERROR, \
+            __FUNCTION__, \
             __FILE__, \
             __LINE__, \
-            "Assertion Failed: " #condition ". " format, \
+            "Assertion Failed: %s. " format, \
+            #condition, \
             ##__VA_ARGS__); \
         ASSERT_BREAK(); \
     } \
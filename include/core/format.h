@@ -0,0 +1,58 @@
+#ifndef ORIGINALIS_CORE_FORMAT_H
+#define ORIGINALIS_CORE_FORMAT_H
+
+#include "core/context.h"
+#include <stdarg.h>
+#include <stddef.h>
+
+/**
+ * @author Ronald Tavarez
+ * @file format.h
+ * @date 2026-10-17
+ * @brief Single-pass printf-style formatting for the Originalis codebase.
+ *
+ * Formats straight into the caller's buffer in one pass over the format string. Integers,
+ * hex, pointers, characters and strings never go through libc, and neither does %f for
+ * finite values up to 9 decimals and below 9e15 once scaled. Other floating point
+ * conversions (%e, %g, %a, long double, huge values) and %f results that sit on a rounding
+ * tie are handed to snprintf, for that one conversion, writing in place.
+ *
+ * The C99 flags, widths, precisions, '*' and length modifiers are supported. %p prints
+ * 0x-prefixed lowercase hex and (nil) for NULL. %n is not supported, its argument is skipped.
+ */
+
+/**
+ * @def FORMAT_PRINTF(format_index, first_argument)
+ * @brief Asks the compiler to check a function's arguments against its printf format string.
+ * @param format_index The 1-based position of the format parameter.
+ * @param first_argument The position of the first variadic argument.
+ */
+#if COMPILER_CL
+    #define FORMAT_PRINTF(format_index, first_argument)
+#else
+    #define FORMAT_PRINTF(format_index, first_argument) __attribute__((format(printf, format_index, first_argument)))
+#endif
+
+/**
+ * @brief Formats a string, like snprintf.
+ *
+ * @param buffer Receives the text, always terminated when capacity is not 0.
+ * @param capacity The size of buffer.
+ * @param format The printf format string.
+ * @param ... The arguments of the format string.
+ * @return size_t The length of the whole text, it was truncated if this is capacity or more.
+ */
+size_t format_string(char * buffer, size_t capacity, const char * format, ...) FORMAT_PRINTF(3, 4);
+
+/**
+ * @brief Formats a string from a va_list, like vsnprintf.
+ *
+ * @param buffer Receives the text, always terminated when capacity is not 0.
+ * @param capacity The size of buffer.
+ * @param format The printf format string.
+ * @param arguments The arguments of the format string.
+ * @return size_t The length of the whole text, it was truncated if this is capacity or more.
+ */
+size_t format_string_va(char * buffer, size_t capacity, const char * format, va_list arguments);
+
+#endif  // ORIGINALIS_CORE_FORMAT_H
@@ -0,0 +1,160 @@
+#ifndef ORIGINALIS_CORE_HASH_H
+#define ORIGINALIS_CORE_HASH_H
+
+#include "core/string.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @author Ronald Tavarez
+ * @file hash.h
+ * @date 2026-10-17
+ * @brief Fast non-cryptographic hashing for the Originalis codebase.
+ *
+ * hash_u64 and hash_pointer mix one integer, for tables keyed by addresses or ids. hash_bytes
+ * hashes memory to 64 bits in two ways picked by length. Up to HASH_SHORT_BYTES it is in the
+ * style of wyhash: 128-bit multiplies of 16 bytes at a time, a few nanoseconds for short keys.
+ * Past that it is in the style of XXH3: eight 64-bit lanes take 32x32-bit multiplies of each
+ * 64-byte stripe, which SSE2, AVX2 and NEON compute two or four lanes at a time, and the lanes are
+ * scrambled after every HASH_BLOCK_BYTES. Every instruction set gives the same hash.
+ *
+ * HashState hashes input that arrives in pieces, to the same value as hash_bytes of the whole.
+ * HASH_LITERAL hashes a string literal at compile time with FNV-1a, hash_fnv1a is its runtime
+ * twin. None of these resist an attacker choosing keys, and hashes are only stable across
+ * machines of the same byte order.
+ */
+
+#define HASH_SHORT_BYTES 256            /** Longest input hashed by the short path. */
+#define HASH_STRIPE_BYTES 64            /** Bytes the long path reads per stripe. */
+#define HASH_BLOCK_BYTES 1024           /** Bytes between scrambles of the long path lanes. */
+#define HASH_LITERAL_MAX_BYTES 64       /** Longest literal HASH_LITERAL takes. */
+
+#define HASH_FNV_OFFSET 0xcbf29ce484222325ULL
+#define HASH_FNV_PRIME 0x100000001b3ULL
+
+/**
+ * @brief State of a hash fed in pieces, see hash_stream_init.
+ */
+typedef struct HashState {
+    uint64_t lanes[8];                                          /** Long path accumulators. */
+    uint64_t seed;                                              /** Seed of the hash. */
+    uint64_t length;                                            /** Bytes fed so far. */
+    size_t pending;                                             /** Bytes of the current block in buffer. */
+    unsigned char buffer[HASH_STRIPE_BYTES + HASH_BLOCK_BYTES]; /** The last stripe of the previous block, then the current block. */
+} HashState;
+
+/**
+ * @brief Mixes a 64-bit integer, every input bit affects every output bit.
+ *
+ * @param value The integer.
+ * @return uint64_t The hash, the MurmurHash3 finalizer, a bijection.
+ */
+static inline uint64_t hash_u64(uint64_t value) {
+    value ^= value >> 33;
+    value *= 0xff51afd7ed558ccdULL;
+    value ^= value >> 33;
+    value *= 0xc4ceb9fe1a85ec53ULL;
+    value ^= value >> 33;
+    return value;
+}
+
+/**
+ * @brief Hashes an address, allocations share their low bits so they must be mixed.
+ *
+ * @param pointer The address.
+ * @return uint64_t The hash.
+ */
+static inline uint64_t hash_pointer(const void * pointer) {
+    return hash_u64((uint64_t)(uintptr_t)pointer);
+}
+
+/**
+ * @brief Hashes memory.
+ *
+ * @param data The bytes, may be NULL when length is 0.
+ * @param length The number of bytes.
+ * @param seed Picks one of many hash functions, 0 is fine.
+ * @return uint64_t The hash.
+ */
+uint64_t hash_bytes(const void * data, size_t length, uint64_t seed);
+
+/**
+ * @brief Hashes a terminated string with seed 0, see hash_bytes.
+ *
+ * @param string The string, NULL hashes as the empty string.
+ * @return uint64_t The hash of its bytes, without the terminator.
+ */
+uint64_t hash_string(const char * string);
+
+/**
+ * @brief Starts a hash fed in pieces.
+ *
+ * @param state The state to initialize.
+ * @param seed The seed, as for hash_bytes.
+ */
+void hash_stream_init(HashState * state, uint64_t seed);
+
+/**
+ * @brief Feeds the next bytes to a hash.
+ *
+ * @param state The state.
+ * @param data The bytes, may be NULL when length is 0.
+ * @param length The number of bytes.
+ */
+void hash_stream_update(HashState * state, const void * data, size_t length);
+
+/**
+ * @brief Gets the hash of every byte fed so far, the state can be fed more afterwards.
+ *
+ * @param state The state.
+ * @return uint64_t The same hash as hash_bytes of all the bytes.
+ */
+uint64_t hash_stream_final(const HashState * state);
+
+/**
+ * @brief Hashes memory with 64-bit FNV-1a, one byte at a time, the runtime twin of HASH_LITERAL.
+ *
+ * @param data The bytes, may be NULL when length is 0.
+ * @param length The number of bytes.
+ * @return uint64_t The hash.
+ */
+uint64_t hash_fnv1a(const void * data, size_t length);
+
+/**
+ * @def HASH_LITERAL(literal)
+ * @brief The hash_fnv1a of a string literal, without its terminator, computed by the compiler.
+ *
+ * Every compiler folds it to a constant when optimizing, GCC and Clang also in static
+ * initializers. It is not an integer constant expression, so it cannot be a case label.
+ * Literals longer than HASH_LITERAL_MAX_BYTES do not compile.
+ */
+#define HASH_LITERAL(literal) (sizeof(char[sizeof(literal) <= HASH_LITERAL_MAX_BYTES + 1 ? 1 : -1]) * 0 + \
+    HASH_LITERAL_8(literal, 56, HASH_LITERAL_8(literal, 48, HASH_LITERAL_8(literal, 40, HASH_LITERAL_8(literal, 32, \
+    HASH_LITERAL_8(literal, 24, HASH_LITERAL_8(literal, 16, HASH_LITERAL_8(literal, 8, HASH_LITERAL_8(literal, 0, HASH_FNV_OFFSET)))))))))
+
+// One FNV-1a step per byte, a step past the end multiplies by 1 so the hash appears once per step.
+#define HASH_LITERAL_STEP(literal, index, hash) \
+    (((hash) ^ ((index) < sizeof(literal) - 1 ? (uint64_t)(unsigned char)(literal)[(index) < sizeof(literal) ? (index) : 0] : 0)) * \
+    ((index) < sizeof(literal) - 1 ? HASH_FNV_PRIME : 1))
+#define HASH_LITERAL_8(literal, index, hash) \
+    HASH_LITERAL_STEP(literal, index + 7, HASH_LITERAL_STEP(literal, index + 6, HASH_LITERAL_STEP(literal, index + 5, HASH_LITERAL_STEP(literal, index + 4, \
+    HASH_LITERAL_STEP(literal, index + 3, HASH_LITERAL_STEP(literal, index + 2, HASH_LITERAL_STEP(literal, index + 1, HASH_LITERAL_STEP(literal, index, hash))))))))
+
+/**
+ * @brief Gets the instructions the long path runs on.
+ *
+ * @return STRING_SIMD AVX2 or SSE2 on x64, NEON on ARM64, NONE elsewhere, detected on the first call.
+ */
+STRING_SIMD hash_simd(void);
+
+/**
+ * @brief Makes the long path run on other instructions, for tests and benchmarks.
+ *
+ * @param simd The instructions.
+ * @return true if they are used from now on,
+ * @return false if the CPU or the build does not support them, nothing changes.
+ */
+bool hash_set_simd(STRING_SIMD simd);
+
+#endif  // ORIGINALIS_CORE_HASH_H
@@ -0,0 +1,119 @@
+#ifndef ORIGINALIS_CORE_INTERN_H
+#define ORIGINALIS_CORE_INTERN_H
+
+#include "core/string.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @author Ronald Tavarez
+ * @file intern.h
+ * @date 2026-10-17
+ * @brief Process-wide string interning for the Originalis codebase.
+ *
+ * Interning maps a string to a small handle, equal strings always to the same one, so
+ * comparing interned strings is an integer compare and each distinct string is stored once.
+ * The bytes are copied into one arena and stay valid, at the same address, until the process
+ * ends, there is no way to remove a string.
+ *
+ * Lookups of strings already interned take no lock: the hash table is published with a
+ * release store and readers probe it with acquire loads. Adding a string takes a mutex, a
+ * full table is replaced by one twice as large and the old one is kept for readers still in
+ * it. intern_static also remembers the address of a string that never changes, such as
+ * __FILE__ or __func__, so interning it again only hashes the pointer.
+ */
+
+/**
+ * @def INTERN_PAGE_STRINGS
+ * @brief Handles per page of the handle directory, a power of two.
+ */
+#if !defined(INTERN_PAGE_STRINGS)
+    #define INTERN_PAGE_STRINGS 1024
+#endif
+
+/**
+ * @def INTERN_MAX_PAGES
+ * @brief Pages in the handle directory, INTERN_PAGE_STRINGS * INTERN_MAX_PAGES strings can be interned.
+ */
+#if !defined(INTERN_MAX_PAGES)
+    #define INTERN_MAX_PAGES 4096
+#endif
+
+/**
+ * @def INTERN_STATIC_SLOTS
+ * @brief Addresses intern_static remembers, a power of two. Once it is full the others are hashed by content.
+ */
+#if !defined(INTERN_STATIC_SLOTS)
+    #define INTERN_STATIC_SLOTS 4096
+#endif
+
+#define INTERN_NONE 0   /** The handle of no string, returned on failure. */
+
+/**
+ * @brief A handle of an interned string, equal strings have equal handles.
+ */
+typedef uint32_t InternHandle;
+
+/**
+ * @brief Interns a terminated string.
+ *
+ * @param string The string, copied if it is new.
+ * @return InternHandle Its handle, or INTERN_NONE if string is NULL or memory ran out.
+ */
+InternHandle intern_string(const char * string);
+
+/**
+ * @brief Interns the bytes of a view, they may contain zeros.
+ *
+ * @param view The bytes, copied and terminated if they are new.
+ * @return InternHandle Their handle, or INTERN_NONE if memory ran out.
+ */
+InternHandle intern_view(StringView view);
+
+/**
+ * @brief Interns a string that is never changed or freed, remembering its address.
+ *
+ * @param string A string literal, __FILE__, __func__ or another string with static storage.
+ * @return InternHandle Its handle, the same as intern_string gives, or INTERN_NONE if string is NULL or memory ran out.
+ */
+InternHandle intern_static(const char * string);
+
+/**
+ * @brief Finds the handle of bytes without interning them.
+ *
+ * @param view The bytes.
+ * @return InternHandle Their handle, or INTERN_NONE if they were never interned.
+ */
+InternHandle intern_lookup(StringView view);
+
+/**
+ * @brief Gets an interned string.
+ *
+ * @param handle The handle.
+ * @return const char * The terminated string, valid until the process ends, or NULL for INTERN_NONE.
+ */
+const char * intern_get(InternHandle handle);
+
+/**
+ * @brief Gets an interned string as a view, with its length.
+ *
+ * @param handle The handle.
+ * @return StringView The string, empty with no data for INTERN_NONE.
+ */
+StringView intern_get_view(InternHandle handle);
+
+/**
+ * @brief Returns the number of distinct strings interned, for monitoring.
+ *
+ * @return size_t The number of strings.
+ */
+size_t intern_count(void);
+
+/**
+ * @brief Returns the bytes held by the interning tables and strings, for monitoring.
+ *
+ * @return size_t The number of bytes, retired tables included.
+ */
+size_t intern_memory_bytes(void);
+
+#endif  // ORIGINALIS_CORE_INTERN_H
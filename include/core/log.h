@@ -1,6 +1,13 @@
 #ifndef ORIGINALIS_CORE_LOG_H
 #define ORIGINALIS_CORE_LOG_H
 
+#include "core/format.h"
+#include <stdio.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
 /**
  * @author Ronald Tavarez
  * @file log.h
@@ -9,15 +16,13 @@
  * Provides a basic logging system, enabling message to be logged with
  * different levels of severity. Each logged message will be associated
  * with the file and line from where it's logged.
- */
-
-/**
- * TODO: Configurable Log level -> set minimum log level to be shown.
- * TODO: File logging
- * TODO: Timestamps
- * TODO: Log rotation
- * TODO: Thread safe logger
- * TODO: Variadic argument logger and string format
+ * 
+ * A message is formatted once into a LogLine and handed to every registered
+ * LogSink. The console sink, writing colored lines to stdout, is registered
+ * by default, see log_file.h for a buffered file sink with rotation.
+ * 
+ * Lines are text by default, log_set_encoding switches every sink to JSON
+ * lines or logfmt for log aggregators, see log_encode.h.
  */
 
 /**
@@ -34,6 +39,152 @@ typedef enum log_level {
     LOG_LEVEL_UNKNOWN = -1  /**< Unrecognized log level used for string to log level conversion */
 } LOG_LEVEL;
 
+/**
+ * @def LOG_COMPILE_LEVEL
+ * @brief Lowest level the LOG_CONSOLE_* macros are compiled for, as the number of a LOG_LEVEL value.
+ * 
+ * Macros below it expand to nothing, their arguments are not even evaluated. Defaults to 0, LOG_LEVEL_DEBUG.
+ * For example build with -DLOG_COMPILE_LEVEL=3 to keep only WARNING, ERROR and FATAL.
+ */
+#if !defined(LOG_COMPILE_LEVEL)
+    #define LOG_COMPILE_LEVEL 0
+#endif
+
+/**
+ * @def LOG_FLIGHT_RECORDER
+ * @brief Set to 0 to stop recording log calls, and filtered string literals, for crash dumps, see log_flight.h.
+ */
+#if !defined(LOG_FLIGHT_RECORDER)
+    #define LOG_FLIGHT_RECORDER 1
+#endif
+
+/**
+ * @brief Lowest level the LOG_CONSOLE_* macros log at run time, LOG_LEVEL_DEBUG by default.
+ * 
+ * Macros compare against it before evaluating their arguments, so a filtered call costs a load,
+ * a branch and, when its message is a string literal, a flight recorder entry of it unformatted,
+ * see LOG_FLIGHT_RECORDER.
+ * Set it with log_set_level, ideally at start up before other threads log.
+ * Direct calls to log_message_to_console are not filtered.
+ */
+extern LOG_LEVEL log_minimum_level;
+
+/**
+ * @brief Sets the lowest level the LOG_CONSOLE_* macros log at run time.
+ * 
+ * @param level The minimum level.
+ */
+void log_set_level(LOG_LEVEL level);
+
+/**
+ * @brief Sets the run time minimum level from an environment variable, e.g. ORIGINALIS_LOG_LEVEL=WARNING.
+ * 
+ * @param variable The name of the environment variable, its value is parsed with string_to_log_level.
+ * @return true if the variable named a level and it was applied,
+ * @return false if it is unset or unknown, the level is left unchanged.
+ */
+bool log_set_level_from_environment(const char * variable);
+
+/**
+ * @def LOG_IS_ENABLED(level)
+ * @brief Checks whether the LOG_CONSOLE_* macro of a level would log at run time.
+ * @param level The log level.
+ */
+#define LOG_IS_ENABLED(level) ((level) >= log_minimum_level)
+
+/**
+ * @brief Turns the timestamp at the start of every line on or off, it is off by default.
+ * 
+ * The time is read with time_ticks at the call and only converted and formatted when the
+ * line is, on the writer thread in asynchronous mode. See core/time.h.
+ * 
+ * @param enabled true to prefix lines with the local date and time.
+ */
+void log_set_timestamps(bool enabled);
+
+/**
+ * @brief Turns folding of identical consecutive lines on or off, it is off by default.
+ * 
+ * While it is on, a line equal to the one before it apart from the time is counted instead of
+ * written, and "Last message repeated N times." is written at its level before the next
+ * different line, or when the sinks are flushed. See log_limit.h to rate limit a call site.
+ * 
+ * @param enabled true to fold repeated lines.
+ */
+void log_set_coalescing(bool enabled);
+
+/**
+ * @brief Returns the number of lines folded into a repeated summary since start up, for monitoring.
+ * 
+ * @return uint64_t The number of lines.
+ */
+uint64_t log_coalesced_count(void);
+
+/**
+ * @enum log_encoding
+ * @brief How log lines are written.
+ */
+typedef enum log_encoding {
+    LOG_ENCODING_TEXT   = 0,    /**< "[LEVEL] (func: file:line) message key=value", the default. */
+    LOG_ENCODING_JSON   = 1,    /**< One JSON object per line. */
+    LOG_ENCODING_LOGFMT = 2     /**< One line of key=value pairs. */
+} LOG_ENCODING;
+
+/**
+ * @brief Sets how log lines are written, ideally at start up before other threads log.
+ * 
+ * JSON and logfmt lines always hold the time and are not colored on the console.
+ * 
+ * @param encoding The encoding.
+ */
+void log_set_encoding(LOG_ENCODING encoding);
+
+/**
+ * @enum log_field_type
+ * @brief Type of the value of a LogField.
+ */
+typedef enum log_field_type {
+    LOG_FIELD_TYPE_STRING,      /**< Null terminated string. */
+    LOG_FIELD_TYPE_INTEGER,     /**< Signed 64-bit integer. */
+    LOG_FIELD_TYPE_UNSIGNED,    /**< Unsigned 64-bit integer. */
+    LOG_FIELD_TYPE_FLOAT,       /**< Double. */
+    LOG_FIELD_TYPE_BOOLEAN      /**< Boolean. */
+} LOG_FIELD_TYPE;
+
+/**
+ * @brief A typed key and value attached to a log message, written after it.
+ */
+typedef struct LogField {
+    const char * key;               /** Name of the field, a plain identifier. */
+    LOG_FIELD_TYPE type;            /** Which member of the union holds the value. */
+    union {
+        const char * string;
+        int64_t integer;
+        uint64_t unsigned_integer;
+        double floating;
+        bool boolean;
+    };
+} LogField;
+
+/**
+ * @def LOG_FIELD_STRING(key, value)
+ * @brief Makes a string field for LOG_CONSOLE_FIELDS, LOG_FIELD_INTEGER, LOG_FIELD_UNSIGNED,
+ * LOG_FIELD_FLOAT and LOG_FIELD_BOOLEAN make the other types.
+ * @param field_key The name of the field.
+ * @param value The value, only read during the log call.
+ */
+#define LOG_FIELD_STRING(field_key, value) ((LogField){ .key = (field_key), .type = LOG_FIELD_TYPE_STRING, .string = (value) })
+#define LOG_FIELD_INTEGER(field_key, value) ((LogField){ .key = (field_key), .type = LOG_FIELD_TYPE_INTEGER, .integer = (int64_t)(value) })
+#define LOG_FIELD_UNSIGNED(field_key, value) ((LogField){ .key = (field_key), .type = LOG_FIELD_TYPE_UNSIGNED, .unsigned_integer = (uint64_t)(value) })
+#define LOG_FIELD_FLOAT(field_key, value) ((LogField){ .key = (field_key), .type = LOG_FIELD_TYPE_FLOAT, .floating = (double)(value) })
+#define LOG_FIELD_BOOLEAN(field_key, value) ((LogField){ .key = (field_key), .type = LOG_FIELD_TYPE_BOOLEAN, .boolean = (value) })
+
+/**
+ * @def LOG_MAX_FIELDS_BYTES
+ * @brief Most bytes the encoded fields of one message take, fields past it are dropped whole.
+ */
+#define LOG_MAX_FIELDS_BYTES 256
+
 /**
  * @brief Converts the given log level to a string representation.
  * 
@@ -51,7 +202,84 @@ const char * log_level_to_string(LOG_LEVEL level);
 LOG_LEVEL string_to_log_level(const char * string);
 
 /**
- * @brief Log a message with a particular severity level to stdout.
+ * @def LOG_MAX_SINKS
+ * @brief Most sinks that can be registered at once.
+ */
+#define LOG_MAX_SINKS 8
+
+/**
+ * @brief A message formatted once for every sink, as "[LEVEL] (func: file:line) message\n",
+ * preceded by "YYYY-MM-DD HH:MM:SS.uuuuuu " when timestamps are on, or as a JSON or logfmt
+ * line, see log_set_encoding.
+ */
+typedef struct LogLine {
+    LOG_LEVEL level;        /** Severity of the message. */
+    uint64_t timestamp;     /** Wall clock time of the log call, nanoseconds since the Unix epoch. */
+    const char * text;      /** The formatted line, ending in a newline, not terminated. */
+    size_t length;          /** Number of bytes in text. */
+    size_t label_start;     /** Offset of the "[LEVEL]" label in text, for sinks that decorate it. */
+    size_t label_length;    /** Length of the label, 0 for JSON and logfmt lines. */
+    size_t content_start;   /** Offset of the part of text that does not depend on the time. */
+    const char * func;      /** Function of the log call. */
+    const char * file;      /** File of the log call. */
+    int line;               /** Line of the log call. */
+} LogLine;
+
+typedef struct LogSink LogSink;
+
+/**
+ * @brief A destination for log lines. Implementations embed it as their first member.
+ * 
+ * write may be called from several threads at once, and from the writer thread in asynchronous
+ * mode, so sinks with state must lock it themselves.
+ */
+struct LogSink {
+    void (*write)(LogSink * sink, const LogLine * line);    /** Takes one line, may buffer it. */
+    void (*flush)(LogSink * sink);                          /** Hands buffered lines to the OS. */
+    LOG_LEVEL minimum_level;                                /** Lines below this level are not passed to write. */
+};
+
+/**
+ * @brief The sink writing lines to stdout, registered at start up.
+ * 
+ * On a terminal each line is written unbuffered with a single system call, so it shows at once
+ * and lines of several threads do not interleave. Redirected to a pipe or a file, lines are
+ * buffered by stdio like printf output. Levels are colored only if stdout is a terminal and
+ * NO_COLOR is not set, checked on the first line, see log_set_console_colors. Remove it with
+ * log_remove_sink to log only to other sinks.
+ */
+extern LogSink log_console_sink;
+
+/**
+ * @brief Colors the console sink's levels or not, whether stdout is a terminal or not.
+ * 
+ * @param enabled true to write the color escape sequences.
+ */
+void log_set_console_colors(bool enabled);
+
+/**
+ * @brief Registers a sink, every later message is written to it.
+ * 
+ * No other thread may log while sinks are added or removed. Registered sinks are flushed at exit.
+ * 
+ * @param sink The sink, it must stay valid until removed.
+ * @return true if the sink was added,
+ * @return false if it is already registered or LOG_MAX_SINKS are.
+ */
+bool log_add_sink(LogSink * sink);
+
+/**
+ * @brief Flushes a sink and unregisters it.
+ * 
+ * No other thread may log while sinks are added or removed.
+ * 
+ * @param sink The sink.
+ * @return true if the sink was registered.
+ */
+bool log_remove_sink(LogSink * sink);
+
+/**
+ * @brief Log a message with a particular severity level to every registered sink, stdout by default.
  * 
  * @param level The severity level of the log.
  * @param file The source file from where the log was made.
@@ -60,46 +288,281 @@ LOG_LEVEL string_to_log_level(const char * string);
  */
 void log_message_to_console(LOG_LEVEL level, const char * func, const char * file, int line, const char * message);
 
+/**
+ * @brief Formats a message straight into the log line and logs it like log_message_to_console.
+ * 
+ * The message is formatted with format_string, no intermediate buffer and no allocation unless
+ * the line is longer than 1024 bytes. In asynchronous mode it is formatted into the ring record.
+ * 
+ * @param level The severity level of the log.
+ * @param func The function from where the log was made.
+ * @param file The source file from where the log was made.
+ * @param line The line number in the source file.
+ * @param format The printf format string of the message.
+ * @param ... The arguments of the format string.
+ */
+void log_format_to_console(LOG_LEVEL level, const char * func, const char * file, int line, const char * format, ...) FORMAT_PRINTF(5, 6);
+
+/**
+ * @brief log_format_to_console taking a va_list.
+ */
+void log_format_to_console_va(LOG_LEVEL level, const char * func, const char * file, int line, const char * format, va_list arguments);
+
+/**
+ * @brief Logs a message with typed fields, see LOG_CONSOLE_FIELDS.
+ * 
+ * The fields are encoded on the calling thread, into a stack buffer of LOG_MAX_FIELDS_BYTES,
+ * so their strings only need to live for the call, in asynchronous mode too.
+ * 
+ * @param level The severity level of the log.
+ * @param func The function from where the log was made.
+ * @param file The source file from where the log was made.
+ * @param line The line number in the source file.
+ * @param message The message.
+ * @param fields The fields.
+ * @param field_count The number of fields.
+ */
+void log_fields_to_console(LOG_LEVEL level, const char * func, const char * file, int line, const char * message, const LogField * fields, size_t field_count);
+
+/**
+ * @brief Writes a message to a stream in the console log format, synchronously and without level filtering.
+ * 
+ * @param stream The stream to write to.
+ * @param level The severity level of the log.
+ * @param func The function from where the log was made.
+ * @param file The source file from where the log was made.
+ * @param line The line number in the source file.
+ * @param message The actual log message.
+ */
+void log_message_to_stream(FILE * stream, LOG_LEVEL level, const char * func, const char * file, int line, const char * message);
+
+/**
+ * @def LOG_ASYNC_MESSAGE_CAPACITY
+ * @brief Longest message, in bytes, an asynchronous log record holds with its encoded fields. Longer messages are truncated.
+ */
+#define LOG_ASYNC_MESSAGE_CAPACITY 464
+
+/**
+ * @enum log_overflow_policy
+ * @brief What an asynchronous log call does when the ring buffer is full.
+ */
+typedef enum log_overflow_policy {
+    LOG_OVERFLOW_BLOCK       = 0,   /**< Wait for the writer thread to make room. Nothing is lost. */
+    LOG_OVERFLOW_DROP_NEWEST = 1,   /**< Discard the message being logged. */
+    LOG_OVERFLOW_DROP_OLDEST = 2    /**< Discard the oldest message not yet written to make room. */
+} LOG_OVERFLOW_POLICY;
+
+/**
+ * @brief Switches log_message_to_console to asynchronous mode.
+ * 
+ * Callers copy their record into a bounded lock-free ring buffer (a Vyukov bounded queue) and
+ * return, a writer thread formats records and hands them to the sinks, flushing them whenever
+ * the ring runs empty. The func and file passed
+ * to log calls must outlive the write, which holds for __FUNCTION__ and __FILE__. The log is
+ * flushed at exit, and after every FATAL message before the call returns.
+ * 
+ * @param capacity The number of records the ring holds, rounded up to a power of two.
+ * @param policy What a log call does when the ring is full.
+ * @return true if asynchronous mode is running,
+ * @return false if it was already running or the ring or writer thread could not be created.
+ */
+bool log_async_start(size_t capacity, LOG_OVERFLOW_POLICY policy);
+
+/**
+ * @brief Writes every pending record, stops the writer thread and returns to synchronous mode.
+ * 
+ * No other thread may log while this runs.
+ */
+void log_async_stop(void);
+
+/**
+ * @brief Waits until every record logged before the call has been written, then flushes every sink.
+ * 
+ * In synchronous mode it only flushes the sinks.
+ */
+void log_async_flush(void);
+
+/**
+ * @brief Gets the number of records discarded by the overflow policy since the process started.
+ * 
+ * @return uint64_t The number of dropped records.
+ */
+uint64_t log_async_dropped_count(void);
+
+/**
+ * @brief Records a message in the calling thread's flight recorder without logging it, see log_flight.h.
+ * 
+ * Called by the LOG_CONSOLE_* macros for messages below the minimum level.
+ * 
+ * @param level The severity level of the message.
+ * @param func The function from where the log was made.
+ * @param file The source file from where the log was made.
+ * @param line The line number in the source file.
+ * @param message The message, or the format string of a printf-style message.
+ */
+void log_flight_record(LOG_LEVEL level, const char * func, const char * file, int line, const char * message);
+
+/**
+ * @brief log_flight_record for a string literal, kept by pointer instead of copied.
+ */
+void log_flight_record_literal(LOG_LEVEL level, const char * func, const char * file, int line, const char * message);
+
+/**
+ * @def LOG_FLIGHT_RECORD(level, message)
+ * @brief Records a call filtered out below the minimum level, only when its message is a string literal.
+ *
+ * Filtered calls must not evaluate their arguments, __builtin_constant_p tells a literal from an
+ * expression without evaluating it. Compilers without it record no filtered calls.
+ */
+#if LOG_FLIGHT_RECORDER && (COMPILER_GCC || COMPILER_CLANG)
+    #define LOG_FLIGHT_RECORD(level, message) (__builtin_constant_p(message) ? \
+        log_flight_record_literal(level, __FUNCTION__, __FILE__, __LINE__, message) : (void)0)
+#else
+    #define LOG_FLIGHT_RECORD(level, message) ((void)0)
+#endif
+
 /**
  * @def LOG_CONSOLE_DEBUG(message)
- * @brief Logs a message with a DEBUG severity to stdout.
+ * @brief Logs a message with a DEBUG severity to the log sinks.
  * @param message The actual log message.
  */
-#define LOG_CONSOLE_DEBUG(message) log_message_to_console(LOG_LEVEL_DEBUG, __FUNCTION__, __FILE__, __LINE__, message)
+#if LOG_COMPILE_LEVEL <= 0
+    #define LOG_CONSOLE_DEBUG(message) (LOG_IS_ENABLED(LOG_LEVEL_DEBUG) ? log_message_to_console(LOG_LEVEL_DEBUG, __FUNCTION__, __FILE__, __LINE__, message) : LOG_FLIGHT_RECORD(LOG_LEVEL_DEBUG, message))
+#else
+    #define LOG_CONSOLE_DEBUG(message) ((void)0)
+#endif
 
 /**
  * @def LOG_CONSOLE_INFO(message)
- * @brief Logs a message with an INFO severity to stdout.
+ * @brief Logs a message with an INFO severity to the log sinks.
  * @param message The actual log message.
  */
-#define LOG_CONSOLE_INFO(message) log_message_to_console(LOG_LEVEL_INFO, __FUNCTION__, __FILE__, __LINE__, message)
+#if LOG_COMPILE_LEVEL <= 1
+    #define LOG_CONSOLE_INFO(message) (LOG_IS_ENABLED(LOG_LEVEL_INFO) ? log_message_to_console(LOG_LEVEL_INFO, __FUNCTION__, __FILE__, __LINE__, message) : LOG_FLIGHT_RECORD(LOG_LEVEL_INFO, message))
+#else
+    #define LOG_CONSOLE_INFO(message) ((void)0)
+#endif
 
 /**
  * @def LOG_CONSOLE_SUCCESS(message)
- * @brief Logs a message with a SUCCESS severity to stdout.
+ * @brief Logs a message with a SUCCESS severity to the log sinks.
  * @param message The actual log message.
  */
-#define LOG_CONSOLE_SUCCESS(message) log_message_to_console(LOG_LEVEL_SUCCESS, __FUNCTION__, __FILE__, __LINE__, message)
+#if LOG_COMPILE_LEVEL <= 2
+    #define LOG_CONSOLE_SUCCESS(message) (LOG_IS_ENABLED(LOG_LEVEL_SUCCESS) ? log_message_to_console(LOG_LEVEL_SUCCESS, __FUNCTION__, __FILE__, __LINE__, message) : LOG_FLIGHT_RECORD(LOG_LEVEL_SUCCESS, message))
+#else
+    #define LOG_CONSOLE_SUCCESS(message) ((void)0)
+#endif
 
 /**
  * @def LOG_CONSOLE_WARNING(message)
- * @brief Logs a message with a WARNING severity to stdout.
+ * @brief Logs a message with a WARNING severity to the log sinks.
  * @param message The actual log message.
  */
-#define LOG_CONSOLE_WARNING(message) log_message_to_console(LOG_LEVEL_WARNING, __FUNCTION__, __FILE__, __LINE__, message)
+#if LOG_COMPILE_LEVEL <= 3
+    #define LOG_CONSOLE_WARNING(message) (LOG_IS_ENABLED(LOG_LEVEL_WARNING) ? log_message_to_console(LOG_LEVEL_WARNING, __FUNCTION__, __FILE__, __LINE__, message) : LOG_FLIGHT_RECORD(LOG_LEVEL_WARNING, message))
+#else
+    #define LOG_CONSOLE_WARNING(message) ((void)0)
+#endif
 
 /**
  * @def LOG_CONSOLE_ERROR(message)
- * @brief Logs a message with an ERROR severity to stdout.
+ * @brief Logs a message with an ERROR severity to the log sinks.
  * @param message The actual log message.
  */
-#define LOG_CONSOLE_ERROR(message) log_message_to_console(LOG_LEVEL_ERROR, __FUNCTION__, __FILE__, __LINE__, message)
+#if LOG_COMPILE_LEVEL <= 4
+    #define LOG_CONSOLE_ERROR(message) (LOG_IS_ENABLED(LOG_LEVEL_ERROR) ? log_message_to_console(LOG_LEVEL_ERROR, __FUNCTION__, __FILE__, __LINE__, message) : LOG_FLIGHT_RECORD(LOG_LEVEL_ERROR, message))
+#else
+    #define LOG_CONSOLE_ERROR(message) ((void)0)
+#endif
 
 /**
  * @def LOG_CONSOLE_FATAL(message)
- * @brief Logs a message with a FATAL severity to stdout. Typically indicates critical issues.
+ * @brief Logs a message with a FATAL severity to the log sinks. Typically indicates critical issues.
  * @param message The actual log message.
  */
-#define LOG_CONSOLE_FATAL(message) log_message_to_console(LOG_LEVEL_FATAL, __FUNCTION__, __FILE__, __LINE__, message)
+#if LOG_COMPILE_LEVEL <= 5
+    #define LOG_CONSOLE_FATAL(message) (LOG_IS_ENABLED(LOG_LEVEL_FATAL) ? log_message_to_console(LOG_LEVEL_FATAL, __FUNCTION__, __FILE__, __LINE__, message) : LOG_FLIGHT_RECORD(LOG_LEVEL_FATAL, message))
+#else
+    #define LOG_CONSOLE_FATAL(message) ((void)0)
+#endif
+
+/**
+ * @def LOG_CONSOLE_DEBUGF(format, ...)
+ * @brief Logs a printf-style message with a DEBUG severity to the log sinks.
+ * @param format The printf format string, checked against the arguments by the compiler.
+ */
+#if LOG_COMPILE_LEVEL <= 0
+    #define LOG_CONSOLE_DEBUGF(format, ...) (LOG_IS_ENABLED(LOG_LEVEL_DEBUG) ? log_format_to_console(LOG_LEVEL_DEBUG, __FUNCTION__, __FILE__, __LINE__, format, ##__VA_ARGS__) : LOG_FLIGHT_RECORD(LOG_LEVEL_DEBUG, format))
+#else
+    #define LOG_CONSOLE_DEBUGF(format, ...) ((void)0)
+#endif
+
+/**
+ * @def LOG_CONSOLE_INFOF(format, ...)
+ * @brief Logs a printf-style message with an INFO severity to the log sinks.
+ * @param format The printf format string, checked against the arguments by the compiler.
+ */
+#if LOG_COMPILE_LEVEL <= 1
+    #define LOG_CONSOLE_INFOF(format, ...) (LOG_IS_ENABLED(LOG_LEVEL_INFO) ? log_format_to_console(LOG_LEVEL_INFO, __FUNCTION__, __FILE__, __LINE__, format, ##__VA_ARGS__) : LOG_FLIGHT_RECORD(LOG_LEVEL_INFO, format))
+#else
+    #define LOG_CONSOLE_INFOF(format, ...) ((void)0)
+#endif
+
+/**
+ * @def LOG_CONSOLE_SUCCESSF(format, ...)
+ * @brief Logs a printf-style message with a SUCCESS severity to the log sinks.
+ * @param format The printf format string, checked against the arguments by the compiler.
+ */
+#if LOG_COMPILE_LEVEL <= 2
+    #define LOG_CONSOLE_SUCCESSF(format, ...) (LOG_IS_ENABLED(LOG_LEVEL_SUCCESS) ? log_format_to_console(LOG_LEVEL_SUCCESS, __FUNCTION__, __FILE__, __LINE__, format, ##__VA_ARGS__) : LOG_FLIGHT_RECORD(LOG_LEVEL_SUCCESS, format))
+#else
+    #define LOG_CONSOLE_SUCCESSF(format, ...) ((void)0)
+#endif
+
+/**
+ * @def LOG_CONSOLE_WARNINGF(format, ...)
+ * @brief Logs a printf-style message with a WARNING severity to the log sinks.
+ * @param format The printf format string, checked against the arguments by the compiler.
+ */
+#if LOG_COMPILE_LEVEL <= 3
+    #define LOG_CONSOLE_WARNINGF(format, ...) (LOG_IS_ENABLED(LOG_LEVEL_WARNING) ? log_format_to_console(LOG_LEVEL_WARNING, __FUNCTION__, __FILE__, __LINE__, format, ##__VA_ARGS__) : LOG_FLIGHT_RECORD(LOG_LEVEL_WARNING, format))
+#else
+    #define LOG_CONSOLE_WARNINGF(format, ...) ((void)0)
+#endif
+
+/**
+ * @def LOG_CONSOLE_ERRORF(format, ...)
+ * @brief Logs a printf-style message with an ERROR severity to the log sinks.
+ * @param format The printf format string, checked against the arguments by the compiler.
+ */
+#if LOG_COMPILE_LEVEL <= 4
+    #define LOG_CONSOLE_ERRORF(format, ...) (LOG_IS_ENABLED(LOG_LEVEL_ERROR) ? log_format_to_console(LOG_LEVEL_ERROR, __FUNCTION__, __FILE__, __LINE__, format, ##__VA_ARGS__) : LOG_FLIGHT_RECORD(LOG_LEVEL_ERROR, format))
+#else
+    #define LOG_CONSOLE_ERRORF(format, ...) ((void)0)
+#endif
+
+/**
+ * @def LOG_CONSOLE_FATALF(format, ...)
+ * @brief Logs a printf-style message with a FATAL severity to the log sinks.
+ * @param format The printf format string, checked against the arguments by the compiler.
+ */
+#if LOG_COMPILE_LEVEL <= 5
+    #define LOG_CONSOLE_FATALF(format, ...) (LOG_IS_ENABLED(LOG_LEVEL_FATAL) ? log_format_to_console(LOG_LEVEL_FATAL, __FUNCTION__, __FILE__, __LINE__, format, ##__VA_ARGS__) : LOG_FLIGHT_RECORD(LOG_LEVEL_FATAL, format))
+#else
+    #define LOG_CONSOLE_FATALF(format, ...) ((void)0)
+#endif
+
+/**
+ * @def LOG_CONSOLE_FIELDS(level, message, ...)
+ * @brief Logs a message with one or more typed fields, e.g.
+ * LOG_CONSOLE_FIELDS(LOG_LEVEL_INFO, "Loaded.", LOG_FIELD_STRING("pack", name), LOG_FIELD_INTEGER("count", count)).
+ * @param level The log level, compiled out below LOG_COMPILE_LEVEL when it is a constant.
+ * @param message The message.
+ */
+#define LOG_CONSOLE_FIELDS(level, message, ...) \
+    ((level) < LOG_COMPILE_LEVEL ? (void)0 : LOG_IS_ENABLED(level) ? \
+        log_fields_to_console(level, __FUNCTION__, __FILE__, __LINE__, message, (const LogField[]){ __VA_ARGS__ }, sizeof((const LogField[]){ __VA_ARGS__ }) / sizeof(LogField)) : \
+        LOG_FLIGHT_RECORD(level, message))
 
 #endif  // CORE_LOG_H
\ No newline at end of file
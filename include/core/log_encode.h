@@ -0,0 +1,104 @@
+#ifndef ORIGINALIS_CORE_LOG_ENCODE_H
+#define ORIGINALIS_CORE_LOG_ENCODE_H
+
+#include "core/log.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @author Ronald Tavarez
+ * @file log_encode.h
+ * @date 2026-10-17
+ * @brief Streaming JSON and logfmt encoding of log records.
+ *
+ * The encoder appends to a buffer owned by the caller, usually on the stack and reused for
+ * every record, and never allocates. Like format_string it keeps counting past the end of
+ * the buffer, so a too small buffer can be retried with the exact size.
+ *
+ * Strings are escaped by scanning 16 bytes at a time with SSE2 on x64, and 8 at a time with
+ * SWAR elsewhere, for the bytes that need escaping, and copying the runs in between whole.
+ * Bytes from 0x80 up are copied as they are, messages are expected to be UTF-8.
+ *
+ * A JSON line is {"time":"2023-11-29T10:00:00.123456Z","level":"INFO","func":"main",
+ * "file":"main.c","line":12,"message":"Loaded.","count":3} and a logfmt line is
+ * time=2023-11-29T10:00:00.123456Z level=INFO func=main file=main.c line=12 message=Loaded. count=3,
+ * both followed by a newline. The time is UTC, unlike the local time of text lines, so
+ * aggregators read it without knowing the zone of the machine.
+ */
+
+/**
+ * @brief Output position in a caller-owned buffer.
+ */
+typedef struct LogEncoder {
+    char * buffer;      /** Receives the text, not terminated. */
+    size_t capacity;    /** Size of buffer. */
+    size_t length;      /** Bytes encoded so far, the text is incomplete if it is more than capacity. */
+} LogEncoder;
+
+/**
+ * @brief Starts encoding into a buffer.
+ *
+ * @param encoder The encoder.
+ * @param buffer Receives the text, may be NULL if capacity is 0 to only measure.
+ * @param capacity The size of buffer.
+ */
+void log_encoder_init(LogEncoder * encoder, char * buffer, size_t capacity);
+
+/**
+ * @brief Appends a JSON string, quoted and escaped.
+ *
+ * @param encoder The encoder.
+ * @param text The string.
+ * @param length The number of bytes in text.
+ */
+void log_encode_json_string(LogEncoder * encoder, const char * text, size_t length);
+
+/**
+ * @brief Appends a logfmt value, quoted and escaped only if it is empty or holds a space, '=', '"' or a control byte.
+ *
+ * @param encoder The encoder.
+ * @param text The value.
+ * @param length The number of bytes in value.
+ */
+void log_encode_logfmt_value(LogEncoder * encoder, const char * text, size_t length);
+
+/**
+ * @brief Appends fields after a record's message, as ,"key":value for JSON and as key=value for logfmt and text.
+ *
+ * Fields are encoded whole or not at all, the ones that would overflow the buffer are dropped
+ * so the output stays valid. Non-finite floats are encoded as null in JSON.
+ *
+ * @param encoder The encoder.
+ * @param encoding LOG_ENCODING_JSON, LOG_ENCODING_LOGFMT or LOG_ENCODING_TEXT.
+ * @param fields The fields.
+ * @param count The number of fields.
+ */
+void log_encode_fields(LogEncoder * encoder, LOG_ENCODING encoding, const LogField * fields, size_t count);
+
+/**
+ * @brief Returns the length of the time that starts every record, the rest of a record only depends on the log call.
+ *
+ * @param encoding LOG_ENCODING_JSON or LOG_ENCODING_LOGFMT.
+ * @return size_t The number of bytes.
+ */
+size_t log_encode_time_length(LOG_ENCODING encoding);
+
+/**
+ * @brief Appends a whole record, ending in a newline.
+ *
+ * @param encoder The encoder.
+ * @param encoding LOG_ENCODING_JSON or LOG_ENCODING_LOGFMT.
+ * @param wall_ns Wall clock time of the log call, nanoseconds since the Unix epoch.
+ * @param level Severity of the message.
+ * @param func Function of the log call.
+ * @param file File of the log call.
+ * @param line Line of the log call.
+ * @param message The message, not escaped.
+ * @param message_length The number of bytes in message.
+ * @param fields Fields already encoded with log_encode_fields in the same encoding, may be NULL.
+ * @param fields_length The number of bytes in fields.
+ */
+void log_encode_record(LogEncoder * encoder, LOG_ENCODING encoding, uint64_t wall_ns, LOG_LEVEL level, const char * func, const char * file, int line,
+    const char * message, size_t message_length, const char * fields, size_t fields_length);
+
+#endif  // ORIGINALIS_CORE_LOG_ENCODE_H
@@ -0,0 +1,91 @@
+#ifndef ORIGINALIS_CORE_LOG_FILE_H
+#define ORIGINALIS_CORE_LOG_FILE_H
+
+#include "core/log.h"
+#include "core/thread.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * @author Ronald Tavarez
+ * @file log_file.h
+ * @date 2026-10-17
+ * @brief Buffered file log sink with rotation for the Originalis codebase.
+ *
+ * Lines are appended to a large user-space buffer and reach the file with a single write(2)
+ * when it fills, when it is flushed, or when a line has waited longer than the flush interval,
+ * which is checked when the next line is written. No timer runs: a lone line waits for the next
+ * one or a flush, which the asynchronous writer of log.h does whenever its queue runs empty.
+ * The sink keeps two buffers: the thread that fills one swaps in the other and writes the full
+ * one outside the buffer lock, so other threads keep logging while it writes, syncs, renames
+ * and reopens the file for a rotation.
+ *
+ * Rotated files are renamed path.1 (newest) to path.N, the oldest one is deleted.
+ */
+
+#define LOG_FILE_DEFAULT_BUFFER_SIZE (1024 * 1024)
+
+/**
+ * @enum log_file_sync_policy
+ * @brief When the sink asks the OS to put written lines on disk with fdatasync.
+ */
+typedef enum log_file_sync_policy {
+    LOG_FILE_SYNC_NEVER     = 0,    /**< Leave write back to the OS. */
+    LOG_FILE_SYNC_ON_ROTATE = 1,    /**< Sync a file before it is rotated or closed. */
+    LOG_FILE_SYNC_ON_ERROR  = 2,    /**< Also write and sync right away after every ERROR or FATAL line. */
+    LOG_FILE_SYNC_ALWAYS    = 3     /**< Sync after every write of the buffer. */
+} LOG_FILE_SYNC_POLICY;
+
+/**
+ * @brief Settings of a file sink, zero means default or disabled for every field.
+ */
+typedef struct LogFileSinkOptions {
+    size_t buffer_size;                 /** Bytes buffered between writes, 0 selects LOG_FILE_DEFAULT_BUFFER_SIZE. */
+    uint64_t rotate_size;               /** Rotate before a write would grow the file past this many bytes, 0 never. */
+    uint32_t rotate_interval;           /** Rotate at the first write once the file is this many seconds old, 0 never. */
+    uint32_t flush_interval;            /** Milliseconds a line may wait in the buffer, checked when the next line is written, 0 waits for a full buffer or a flush. */
+    unsigned int keep_count;            /** Rotated files kept, 0 truncates the file instead. */
+    LOG_FILE_SYNC_POLICY sync_policy;   /** When written lines are synced to disk. */
+} LogFileSinkOptions;
+
+/**
+ * @brief A sink writing lines to a file, register it with log_add_sink(&file_sink->sink).
+ */
+typedef struct LogFileSink {
+    LogSink sink;                   /** Interface passed to log_add_sink, must stay first. */
+    LogFileSinkOptions options;     /** Settings, with defaults applied. */
+    char * path;                    /** Path of the current file. */
+    char * rotate_path;             /** Scratch space for the names of rotated files. */
+    int file;                       /** File descriptor, -1 if the file could not be opened. */
+    uint64_t file_size;             /** Bytes in the current file. */
+    uint64_t file_opened;           /** Wall clock seconds when the current file was opened. */
+    Mutex lock;                     /** Guards the buffers, used, writing and flush_deadline. */
+    char * buffer;                  /** Buffer lines are appended to. */
+    char * spare;                   /** Second buffer, swapped in while the first one is written. */
+    size_t used;                    /** Bytes appended to buffer. */
+    bool writing;                   /** A thread owns spare and the file, it is writing outside the lock. */
+    uint64_t flush_deadline;        /** Milliseconds when the oldest buffered line must be written, 0 if buffer is empty. */
+} LogFileSink;
+
+/**
+ * @brief Opens or creates a log file, appending to it, and initializes a sink writing to it.
+ *
+ * @param sink The sink to initialize.
+ * @param path The path of the file.
+ * @param options The settings, NULL for defaults.
+ * @return true on success,
+ * @return false if the file could not be opened or the buffers allocated.
+ */
+bool log_file_sink_open(LogFileSink * sink, const char * path, const LogFileSinkOptions * options);
+
+/**
+ * @brief Writes the buffered lines, syncs them unless the policy is LOG_FILE_SYNC_NEVER and closes the file.
+ *
+ * The sink must have been removed with log_remove_sink first.
+ *
+ * @param sink The sink.
+ */
+void log_file_sink_close(LogFileSink * sink);
+
+#endif  // ORIGINALIS_CORE_LOG_FILE_H
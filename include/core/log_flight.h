@@ -0,0 +1,94 @@
+#ifndef ORIGINALIS_CORE_LOG_FLIGHT_H
+#define ORIGINALIS_CORE_LOG_FLIGHT_H
+
+#include "core/log.h"
+#include <stdarg.h>
+#include <stddef.h>
+
+/**
+ * @author Ronald Tavarez
+ * @file log_flight.h
+ * @date 2026-10-17
+ * @brief Crash-safe in-memory flight recorder of the latest log records.
+ *
+ * Every thread records its last LOG_FLIGHT_RECORDS log calls in a ring of its own. Recording one
+ * is a tick read and a copy of at most LOG_FLIGHT_TEXT_BYTES of text, with no lock and no atomic
+ * read-modify-write, so it stays on in release builds. With GCC and Clang, calls below the
+ * minimum level are recorded too when their message or format is a string literal, kept by
+ * pointer and unformatted: formatting would cost what filtering saves, and a message built by
+ * an expression is skipped because filtered calls never evaluate their arguments.
+ *
+ * The rings are dumped, merged oldest first across threads, by ASSERT_BREAK and by a handler of
+ * SIGSEGV, SIGBUS, SIGILL, SIGFPE and SIGABRT installed with the first record. The dump only
+ * uses async-signal-safe calls. The handler then restores the previous one, so the crash goes
+ * on to a debugger, sanitizer or core dump.
+ *
+ * Build with LOG_FLIGHT_RECORDER set to 0 to compile it out, see log.h.
+ */
+
+/**
+ * @def LOG_FLIGHT_RECORDS
+ * @brief Records kept per thread, a power of two.
+ */
+#if !defined(LOG_FLIGHT_RECORDS)
+    #define LOG_FLIGHT_RECORDS 64
+#endif
+
+/**
+ * @def LOG_FLIGHT_TEXT_BYTES
+ * @brief Bytes of message kept per record, longer messages are truncated.
+ */
+#if !defined(LOG_FLIGHT_TEXT_BYTES)
+    #define LOG_FLIGHT_TEXT_BYTES 96
+#endif
+
+/**
+ * @def LOG_FLIGHT_MAX_THREADS
+ * @brief Rings in the recorder. A ring is freed when its thread exits and keeps its records
+ * until another thread takes it, threads started while every ring is taken are not recorded.
+ */
+#if !defined(LOG_FLIGHT_MAX_THREADS)
+    #define LOG_FLIGHT_MAX_THREADS 64
+#endif
+
+#define LOG_FLIGHT_PATH_BYTES 256
+
+/**
+ * @brief Records a formatted message, called by the logger for every message it writes.
+ *
+ * @param level Severity of the message.
+ * @param func Function of the log call.
+ * @param file File of the log call.
+ * @param line Line of the log call.
+ * @param format The printf format string.
+ * @param arguments The arguments of the format string.
+ */
+void log_flight_record_va(LOG_LEVEL level, const char * func, const char * file, int line, const char * format, va_list arguments);
+
+/**
+ * @brief Sets where crash dumps go, stderr by default.
+ *
+ * Call it before other threads log, the file is only created when a crash is dumped.
+ *
+ * @param path The file, truncated by the dump, NULL for stderr. Paths of LOG_FLIGHT_PATH_BYTES or more are ignored.
+ */
+void log_flight_set_path(const char * path);
+
+/**
+ * @brief Writes every thread's records, oldest first, async-signal-safe.
+ *
+ * Records being written by other threads while the dump runs may come out garbled.
+ *
+ * @param descriptor The file descriptor to write to.
+ * @return size_t The number of records written.
+ */
+size_t log_flight_dump(int descriptor);
+
+/**
+ * @brief Dumps the records to the log_flight_set_path file or stderr, only the first call in the process does.
+ *
+ * Called by ASSERT_BREAK and the crash handler, async-signal-safe.
+ */
+void log_flight_crash(void);
+
+#endif  // ORIGINALIS_CORE_LOG_FLIGHT_H
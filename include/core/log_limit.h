@@ -0,0 +1,126 @@
+#ifndef ORIGINALIS_CORE_LOG_LIMIT_H
+#define ORIGINALIS_CORE_LOG_LIMIT_H
+
+#include "core/log.h"
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @author Ronald Tavarez
+ * @file log_limit.h
+ * @date 2026-10-17
+ * @brief Per-callsite rate limiting of log messages.
+ *
+ * Every LOG_CONSOLE_*_LIMITED call site owns a static token bucket, kept as a single atomic
+ * "next free slot" time (GCRA). A message that is let through costs a coarse clock read and
+ * one compare-and-swap, a suppressed one a failed comparison and a counter increment. The
+ * next message let through is preceded by "Suppressed N messages from this call site." at
+ * the same level.
+ *
+ * See log_set_coalescing in log.h to fold identical consecutive lines from any call site.
+ */
+
+/**
+ * @def LOG_RATE_LIMIT_PER_SECOND
+ * @brief Messages per second a LOG_CONSOLE_*_LIMITED call site sustains.
+ */
+#if !defined(LOG_RATE_LIMIT_PER_SECOND)
+    #define LOG_RATE_LIMIT_PER_SECOND 10
+#endif
+
+/**
+ * @def LOG_RATE_LIMIT_BURST
+ * @brief Messages a LOG_CONSOLE_*_LIMITED call site may log at once after being quiet.
+ */
+#if !defined(LOG_RATE_LIMIT_BURST)
+    #define LOG_RATE_LIMIT_BURST 20
+#endif
+
+/**
+ * @brief A token bucket, usually one static per call site.
+ */
+typedef struct LogRateLimit {
+    atomic_uint_least64_t next_ns;      /** Time the bucket would be full again, time_now_coarse_ns based. */
+    atomic_uint_least64_t suppressed;   /** Messages suppressed since the last one let through. */
+    uint64_t interval_ns;               /** Time one token takes to come back. */
+    uint64_t burst_ns;                  /** Time the whole bucket takes to come back, interval_ns times the burst. */
+} LogRateLimit;
+
+/**
+ * @def LOG_RATE_LIMIT_INIT(per_second, burst)
+ * @brief Initializer of a LogRateLimit.
+ * @param per_second Messages per second sustained, at least 1.
+ * @param burst Messages let through at once after being quiet, at least 1.
+ */
+#define LOG_RATE_LIMIT_INIT(per_second, burst) { 0, 0, 1000000000ULL / (per_second), 1000000000ULL / (per_second) * (burst) }
+
+/**
+ * @brief Takes a token from the bucket.
+ *
+ * @param limit The bucket.
+ * @return true if the message may be logged,
+ * @return false if it is suppressed, it is counted in the bucket, and in log_rate_limited_count once its summary is logged.
+ */
+bool log_rate_limit_acquire(LogRateLimit * limit);
+
+/**
+ * @brief Logs the suppressed summary of a bucket if it has one, then the message, see log_format_to_console.
+ *
+ * Called by the LOG_CONSOLE_*_LIMITED macros once log_rate_limit_acquire let a message through.
+ */
+void log_limited_to_console(LogRateLimit * limit, LOG_LEVEL level, const char * func, const char * file, int line, const char * format, ...) FORMAT_PRINTF(6, 7);
+
+/**
+ * @brief Returns the number of messages suppressed by every rate limit since start up, for monitoring.
+ *
+ * A call site's suppressed messages are added when its summary is logged, with the next message
+ * let through, so a flood is only counted once it ends or lets a message through.
+ *
+ * @return uint64_t The number of messages.
+ */
+uint64_t log_rate_limited_count(void);
+
+/**
+ * @def LOG_CONSOLE_LIMITED_RATE(level, per_second, burst, format, ...)
+ * @brief Logs a printf-style message unless its call site went over its rate.
+ * @param level The log level, compiled out below LOG_COMPILE_LEVEL when it is a constant.
+ * @param per_second Messages per second the call site sustains.
+ * @param burst Messages the call site may log at once after being quiet.
+ * @param format The printf format string.
+ */
+#define LOG_CONSOLE_LIMITED_RATE(level, per_second, burst, format, ...) do { \
+        static LogRateLimit log_rate_limit = LOG_RATE_LIMIT_INIT(per_second, burst); \
+        if ((level) >= LOG_COMPILE_LEVEL && LOG_IS_ENABLED(level) && log_rate_limit_acquire(&log_rate_limit)) \
+            log_limited_to_console(&log_rate_limit, level, __FUNCTION__, __FILE__, __LINE__, format, ##__VA_ARGS__); \
+    } while (0)
+
+/**
+ * @def LOG_CONSOLE_DEBUG_LIMITED(format, ...)
+ * @brief Logs a printf-style DEBUG message at most LOG_RATE_LIMIT_PER_SECOND times a second from this call site.
+ * @param format The printf format string.
+ */
+#define LOG_CONSOLE_DEBUG_LIMITED(format, ...) LOG_CONSOLE_LIMITED_RATE(LOG_LEVEL_DEBUG, LOG_RATE_LIMIT_PER_SECOND, LOG_RATE_LIMIT_BURST, format, ##__VA_ARGS__)
+
+/**
+ * @def LOG_CONSOLE_INFO_LIMITED(format, ...)
+ * @brief Logs a printf-style INFO message at most LOG_RATE_LIMIT_PER_SECOND times a second from this call site.
+ * @param format The printf format string.
+ */
+#define LOG_CONSOLE_INFO_LIMITED(format, ...) LOG_CONSOLE_LIMITED_RATE(LOG_LEVEL_INFO, LOG_RATE_LIMIT_PER_SECOND, LOG_RATE_LIMIT_BURST, format, ##__VA_ARGS__)
+
+/**
+ * @def LOG_CONSOLE_WARNING_LIMITED(format, ...)
+ * @brief Logs a printf-style WARNING message at most LOG_RATE_LIMIT_PER_SECOND times a second from this call site.
+ * @param format The printf format string.
+ */
+#define LOG_CONSOLE_WARNING_LIMITED(format, ...) LOG_CONSOLE_LIMITED_RATE(LOG_LEVEL_WARNING, LOG_RATE_LIMIT_PER_SECOND, LOG_RATE_LIMIT_BURST, format, ##__VA_ARGS__)
+
+/**
+ * @def LOG_CONSOLE_ERROR_LIMITED(format, ...)
+ * @brief Logs a printf-style ERROR message at most LOG_RATE_LIMIT_PER_SECOND times a second from this call site.
+ * @param format The printf format string.
+ */
+#define LOG_CONSOLE_ERROR_LIMITED(format, ...) LOG_CONSOLE_LIMITED_RATE(LOG_LEVEL_ERROR, LOG_RATE_LIMIT_PER_SECOND, LOG_RATE_LIMIT_BURST, format, ##__VA_ARGS__)
+
+#endif  // ORIGINALIS_CORE_LOG_LIMIT_H
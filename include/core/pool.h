@@ -0,0 +1,89 @@
+#ifndef ORIGINALIS_CORE_POOL_H
+#define ORIGINALIS_CORE_POOL_H
+
+#include <stddef.h>
+#include <stdbool.h>
+
+/**
+ * @author Ronald Tavarez
+ * @file pool.h
+ * @date 2026-10-17
+ * @brief Fixed-size pool allocator for the Originalis codebase.
+ * 
+ * A pool carves equally sized slots out of large slabs and recycles freed slots
+ * through an intrusive free list, so allocating and freeing a slot is O(1) and
+ * same-sized nodes stay packed together instead of being scattered over the heap.
+ * Pools are not synchronized, each pool must be used by one thread at a time.
+ */
+
+#define POOL_DEFAULT_SLOTS_PER_SLAB 256
+#define POOL_SLOT_ALIGNMENT 16
+
+/**
+ * @brief Header of a slab, the slots follow it.
+ */
+typedef struct PoolSlab {
+    struct PoolSlab * next;     /** Next slab owned by the same pool. */
+} PoolSlab;
+
+/**
+ * @brief A pool of equally sized slots.
+ */
+typedef struct Pool {
+    void * free_list;           /** Most recently freed slot, each free slot stores the next one in its first bytes. */
+    unsigned char * bump;       /** Next never-used slot in the newest slab. */
+    unsigned char * bump_end;   /** End of the newest slab. */
+    PoolSlab * slabs;           /** Every slab owned by the pool. */
+    size_t slot_size;           /** Usable size of a slot. */
+    size_t stride;              /** Distance between slots, including guard bytes and alignment padding. */
+    size_t slots_per_slab;      /** Number of slots carved from each slab. */
+    size_t count;               /** Number of slots currently allocated. */
+    bool debug;                 /** Slots carry guard bytes and are poisoned while free. */
+} Pool;
+
+/**
+ * @brief Initializes a pool. No memory is allocated until the first slot is requested.
+ * 
+ * @param pool The pool to initialize.
+ * @param slot_size The usable size of each slot.
+ * @param slots_per_slab The number of slots per slab, 0 selects POOL_DEFAULT_SLOTS_PER_SLAB.
+ */
+void pool_init(Pool * pool, size_t slot_size, size_t slots_per_slab);
+
+/**
+ * @brief Initializes a pool in debug mode.
+ * 
+ * Each slot is followed by the debug allocator's guard bytes, which are checked on free. Freed
+ * slots are filled with DEBUG_MEMORY_FREE_VALUE and the poison is verified when the slot is
+ * handed out again, catching writes through dangling pointers.
+ * 
+ * @param pool The pool to initialize.
+ * @param slot_size The usable size of each slot.
+ * @param slots_per_slab The number of slots per slab, 0 selects POOL_DEFAULT_SLOTS_PER_SLAB.
+ */
+void pool_init_debug(Pool * pool, size_t slot_size, size_t slots_per_slab);
+
+/**
+ * @brief Releases every slab owned by the pool. Slots still allocated become invalid.
+ * 
+ * @param pool The pool to destroy.
+ */
+void pool_destroy(Pool * pool);
+
+/**
+ * @brief Allocates a slot.
+ * 
+ * @param pool The pool to allocate from.
+ * @return void * A pointer to the uninitialized slot, or NULL on failure.
+ */
+void * pool_alloc(Pool * pool);
+
+/**
+ * @brief Returns a slot to the pool.
+ * 
+ * @param pool The pool the slot was allocated from.
+ * @param slot The slot to free, NULL is ignored.
+ */
+void pool_free(Pool * pool, void * slot);
+
+#endif  // ORIGINALIS_CORE_POOL_H
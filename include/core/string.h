@@ -1,23 +1,274 @@
 #ifndef ORIGINALIS_CORE_STRING_H
 #define ORIGINALIS_CORE_STRING_H
 
+#include "core/arena.h"
+#include "core/format.h"
+#include "core/pool.h"
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * @brief The vector instructions string_length and string_compare run on.
+ *
+ * The best one the CPU supports is picked on the first call, AVX2 over SSE2 on x64 and NEON
+ * on ARM64, the scalar loops everywhere else. Vector loads never read past the page that
+ * holds the end of a string, so strings may end right before unmapped memory.
+ */
+typedef enum string_simd {
+    STRING_SIMD_NONE,   /** One byte at a time. */
+    STRING_SIMD_SSE2,   /** 16 bytes at a time, x64. */
+    STRING_SIMD_AVX2,   /** 32 bytes at a time, x64 CPUs that support it. */
+    STRING_SIMD_NEON    /** 16 bytes at a time, ARM64. */
+} STRING_SIMD;
+
 /**
  * @brief Compare two string for equality.
- * 
+ *
  * @param string_one The first string.
  * @param string_two The second string.
- * @return int - Returns 0 if the strings are equal, non-zero otherwise.
+ * @return int - Returns 0 if the strings are equal, otherwise the difference of the first bytes that differ, as unsigned chars.
  */
 int string_compare(const char * string_one, const char * string_two);
 
 /**
  * @brief Get the length of a string.
- * 
+ *
  * @param string The string.
  * @return int - Returns the length of the string.
  */
 int string_length(const char * string);
 
+/**
+ * @brief Gets the instructions the string functions run on.
+ *
+ * @return STRING_SIMD The instructions in use, detected on the first call if no string function ran yet.
+ */
+STRING_SIMD string_simd(void);
+
+/**
+ * @brief Checks whether the CPU and the build support vector instructions.
+ *
+ * @param simd The instructions.
+ * @return true if they can be used,
+ * @return false if not.
+ */
+bool string_simd_supported(STRING_SIMD simd);
+
+/**
+ * @brief Makes the string functions run on other instructions, for tests and benchmarks.
+ *
+ * @param simd The instructions.
+ * @return true if they are used from now on,
+ * @return false if the CPU or the build does not support them, nothing changes.
+ */
+bool string_set_simd(STRING_SIMD simd);
+
+/**
+ * @brief A run of bytes that knows its length, not owned and not terminated.
+ *
+ * Views are passed by value. Slicing and splitting make new views of the same bytes, which
+ * must outlive every view of them.
+ */
+typedef struct StringView {
+    const char * data;              /** First byte, NULL for the view of no string. */
+    size_t length;                  /** Number of bytes. */
+} StringView;
+
+/**
+ * @def STRING_VIEW_LITERAL(literal)
+ * @brief A view of a string literal, its length known at compile time.
+ */
+#define STRING_VIEW_LITERAL(literal) ((StringView){ "" literal, sizeof(literal) - 1 })
+
+/**
+ * @def STRING_VIEW_FORMAT
+ * @brief The printf conversion for a view, with STRING_VIEW_ARGUMENTS as its arguments.
+ */
+#define STRING_VIEW_FORMAT "%.*s"
+#define STRING_VIEW_ARGUMENTS(view) (int)(view).length, (view).data
+
+/**
+ * @def STRING_VIEW_NOT_FOUND
+ * @brief Returned by string_view_find when the byte is not in the view.
+ */
+#define STRING_VIEW_NOT_FOUND ((size_t)-1)
+
+/**
+ * @brief Makes a view of a terminated string.
+ *
+ * @param string The string, NULL gives an empty view with no data.
+ * @return StringView The view, without the terminator.
+ */
+StringView string_view(const char * string);
+
+/**
+ * @brief Makes a view of part of a view, clamped to its end.
+ *
+ * @param view The view.
+ * @param start Index of the first byte.
+ * @param length Number of bytes, fewer if the view ends first.
+ * @return StringView The part, empty if start is past the end.
+ */
+StringView string_view_slice(StringView view, size_t start, size_t length);
+
+/**
+ * @brief Compares two views byte by byte, as unsigned chars.
+ *
+ * @return int - Returns 0 if they are equal, less than 0 if the first sorts before the second, a prefix sorting first.
+ */
+int string_view_compare(StringView view_one, StringView view_two);
+
+/**
+ * @brief Checks two views for equality, their lengths first.
+ */
+bool string_view_equal(StringView view_one, StringView view_two);
+
+/**
+ * @brief Checks whether a view starts with another one.
+ */
+bool string_view_starts_with(StringView view, StringView prefix);
+
+/**
+ * @brief Checks whether a view ends with another one.
+ */
+bool string_view_ends_with(StringView view, StringView suffix);
+
+/**
+ * @brief Finds the first occurrence of a byte.
+ *
+ * @param view The view to search.
+ * @param character The byte.
+ * @return size_t Its index, or STRING_VIEW_NOT_FOUND.
+ */
+size_t string_view_find(StringView view, char character);
 
+/**
+ * @brief Takes the next token off a view, up to a delimiter.
+ *
+ * Every delimiter ends a token, so "a,,b," splits into "a", "", "b" and "". The view of
+ * no string (NULL data) has no tokens, the empty string has one empty token.
+ *
+ * @param rest The view left to split, moved past the token and its delimiter.
+ * @param delimiter The byte between tokens.
+ * @param token Receives the token.
+ * @return true if a token was taken,
+ * @return false if rest was already used up.
+ */
+bool string_view_split(StringView * rest, char delimiter, StringView * token);
+
+/**
+ * @brief Where the text of a string builder lives.
+ */
+typedef enum STRING_BUILDER_MEMORY {
+    STRING_BUILDER_MEMORY_CALLER,   /** The buffer given to string_builder_init, never freed. */
+    STRING_BUILDER_MEMORY_HEAP,     /** malloc, freed by string_builder_destroy. */
+    STRING_BUILDER_MEMORY_ARENA,    /** The builder's arena, released with the arena. */
+    STRING_BUILDER_MEMORY_POOL      /** A slot of the builder's pool, returned by string_builder_destroy. */
+} STRING_BUILDER_MEMORY;
+
+/**
+ * @brief Text built by appends, its capacity doubling when it runs out.
+ *
+ * A builder starts in a caller buffer, usually on the stack, in an arena or in a pool slot,
+ * so short texts never touch malloc. Text that outgrows an arena builder is moved further up
+ * the arena, or grown in place when nothing was pushed after it. Text that outgrows a caller
+ * buffer or a pool slot moves to the heap. The text is always terminated.
+ */
+typedef struct StringBuilder {
+    char * data;                    /** The text, NULL until the first append when no buffer was given. */
+    size_t length;                  /** Number of bytes, without the terminator. */
+    size_t capacity;                /** Bytes data holds, with the terminator. */
+    Arena * arena;                  /** Arena the text grows in, or NULL. */
+    Pool * pool;                    /** Pool the first buffer is taken from, or NULL. */
+    STRING_BUILDER_MEMORY memory;   /** Where data lives. */
+    bool truncated;                 /** An append ran out of memory, only what fit was kept. */
+} StringBuilder;
+
+/**
+ * @brief Initializes a builder on a caller buffer, the text moves to the heap if it outgrows it.
+ *
+ * @param builder The builder to initialize.
+ * @param buffer The first buffer, may be NULL.
+ * @param capacity The size of buffer, 0 when it is NULL.
+ */
+void string_builder_init(StringBuilder * builder, char * buffer, size_t capacity);
+
+/**
+ * @brief Initializes a builder whose memory comes from an arena. Nothing is pushed until the first append.
+ *
+ * @param builder The builder to initialize.
+ * @param arena The arena, the text lives until the arena is moved back past it.
+ */
+void string_builder_init_arena(StringBuilder * builder, Arena * arena);
+
+/**
+ * @brief Initializes a builder that starts in a slot of a pool, the text moves to the heap if it outgrows it.
+ *
+ * @param builder The builder to initialize.
+ * @param pool The pool, its slot size is the first capacity.
+ */
+void string_builder_init_pool(StringBuilder * builder, Pool * pool);
+
+/**
+ * @brief Frees the heap memory or pool slot of a builder, arena and caller memory is left alone.
+ *
+ * @param builder The builder to destroy.
+ */
+void string_builder_destroy(StringBuilder * builder);
+
+/**
+ * @brief Empties a builder, keeping its memory.
+ *
+ * @param builder The builder.
+ */
+void string_builder_clear(StringBuilder * builder);
+
+/**
+ * @brief Appends bytes.
+ *
+ * @param builder The builder.
+ * @param data The bytes, may contain zeros, not from the builder's own text.
+ * @param length The number of bytes.
+ * @return true if they were appended,
+ * @return false if memory ran out, what fit was appended and truncated is set.
+ */
+bool string_builder_append(StringBuilder * builder, const char * data, size_t length);
+
+/**
+ * @brief Appends the bytes of a view, see string_builder_append.
+ */
+bool string_builder_append_view(StringBuilder * builder, StringView view);
+
+/**
+ * @brief Appends a terminated string, see string_builder_append.
+ */
+bool string_builder_append_string(StringBuilder * builder, const char * string);
+
+/**
+ * @brief Appends one byte, see string_builder_append.
+ */
+bool string_builder_append_char(StringBuilder * builder, char character);
+
+/**
+ * @brief Appends formatted text, see format_string for the conversions.
+ *
+ * @param builder The builder.
+ * @param format The printf format string.
+ * @param ... The arguments of the format string.
+ * @return true if the text was appended,
+ * @return false if memory ran out, what fit was appended and truncated is set.
+ */
+bool string_builder_append_format(StringBuilder * builder, const char * format, ...) FORMAT_PRINTF(2, 3);
+
+/**
+ * @brief Appends formatted text from a va_list, see string_builder_append_format.
+ */
+bool string_builder_append_format_va(StringBuilder * builder, const char * format, va_list arguments);
+
+/**
+ * @brief Gets a view of the text of a builder, valid until the next append.
+ */
+StringView string_builder_view(const StringBuilder * builder);
 
-#endif  // CORE_STRING_H
\ No newline at end of file
+#endif  // CORE_STRING_H
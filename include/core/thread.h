@@ -0,0 +1,132 @@
+#ifndef ORIGINALIS_CORE_THREAD_H
+#define ORIGINALIS_CORE_THREAD_H
+
+#include "core/context.h"
+#include <stdbool.h>
+
+#if OS_WINDOWS
+    #include <windows.h>
+#else
+    #include <pthread.h>
+#endif
+
+/**
+ * @author Ronald Tavarez
+ * @file thread.h
+ * @date 2026-10-17
+ * @brief Threading primitives for the Originalis codebase.
+ * 
+ * Thin wrappers over Win32 and pthreads so the rest of the codebase can create
+ * threads, take locks and run one-time initialization without platform checks.
+ */
+
+/**
+ * @def THREAD_LOCAL
+ * @brief Storage class specifier for thread-local variables.
+ */
+#if COMPILER_CL
+    #define THREAD_LOCAL __declspec(thread)
+#else
+    #define THREAD_LOCAL _Thread_local
+#endif
+
+/**
+ * @brief Entry point of a thread created with thread_create.
+ */
+typedef void (*ThreadFunction)(void * argument);
+
+#if OS_WINDOWS
+    typedef struct Mutex {
+        SRWLOCK lock;               /** Slim reader/writer lock used in exclusive mode. */
+    } Mutex;
+
+    typedef struct Thread {
+        HANDLE handle;              /** Handle of the running thread. */
+        ThreadFunction function;    /** Entry point, called from the platform trampoline. */
+        void * argument;            /** Argument passed to the entry point. */
+    } Thread;
+
+    typedef INIT_ONCE Once;
+    #define ONCE_INITIALIZER INIT_ONCE_STATIC_INIT
+#else
+    typedef struct Mutex {
+        pthread_mutex_t lock;       /** Underlying pthread mutex. */
+    } Mutex;
+
+    typedef struct Thread {
+        pthread_t handle;           /** Handle of the running thread. */
+        ThreadFunction function;    /** Entry point, called from the platform trampoline. */
+        void * argument;            /** Argument passed to the entry point. */
+    } Thread;
+
+    typedef pthread_once_t Once;
+    #define ONCE_INITIALIZER PTHREAD_ONCE_INIT
+#endif
+
+/**
+ * @brief Initializes a mutex.
+ * 
+ * @param mutex The mutex to initialize.
+ */
+void mutex_init(Mutex * mutex);
+
+/**
+ * @brief Destroys a mutex. The mutex must not be locked.
+ * 
+ * @param mutex The mutex to destroy.
+ */
+void mutex_destroy(Mutex * mutex);
+
+/**
+ * @brief Blocks until the mutex is acquired by the calling thread.
+ * 
+ * @param mutex The mutex to lock.
+ */
+void mutex_lock(Mutex * mutex);
+
+/**
+ * @brief Releases a mutex held by the calling thread.
+ * 
+ * @param mutex The mutex to unlock.
+ */
+void mutex_unlock(Mutex * mutex);
+
+/**
+ * @brief Runs the given function exactly once across all threads.
+ * 
+ * @param once The once flag, statically initialized with ONCE_INITIALIZER.
+ * @param function The function to run.
+ */
+void thread_once(Once * once, void (*function)(void));
+
+/**
+ * @brief Starts a new thread.
+ * 
+ * @param thread The thread handle to fill, must stay valid until thread_join returns.
+ * @param function The entry point of the thread.
+ * @param argument The argument passed to the entry point.
+ * @return true if the thread was started,
+ * @return false on failure.
+ */
+bool thread_create(Thread * thread, ThreadFunction function, void * argument);
+
+/**
+ * @brief Waits for a thread started with thread_create to finish.
+ * 
+ * @param thread The thread to wait for.
+ */
+void thread_join(Thread * thread);
+
+/**
+ * @brief Yields the rest of the calling thread's time slice.
+ */
+void thread_yield(void);
+
+/**
+ * @brief Suspends the calling thread.
+ * 
+ * @param milliseconds The minimum time to sleep.
+ */
+void thread_sleep(unsigned int milliseconds);
+
+#endif  // ORIGINALIS_CORE_THREAD_H
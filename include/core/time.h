@@ -0,0 +1,125 @@
+#ifndef ORIGINALIS_CORE_TIME_H
+#define ORIGINALIS_CORE_TIME_H
+
+#include "core/context.h"
+#include <stddef.h>
+#include <stdint.h>
+
+#if (ARCH_X64 || ARCH_X86) && COMPILER_CL
+    #include <intrin.h>
+#elif ARCH_X64 || ARCH_X86
+    #include <x86intrin.h>
+#endif
+
+/**
+ * @author Ronald Tavarez
+ * @file time.h
+ * @date 2026-10-17
+ * @brief Clocks and timestamps for the Originalis codebase.
+ *
+ * Hot paths read time_ticks, the CPU's counter (the TSC on x86, the virtual counter on ARM64)
+ * or the monotonic clock where there is none, and convert ticks to nanoseconds or wall clock
+ * time later, at formatting or output time. The counter frequency is calibrated against the
+ * monotonic clock on first use and refined over the first minutes of the process. On x86 the
+ * TSC is assumed to be invariant, true of every x86-64 CPU of the last decade.
+ */
+
+/**
+ * @def TIME_TIMESTAMP_LENGTH
+ * @brief Length of a timestamp written by time_format_wall, "YYYY-MM-DD HH:MM:SS.uuuuuu".
+ */
+#define TIME_TIMESTAMP_LENGTH 26
+
+/**
+ * @def TIME_UTC_TIMESTAMP_LENGTH
+ * @brief Length of a timestamp written by time_format_utc, "YYYY-MM-DDTHH:MM:SS.uuuuuuZ".
+ */
+#define TIME_UTC_TIMESTAMP_LENGTH 27
+
+/**
+ * @brief Reads the monotonic clock.
+ *
+ * @return uint64_t Nanoseconds from an arbitrary epoch.
+ */
+uint64_t time_now_ns(void);
+
+/**
+ * @brief Reads the cheapest monotonic clock, with a resolution of a few milliseconds.
+ *
+ * CLOCK_MONOTONIC_COARSE on Linux and Android, GetTickCount64 on Windows, the monotonic clock elsewhere.
+ *
+ * @return uint64_t Nanoseconds from an arbitrary epoch.
+ */
+uint64_t time_now_coarse_ns(void);
+
+/**
+ * @brief Reads the wall clock.
+ *
+ * @return uint64_t Nanoseconds since the Unix epoch, UTC.
+ */
+uint64_t time_now_wall_ns(void);
+
+/**
+ * @brief Reads the tick counter, the cheapest precise clock.
+ *
+ * @return uint64_t Ticks from an arbitrary epoch, convert them with time_ticks_to_ns or time_ticks_to_wall_ns.
+ */
+static inline uint64_t time_ticks(void) {
+#if ARCH_X64 || ARCH_X86
+    return __rdtsc();
+#elif ARCH_ARM64 && !COMPILER_CL
+    uint64_t ticks;
+    __asm__ volatile("mrs %0, cntvct_el0" : "=r"(ticks));
+    return ticks;
+#else
+    return time_now_ns();
+#endif
+}
+
+/**
+ * @brief Gets the calibrated frequency of time_ticks.
+ *
+ * @return uint64_t Ticks per second.
+ */
+uint64_t time_ticks_per_second(void);
+
+/**
+ * @brief Converts ticks to the monotonic clock of time_now_ns.
+ *
+ * @param ticks A value of time_ticks.
+ * @return uint64_t Nanoseconds on the time_now_ns clock.
+ */
+uint64_t time_ticks_to_ns(uint64_t ticks);
+
+/**
+ * @brief Converts ticks to wall clock time.
+ *
+ * The wall clock is sampled once, with the calibration, later adjustments such as NTP steps are not followed.
+ *
+ * @param ticks A value of time_ticks.
+ * @return uint64_t Nanoseconds since the Unix epoch, UTC.
+ */
+uint64_t time_ticks_to_wall_ns(uint64_t ticks);
+
+/**
+ * @brief Formats wall clock time in local time as "YYYY-MM-DD HH:MM:SS.uuuuuu".
+ *
+ * The date and time up to the second are cached per thread, so only calls that move to
+ * another second pay for the calendar conversion, the others only write the microseconds.
+ *
+ * @param wall_ns Nanoseconds since the Unix epoch.
+ * @param buffer Receives TIME_TIMESTAMP_LENGTH characters and a terminator.
+ * @return size_t TIME_TIMESTAMP_LENGTH.
+ */
+size_t time_format_wall(uint64_t wall_ns, char * buffer);
+
+/**
+ * @brief Formats wall clock time in UTC as ISO 8601, "YYYY-MM-DDTHH:MM:SS.uuuuuuZ", cached like time_format_wall.
+ *
+ * @param wall_ns Nanoseconds since the Unix epoch.
+ * @param buffer Receives TIME_UTC_TIMESTAMP_LENGTH characters and a terminator.
+ * @return size_t TIME_UTC_TIMESTAMP_LENGTH.
+ */
+size_t time_format_utc(uint64_t wall_ns, char * buffer);
+
+#endif  // ORIGINALIS_CORE_TIME_H
@@ -0,0 +1,198 @@
+#include "core/arena.h"
+#include "core/debug.h"
+#include <string.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+/**
+ * @def ARENA_CHUNK_HEADER_SIZE
+ * @brief Size of the chunk header, rounded up so the first usable byte keeps malloc alignment.
+ */
+#define ARENA_CHUNK_HEADER_SIZE ((sizeof(ArenaChunk) + ARENA_DEFAULT_ALIGNMENT - 1) & ~(size_t)(ARENA_DEFAULT_ALIGNMENT - 1))
+
+/**
+ * @brief Helper function to get the first usable byte of a chunk.
+ * 
+ * @param chunk The chunk.
+ * @return uint8_t * The start of the chunk memory.
+ */
+static inline uint8_t * arena_chunk_memory(ArenaChunk * chunk) {
+    return (uint8_t *)chunk + ARENA_CHUNK_HEADER_SIZE;
+}
+
+/**
+ * @brief Helper function to allocate a chunk from malloc or from the debug allocator.
+ * 
+ * @param arena The arena the chunk belongs to.
+ * @param capacity The number of usable bytes.
+ * @return ArenaChunk * The uninitialized chunk, or NULL on failure.
+ */
+static ArenaChunk * allocate_arena_chunk(Arena * arena, size_t capacity) {
+    if (capacity > SIZE_MAX - ARENA_CHUNK_HEADER_SIZE)
+        return NULL;
+    size_t size = ARENA_CHUNK_HEADER_SIZE + capacity;
+    ArenaChunk * chunk = (ArenaChunk *)(arena->tracked ? debug_malloc(size, arena->file, arena->line) : malloc(size));
+    if (chunk)
+        chunk->capacity = capacity;
+    return chunk;
+}
+
+/**
+ * @brief Helper function to give a chunk back to the allocator it came from.
+ * 
+ * @param arena The arena the chunk belongs to.
+ * @param chunk The chunk to release.
+ */
+static void free_arena_chunk(Arena * arena, ArenaChunk * chunk) {
+    if (arena->tracked)
+        debug_free(chunk);
+    else
+        free(chunk);
+}
+
+/**
+ * @brief Helper function to retire the current chunk, keeping it as the spare when it is a standard size.
+ * 
+ * @param arena The arena.
+ */
+static void pop_arena_chunk(Arena * arena) {
+    ArenaChunk * chunk = arena->current;
+    arena->current = chunk->previous;
+    if (!arena->spare && chunk->capacity == arena->chunk_size) {
+        arena->spare = chunk;
+    } else {
+        free_arena_chunk(arena, chunk);
+    }
+}
+
+/**
+ * @brief Helper function to start a new chunk large enough for the given push.
+ * 
+ * @param arena The arena.
+ * @param size The number of bytes requested.
+ * @param alignment The requested alignment.
+ * @return true if a chunk with enough room is current,
+ * @return false on allocation failure.
+ */
+static bool push_arena_chunk(Arena * arena, size_t size, size_t alignment) {
+    // Chunk memory is only guaranteed to be ARENA_DEFAULT_ALIGNMENT aligned, reserve room for larger alignments.
+    size_t padding = alignment > ARENA_DEFAULT_ALIGNMENT ? alignment - 1 : 0;
+    if (size > SIZE_MAX - padding)
+        return false;
+    size_t needed = size + padding;
+
+    ArenaChunk * chunk = NULL;
+    if (arena->spare && arena->spare->capacity >= needed) {
+        chunk = arena->spare;
+        arena->spare = NULL;
+    } else {
+        chunk = allocate_arena_chunk(arena, needed > arena->chunk_size ? needed : arena->chunk_size);
+        if (!chunk)
+            return false;
+    }
+
+    chunk->previous = arena->current;
+    chunk->base = arena->current ? arena->current->base + arena->current->capacity : 0;
+    chunk->used = 0;
+    arena->current = chunk;
+    return true;
+}
+
+void arena_init(Arena * arena, size_t chunk_size) {
+    arena->current = NULL;
+    arena->spare = NULL;
+    arena->chunk_size = chunk_size ? chunk_size : ARENA_DEFAULT_CHUNK_SIZE;
+    arena->file = NULL;
+    arena->line = 0;
+    arena->tracked = false;
+}
+
+void arena_init_tracked(Arena * arena, size_t chunk_size, const char * file, int line) {
+    arena_init(arena, chunk_size);
+    arena->file = file;
+    arena->line = line;
+    arena->tracked = true;
+}
+
+void arena_destroy(Arena * arena) {
+    while (arena->current)
+        pop_arena_chunk(arena);
+    if (arena->spare)
+        free_arena_chunk(arena, arena->spare);
+    arena->spare = NULL;
+}
+
+void * arena_push_aligned(Arena * arena, size_t size, size_t alignment) {
+    ASSERT_FORMAT(alignment && !(alignment & (alignment - 1)), "Alignment %zu is not a power of two.", alignment);
+
+    ArenaChunk * chunk = arena->current;
+    if (chunk) {
+        // Fast path, bump inside the current chunk. Compared against the room left so huge sizes cannot wrap.
+        uintptr_t top = (uintptr_t)arena_chunk_memory(chunk) + chunk->used;
+        size_t padding = (size_t)(-top & (uintptr_t)(alignment - 1));
+        size_t room = chunk->capacity - chunk->used;
+        if (padding <= room && size <= room - padding) {
+            chunk->used += padding + size;
+            return (void *)(top + padding);
+        }
+    }
+
+    if (!push_arena_chunk(arena, size, alignment))
+        return NULL;
+
+    chunk = arena->current;
+    uintptr_t start = (uintptr_t)arena_chunk_memory(chunk);
+    uintptr_t aligned = (start + alignment - 1) & ~(uintptr_t)(alignment - 1);
+    chunk->used = (size_t)(aligned - start) + size;
+    return (void *)aligned;
+}
+
+void * arena_push(Arena * arena, size_t size) {
+    return arena_push_aligned(arena, size, ARENA_DEFAULT_ALIGNMENT);
+}
+
+void * arena_push_zero(Arena * arena, size_t size) {
+    void * memory = arena_push(arena, size);
+    if (memory)
+        memset(memory, 0, size);
+    return memory;
+}
+
+bool arena_extend(Arena * arena, void * memory, size_t size, size_t new_size) {
+    ArenaChunk * chunk = arena->current;
+    if (!chunk || (uint8_t *)memory + size != arena_chunk_memory(chunk) + chunk->used)
+        return false;
+    size_t start = (size_t)((uint8_t *)memory - arena_chunk_memory(chunk));
+    if (new_size > chunk->capacity - start)
+        return false;
+    chunk->used = start + new_size;
+    return true;
+}
+
+size_t arena_position(const Arena * arena) {
+    return arena->current ? arena->current->base + arena->current->used : 0;
+}
+
+ArenaMarker arena_save(const Arena * arena) {
+    ArenaMarker marker = { arena_position(arena) };
+    return marker;
+}
+
+void arena_restore(Arena * arena, ArenaMarker marker) {
+    // Drop whole chunks that start at or after the marker, then rewind inside the remaining one.
+    while (arena->current && arena->current->previous && arena->current->base >= marker.position)
+        pop_arena_chunk(arena);
+    if (arena->current && marker.position >= arena->current->base)
+        arena->current->used = marker.position - arena->current->base;
+}
+
+void arena_pop(Arena * arena, size_t size) {
+    size_t position = arena_position(arena);
+    ArenaMarker marker = { size < position ? position - size : 0 };
+    arena_restore(arena, marker);
+}
+
+void arena_reset(Arena * arena) {
+    ArenaMarker marker = { 0 };
+    arena_restore(arena, marker);
+}
@@ -0,0 +1,762 @@
+#include "core/binlog.h"
+#include "core/intern.h"
+#include "core/thread.h"
+#include "core/time.h"
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BINLOG_MAGIC "ORIGBLG2"
+#define BINLOG_RECORD_DICTIONARY 0x01
+#define BINLOG_RECORD_CHUNK 0x02
+#define BINLOG_RECORD_CLOCK 0x03
+#define BINLOG_MAX_VARINT_BYTES 10
+#define BINLOG_MAX_DECODED_MESSAGE 4096
+
+/**
+ * @brief How an argument is read from the va_list and encoded.
+ *
+ * Signed integers are zigzag varints and unsigned integers varints, both truncated to the
+ * type their conversion prints, so the decoder can print every integer as long long.
+ */
+typedef enum binlog_argument {
+    BINLOG_ARGUMENT_INT,            /**< int, also '*' widths and precisions and %c. */
+    BINLOG_ARGUMENT_UINT,           /**< unsigned int. */
+    BINLOG_ARGUMENT_SCHAR,          /**< int printed as signed char, %hhd. */
+    BINLOG_ARGUMENT_UCHAR,          /**< int printed as unsigned char, %hhu. */
+    BINLOG_ARGUMENT_SHORT,          /**< int printed as short, %hd. */
+    BINLOG_ARGUMENT_USHORT,         /**< int printed as unsigned short, %hu. */
+    BINLOG_ARGUMENT_LONG,           /**< long. */
+    BINLOG_ARGUMENT_ULONG,          /**< unsigned long. */
+    BINLOG_ARGUMENT_LONG_LONG,      /**< long long, also intmax_t. */
+    BINLOG_ARGUMENT_ULONG_LONG,     /**< unsigned long long, also uintmax_t. */
+    BINLOG_ARGUMENT_SIZE,           /**< size_t. */
+    BINLOG_ARGUMENT_PTRDIFF,        /**< ptrdiff_t, also %zd. */
+    BINLOG_ARGUMENT_DOUBLE,         /**< double, 8 raw bytes. */
+    BINLOG_ARGUMENT_LONG_DOUBLE,    /**< long double, encoded as a double. */
+    BINLOG_ARGUMENT_STRING,         /**< const char *, a varint length and the bytes. */
+    BINLOG_ARGUMENT_POINTER,        /**< void *, a varint of its value. */
+    BINLOG_ARGUMENT_IGNORED         /**< Unsupported pointer argument such as %n, read and dropped. */
+} BINLOG_ARGUMENT;
+
+/**
+ * @brief One conversion specification of a format string.
+ */
+typedef struct BinlogConversion {
+    size_t start;               /** Offset of the '%'. */
+    size_t length;              /** Length of the specification, conversion character included. */
+    bool width_star;            /** The width is read from an int argument. */
+    bool precision_star;        /** The precision is read from an int argument. */
+    BINLOG_ARGUMENT argument;   /** How the value is encoded. */
+} BinlogConversion;
+
+/**
+ * @brief A thread's buffer of encoded messages, written to the file as one chunk.
+ */
+typedef struct BinlogBuffer {
+    Mutex lock;                         /** Taken by the owning thread while encoding and by flushes from any thread. */
+    struct BinlogBuffer * next;         /** Next buffer of the open file. */
+    size_t used;                        /** Bytes of data in use. */
+    uint64_t last_timestamp;            /** Ticks of the previous message in the chunk, messages store deltas. */
+    uint8_t data[BINLOG_BUFFER_SIZE];   /** Encoded messages. */
+} BinlogBuffer;
+
+static Once binlog_once = ONCE_INITIALIZER;
+static Mutex binlog_lock;
+static FILE * binlog_file;
+static BinlogBuffer * binlog_buffers;
+static atomic_uint binlog_active_generation;
+static unsigned int binlog_generation_count;
+static uint32_t binlog_callsite_count;
+static THREAD_LOCAL BinlogBuffer * binlog_thread_buffer;
+static THREAD_LOCAL unsigned int binlog_thread_generation;
+
+static void initialize_binlog(void) {
+    mutex_init(&binlog_lock);
+}
+
+/**
+ * @brief Helper function to split a format string into its conversions.
+ *
+ * @param format The printf format string.
+ * @param conversions Receives the conversions, in order.
+ * @param capacity The number of entries conversions can hold.
+ * @return size_t The number of conversions found, %% is not a conversion. Parsing stops before a
+ * conversion that could take the arguments past BINLOG_MAX_ARGUMENTS, the rest is printed as written.
+ */
+static size_t parse_binlog_format(const char * format, BinlogConversion * conversions, size_t capacity) {
+    size_t count = 0;
+    size_t argument_count = 0;
+    for (size_t index = 0; format[index] && count < capacity && argument_count + 3 <= BINLOG_MAX_ARGUMENTS; index++) {
+        if (format[index] != '%')
+            continue;
+        size_t start = index++;
+        if (format[index] == '%')
+            continue;
+
+        BinlogConversion * conversion = &conversions[count];
+        conversion->start = start;
+        conversion->width_star = false;
+        conversion->precision_star = false;
+
+        // Flags, width and precision.
+        while (format[index] && strchr("-+ #0'", format[index]))
+            index++;
+        if (format[index] == '*') {
+            conversion->width_star = true;
+            index++;
+        }
+        while (format[index] >= '0' && format[index] <= '9')
+            index++;
+        if (format[index] == '.') {
+            index++;
+            if (format[index] == '*') {
+                conversion->precision_star = true;
+                index++;
+            }
+            while (format[index] >= '0' && format[index] <= '9')
+                index++;
+        }
+
+        // Length modifier.
+        char modifier[3] = { 0 };
+        for (int position = 0; position < 2 && format[index] && strchr("hljztLq", format[index]); position++)
+            modifier[position] = format[index++];
+        char specifier = format[index];
+        if (!specifier)
+            break;
+
+        bool is_signed = specifier == 'd' || specifier == 'i';
+        switch (specifier) {
+            case 'd': case 'i': case 'u': case 'o': case 'x': case 'X':
+                if (!strcmp(modifier, "hh"))
+                    conversion->argument = is_signed ? BINLOG_ARGUMENT_SCHAR : BINLOG_ARGUMENT_UCHAR;
+                else if (!strcmp(modifier, "h"))
+                    conversion->argument = is_signed ? BINLOG_ARGUMENT_SHORT : BINLOG_ARGUMENT_USHORT;
+                else if (!strcmp(modifier, "l"))
+                    conversion->argument = is_signed ? BINLOG_ARGUMENT_LONG : BINLOG_ARGUMENT_ULONG;
+                else if (!strcmp(modifier, "ll") || !strcmp(modifier, "j") || !strcmp(modifier, "q"))
+                    conversion->argument = is_signed ? BINLOG_ARGUMENT_LONG_LONG : BINLOG_ARGUMENT_ULONG_LONG;
+                else if (!strcmp(modifier, "z") || !strcmp(modifier, "t"))
+                    conversion->argument = is_signed ? BINLOG_ARGUMENT_PTRDIFF : BINLOG_ARGUMENT_SIZE;
+                else
+                    conversion->argument = is_signed ? BINLOG_ARGUMENT_INT : BINLOG_ARGUMENT_UINT;
+                break;
+            case 'c':
+                conversion->argument = BINLOG_ARGUMENT_INT;
+                break;
+            case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+                conversion->argument = modifier[0] == 'L' ? BINLOG_ARGUMENT_LONG_DOUBLE : BINLOG_ARGUMENT_DOUBLE;
+                break;
+            case 's':
+                conversion->argument = modifier[0] == 'l' ? BINLOG_ARGUMENT_IGNORED : BINLOG_ARGUMENT_STRING;
+                break;
+            case 'p':
+                conversion->argument = BINLOG_ARGUMENT_POINTER;
+                break;
+            default:
+                conversion->argument = BINLOG_ARGUMENT_IGNORED;
+                break;
+        }
+        conversion->length = index - start + 1;
+        argument_count += 1 + conversion->width_star + conversion->precision_star;
+        count++;
+    }
+    return count;
+}
+
+/**
+ * @brief Helper function to encode an unsigned LEB128 varint.
+ *
+ * @param cursor Where to write, BINLOG_MAX_VARINT_BYTES must be available.
+ * @param value The value.
+ * @return size_t The number of bytes written.
+ */
+static inline size_t write_binlog_varint(uint8_t * cursor, uint64_t value) {
+    size_t length = 0;
+    while (value >= 0x80) {
+        cursor[length++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    cursor[length++] = (uint8_t)value;
+    return length;
+}
+
+/**
+ * @brief Helper function to decode an unsigned LEB128 varint.
+ *
+ * @param cursor The read position, advanced past the varint.
+ * @param end The end of the readable bytes.
+ * @param value Receives the value.
+ * @return true on success,
+ * @return false if the varint runs past end.
+ */
+static bool read_binlog_varint(const uint8_t ** cursor, const uint8_t * end, uint64_t * value) {
+    uint64_t result = 0;
+    for (int shift = 0; *cursor < end && shift < 64; shift += 7) {
+        uint8_t byte = *(*cursor)++;
+        result |= (uint64_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            *value = result;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Helper function to decode an unsigned LEB128 varint from a stream.
+ *
+ * @param stream The stream.
+ * @param value Receives the value.
+ * @return true on success,
+ * @return false at the end of the stream.
+ */
+static bool read_binlog_varint_from_stream(FILE * stream, uint64_t * value) {
+    uint64_t result = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        int byte = fgetc(stream);
+        if (byte == EOF)
+            return false;
+        result |= (uint64_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            *value = result;
+            return true;
+        }
+    }
+    return false;
+}
+
+static inline uint64_t encode_zigzag(int64_t value) {
+    return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+}
+
+static inline int64_t decode_zigzag(uint64_t value) {
+    return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+}
+
+/**
+ * @brief Helper function to write a string with its varint length.
+ */
+static void write_binlog_string(FILE * stream, const char * string) {
+    uint8_t length_bytes[BINLOG_MAX_VARINT_BYTES];
+    size_t length = strlen(string);
+    fwrite(length_bytes, 1, write_binlog_varint(length_bytes, length), stream);
+    fwrite(string, 1, length, stream);
+}
+
+/**
+ * @brief Helper function to write a callsite's dictionary record, binlog_lock must be held.
+ *
+ * @param callsite The callsite, its id must be assigned.
+ */
+static void write_binlog_dictionary(const BinlogCallsite * callsite) {
+    uint8_t header[1 + 3 * BINLOG_MAX_VARINT_BYTES];
+    size_t length = 0;
+    header[length++] = BINLOG_RECORD_DICTIONARY;
+    length += write_binlog_varint(header + length, callsite->id);
+    length += write_binlog_varint(header + length, (uint64_t)callsite->level);
+    length += write_binlog_varint(header + length, (uint64_t)callsite->line);
+    fwrite(header, 1, length, binlog_file);
+    write_binlog_string(binlog_file, callsite->format);
+    write_binlog_string(binlog_file, callsite->file);
+    write_binlog_string(binlog_file, callsite->func);
+}
+
+/**
+ * @brief Helper function to write a clock record, a tick count with its wall clock time and the tick frequency, binlog_lock must be held.
+ *
+ * Messages store ticks, the decoder converts them with the latest clock record.
+ */
+static void write_binlog_clock(void) {
+    uint8_t record[1 + 3 * BINLOG_MAX_VARINT_BYTES];
+    uint64_t ticks = time_ticks();
+    size_t length = 0;
+    record[length++] = BINLOG_RECORD_CLOCK;
+    length += write_binlog_varint(record + length, ticks);
+    length += write_binlog_varint(record + length, time_ticks_to_wall_ns(ticks));
+    length += write_binlog_varint(record + length, time_ticks_per_second());
+    fwrite(record, 1, length, binlog_file);
+}
+
+/**
+ * @brief Helper function to register a callsite in the open file on its first call there.
+ *
+ * @param callsite The callsite.
+ * @param generation The generation of the open file.
+ */
+static void register_binlog_callsite(BinlogCallsite * callsite, unsigned int generation) {
+    mutex_lock(&binlog_lock);
+    if (atomic_load_explicit(&callsite->generation, memory_order_relaxed) != generation && binlog_file) {
+        if (!callsite->id) {
+            BinlogConversion conversions[BINLOG_MAX_ARGUMENTS];
+            size_t conversion_count = parse_binlog_format(callsite->format, conversions, BINLOG_MAX_ARGUMENTS);
+            size_t argument_count = 0;
+            for (size_t index = 0; index < conversion_count; index++) {
+                if (conversions[index].width_star)
+                    callsite->arguments[argument_count++] = BINLOG_ARGUMENT_INT;
+                if (conversions[index].precision_star)
+                    callsite->arguments[argument_count++] = BINLOG_ARGUMENT_INT;
+                callsite->arguments[argument_count++] = (uint8_t)conversions[index].argument;
+            }
+            callsite->argument_count = (uint8_t)argument_count;
+            callsite->id = ++binlog_callsite_count;
+        }
+        write_binlog_dictionary(callsite);
+        atomic_store_explicit(&callsite->generation, generation, memory_order_release);
+    }
+    mutex_unlock(&binlog_lock);
+}
+
+/**
+ * @brief Helper function to write a buffer as a chunk and empty it, the buffer must be locked.
+ *
+ * @param buffer The buffer.
+ */
+static void write_binlog_chunk(BinlogBuffer * buffer) {
+    if (!buffer->used)
+        return;
+    uint8_t header[1 + BINLOG_MAX_VARINT_BYTES];
+    size_t length = 0;
+    header[length++] = BINLOG_RECORD_CHUNK;
+    length += write_binlog_varint(header + length, buffer->used);
+    mutex_lock(&binlog_lock);
+    if (binlog_file) {
+        fwrite(header, 1, length, binlog_file);
+        fwrite(buffer->data, 1, buffer->used, binlog_file);
+    }
+    mutex_unlock(&binlog_lock);
+    buffer->used = 0;
+    buffer->last_timestamp = 0;
+}
+
+/**
+ * @brief Helper function to get the calling thread's buffer for the open file, creating it on first use.
+ *
+ * @param generation The generation of the open file.
+ * @return BinlogBuffer * The buffer, or NULL if it could not be allocated.
+ */
+static BinlogBuffer * get_binlog_thread_buffer(unsigned int generation) {
+    if (binlog_thread_generation == generation)
+        return binlog_thread_buffer;
+
+    BinlogBuffer * buffer = (BinlogBuffer *)malloc(sizeof(BinlogBuffer));
+    if (!buffer)
+        return NULL;
+    mutex_init(&buffer->lock);
+    buffer->used = 0;
+    buffer->last_timestamp = 0;
+    mutex_lock(&binlog_lock);
+    buffer->next = binlog_buffers;
+    binlog_buffers = buffer;
+    mutex_unlock(&binlog_lock);
+
+    binlog_thread_buffer = buffer;
+    binlog_thread_generation = generation;
+    return buffer;
+}
+
+/**
+ * @brief Helper function to format a call and send it to the console while no file is open.
+ */
+static void write_binlog_to_console(const BinlogCallsite * callsite, va_list arguments) {
+    log_format_to_console_va(callsite->level, callsite->func, callsite->file, callsite->line, callsite->format, arguments);
+}
+
+void binlog_write(BinlogCallsite * callsite, ...) {
+    va_list arguments;
+    va_start(arguments, callsite);
+    unsigned int generation = atomic_load_explicit(&binlog_active_generation, memory_order_acquire);
+    if (!generation) {
+        write_binlog_to_console(callsite, arguments);
+        va_end(arguments);
+        return;
+    }
+    if (atomic_load_explicit(&callsite->generation, memory_order_acquire) != generation)
+        register_binlog_callsite(callsite, generation);
+    BinlogBuffer * buffer = get_binlog_thread_buffer(generation);
+    if (!buffer) {
+        va_end(arguments);
+        return;
+    }
+
+    uint64_t timestamp = time_ticks();
+    mutex_lock(&buffer->lock);
+    if (buffer->used + BINLOG_MAX_RECORD_BYTES > BINLOG_BUFFER_SIZE)
+        write_binlog_chunk(buffer);
+
+    uint8_t * cursor = buffer->data + buffer->used;
+    uint8_t * end = cursor + BINLOG_MAX_RECORD_BYTES;
+    cursor += write_binlog_varint(cursor, callsite->id);
+    cursor += write_binlog_varint(cursor, timestamp - buffer->last_timestamp);
+    buffer->last_timestamp = timestamp;
+    for (size_t index = 0; index < callsite->argument_count; index++) {
+        switch ((BINLOG_ARGUMENT)callsite->arguments[index]) {
+            case BINLOG_ARGUMENT_INT:         cursor += write_binlog_varint(cursor, encode_zigzag(va_arg(arguments, int))); break;
+            case BINLOG_ARGUMENT_UINT:        cursor += write_binlog_varint(cursor, va_arg(arguments, unsigned int)); break;
+            case BINLOG_ARGUMENT_SCHAR:       cursor += write_binlog_varint(cursor, encode_zigzag((signed char)va_arg(arguments, int))); break;
+            case BINLOG_ARGUMENT_UCHAR:       cursor += write_binlog_varint(cursor, (unsigned char)va_arg(arguments, unsigned int)); break;
+            case BINLOG_ARGUMENT_SHORT:       cursor += write_binlog_varint(cursor, encode_zigzag((short)va_arg(arguments, int))); break;
+            case BINLOG_ARGUMENT_USHORT:      cursor += write_binlog_varint(cursor, (unsigned short)va_arg(arguments, unsigned int)); break;
+            case BINLOG_ARGUMENT_LONG:        cursor += write_binlog_varint(cursor, encode_zigzag(va_arg(arguments, long))); break;
+            case BINLOG_ARGUMENT_ULONG:       cursor += write_binlog_varint(cursor, va_arg(arguments, unsigned long)); break;
+            case BINLOG_ARGUMENT_LONG_LONG:   cursor += write_binlog_varint(cursor, encode_zigzag(va_arg(arguments, long long))); break;
+            case BINLOG_ARGUMENT_ULONG_LONG:  cursor += write_binlog_varint(cursor, va_arg(arguments, unsigned long long)); break;
+            case BINLOG_ARGUMENT_SIZE:        cursor += write_binlog_varint(cursor, va_arg(arguments, size_t)); break;
+            case BINLOG_ARGUMENT_PTRDIFF:     cursor += write_binlog_varint(cursor, encode_zigzag(va_arg(arguments, ptrdiff_t))); break;
+            case BINLOG_ARGUMENT_POINTER:     cursor += write_binlog_varint(cursor, (uintptr_t)va_arg(arguments, void *)); break;
+            case BINLOG_ARGUMENT_IGNORED:     (void)va_arg(arguments, void *); break;
+            case BINLOG_ARGUMENT_DOUBLE:
+            case BINLOG_ARGUMENT_LONG_DOUBLE: {
+                double value = callsite->arguments[index] == BINLOG_ARGUMENT_DOUBLE ? va_arg(arguments, double) : (double)va_arg(arguments, long double);
+                memcpy(cursor, &value, sizeof(value));
+                cursor += sizeof(value);
+                break;
+            }
+            case BINLOG_ARGUMENT_STRING: {
+                // Leave room for the arguments still to come, truncating the string if needed.
+                const char * string = va_arg(arguments, const char *);
+                if (!string)
+                    string = "(null)";
+                size_t room = (size_t)(end - cursor) - BINLOG_MAX_VARINT_BYTES * (callsite->argument_count - index);
+                size_t length = strlen(string);
+                if (length > room)
+                    length = room;
+                cursor += write_binlog_varint(cursor, length);
+                memcpy(cursor, string, length);
+                cursor += length;
+                break;
+            }
+        }
+    }
+    buffer->used = (size_t)(cursor - buffer->data);
+    mutex_unlock(&buffer->lock);
+    va_end(arguments);
+}
+
+bool binlog_open(const char * path) {
+    thread_once(&binlog_once, initialize_binlog);
+    mutex_lock(&binlog_lock);
+    if (binlog_file) {
+        mutex_unlock(&binlog_lock);
+        return false;
+    }
+    binlog_file = fopen(path, "wb");
+    if (!binlog_file) {
+        mutex_unlock(&binlog_lock);
+        return false;
+    }
+    fwrite(BINLOG_MAGIC, 1, sizeof(BINLOG_MAGIC) - 1, binlog_file);
+    write_binlog_clock();
+    atomic_store_explicit(&binlog_active_generation, ++binlog_generation_count, memory_order_release);
+    mutex_unlock(&binlog_lock);
+    return true;
+}
+
+void binlog_flush(void) {
+    thread_once(&binlog_once, initialize_binlog);
+    mutex_lock(&binlog_lock);
+    BinlogBuffer * buffers = binlog_buffers;
+    // A fresh clock record keeps the conversion of the chunks that follow close to their ticks.
+    if (binlog_file)
+        write_binlog_clock();
+    mutex_unlock(&binlog_lock);
+
+    // Buffers are only unlinked by binlog_close, so the list can be walked unlocked.
+    for (BinlogBuffer * buffer = buffers; buffer; buffer = buffer->next) {
+        mutex_lock(&buffer->lock);
+        write_binlog_chunk(buffer);
+        mutex_unlock(&buffer->lock);
+    }
+    mutex_lock(&binlog_lock);
+    if (binlog_file)
+        fflush(binlog_file);
+    mutex_unlock(&binlog_lock);
+}
+
+void binlog_close(void) {
+    binlog_flush();
+    mutex_lock(&binlog_lock);
+    atomic_store_explicit(&binlog_active_generation, 0, memory_order_release);
+    while (binlog_buffers) {
+        BinlogBuffer * buffer = binlog_buffers;
+        binlog_buffers = buffer->next;
+        mutex_destroy(&buffer->lock);
+        free(buffer);
+    }
+    if (binlog_file)
+        fclose(binlog_file);
+    binlog_file = NULL;
+    mutex_unlock(&binlog_lock);
+}
+
+/**
+ * @brief A callsite read back from a dictionary record.
+ */
+typedef struct BinlogDecodedCallsite {
+    LOG_LEVEL level;                                    /** Severity of the call. */
+    int line;                                           /** Line of the call. */
+    char * format;                                      /** printf format string. */
+    const char * file;                                  /** File of the call, interned, shared by the callsites of a file. */
+    const char * func;                                  /** Function of the call, interned. */
+    size_t conversion_count;                            /** Number of conversions in format. */
+    BinlogConversion conversions[BINLOG_MAX_ARGUMENTS]; /** Conversions of format. */
+} BinlogDecodedCallsite;
+
+/**
+ * @brief Helper function to read a string with its varint length from a stream.
+ *
+ * @return char * The terminated string, or NULL on failure.
+ */
+static char * read_binlog_string(FILE * stream) {
+    uint64_t length;
+    if (!read_binlog_varint_from_stream(stream, &length) || length > BINLOG_BUFFER_SIZE)
+        return NULL;
+    char * string = (char *)malloc((size_t)length + 1);
+    if (!string)
+        return NULL;
+    if (fread(string, 1, (size_t)length, stream) != length) {
+        free(string);
+        return NULL;
+    }
+    string[length] = '\0';
+    return string;
+}
+
+/**
+ * @brief Helper function to read a string with its varint length from a stream and intern it.
+ *
+ * @return const char * The interned string, or NULL on failure.
+ */
+static const char * read_interned_binlog_string(FILE * stream) {
+    char * string = read_binlog_string(stream);
+    InternHandle handle = string ? intern_string(string) : INTERN_NONE;
+    free(string);
+    return intern_get(handle);
+}
+
+/**
+ * @brief Helper function to print one conversion with its decoded value.
+ *
+ * @param output Where to write.
+ * @param capacity The room in output.
+ * @param specification The conversion specification, length modifier already removed or replaced.
+ * @param star_count The number of '*' arguments, 0 to 2.
+ * @param stars The '*' arguments.
+ * @return int The snprintf result.
+ */
+#define PRINT_BINLOG_CONVERSION(output, capacity, specification, star_count, stars, value) \
+    ((star_count) == 0 ? snprintf((output), (capacity), (specification), (value)) : \
+     (star_count) == 1 ? snprintf((output), (capacity), (specification), (stars)[0], (value)) : \
+                         snprintf((output), (capacity), (specification), (stars)[0], (stars)[1], (value)))
+
+/**
+ * @brief Helper function to rebuild the text of one message from its encoded arguments.
+ *
+ * @param callsite The callsite of the message.
+ * @param cursor The read position, advanced past the arguments.
+ * @param end The end of the chunk.
+ * @param message Receives the text.
+ * @param capacity The room in message.
+ * @return true on success,
+ * @return false if the arguments run past the chunk.
+ */
+static bool decode_binlog_message(const BinlogDecodedCallsite * callsite, const uint8_t ** cursor, const uint8_t * end, char * message, size_t capacity) {
+    size_t used = 0;
+    size_t literal_start = 0;
+    for (size_t index = 0; index <= callsite->conversion_count; index++) {
+        // Copy the text before the conversion, unescaping %%.
+        size_t literal_end = index < callsite->conversion_count ? callsite->conversions[index].start : strlen(callsite->format);
+        for (size_t position = literal_start; position < literal_end && used + 1 < capacity; position++) {
+            message[used++] = callsite->format[position];
+            if (callsite->format[position] == '%' && callsite->format[position + 1] == '%')
+                position++;
+        }
+        if (index == callsite->conversion_count)
+            break;
+
+        const BinlogConversion * conversion = &callsite->conversions[index];
+        literal_start = conversion->start + conversion->length;
+        int stars[2] = { 0, 0 };
+        int star_count = 0;
+        uint64_t value = 0;
+        for (int star = 0; star < (int)conversion->width_star + (int)conversion->precision_star; star++) {
+            if (!read_binlog_varint(cursor, end, &value))
+                return false;
+            stars[star_count++] = (int)decode_zigzag(value);
+        }
+
+        // Rebuild the specification without its length modifier, integers are printed as long long.
+        char specification[64];
+        size_t specification_length = 0;
+        const char * source = callsite->format + conversion->start;
+        char specifier = source[conversion->length - 1];
+        for (size_t position = 0; position + 1 < conversion->length && specification_length + 4 < sizeof(specification); position++) {
+            if (!strchr("hljztLq", source[position]))
+                specification[specification_length++] = source[position];
+        }
+        bool is_integer = strchr("diouxX", specifier) != NULL;
+        if (is_integer) {
+            specification[specification_length++] = 'l';
+            specification[specification_length++] = 'l';
+        }
+        specification[specification_length++] = specifier;
+        specification[specification_length] = '\0';
+
+        int written = 0;
+        char * output = message + used;
+        size_t room = capacity - used;
+        switch (conversion->argument) {
+            case BINLOG_ARGUMENT_INT:
+            case BINLOG_ARGUMENT_SCHAR:
+            case BINLOG_ARGUMENT_SHORT:
+            case BINLOG_ARGUMENT_LONG:
+            case BINLOG_ARGUMENT_LONG_LONG:
+            case BINLOG_ARGUMENT_PTRDIFF:
+                if (!read_binlog_varint(cursor, end, &value))
+                    return false;
+                if (specifier == 'c')
+                    written = PRINT_BINLOG_CONVERSION(output, room, specification, star_count, stars, (int)decode_zigzag(value));
+                else if (is_integer && (specifier == 'd' || specifier == 'i'))
+                    written = PRINT_BINLOG_CONVERSION(output, room, specification, star_count, stars, (long long)decode_zigzag(value));
+                else
+                    written = PRINT_BINLOG_CONVERSION(output, room, specification, star_count, stars, (unsigned long long)decode_zigzag(value));
+                break;
+            case BINLOG_ARGUMENT_UINT:
+            case BINLOG_ARGUMENT_UCHAR:
+            case BINLOG_ARGUMENT_USHORT:
+            case BINLOG_ARGUMENT_ULONG:
+            case BINLOG_ARGUMENT_ULONG_LONG:
+            case BINLOG_ARGUMENT_SIZE:
+                if (!read_binlog_varint(cursor, end, &value))
+                    return false;
+                written = PRINT_BINLOG_CONVERSION(output, room, specification, star_count, stars, (unsigned long long)value);
+                break;
+            case BINLOG_ARGUMENT_DOUBLE:
+            case BINLOG_ARGUMENT_LONG_DOUBLE: {
+                double number;
+                if ((size_t)(end - *cursor) < sizeof(number))
+                    return false;
+                memcpy(&number, *cursor, sizeof(number));
+                *cursor += sizeof(number);
+                written = PRINT_BINLOG_CONVERSION(output, room, specification, star_count, stars, number);
+                break;
+            }
+            case BINLOG_ARGUMENT_STRING: {
+                // The writer never encodes a string longer than a record, a longer one is damage.
+                if (!read_binlog_varint(cursor, end, &value) || value > BINLOG_MAX_RECORD_BYTES || (uint64_t)(end - *cursor) < value)
+                    return false;
+                char string[BINLOG_MAX_RECORD_BYTES + 1];
+                memcpy(string, *cursor, (size_t)value);
+                string[value] = '\0';
+                *cursor += value;
+                written = PRINT_BINLOG_CONVERSION(output, room, specification, star_count, stars, string);
+                break;
+            }
+            case BINLOG_ARGUMENT_POINTER:
+                if (!read_binlog_varint(cursor, end, &value))
+                    return false;
+                written = PRINT_BINLOG_CONVERSION(output, room, specification, star_count, stars, (void *)(uintptr_t)value);
+                break;
+            case BINLOG_ARGUMENT_IGNORED:
+                break;
+        }
+        if (written > 0)
+            used += (size_t)written < room ? (size_t)written : room - 1;
+    }
+    message[used] = '\0';
+    return true;
+}
+
+bool binlog_decode(FILE * input, FILE * output, bool timestamps) {
+    char magic[sizeof(BINLOG_MAGIC) - 1];
+    if (fread(magic, 1, sizeof(magic), input) != sizeof(magic) || memcmp(magic, BINLOG_MAGIC, sizeof(magic)) != 0)
+        return false;
+
+    BinlogDecodedCallsite ** callsites = NULL;
+    size_t callsite_capacity = 0;
+    uint8_t * chunk = (uint8_t *)malloc(BINLOG_BUFFER_SIZE);
+    char * message = (char *)malloc(BINLOG_MAX_DECODED_MESSAGE);
+    bool intact = chunk && message;
+    uint64_t clock_ticks = 0, clock_wall_ns = 0, clock_frequency = 0;
+    int tag;
+    while (intact && (tag = fgetc(input)) != EOF) {
+        uint64_t value;
+        if (tag == BINLOG_RECORD_DICTIONARY) {
+            uint64_t id, level, line;
+            intact = read_binlog_varint_from_stream(input, &id) && read_binlog_varint_from_stream(input, &level) &&
+                read_binlog_varint_from_stream(input, &line) && id > 0 && id < (1u << 24);
+            if (!intact)
+                break;
+            if (id >= callsite_capacity) {
+                size_t new_capacity = callsite_capacity ? callsite_capacity : 64;
+                while (new_capacity <= id)
+                    new_capacity *= 2;
+                BinlogDecodedCallsite ** grown = (BinlogDecodedCallsite **)realloc(callsites, new_capacity * sizeof(*callsites));
+                if (!(intact = grown != NULL))
+                    break;
+                memset(grown + callsite_capacity, 0, (new_capacity - callsite_capacity) * sizeof(*callsites));
+                callsites = grown;
+                callsite_capacity = new_capacity;
+            }
+
+            BinlogDecodedCallsite * callsite = callsites[id];
+            if (!callsite && !(callsite = callsites[id] = (BinlogDecodedCallsite *)calloc(1, sizeof(BinlogDecodedCallsite)))) {
+                intact = false;
+                break;
+            }
+            free(callsite->format);
+            callsite->level = (LOG_LEVEL)level;
+            callsite->line = (int)line;
+            callsite->format = read_binlog_string(input);
+            callsite->file = read_interned_binlog_string(input);
+            callsite->func = read_interned_binlog_string(input);
+            intact = callsite->format && callsite->file && callsite->func;
+            if (intact)
+                callsite->conversion_count = parse_binlog_format(callsite->format, callsite->conversions, BINLOG_MAX_ARGUMENTS);
+        } else if (tag == BINLOG_RECORD_CLOCK) {
+            intact = read_binlog_varint_from_stream(input, &clock_ticks) && read_binlog_varint_from_stream(input, &clock_wall_ns) &&
+                read_binlog_varint_from_stream(input, &clock_frequency) && clock_frequency > 0;
+        } else if (tag == BINLOG_RECORD_CHUNK) {
+            intact = read_binlog_varint_from_stream(input, &value) && value <= BINLOG_BUFFER_SIZE && fread(chunk, 1, (size_t)value, input) == value;
+            const uint8_t * cursor = chunk;
+            const uint8_t * end = chunk + (intact ? value : 0);
+            uint64_t timestamp = 0;
+            while (intact && cursor < end) {
+                uint64_t id, delta;
+                intact = read_binlog_varint(&cursor, end, &id) && read_binlog_varint(&cursor, end, &delta) && id < callsite_capacity && callsites[id];
+                if (!intact)
+                    break;
+                const BinlogDecodedCallsite * callsite = callsites[id];
+                timestamp += delta;
+                intact = decode_binlog_message(callsite, &cursor, end, message, BINLOG_MAX_DECODED_MESSAGE);
+                if (!intact)
+                    break;
+                if (timestamps && clock_frequency) {
+                    // Ticks before the clock record give a negative offset.
+                    bool before = timestamp < clock_ticks;
+                    uint64_t delta = before ? clock_ticks - timestamp : timestamp - clock_ticks;
+                    uint64_t ns = delta / clock_frequency * 1000000000ULL + delta % clock_frequency * 1000000000ULL / clock_frequency;
+                    char text[TIME_TIMESTAMP_LENGTH + 1];
+                    time_format_wall(before ? clock_wall_ns - ns : clock_wall_ns + ns, text);
+                    fprintf(output, "%s ", text);
+                }
+                log_message_to_stream(output, callsite->level, callsite->func, callsite->file, callsite->line, message);
+            }
+        } else {
+            intact = false;
+        }
+    }
+
+    for (size_t index = 0; index < callsite_capacity; index++) {
+        if (callsites[index]) {
+            free(callsites[index]->format);
+            free(callsites[index]);
+        }
+    }
+    free(callsites);
+    free(chunk);
+    free(message);
+    return intact;
+}
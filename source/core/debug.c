@@ -1,11 +1,88 @@
 #include "core/debug.h"
+#include "core/hash.h"
+#include "core/log_limit.h"
+#include "core/thread.h"
+#include "core/pool.h"
+#include "core/intern.h"
+#include "core/string.h"
 #include <string.h>
 #include <stdint.h>
 #include <stdbool.h>
 #include <stdlib.h>
+#include <stdatomic.h>
+#include <math.h>
 
+#if OS_LINUX || OS_MAC
+    #include <execinfo.h>
+#endif
 
-static MemoryAllocation * head_allocation = NULL;
+#if OS_LINUX || OS_ANDROID || OS_MAC || OS_IOS
+    #include <sys/mman.h>
+    #include <unistd.h>
+#endif
+
+#if OS_LINUX || OS_ANDROID || OS_WINDOWS
+    #include <malloc.h>
+#elif OS_MAC || OS_IOS
+    #include <malloc/malloc.h>
+#endif
+
+#if COMPILER_CL
+    #define DEBUG_NOINLINE __declspec(noinline)
+#else
+    #define DEBUG_NOINLINE __attribute__((noinline))
+#endif
+
+
+#define DEBUG_MEMORY_TABLE_INITIAL_CAPACITY 256
+#define DEBUG_MEMORY_SHARD_BITS 6
+#define DEBUG_MEMORY_SHARD_COUNT (1 << DEBUG_MEMORY_SHARD_BITS)
+#define DEBUG_MEMORY_HEADER_MAGIC 0xA110CA7EDB10C000ULL
+#define DEBUG_MEMORY_PAGE_SLACK_VALUE 0xFB
+#define DEBUG_MEMORY_PAGE_CACHE_CLASSES 8
+#define DEBUG_MEMORY_PAGE_CACHE_DEPTH 64
+#define DEBUG_MEMORY_QUARANTINE_SHARD_CAPACITY 256
+
+/**
+ * @def DEBUG_MEMORY_HEADER_SIZE
+ * @brief Size of the inline header, rounded up so the front guard and user block stay 16-byte aligned.
+ */
+#define DEBUG_MEMORY_HEADER_SIZE ((sizeof(MemoryAllocation) + 15) & ~(size_t)15)
+
+/**
+ * @brief Address-keyed open-addressing hash table of live MemoryAllocation records.
+ * 
+ * Slots use linear probing and backward-shift deletion, so there are no tombstones and
+ * lookup, insert and remove are amortized O(1). A NULL slot is empty.
+ */
+typedef struct MemoryAllocationTable {
+    MemoryAllocation ** slots;  /** Slot array, capacity is always a power of two. */
+    size_t capacity;            /** Number of slots. */
+    size_t count;               /** Number of live records. */
+} MemoryAllocationTable;
+
+/**
+ * @brief One shard of the allocation tracking state.
+ * 
+ * An address always maps to the same shard, picked from the high bits of its hash, so
+ * threads working on different blocks rarely contend for the same lock. Shards are
+ * cache-line aligned to keep neighbouring locks from false sharing.
+ */
+typedef struct MemoryAllocationShard {
+    _Alignas(64) Mutex lock;        /** Guards the shard, only used when DEBUG_MEMORY_THREAD_SAFE is set. */
+#if DEBUG_MEMORY_INLINE_HEADERS
+    MemoryAllocation * head;        /** Intrusive list of live blocks whose address hashes to this shard. */
+#else
+    MemoryAllocationTable table;    /** Live records whose address hashes to this shard. */
+    Pool records;                   /** Storage for the records in the table. */
+#endif
+    MemoryAllocation * quarantine;  /** Ring of freed blocks held back from the C allocator, allocated on first use. */
+    size_t quarantine_head;         /** Index of the oldest block in the ring. */
+    size_t quarantine_count;        /** Number of blocks in the ring. */
+    size_t quarantine_bytes;        /** Sum of the sizes of the blocks in the ring. */
+} MemoryAllocationShard;
+
+static MemoryAllocationShard allocation_shards[DEBUG_MEMORY_SHARD_COUNT];
 static const uint8_t DEBUG_MEMORY_GUARD_VALUE[DEBUG_MEMORY_GUARD_SIZE] = {
     0x00, 0x00, 0x00, 0x00, 
     0xCC, 0xCC, 0xCC, 0xCC, 
@@ -33,18 +110,246 @@ bool is_memory_guard_intact(void * address, size_t size) {
  * @param size The size of the allocated memory block.
  * @details This function assumes that the memory guard bytes are intact and address points to a valid memory block.
  */
-static inline void set_memory_guard_bytes(void * address, size_t size) {
+void set_memory_guard_bytes(void * address, size_t size) {
     uint8_t * guard_bytes = (uint8_t *)address + size;
     memcpy(guard_bytes, DEBUG_MEMORY_GUARD_VALUE, DEBUG_MEMORY_GUARD_SIZE);
 }
 
 /**
- * @brief Helper function to allocate memory and set the memory guard bytes to a known value to detect buffer overruns.
+ * @brief Helper function to ask the C allocator how many bytes a block can really hold.
+ * 
+ * @param block A pointer returned by malloc or realloc.
+ * @return size_t The usable size, at least the requested size, or 0 if the platform cannot tell.
+ */
+static inline size_t get_usable_size(void * block) {
+#if OS_LINUX || OS_ANDROID
+    return malloc_usable_size(block);
+#elif OS_WINDOWS
+    return _msize(block);
+#elif OS_MAC || OS_IOS
+    return malloc_size(block);
+#else
+    (void)block;
+    return 0;
+#endif
+}
+
+#if DEBUG_MEMORY_INLINE_HEADERS
+bool is_memory_front_guard_intact(void * address) {
+    uint8_t * guard_bytes = (uint8_t *)address - DEBUG_MEMORY_GUARD_SIZE;
+    return memcmp(guard_bytes, DEBUG_MEMORY_GUARD_VALUE, DEBUG_MEMORY_GUARD_SIZE) == 0;
+}
+#endif
+
+#if DEBUG_MEMORY_THREAD_SAFE
+static Once allocation_shards_once = ONCE_INITIALIZER;
+static Mutex memory_sample_lock;
+static Mutex memory_page_cache_lock;
+
+/**
+ * @brief Helper function to initialize the lock of every shard, run once on first use.
+ */
+static void initialize_allocation_shards(void) {
+    for (size_t index = 0; index < DEBUG_MEMORY_SHARD_COUNT; index++)
+        mutex_init(&allocation_shards[index].lock);
+    mutex_init(&memory_sample_lock);
+    mutex_init(&memory_page_cache_lock);
+}
+
+static inline void lock_shard(MemoryAllocationShard * shard) {
+    mutex_lock(&shard->lock);
+}
+
+static inline void unlock_shard(MemoryAllocationShard * shard) {
+    mutex_unlock(&shard->lock);
+}
+#else
+static inline void lock_shard(MemoryAllocationShard * shard) { (void)shard; }
+static inline void unlock_shard(MemoryAllocationShard * shard) { (void)shard; }
+#endif
+
+/**
+ * @brief Helper function to find the shard that tracks the given address hash.
+ * 
+ * @param hash The hash of the address, from hash_pointer, the high bits select the shard and the low bits the table slot.
+ * @return MemoryAllocationShard * The shard owning the address.
+ */
+static inline MemoryAllocationShard * get_allocation_shard(uint64_t hash) {
+#if DEBUG_MEMORY_THREAD_SAFE
+    thread_once(&allocation_shards_once, initialize_allocation_shards);
+#endif
+    return &allocation_shards[hash >> (64 - DEBUG_MEMORY_SHARD_BITS)];
+}
+
+#if !DEBUG_MEMORY_INLINE_HEADERS
+
+/**
+ * @def DEBUG_MEMORY_BLOCK_PREFIX_SIZE
+ * @brief Bytes a block keeps in front of the user memory, records live in the shard tables.
+ */
+#define DEBUG_MEMORY_BLOCK_PREFIX_SIZE 0
+/**
+ * @brief Helper function to resize an allocation table and rehash every live record.
+ * 
+ * @param table The table to resize.
+ * @param new_capacity The new capacity of the table, must be a power of two.
+ * @return true if the table was resized, 
+ * @return false if the slot array could not be allocated.
+ */
+static bool resize_allocation_table(MemoryAllocationTable * table, size_t new_capacity) {
+    MemoryAllocation ** new_slots = (MemoryAllocation **)calloc(new_capacity, sizeof(MemoryAllocation *));
+    if (!new_slots)
+        return false;
+
+    // Reinsert every live record into the new slot array.
+    for (size_t index = 0; index < table->capacity; index++) {
+        MemoryAllocation * allocation = table->slots[index];
+        if (!allocation)
+            continue;
+        size_t slot = (size_t)hash_pointer(allocation->address) & (new_capacity - 1);
+        while (new_slots[slot])
+            slot = (slot + 1) & (new_capacity - 1);
+        new_slots[slot] = allocation;
+    }
+
+    free(table->slots);
+    table->slots = new_slots;
+    table->capacity = new_capacity;
+    return true;
+}
+
+/**
+ * @brief Helper function to insert a MemoryAllocation structure into an allocation table.
+ * 
+ * @param table The table to insert into.
+ * @param allocation The MemoryAllocation structure to insert.
+ * @param hash The hash of the allocation address.
+ * @return true if the allocation was inserted, 
+ * @return false if the table could not grow to hold it.
+ * @details This function assumes that the allocation address is not already in the table.
+ */
+static bool insert_allocation(MemoryAllocationTable * table, MemoryAllocation * allocation, uint64_t hash) {
+    // Keep the load factor at or below 3/4 so probe sequences stay short.
+    if ((table->count + 1) * 4 > table->capacity * 3) {
+        size_t new_capacity = table->capacity ? table->capacity * 2 : DEBUG_MEMORY_TABLE_INITIAL_CAPACITY;
+        if (!resize_allocation_table(table, new_capacity))
+            return false;
+    }
+
+    size_t mask = table->capacity - 1;
+    size_t slot = (size_t)hash & mask;
+    while (table->slots[slot])
+        slot = (slot + 1) & mask;
+    table->slots[slot] = allocation;
+    table->count++;
+    return true;
+}
+
+/**
+ * @brief Helper function to find the table slot holding the record for the given address.
+ * 
+ * @param table The table to search.
+ * @param address The address of the allocated memory block.
+ * @param hash The hash of the address.
+ * @return size_t The slot index, or table->capacity if the address is not tracked.
+ */
+static size_t find_allocation_slot(const MemoryAllocationTable * table, void * address, uint64_t hash) {
+    if (!table->count)
+        return table->capacity;
+
+    size_t mask = table->capacity - 1;
+    size_t slot = (size_t)hash & mask;
+    while (table->slots[slot]) {
+        if (table->slots[slot]->address == address)
+            return slot;
+        slot = (slot + 1) & mask;
+    }
+    return table->capacity;
+}
+
+/**
+ * @brief Helper function to remove the record in the given slot from an allocation table.
+ * 
+ * @param table The table to remove from.
+ * @param slot The slot holding the record, from find_allocation_slot.
+ * @details Uses backward-shift deletion, records after the hole are moved back towards their
+ * home slot so later lookups never stop early on an empty slot.
+ */
+static void remove_allocation_slot(MemoryAllocationTable * table, size_t slot) {
+    size_t mask = table->capacity - 1;
+    size_t hole = slot;
+    size_t next = (hole + 1) & mask;
+    while (table->slots[next]) {
+        // A record may fill the hole only if its home slot does not lie cyclically in (hole, next].
+        size_t home = (size_t)hash_pointer(table->slots[next]->address) & mask;
+        if (((next - home) & mask) >= ((next - hole) & mask)) {
+            table->slots[hole] = table->slots[next];
+            hole = next;
+        }
+        next = (next + 1) & mask;
+    }
+    table->slots[hole] = NULL;
+    table->count--;
+}
+
+/**
+ * @brief Helper function to add a copy of a record to the shard that owns its address.
+ * 
+ * @param allocation The record to track, its address field must be set.
+ * @return true if the record is tracked, 
+ * @return false if the shard could not grow to hold it.
+ * @details Records are slots of the shard's pool, so tracking a block costs no malloc in steady state.
+ */
+static bool track_allocation(const MemoryAllocation * allocation) {
+    uint64_t hash = hash_pointer(allocation->address);
+    MemoryAllocationShard * shard = get_allocation_shard(hash);
+    lock_shard(shard);
+    if (!shard->records.slot_size)
+        pool_init(&shard->records, sizeof(MemoryAllocation), 0);
+
+    MemoryAllocation * record = (MemoryAllocation *)pool_alloc(&shard->records);
+    bool inserted = false;
+    if (record) {
+        *record = *allocation;
+        inserted = insert_allocation(&shard->table, record, hash);
+        if (!inserted)
+            pool_free(&shard->records, record);
+    }
+    unlock_shard(shard);
+    return inserted;
+}
+
+/**
+ * @brief Helper function to find the record for an address and remove it from its shard.
+ * 
+ * @param address The address of the allocated memory block.
+ * @param allocation Receives a copy of the record.
+ * @return true if the address was tracked,
+ * @return false otherwise.
+ */
+static bool untrack_allocation(void * address, MemoryAllocation * allocation) {
+    uint64_t hash = hash_pointer(address);
+    MemoryAllocationShard * shard = get_allocation_shard(hash);
+    lock_shard(shard);
+    size_t slot = find_allocation_slot(&shard->table, address, hash);
+    bool found = slot < shard->table.capacity;
+    if (found) {
+        MemoryAllocation * record = shard->table.slots[slot];
+        *allocation = *record;
+        remove_allocation_slot(&shard->table, slot);
+        pool_free(&shard->records, record);
+    }
+    unlock_shard(shard);
+    return found;
+}
+
+/**
+ * @brief Helper function to allocate memory followed by guard bytes.
  * 
  * @param size The size of the memory to allocate.
- * @return void* A pointer to the allocated memory block, or NULL on failure.
+ * @return void * The address of the memory, or NULL on failure.
  */
-static void * allocate_memory_with_guard(size_t size) {
+static void * allocate_memory_block(size_t size) {
     void * address = malloc(size + DEBUG_MEMORY_GUARD_SIZE);
     if (address)
         set_memory_guard_bytes(address, size); 
@@ -52,91 +357,1094 @@ static void * allocate_memory_with_guard(size_t size) {
 }
 
 /**
- * @brief Helper function to allocate and initialize a MemoryAllocation structure.
+ * @brief Helper function to release memory returned by allocate_memory_block.
+ * 
+ * @param address The address of the memory.
+ */
+static void free_memory_block(void * address) {
+    free(address);
+}
+
+/**
+ * @brief Helper function to get how large a block can become without moving.
+ * 
+ * @param address The address of the memory.
+ * @param size The current size, returned when the platform cannot report usable sizes.
+ * @return size_t The largest size that still leaves room for the guard bytes.
+ */
+static size_t get_memory_block_capacity(void * address, size_t size) {
+    size_t usable = get_usable_size(address);
+    return usable >= size + DEBUG_MEMORY_GUARD_SIZE ? usable - DEBUG_MEMORY_GUARD_SIZE : size;
+}
+
+/**
+ * @brief Helper function to resize memory returned by allocate_memory_block, letting the C allocator extend it in place.
+ * 
+ * @param address The address of the memory.
+ * @param size The new size of the memory.
+ * @return void * The address of the memory, or NULL on failure, in which case the old memory is untouched.
+ */
+static void * reallocate_memory_block(void * address, size_t size) {
+    void * new_address = realloc(address, size + DEBUG_MEMORY_GUARD_SIZE);
+    if (new_address)
+        set_memory_guard_bytes(new_address, size);
+    return new_address;
+}
+
+#else
+
+/**
+ * @def DEBUG_MEMORY_BLOCK_PREFIX_SIZE
+ * @brief Bytes a block keeps in front of the user memory, its header and front guard.
+ */
+#define DEBUG_MEMORY_BLOCK_PREFIX_SIZE (DEBUG_MEMORY_HEADER_SIZE + DEBUG_MEMORY_GUARD_SIZE)
+
+/**
+ * @brief Helper function to get the inline header in front of a block.
  * 
  * @param address The address of the allocated memory block.
- * @param size The size of the allocated memory block.
- * @param file The name of the source file where the memory allocation occurred.
- * @param line The line number in the source file where the memory allocation occurred.
- * @return MemoryAllocation * A pointer to the initialized MemoryAllocation structure, or NULL on failure.
+ * @return MemoryAllocation * The header.
  */
-static MemoryAllocation * create_memory_allocation(void * address, size_t size, const char * file, int line) {
-    // Allocate memory for the structure
-    MemoryAllocation * allocation = (MemoryAllocation *)malloc(sizeof(MemoryAllocation));
-    if (allocation) {
-        // Initialize the structure fields
-        allocation->address = address;
-        allocation->size = size;
-        allocation->file = file;
-        allocation->line = line;
-        // Insert the new allocation record at the beginning of the linked list
-        allocation->next = head_allocation;
-    }
-    return allocation;
+static inline MemoryAllocation * get_allocation_header(void * address) {
+    return (MemoryAllocation *)((uint8_t *)address - DEBUG_MEMORY_GUARD_SIZE - DEBUG_MEMORY_HEADER_SIZE);
+}
+
+/**
+ * @brief Helper function to fill in the inline header of a block and link it into its shard.
+ * 
+ * @param allocation The record to track, its address field must be set.
+ * @return true, linking a header never needs memory.
+ */
+static bool track_allocation(const MemoryAllocation * allocation) {
+    MemoryAllocation * header = get_allocation_header(allocation->address);
+    MemoryAllocationShard * shard = get_allocation_shard(hash_pointer(allocation->address));
+    lock_shard(shard);
+    *header = *allocation;
+    header->magic = DEBUG_MEMORY_HEADER_MAGIC;
+    header->previous = NULL;
+    header->next = shard->head;
+    if (shard->head)
+        shard->head->previous = header;
+    shard->head = header;
+    unlock_shard(shard);
+    return true;
 }
 
 /**
- * @brief Helper function to find a MemoryAllocation structure for the given address.
- *  
+ * @brief Helper function to find the header in front of an address and unlink it from its shard.
+ * 
  * @param address The address of the allocated memory block.
- * @return MemoryAllocation * A pointer to the MemoryAllocation structure for the given address, or NULL if not found.
+ * @param allocation Receives a copy of the header.
+ * @return true if the address is a live block,
+ * @return false otherwise.
+ * @details The header is found by pointer arithmetic, its magic value tells live blocks apart from
+ * foreign or already freed pointers.
+ */
+static bool untrack_allocation(void * address, MemoryAllocation * allocation) {
+    MemoryAllocation * header = get_allocation_header(address);
+    MemoryAllocationShard * shard = get_allocation_shard(hash_pointer(address));
+    lock_shard(shard);
+    if (header->magic != DEBUG_MEMORY_HEADER_MAGIC || header->address != address) {
+        unlock_shard(shard);
+        return false;
+    }
+    if (header->previous)
+        header->previous->next = header->next;
+    else
+        shard->head = header->next;
+    if (header->next)
+        header->next->previous = header->previous;
+    header->magic = 0;
+    *allocation = *header;
+    unlock_shard(shard);
+    return true;
+}
+
+/**
+ * @brief Helper function to allocate a block holding its header, front guard, user memory and back guard.
+ * 
+ * @param size The size of the memory to allocate.
+ * @return void * The address of the user memory, or NULL on failure.
+ */
+static void * allocate_memory_block(size_t size) {
+    // A single allocation laid out as [header][front guard][user memory][back guard].
+    uint8_t * block = (uint8_t *)malloc(DEBUG_MEMORY_HEADER_SIZE + DEBUG_MEMORY_GUARD_SIZE + size + DEBUG_MEMORY_GUARD_SIZE);
+    if (!block)
+        return NULL;
+
+    uint8_t * address = block + DEBUG_MEMORY_HEADER_SIZE + DEBUG_MEMORY_GUARD_SIZE;
+    ((MemoryAllocation *)block)->magic = 0;
+    memcpy(address - DEBUG_MEMORY_GUARD_SIZE, DEBUG_MEMORY_GUARD_VALUE, DEBUG_MEMORY_GUARD_SIZE);
+    set_memory_guard_bytes(address, size);
+    return address;
+}
+
+/**
+ * @brief Helper function to release a block, its header lives in the same allocation.
+ * 
+ * @param address The address of the user memory.
+ */
+static void free_memory_block(void * address) {
+    free(get_allocation_header(address));
+}
+
+/**
+ * @brief Helper function to get how large a block can become without moving.
+ * 
+ * @param address The address of the user memory.
+ * @param size The current size, returned when the platform cannot report usable sizes.
+ * @return size_t The largest size that still leaves room for the header and guard bytes.
  */
-static MemoryAllocation * find_allocation(void * address) {
-    MemoryAllocation * allocation = head_allocation;
-    while (allocation) {
-        if (allocation->address == address) {
-            return allocation;
+static size_t get_memory_block_capacity(void * address, size_t size) {
+    size_t usable = get_usable_size(get_allocation_header(address));
+    size_t overhead = DEBUG_MEMORY_HEADER_SIZE + 2 * DEBUG_MEMORY_GUARD_SIZE;
+    return usable >= size + overhead ? usable - overhead : size;
+}
+
+/**
+ * @brief Helper function to resize a block, the header and front guard move with it.
+ * 
+ * @param address The address of the user memory.
+ * @param size The new size of the user memory.
+ * @return void * The new address of the user memory, or NULL on failure, in which case the old block is untouched.
+ */
+static void * reallocate_memory_block(void * address, size_t size) {
+    uint8_t * block = (uint8_t *)realloc(get_allocation_header(address), DEBUG_MEMORY_HEADER_SIZE + DEBUG_MEMORY_GUARD_SIZE + size + DEBUG_MEMORY_GUARD_SIZE);
+    if (!block)
+        return NULL;
+    uint8_t * new_address = block + DEBUG_MEMORY_HEADER_SIZE + DEBUG_MEMORY_GUARD_SIZE;
+    set_memory_guard_bytes(new_address, size);
+    return new_address;
+}
+
+#endif
+
+#if DEBUG_MEMORY_PROFILER
+
+#define DEBUG_MEMORY_CALLSITE_EMPTY 0
+#define DEBUG_MEMORY_CALLSITE_CLAIMED 1
+#define DEBUG_MEMORY_CALLSITE_READY 2
+#define DEBUG_MEMORY_CALLSITE_MAX_PROBES 64
+#define DEBUG_MEMORY_CALLSITE_OTHER_FILE "(other callsites)"
+
+/**
+ * @brief Live counters of one callsite, see MemoryCallsiteStats.
+ */
+typedef struct MemoryCallsite {
+    atomic_int state;                                       /** EMPTY, CLAIMED while the key is written, then READY. */
+    InternHandle file;                                      /** Interned file of the callsite, valid once READY. */
+    int line;                                               /** Line of the callsite, valid once READY. */
+    atomic_uint_least64_t allocation_count;
+    atomic_uint_least64_t total_bytes;
+    atomic_uint_least64_t live_bytes;
+    atomic_uint_least64_t peak_live_bytes;
+    atomic_uint_least64_t size_histogram[DEBUG_MEMORY_HISTOGRAM_BUCKETS];
+} MemoryCallsite;
+
+/**
+ * Insert-only open-addressing table keyed by (interned file, line). Slots are claimed with a
+ * compare-and-swap and never removed, so lookups and counter updates take no lock. Interning
+ * merges the copies of a __FILE__ string that translation units get for the same header.
+ * A callsite whose first DEBUG_MEMORY_CALLSITE_MAX_PROBES slots hold others is counted in
+ * memory_callsite_other, so a full table costs a bounded probe instead of a scan of every slot.
+ */
+static MemoryCallsite memory_callsites[DEBUG_MEMORY_CALLSITE_CAPACITY];
+static MemoryCallsite memory_callsite_other;
+static atomic_size_t memory_callsite_count;
+
+/**
+ * @brief Helper function to pick the histogram bucket of an allocation size.
+ * 
+ * @param size The allocation size.
+ * @return size_t The bucket index.
+ */
+static inline size_t get_size_histogram_bucket(size_t size) {
+    size_t bucket = 0;
+    size_t limit = 16;
+    while (size > limit && bucket < DEBUG_MEMORY_HISTOGRAM_BUCKETS - 1) {
+        limit <<= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+/**
+ * @brief Helper function to find or insert the counters of a callsite.
+ * 
+ * @param file The file of the callsite.
+ * @param line The line of the callsite.
+ * @return MemoryCallsite * The counters, memory_callsite_other if the callsite found no slot.
+ */
+static MemoryCallsite * get_memory_callsite(const char * file, int line) {
+    InternHandle handle = intern_static(file);
+    size_t mask = DEBUG_MEMORY_CALLSITE_CAPACITY - 1;
+    size_t slot = (size_t)(((uint64_t)handle << 32 | (uint32_t)line) * 0x9E3779B97F4A7C15ULL >> 32) & mask;
+    for (size_t probe = 0; probe < DEBUG_MEMORY_CALLSITE_MAX_PROBES; probe++) {
+        MemoryCallsite * callsite = &memory_callsites[slot];
+        int state = atomic_load_explicit(&callsite->state, memory_order_acquire);
+        if (state == DEBUG_MEMORY_CALLSITE_EMPTY) {
+            int expected = DEBUG_MEMORY_CALLSITE_EMPTY;
+            if (atomic_compare_exchange_strong_explicit(&callsite->state, &expected, DEBUG_MEMORY_CALLSITE_CLAIMED, memory_order_acquire, memory_order_acquire)) {
+                callsite->file = handle;
+                callsite->line = line;
+                atomic_store_explicit(&callsite->state, DEBUG_MEMORY_CALLSITE_READY, memory_order_release);
+                atomic_fetch_add_explicit(&memory_callsite_count, 1, memory_order_relaxed);
+                return callsite;
+            }
+            state = expected;
         }
-        allocation = allocation->next;
+        // Another thread is writing this key, wait for it before comparing.
+        while (state == DEBUG_MEMORY_CALLSITE_CLAIMED)
+            state = atomic_load_explicit(&callsite->state, memory_order_acquire);
+        if (callsite->file == handle && callsite->line == line)
+            return callsite;
+        slot = (slot + 1) & mask;
     }
-    return NULL;
+    return &memory_callsite_other;
 }
 
 /**
- * @brief Helper function to update the information for a MemoryAllocation structure.
+ * @brief Helper function to add an allocation to the statistics of its callsite.
  * 
- * @param address The address of the allocated memory block.
- * @param size The size of the allocated memory block.
- * @param file The name of the source file where the memory allocation occurred.
- * @param line The line number in the source file where the memory allocation occurred.
+ * @param file The file of the callsite.
+ * @param line The line of the callsite.
+ * @param size The allocation size.
  */
-static void update_memory_allocation(void * address, size_t size, const char * file, int line) {
-    MemoryAllocation * allocation = find_allocation(address);
-    if (allocation) {
-        allocation->size = size;
-        allocation->file = file;
-        allocation->line = line;
+static void profile_allocation(const char * file, int line, size_t size) {
+    MemoryCallsite * callsite = get_memory_callsite(file, line);
+    atomic_fetch_add_explicit(&callsite->allocation_count, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&callsite->total_bytes, size, memory_order_relaxed);
+    atomic_fetch_add_explicit(&callsite->size_histogram[get_size_histogram_bucket(size)], 1, memory_order_relaxed);
+    uint64_t live = atomic_fetch_add_explicit(&callsite->live_bytes, size, memory_order_relaxed) + size;
+    uint64_t peak = atomic_load_explicit(&callsite->peak_live_bytes, memory_order_relaxed);
+    while (live > peak && !atomic_compare_exchange_weak_explicit(&callsite->peak_live_bytes, &peak, live, memory_order_relaxed, memory_order_relaxed))
+        ;
+}
+
+/**
+ * @brief Helper function to remove a freed block from the live bytes of its callsite.
+ * 
+ * @param file The file of the callsite.
+ * @param line The line of the callsite.
+ * @param size The allocation size.
+ */
+static void profile_free(const char * file, int line, size_t size) {
+    MemoryCallsite * callsite = get_memory_callsite(file, line);
+    atomic_fetch_sub_explicit(&callsite->live_bytes, size, memory_order_relaxed);
+}
+
+/**
+ * @brief Helper function to copy the counters of a callsite into a snapshot entry.
+ * 
+ * @param entry The entry to fill.
+ * @param callsite The counters.
+ * @param file The file to report.
+ * @param line The line to report.
+ */
+static void copy_memory_callsite_stats(MemoryCallsiteStats * entry, MemoryCallsite * callsite, const char * file, int line) {
+    entry->file = file;
+    entry->line = line;
+    entry->allocation_count = atomic_load_explicit(&callsite->allocation_count, memory_order_relaxed);
+    entry->total_bytes = atomic_load_explicit(&callsite->total_bytes, memory_order_relaxed);
+    entry->live_bytes = atomic_load_explicit(&callsite->live_bytes, memory_order_relaxed);
+    entry->peak_live_bytes = atomic_load_explicit(&callsite->peak_live_bytes, memory_order_relaxed);
+    for (size_t bucket = 0; bucket < DEBUG_MEMORY_HISTOGRAM_BUCKETS; bucket++)
+        entry->size_histogram[bucket] = atomic_load_explicit(&callsite->size_histogram[bucket], memory_order_relaxed);
+}
+
+size_t debug_memory_profile_snapshot(MemoryCallsiteStats * stats, size_t capacity) {
+    size_t count = 0;
+    for (size_t slot = 0; slot < DEBUG_MEMORY_CALLSITE_CAPACITY; slot++) {
+        MemoryCallsite * callsite = &memory_callsites[slot];
+        if (atomic_load_explicit(&callsite->state, memory_order_acquire) != DEBUG_MEMORY_CALLSITE_READY)
+            continue;
+        if (count < capacity)
+            copy_memory_callsite_stats(&stats[count], callsite, intern_get(callsite->file), callsite->line);
+        count++;
+    }
+    if (atomic_load_explicit(&memory_callsite_other.allocation_count, memory_order_relaxed)) {
+        if (count < capacity)
+            copy_memory_callsite_stats(&stats[count], &memory_callsite_other, DEBUG_MEMORY_CALLSITE_OTHER_FILE, 0);
+        count++;
+    }
+    return count;
+}
+
+#else
+
+static inline void profile_allocation(const char * file, int line, size_t size) { (void)file; (void)line; (void)size; }
+static inline void profile_free(const char * file, int line, size_t size) { (void)file; (void)line; (void)size; }
+
+size_t debug_memory_profile_snapshot(MemoryCallsiteStats * stats, size_t capacity) {
+    (void)stats;
+    (void)capacity;
+    return 0;
+}
+
+#endif
+
+static MEMORY_PROFILE_SORT memory_profile_sort_column;
+
+/**
+ * @brief Helper function to read the sort column of a snapshot entry.
+ */
+static uint64_t get_memory_profile_sort_key(const MemoryCallsiteStats * stats) {
+    switch (memory_profile_sort_column) {
+        case MEMORY_PROFILE_SORT_LIVE_BYTES: return stats->live_bytes;
+        case MEMORY_PROFILE_SORT_PEAK_BYTES: return stats->peak_live_bytes;
+        case MEMORY_PROFILE_SORT_COUNT:      return stats->allocation_count;
+        default:                             return stats->total_bytes;
+    }
+}
+
+/**
+ * @brief qsort comparator ordering snapshot entries by descending sort key.
+ */
+static int compare_memory_callsite_stats(const void * left, const void * right) {
+    uint64_t left_key = get_memory_profile_sort_key((const MemoryCallsiteStats *)left);
+    uint64_t right_key = get_memory_profile_sort_key((const MemoryCallsiteStats *)right);
+    return (left_key < right_key) - (left_key > right_key);
+}
+
+void debug_memory_profile_dump(FILE * stream, MEMORY_PROFILE_FORMAT format, MEMORY_PROFILE_SORT sort) {
+    // Size the snapshot from the callsite count, retrying if callsites appear while copying.
+    size_t capacity = debug_memory_profile_snapshot(NULL, 0);
+    MemoryCallsiteStats * stats = NULL;
+    size_t count = 0;
+    for (;;) {
+        stats = (MemoryCallsiteStats *)realloc(stats, (capacity ? capacity : 1) * sizeof(MemoryCallsiteStats));
+        if (!stats) {
+            LOG_CONSOLE_ERROR("Failed to allocate the memory profile snapshot.");
+            return;
+        }
+        count = debug_memory_profile_snapshot(stats, capacity);
+        if (count <= capacity)
+            break;
+        capacity = count;
+    }
+
+    // The dump runs rarely and never concurrently with itself, a file-scope sort column keeps qsort portable.
+    memory_profile_sort_column = sort;
+    qsort(stats, count, sizeof(MemoryCallsiteStats), compare_memory_callsite_stats);
+
+    if (format == MEMORY_PROFILE_FORMAT_CSV) {
+        fprintf(stream, "file,line,allocation_count,total_bytes,live_bytes,peak_live_bytes");
+        for (size_t bucket = 0; bucket < DEBUG_MEMORY_HISTOGRAM_BUCKETS - 1; bucket++)
+            fprintf(stream, ",size_le_%llu", 16ULL << bucket);
+        fprintf(stream, ",size_gt_%llu", 16ULL << (DEBUG_MEMORY_HISTOGRAM_BUCKETS - 2));
+        fprintf(stream, "\n");
+        for (size_t index = 0; index < count; index++) {
+            const MemoryCallsiteStats * entry = &stats[index];
+            fprintf(stream, "\"%s\",%d,%llu,%llu,%llu,%llu", entry->file, entry->line,
+                (unsigned long long)entry->allocation_count, (unsigned long long)entry->total_bytes,
+                (unsigned long long)entry->live_bytes, (unsigned long long)entry->peak_live_bytes);
+            for (size_t bucket = 0; bucket < DEBUG_MEMORY_HISTOGRAM_BUCKETS; bucket++)
+                fprintf(stream, ",%llu", (unsigned long long)entry->size_histogram[bucket]);
+            fprintf(stream, "\n");
+        }
+    } else {
+        fprintf(stream, "%-48s %12s %16s %16s %16s\n", "callsite", "count", "total bytes", "live bytes", "peak bytes");
+        // Callsites are formatted on the stack, long paths move to the heap instead of being cut.
+        char callsite_buffer[256];
+        StringBuilder callsite;
+        string_builder_init(&callsite, callsite_buffer, sizeof(callsite_buffer));
+        for (size_t index = 0; index < count; index++) {
+            const MemoryCallsiteStats * entry = &stats[index];
+            string_builder_clear(&callsite);
+            string_builder_append_format(&callsite, "%s:%d", entry->file, entry->line);
+            fprintf(stream, "%-48s %12llu %16llu %16llu %16llu\n", callsite.data,
+                (unsigned long long)entry->allocation_count, (unsigned long long)entry->total_bytes,
+                (unsigned long long)entry->live_bytes, (unsigned long long)entry->peak_live_bytes);
+        }
+        string_builder_destroy(&callsite);
     }
+    free(stats);
+}
+
+#define DEBUG_MEMORY_SAMPLE_BUCKETS 1024
+
+/**
+ * @brief A live allocation picked by the sampling heap profiler.
+ */
+typedef struct MemorySample {
+    struct MemorySample * next;                 /** Next sample in the same bucket. */
+    void * address;                             /** Address of the sampled block. */
+    size_t size;                                /** Size of the sampled block. */
+    int depth;                                  /** Number of frames in stack. */
+    void * stack[DEBUG_MEMORY_SAMPLE_MAX_DEPTH]; /** Return addresses, innermost frame first. */
+} MemorySample;
+
+static MemorySample * memory_sample_buckets[DEBUG_MEMORY_SAMPLE_BUCKETS];
+static atomic_size_t memory_sample_rate;
+static THREAD_LOCAL int64_t memory_bytes_until_sample;
+static THREAD_LOCAL uint64_t memory_sample_random_state;
+
+static inline void lock_samples(void) {
+#if DEBUG_MEMORY_THREAD_SAFE
+    thread_once(&allocation_shards_once, initialize_allocation_shards);
+    mutex_lock(&memory_sample_lock);
+#endif
+}
+
+static inline void unlock_samples(void) {
+#if DEBUG_MEMORY_THREAD_SAFE
+    mutex_unlock(&memory_sample_lock);
+#endif
+}
+
+void debug_memory_set_sample_rate(size_t sample_rate) {
+    atomic_store_explicit(&memory_sample_rate, sample_rate, memory_order_relaxed);
+}
+
+/**
+ * @brief Helper function to step a thread-local xorshift generator.
+ * 
+ * @param state The generator state, seeded from its own address when still 0.
+ * @return uint64_t The next pseudo-random value, never 0.
+ */
+static inline uint64_t next_random_value(uint64_t * state) {
+    // Seed each thread from the address of its thread-local state.
+    if (!*state)
+        *state = hash_pointer(state) | 1;
+
+    uint64_t value = *state;
+    value ^= value << 13;
+    value ^= value >> 7;
+    value ^= value << 17;
+    *state = value;
+    return value;
+}
+
+/**
+ * @brief Helper function to draw the number of bytes until the next sample.
+ * 
+ * @param sample_rate The mean number of bytes between samples.
+ * @return int64_t An exponentially distributed byte count, so samples form a Poisson process over bytes.
+ */
+static int64_t draw_bytes_until_sample(size_t sample_rate) {
+    uint64_t value = next_random_value(&memory_sample_random_state);
+
+    // Uniform in (0, 1], from the top 53 bits.
+    double uniform = ((double)(value >> 11) + 1.0) / 9007199254740992.0;
+    return (int64_t)(-log(uniform) * (double)sample_rate) + 1;
+}
+
+/**
+ * @brief Helper function to decide whether an allocation is sampled.
+ * 
+ * @param size The allocation size.
+ * @return true if a stack trace should be captured for this allocation,
+ * @return false otherwise. Costs a load and a subtraction when not sampling.
+ */
+static inline bool should_sample_allocation(size_t size) {
+    size_t sample_rate = atomic_load_explicit(&memory_sample_rate, memory_order_relaxed);
+    if (!sample_rate)
+        return false;
+
+    memory_bytes_until_sample -= (int64_t)size;
+    if (memory_bytes_until_sample > 0)
+        return false;
+
+    // A thread's first allocation only arms its counter, so threads do not all sample at start up.
+    bool armed = memory_sample_random_state != 0;
+    memory_bytes_until_sample = draw_bytes_until_sample(sample_rate);
+    return armed;
 }
 
 /**
+ * @brief Helper function to capture the stack of the allocating thread.
  * 
- * @brief Helper function to remove a MemoryAllocation structure from the global linked list.
+ * @param stack Receives the return addresses, innermost first.
+ * @param skip The number of innermost frames to drop.
+ * @return int The number of frames captured.
+ */
+static int capture_stack_trace(void ** stack, int skip) {
+    void * frames[DEBUG_MEMORY_SAMPLE_MAX_DEPTH + 4];
+    int depth = 0;
+#if OS_LINUX || OS_MAC
+    depth = backtrace(frames, DEBUG_MEMORY_SAMPLE_MAX_DEPTH + 4);
+#elif OS_WINDOWS
+    depth = (int)CaptureStackBackTrace(0, DEBUG_MEMORY_SAMPLE_MAX_DEPTH + 4, frames, NULL);
+#endif
+    depth -= skip;
+    if (depth <= 0)
+        return 0;
+    if (depth > DEBUG_MEMORY_SAMPLE_MAX_DEPTH)
+        depth = DEBUG_MEMORY_SAMPLE_MAX_DEPTH;
+    memcpy(stack, frames + skip, (size_t)depth * sizeof(void *));
+    return depth;
+}
+
+/**
+ * @brief Helper function to capture and store a sample for a newly allocated block.
  * 
- * @param target The MemoryAllocation structure to remove.
- * @details This function assumes that the allocation is in the list.
+ * @param address The address of the block.
+ * @param size The size of the block.
+ * @details Kept out of line so the frames to skip are always this function and its debug_* caller.
  */
-static void remove_allocation_from_list(MemoryAllocation * target) {
-    // If the allocation is the head of the list, update the head pointer.
-    if (head_allocation == target) {
-        head_allocation = target->next;
+static DEBUG_NOINLINE void record_memory_sample(void * address, size_t size) {
+    MemorySample * sample = (MemorySample *)malloc(sizeof(MemorySample));
+    if (!sample)
         return;
+    sample->address = address;
+    sample->size = size;
+    sample->depth = capture_stack_trace(sample->stack, 2);
+
+    size_t bucket = (size_t)hash_pointer(address) & (DEBUG_MEMORY_SAMPLE_BUCKETS - 1);
+    lock_samples();
+    sample->next = memory_sample_buckets[bucket];
+    memory_sample_buckets[bucket] = sample;
+    unlock_samples();
+}
+
+/**
+ * @brief Helper function to drop the sample of a block that is being freed.
+ * 
+ * @param address The address of the block.
+ */
+static void remove_memory_sample(void * address) {
+    size_t bucket = (size_t)hash_pointer(address) & (DEBUG_MEMORY_SAMPLE_BUCKETS - 1);
+    lock_samples();
+    MemorySample ** link = &memory_sample_buckets[bucket];
+    while (*link && (*link)->address != address)
+        link = &(*link)->next;
+    MemorySample * sample = *link;
+    if (sample)
+        *link = sample->next;
+    unlock_samples();
+    free(sample);
+}
+
+void debug_memory_write_heap_profile(FILE * stream) {
+    size_t sample_rate = atomic_load_explicit(&memory_sample_rate, memory_order_relaxed);
+
+    lock_samples();
+    size_t total_count = 0;
+    size_t total_bytes = 0;
+    for (size_t bucket = 0; bucket < DEBUG_MEMORY_SAMPLE_BUCKETS; bucket++) {
+        for (MemorySample * sample = memory_sample_buckets[bucket]; sample; sample = sample->next) {
+            total_count++;
+            total_bytes += sample->size;
+        }
+    }
+
+    // Counts are raw samples, pprof unsamples them using the rate after heap_v2/.
+    fprintf(stream, "heap profile: %zu: %zu [%zu: %zu] @ heap_v2/%zu\n", total_count, total_bytes, total_count, total_bytes, sample_rate);
+    for (size_t bucket = 0; bucket < DEBUG_MEMORY_SAMPLE_BUCKETS; bucket++) {
+        for (MemorySample * sample = memory_sample_buckets[bucket]; sample; sample = sample->next) {
+            fprintf(stream, "1: %zu [1: %zu] @", sample->size, sample->size);
+            for (int frame = 0; frame < sample->depth; frame++)
+                fprintf(stream, " %p", sample->stack[frame]);
+            fprintf(stream, "\n");
+        }
+    }
+    unlock_samples();
+
+#if OS_LINUX
+    // pprof maps addresses back to binaries with the process memory map.
+    FILE * maps = fopen("/proc/self/maps", "r");
+    if (maps) {
+        char buffer[4096];
+        size_t length;
+        fprintf(stream, "\nMAPPED_LIBRARIES:\n");
+        while ((length = fread(buffer, 1, sizeof(buffer), maps)) > 0)
+            fwrite(buffer, 1, length, stream);
+        fclose(maps);
+    }
+#endif
+}
+
+/**
+ * @brief Helper function to write the name of one frame in a collapsed stack.
+ * 
+ * @param stream The stream to write to.
+ * @param address The return address of the frame.
+ * @param symbol The backtrace_symbols string for the frame, or NULL.
+ */
+static void write_collapsed_frame(FILE * stream, void * address, const char * symbol) {
+    // backtrace_symbols gives "binary(function+0x1f) [0x...]", keep only the function name.
+    if (symbol) {
+        const char * open = strchr(symbol, '(');
+        const char * end = open ? strpbrk(open + 1, "+)") : NULL;
+        if (open && end && end > open + 1) {
+            fwrite(open + 1, 1, (size_t)(end - open - 1), stream);
+            return;
+        }
+    }
+    fprintf(stream, "%p", address);
+}
+
+void debug_memory_write_collapsed_stacks(FILE * stream) {
+    size_t sample_rate = atomic_load_explicit(&memory_sample_rate, memory_order_relaxed);
+
+    lock_samples();
+    for (size_t bucket = 0; bucket < DEBUG_MEMORY_SAMPLE_BUCKETS; bucket++) {
+        for (MemorySample * sample = memory_sample_buckets[bucket]; sample; sample = sample->next) {
+            char ** symbols = NULL;
+#if OS_LINUX || OS_MAC
+            symbols = backtrace_symbols(sample->stack, sample->depth);
+#endif
+            for (int frame = sample->depth - 1; frame >= 0; frame--) {
+                write_collapsed_frame(stream, sample->stack[frame], symbols ? symbols[frame] : NULL);
+                if (frame)
+                    fputc(';', stream);
+            }
+            free(symbols);
+
+            // A block of size s is sampled with probability 1 - e^(-s/rate), scale it back up.
+            double size = (double)sample->size;
+            double probability = sample_rate ? 1.0 - exp(-size / (double)sample_rate) : 1.0;
+            fprintf(stream, " %.0f\n", probability > 0.0 ? size / probability : size);
+        }
+    }
+    unlock_samples();
+}
+
+#if OS_WINDOWS || OS_LINUX || OS_ANDROID || OS_MAC || OS_IOS
+    #define DEBUG_MEMORY_PAGE_GUARD_SUPPORTED 1
+#else
+    #define DEBUG_MEMORY_PAGE_GUARD_SUPPORTED 0
+#endif
+
+/**
+ * @brief Mappings of freed page-guarded blocks kept for reuse, grouped by their number of data pages.
+ * 
+ * A cached mapping keeps its inaccessible page and has its data pages made inaccessible too, so
+ * reusing it costs one protection change instead of a map, a protect and an unmap, and a stale
+ * pointer into it still faults.
+ */
+typedef struct MemoryPageCache {
+    void * mappings[DEBUG_MEMORY_PAGE_CACHE_CLASSES][DEBUG_MEMORY_PAGE_CACHE_DEPTH]; /** Free mappings, class i has i + 1 data pages. */
+    size_t counts[DEBUG_MEMORY_PAGE_CACHE_CLASSES];                                  /** Number of mappings in each class. */
+} MemoryPageCache;
+
+static MemoryPageCache memory_page_cache;
+static atomic_size_t memory_page_size;
+static atomic_size_t memory_page_guard_minimum_size;
+static atomic_size_t memory_page_guard_sample_interval;
+static THREAD_LOCAL int64_t memory_allocations_until_page_guard;
+static THREAD_LOCAL uint64_t memory_page_guard_random_state;
+
+static inline void lock_page_cache(void) {
+#if DEBUG_MEMORY_THREAD_SAFE
+    thread_once(&allocation_shards_once, initialize_allocation_shards);
+    mutex_lock(&memory_page_cache_lock);
+#endif
+}
+
+static inline void unlock_page_cache(void) {
+#if DEBUG_MEMORY_THREAD_SAFE
+    mutex_unlock(&memory_page_cache_lock);
+#endif
+}
+
+void debug_memory_set_page_guard(size_t minimum_size, size_t sample_interval) {
+    atomic_store_explicit(&memory_page_guard_minimum_size, minimum_size, memory_order_relaxed);
+    atomic_store_explicit(&memory_page_guard_sample_interval, sample_interval, memory_order_relaxed);
+}
+
+/**
+ * @brief Helper function to get the size of a virtual memory page.
+ * 
+ * @return size_t The page size, queried from the system on first use.
+ */
+static size_t get_page_size(void) {
+    size_t page_size = atomic_load_explicit(&memory_page_size, memory_order_relaxed);
+    if (!page_size) {
+#if OS_WINDOWS
+        SYSTEM_INFO info;
+        GetSystemInfo(&info);
+        page_size = (size_t)info.dwPageSize;
+#elif DEBUG_MEMORY_PAGE_GUARD_SUPPORTED
+        page_size = (size_t)sysconf(_SC_PAGESIZE);
+#else
+        page_size = 4096;
+#endif
+        atomic_store_explicit(&memory_page_size, page_size, memory_order_relaxed);
+    }
+    return page_size;
+}
+
+/**
+ * @brief Helper function to map readable and writable pages.
+ * 
+ * @param size The number of bytes to map, a multiple of the page size.
+ * @return void * The first page, or NULL on failure.
+ */
+static void * map_pages(size_t size) {
+#if OS_WINDOWS
+    return VirtualAlloc(NULL, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+#elif DEBUG_MEMORY_PAGE_GUARD_SUPPORTED
+    void * pages = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    return pages == MAP_FAILED ? NULL : pages;
+#else
+    (void)size;
+    return NULL;
+#endif
+}
+
+/**
+ * @brief Helper function to change whether mapped pages can be accessed.
+ * 
+ * @param pages The first page.
+ * @param size The number of bytes to change, a multiple of the page size.
+ * @param accessible true to make the pages readable and writable, false to make any access fault.
+ * @return true on success,
+ * @return false otherwise.
+ */
+static bool protect_pages(void * pages, size_t size, bool accessible) {
+#if OS_WINDOWS
+    DWORD old_protection;
+    return VirtualProtect(pages, size, accessible ? PAGE_READWRITE : PAGE_NOACCESS, &old_protection) != 0;
+#elif DEBUG_MEMORY_PAGE_GUARD_SUPPORTED
+    return mprotect(pages, size, accessible ? PROT_READ | PROT_WRITE : PROT_NONE) == 0;
+#else
+    (void)pages; (void)size; (void)accessible;
+    return false;
+#endif
+}
+
+/**
+ * @brief Helper function to unmap pages returned by map_pages.
+ * 
+ * @param pages The first page.
+ * @param size The number of bytes mapped.
+ */
+static void unmap_pages(void * pages, size_t size) {
+#if OS_WINDOWS
+    (void)size;
+    VirtualFree(pages, 0, MEM_RELEASE);
+#elif DEBUG_MEMORY_PAGE_GUARD_SUPPORTED
+    munmap(pages, size);
+#else
+    (void)pages; (void)size;
+#endif
+}
+
+/**
+ * @brief Helper function to get the number of accessible bytes mapped for a page-guarded block.
+ * 
+ * @param size The size of the block.
+ * @return size_t The data pages in bytes, the inaccessible page follows them.
+ */
+static inline size_t get_page_guard_data_size(size_t size) {
+    size_t page_size = get_page_size();
+    size_t used = DEBUG_MEMORY_BLOCK_PREFIX_SIZE + ((size + 15) & ~(size_t)15);
+    return (used + page_size - 1) & ~(page_size - 1);
+}
+
+/**
+ * @brief Helper function to decide whether an allocation gets its own pages.
+ * 
+ * @param size The allocation size.
+ * @return true if the block should end against an inaccessible page,
+ * @return false otherwise. Costs two loads when page guards are disabled.
+ */
+static inline bool should_guard_page(size_t size) {
+    size_t minimum_size = atomic_load_explicit(&memory_page_guard_minimum_size, memory_order_relaxed);
+    if (minimum_size && size >= minimum_size)
+        return true;
+
+    size_t sample_interval = atomic_load_explicit(&memory_page_guard_sample_interval, memory_order_relaxed);
+    if (!sample_interval)
+        return false;
+    if (--memory_allocations_until_page_guard > 0)
+        return false;
+
+    // Uniform in [1, 2 * sample_interval - 1] so the mean gap is sample_interval without a fixed stride.
+    // A thread's first allocation only arms its countdown, like the sampling heap profiler.
+    bool armed = memory_page_guard_random_state != 0;
+    uint64_t value = next_random_value(&memory_page_guard_random_state);
+    memory_allocations_until_page_guard = (int64_t)(value % (2 * (uint64_t)sample_interval - 1)) + 1;
+    return armed;
+}
+
+/**
+ * @brief Helper function to allocate a block that ends against an inaccessible page.
+ * 
+ * @param size The size of the memory to allocate.
+ * @return void * The address of the user memory, or NULL on failure.
+ * @details The user memory is placed as late as 16-byte alignment allows, the up to 15 bytes of
+ * slack after it are filled with DEBUG_MEMORY_PAGE_SLACK_VALUE and checked on free instead.
+ */
+static void * allocate_page_guarded_block(size_t size) {
+    size_t page_size = get_page_size();
+    size_t data_size = get_page_guard_data_size(size);
+    size_t page_class = data_size / page_size - 1;
+
+    // Reuse a cached mapping of the same size if there is one.
+    uint8_t * mapping = NULL;
+    if (page_class < DEBUG_MEMORY_PAGE_CACHE_CLASSES) {
+        lock_page_cache();
+        if (memory_page_cache.counts[page_class])
+            mapping = (uint8_t *)memory_page_cache.mappings[page_class][--memory_page_cache.counts[page_class]];
+        unlock_page_cache();
+        if (mapping && !protect_pages(mapping, data_size, true)) {
+            unmap_pages(mapping, data_size + page_size);
+            mapping = NULL;
+        }
+    }
+    if (!mapping) {
+        mapping = (uint8_t *)map_pages(data_size + page_size);
+        if (!mapping)
+            return NULL;
+        if (!protect_pages(mapping + data_size, page_size, false)) {
+            unmap_pages(mapping, data_size + page_size);
+            return NULL;
+        }
+    }
+
+    size_t rounded_size = (size + 15) & ~(size_t)15;
+    uint8_t * address = mapping + data_size - rounded_size;
+    memset(address + size, DEBUG_MEMORY_PAGE_SLACK_VALUE, rounded_size - size);
+#if DEBUG_MEMORY_INLINE_HEADERS
+    ((MemoryAllocation *)(address - DEBUG_MEMORY_BLOCK_PREFIX_SIZE))->magic = 0;
+    memcpy(address - DEBUG_MEMORY_GUARD_SIZE, DEBUG_MEMORY_GUARD_VALUE, DEBUG_MEMORY_GUARD_SIZE);
+#endif
+    return address;
+}
+
+/**
+ * @brief Helper function to release a block returned by allocate_page_guarded_block.
+ * 
+ * @param address The address of the user memory.
+ * @param size The size of the block.
+ */
+static void free_page_guarded_block(void * address, size_t size) {
+    size_t page_size = get_page_size();
+    size_t data_size = get_page_guard_data_size(size);
+    size_t page_class = data_size / page_size - 1;
+    uint8_t * mapping = (uint8_t *)address + ((size + 15) & ~(size_t)15) - data_size;
+
+    // Keep the mapping for reuse with every page inaccessible, unless its class is full.
+    if (page_class < DEBUG_MEMORY_PAGE_CACHE_CLASSES && protect_pages(mapping, data_size, false)) {
+        bool cached = false;
+        lock_page_cache();
+        if (memory_page_cache.counts[page_class] < DEBUG_MEMORY_PAGE_CACHE_DEPTH) {
+            memory_page_cache.mappings[page_class][memory_page_cache.counts[page_class]++] = mapping;
+            cached = true;
+        }
+        unlock_page_cache();
+        if (cached)
+            return;
+    }
+    unmap_pages(mapping, data_size + page_size);
+}
+
+/**
+ * @brief Helper function to check the slack between a page-guarded block and its inaccessible page.
+ * 
+ * @param address The address of the user memory.
+ * @param size The size of the block.
+ * @return true if the slack bytes are intact,
+ * @return false if they have been overwritten.
+ */
+static bool is_page_slack_intact(void * address, size_t size) {
+    const uint8_t * slack = (const uint8_t *)address + size;
+    for (size_t index = 0; index < (((size + 15) & ~(size_t)15) - size); index++) {
+        if (slack[index] != DEBUG_MEMORY_PAGE_SLACK_VALUE)
+            return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Helper function to allocate a block with its own pages when page guards pick it, or from the C allocator.
+ * 
+ * @param size The size of the memory to allocate.
+ * @param flags Receives DEBUG_MEMORY_FLAG_PAGE_GUARD when the block got its own pages.
+ * @return void * The address of the user memory, or NULL on failure.
+ * @details Falls back to the C allocator when pages cannot be mapped, e.g. once the process
+ * reaches its mapping limit, so page guards never make an allocation fail.
+ */
+static void * allocate_block(size_t size, unsigned int * flags) {
+    if (should_guard_page(size)) {
+        void * address = allocate_page_guarded_block(size);
+        if (address) {
+            *flags |= DEBUG_MEMORY_FLAG_PAGE_GUARD;
+            return address;
+        }
     }
+    return allocate_memory_block(size);
+}
 
-    // Else, find the previous allocation in the list.
-    MemoryAllocation * previous = head_allocation;
-    while (previous && previous->next != target)
-        previous = previous->next;
+/**
+ * @brief Helper function to release a block returned by allocate_block.
+ * 
+ * @param allocation The record of the block.
+ */
+static void free_block(const MemoryAllocation * allocation) {
+    if (allocation->flags & DEBUG_MEMORY_FLAG_PAGE_GUARD)
+        free_page_guarded_block(allocation->address, (size_t)allocation->size);
+    else
+        free_memory_block(allocation->address);
+}
 
-    // If we found the previous allocation, remove the current allocation from the list.
-    if (previous)
-        previous->next = target->next;  
-    
+/**
+ * @brief Helper function to report damaged guard bytes around a block.
+ * 
+ * @param allocation The record of the block to check.
+ * @param overrun_message The message logged when the back guard was overwritten.
+ * @param underrun_message The message logged when the front guard was overwritten.
+ * @return true if every guard is intact, 
+ * @return false otherwise.
+ */
+static bool check_memory_guards(const MemoryAllocation * allocation, const char * overrun_message, const char * underrun_message) {
+    bool intact = true;
+    bool back_intact = allocation->flags & DEBUG_MEMORY_FLAG_PAGE_GUARD
+        ? is_page_slack_intact(allocation->address, (size_t)allocation->size)
+        : is_memory_guard_intact(allocation->address, allocation->size);
+    if (!back_intact) {
+        LOG_CONSOLE_ERROR_LIMITED("%s The block was allocated at %s:%d.", overrun_message, allocation->file, allocation->line);
+        intact = false;
+    }
+#if DEBUG_MEMORY_INLINE_HEADERS
+    if (!is_memory_front_guard_intact(allocation->address)) {
+        LOG_CONSOLE_ERROR_LIMITED("%s The block was allocated at %s:%d.", underrun_message, allocation->file, allocation->line);
+        intact = false;
+    }
+#else
+    (void)underrun_message;
+#endif
+    return intact;
+}
+
+static atomic_size_t memory_quarantine_size;
+
+void debug_memory_set_quarantine_size(size_t byte_budget) {
+    atomic_store_explicit(&memory_quarantine_size, byte_budget, memory_order_relaxed);
+}
+
+/**
+ * @brief Helper function to find the first byte of a freed block that no longer holds the poison value.
+ * 
+ * @param address The address of the block.
+ * @param size The size of the block.
+ * @return size_t The offset of the first damaged byte, or size if the poison is intact.
+ */
+static size_t find_poison_damage(const uint8_t * address, size_t size) {
+    // Compare a word at a time, then find the exact byte.
+    const uint64_t poison = 0x0101010101010101ULL * DEBUG_MEMORY_FREE_VALUE;
+    size_t offset = 0;
+    for (; offset + sizeof(uint64_t) <= size; offset += sizeof(uint64_t)) {
+        uint64_t word;
+        memcpy(&word, address + offset, sizeof(word));
+        if (word != poison)
+            break;
+    }
+    for (; offset < size; offset++) {
+        if (address[offset] != DEBUG_MEMORY_FREE_VALUE)
+            return offset;
+    }
+    return size;
+}
+
+/**
+ * @brief Helper function to verify a block leaving the quarantine and return it to the C allocator.
+ * 
+ * @param allocation The record of the block, as it was when the block was freed.
+ * @return true if the block was untouched while quarantined,
+ * @return false otherwise.
+ */
+static bool release_quarantined_block(const MemoryAllocation * allocation) {
+    size_t size = (size_t)allocation->size;
+    size_t offset = find_poison_damage((const uint8_t *)allocation->address, size);
+    bool intact = offset == size;
+    if (!intact) {
+        LOG_CONSOLE_ERROR_LIMITED("Use after free detected at %p, byte %zu of %zu was written after free. The block was allocated at %s:%d.",
+            allocation->address, offset, size, allocation->file, allocation->line);
+    }
+    intact &= check_memory_guards(allocation, "Buffer overrun detected after free.", "Buffer underrun detected after free.");
+    free_block(allocation);
+    return intact;
+}
+
+/**
+ * @brief Helper function to take the oldest block out of a shard's quarantine, the shard must be locked and its quarantine not empty.
+ * 
+ * @param shard The shard.
+ * @return MemoryAllocation The record of the block.
+ */
+static MemoryAllocation pop_quarantined_block(MemoryAllocationShard * shard) {
+    MemoryAllocation evicted = shard->quarantine[shard->quarantine_head];
+    shard->quarantine_head = (shard->quarantine_head + 1) % DEBUG_MEMORY_QUARANTINE_SHARD_CAPACITY;
+    shard->quarantine_count--;
+    shard->quarantine_bytes -= (size_t)evicted.size;
+    return evicted;
+}
+
+/**
+ * @brief Helper function to poison a freed block and hold it in its shard's quarantine.
+ * 
+ * @param allocation The record of the freed block.
+ * @return true if the block was quarantined,
+ * @return false if it should be released right away.
+ * @details The oldest blocks are evicted until the new one fits, each block is pushed and
+ * evicted once, so the cost is O(1) amortized per free. Evicted blocks are verified with the
+ * shard unlocked.
+ */
+static bool quarantine_memory_block(const MemoryAllocation * allocation) {
+    size_t budget = atomic_load_explicit(&memory_quarantine_size, memory_order_relaxed) / DEBUG_MEMORY_SHARD_COUNT;
+    size_t size = (size_t)allocation->size;
+    if (size > budget || (allocation->flags & DEBUG_MEMORY_FLAG_PAGE_GUARD))
+        return false;
+
+    MemoryAllocationShard * shard = get_allocation_shard(hash_pointer(allocation->address));
+    lock_shard(shard);
+    if (!shard->quarantine) {
+        shard->quarantine = (MemoryAllocation *)malloc(DEBUG_MEMORY_QUARANTINE_SHARD_CAPACITY * sizeof(MemoryAllocation));
+        if (!shard->quarantine) {
+            unlock_shard(shard);
+            return false;
+        }
+    }
+    while (shard->quarantine_count == DEBUG_MEMORY_QUARANTINE_SHARD_CAPACITY || (shard->quarantine_count && shard->quarantine_bytes + size > budget)) {
+        MemoryAllocation evicted = pop_quarantined_block(shard);
+        unlock_shard(shard);
+        release_quarantined_block(&evicted);
+        lock_shard(shard);
+    }
+
+    memset(allocation->address, DEBUG_MEMORY_FREE_VALUE, size);
+    size_t tail = (shard->quarantine_head + shard->quarantine_count) % DEBUG_MEMORY_QUARANTINE_SHARD_CAPACITY;
+    shard->quarantine[tail] = *allocation;
+    shard->quarantine_count++;
+    shard->quarantine_bytes += size;
+    unlock_shard(shard);
+    return true;
+}
+
+size_t debug_memory_flush_quarantine(void) {
+    size_t damaged = 0;
+    for (size_t shard_index = 0; shard_index < DEBUG_MEMORY_SHARD_COUNT; shard_index++) {
+        MemoryAllocationShard * shard = get_allocation_shard((uint64_t)shard_index << (64 - DEBUG_MEMORY_SHARD_BITS));
+        lock_shard(shard);
+        while (shard->quarantine_count) {
+            MemoryAllocation evicted = pop_quarantined_block(shard);
+            unlock_shard(shard);
+            damaged += !release_quarantined_block(&evicted);
+            lock_shard(shard);
+        }
+        unlock_shard(shard);
+    }
+    return damaged;
+}
+
+size_t debug_memory_quarantine_bytes(void) {
+    size_t bytes = 0;
+    for (size_t shard_index = 0; shard_index < DEBUG_MEMORY_SHARD_COUNT; shard_index++) {
+        MemoryAllocationShard * shard = get_allocation_shard((uint64_t)shard_index << (64 - DEBUG_MEMORY_SHARD_BITS));
+        lock_shard(shard);
+        bytes += shard->quarantine_bytes;
+        unlock_shard(shard);
+    }
+    return bytes;
 }
 
 void * debug_malloc(size_t size, const char * file, int line) {
     // Allocate the requested memory, including space for the guard bytes, and return NULL if the allocation failed.
-    void * address = allocate_memory_with_guard(size);
+    MemoryAllocation allocation = { 0 };
+    void * address = allocate_block(size, &allocation.flags);
     if (!address) {
         LOG_CONSOLE_ERROR("Failed to allocate memory with guard.");
         return NULL;
@@ -144,17 +1452,22 @@ void * debug_malloc(size_t size, const char * file, int line) {
 
     // Initialize the memory to DEBUG_MEMORY_INIT_VALUE to detect uninitialized memory reads.
     memset(address, DEBUG_MEMORY_INIT_VALUE, size);
-    
-    // Create a new allocation record and add it to the list, or return NULL if the allocation failed.
-    MemoryAllocation * allocation = create_memory_allocation(address, size, file, line);
-    if (!allocation) {
+
+    // Track the block in its shard, or return NULL if the shard could not grow.
+    allocation.address = address;
+    allocation.size = size;
+    allocation.file = file;
+    allocation.line = line;
+    if (should_sample_allocation(size))
+        allocation.flags |= DEBUG_MEMORY_FLAG_SAMPLED;
+    if (!track_allocation(&allocation)) {
         LOG_CONSOLE_ERROR("Failed to create memory allocation.");
-        free(address);
+        free_block(&allocation);
         return NULL;
     }
-
-    // Update the head pointer to the new allocation record.
-    head_allocation = allocation;
+    profile_allocation(file, line, size);
+    if (allocation.flags & DEBUG_MEMORY_FLAG_SAMPLED)
+        record_memory_sample(address, size);
 
     // Return the address of the allocated memory block.
     return address;
@@ -166,32 +1479,78 @@ void * debug_realloc(void * address, size_t size, const char * file, int line) {
     if (!address) 
         return debug_malloc(size, file, line);
 
-    // Check for buffer overruns before reallocating.
-    MemoryAllocation * target = find_allocation(address);
-    if (target && !is_memory_guard_intact(address, target->size)) {
-        LOG_CONSOLE_ERROR("Buffer overrun detected before realloc.");
+    // Find the target allocation and take it out of its shard.
+    MemoryAllocation target;
+    if (!untrack_allocation(address, &target)) {
+        LOG_CONSOLE_ERROR_LIMITED("Target memory address %p not found in allocation table during realloc.", address);
         return NULL;
     }
 
-    // Reallocate the requested memory, including space for the guard bytes, and return NULL if the allocation failed.
-    void * new_address = allocate_memory_with_guard(size);
-    if (!new_address) {
-        LOG_CONSOLE_ERROR("Failed to allocate memory with guard.");
+    // Check for buffer overruns before reallocating, the damaged block stays tracked so it is still reported.
+    if (!check_memory_guards(&target, "Buffer overrun detected before realloc.", "Buffer underrun detected before realloc.")) {
+        track_allocation(&target);
         return NULL;
     }
 
-    // Copy the contents of the old memory block to the new memory block.
-    if (target) {
-        memcpy(new_address, address, (size > target->size) ? target->size : size);
-        debug_free(address);
-        update_memory_allocation(new_address, size, file, line);
+    // Drop the sample while the old address still belongs to this block.
+    if (target.flags & DEBUG_MEMORY_FLAG_SAMPLED) {
+        remove_memory_sample(address);
+        target.flags &= ~DEBUG_MEMORY_FLAG_SAMPLED;
+    }
+
+    size_t old_size = (size_t)target.size;
+    void * new_address = address;
+    unsigned int new_flags = 0;
+    bool was_page_guarded = (target.flags & DEBUG_MEMORY_FLAG_PAGE_GUARD) != 0;
+    bool page_guarded = should_guard_page(size);
+    if (!was_page_guarded && !page_guarded && size <= get_memory_block_capacity(address, old_size)) {
+        // Shrink, or grow into the slack the C allocator already gave the block, and move the guard to the new end.
+        set_memory_guard_bytes(address, size);
+    } else if (!was_page_guarded && !page_guarded) {
+        // Let the C allocator extend the block, it only copies when the block cannot grow where it is.
+        new_address = reallocate_memory_block(address, size);
+        if (!new_address) {
+            LOG_CONSOLE_ERROR("Failed to allocate memory with guard.");
+            track_allocation(&target);
+            return NULL;
+        }
+    } else {
+        // Page-guarded blocks end against their inaccessible page, so moving into or out of one always copies.
+        new_address = page_guarded ? allocate_page_guarded_block(size) : NULL;
+        if (new_address)
+            new_flags = DEBUG_MEMORY_FLAG_PAGE_GUARD;
+        else
+            new_address = allocate_memory_block(size);
+        if (!new_address) {
+            LOG_CONSOLE_ERROR("Failed to allocate memory with guard.");
+            track_allocation(&target);
+            return NULL;
+        }
+        memcpy(new_address, address, size < old_size ? size : old_size);
+        free_block(&target);
+    }
+    profile_free(target.file, target.line, old_size);
+
+    // Memory past the old size is uninitialized, mark it like debug_malloc does.
+    if (size > old_size)
+        memset((uint8_t *)new_address + old_size, DEBUG_MEMORY_INIT_VALUE, size - old_size);
+
+    // Track the new block under the callsite of the reallocation.
+    target.address = new_address;
+    target.size = size;
+    target.file = file;
+    target.line = line;
+    target.flags = new_flags | (should_sample_allocation(size) ? DEBUG_MEMORY_FLAG_SAMPLED : 0);
+    if (!track_allocation(&target)) {
+        // The block may be the caller's own, resized in place, and the old one may be gone, so it is returned untracked.
+        // debug_free then reports it as not found and leaves it allocated.
+        LOG_CONSOLE_ERROR("Failed to track the reallocated memory, it is returned untracked.");
         return new_address;
     }
-    
-    // If allocation is not in the list, clean up memory and return NULL.
-    LOG_CONSOLE_ERROR("Target memory address not found in allocation list during realloc.");
-    free(new_address);
-    return NULL;
+    profile_allocation(file, line, size);
+    if (target.flags & DEBUG_MEMORY_FLAG_SAMPLED)
+        record_memory_sample(new_address, size);
+    return new_address;
 }
 
 
@@ -214,33 +1573,121 @@ void * debug_calloc(size_t count, size_t size, const char * file, int line) {
 void debug_free(void * address) {
     if (!address) return;  
 
-    // Find the target allocation in the list.
-    MemoryAllocation * target = find_allocation(address);
-    if (!target) {
-        LOG_CONSOLE_ERROR("Target memory address not found in allocation list during free.");
+    // Find the target allocation and take it out of its shard.
+    MemoryAllocation target;
+    if (!untrack_allocation(address, &target)) {
+        LOG_CONSOLE_ERROR_LIMITED("Target memory address %p not found in allocation table during free.", address);
         return;
     }
 
     // Check for buffer overruns before freeing.
-    if (!is_memory_guard_intact(address, target->size))
-        LOG_CONSOLE_ERROR("Buffer overrun detected before free.");
-    
+    check_memory_guards(&target, "Buffer overrun detected before free.", "Buffer underrun detected before free.");
+    profile_free(target.file, target.line, (size_t)target.size);
+    if (target.flags & DEBUG_MEMORY_FLAG_SAMPLED)
+        remove_memory_sample(address);
 
-    // Remove the allocation from the list and free it.
-    remove_allocation_from_list(target);
-    free(target);
-    free(address);
+    // Hold the block back poisoned when the quarantine is enabled, so writes through stale pointers are caught.
+    if (!quarantine_memory_block(&target))
+        free_block(&target);
 }
 
 
+/**
+ * @brief Helper function to log a single leaked block.
+ * 
+ * @param allocation The record of the leaked block.
+ */
+static void report_memory_leak(const MemoryAllocation * allocation) {
+    LOG_CONSOLE_ERRORF("Memory leak detected at %s:%d. %d bytes were allocated at %p.", 
+        allocation->file, allocation->line, allocation->size, allocation->address);
+}
+
 void report_memory_leaks(void) {
-    MemoryAllocation * allocation = head_allocation;
-    while (allocation) {
-        char error_buffer[1024];
-        snprintf(error_buffer, sizeof(error_buffer), 
-            "Memory leak detected at %s:%d. %d bytes were allocated at %p.", 
-            allocation->file, allocation->line, allocation->size, allocation->address);
-        LOG_CONSOLE_ERROR(error_buffer);
-        allocation = allocation->next;
-    }
-}
\ No newline at end of file
+    // Merge every shard, each one is locked only while it is being walked.
+    for (size_t shard_index = 0; shard_index < DEBUG_MEMORY_SHARD_COUNT; shard_index++) {
+        MemoryAllocationShard * shard = get_allocation_shard((uint64_t)shard_index << (64 - DEBUG_MEMORY_SHARD_BITS));
+        lock_shard(shard);
+#if DEBUG_MEMORY_INLINE_HEADERS
+        for (MemoryAllocation * allocation = shard->head; allocation; allocation = allocation->next)
+            report_memory_leak(allocation);
+#else
+        for (size_t index = 0; index < shard->table.capacity; index++) {
+            if (shard->table.slots[index])
+                report_memory_leak(shard->table.slots[index]);
+        }
+#endif
+        unlock_shard(shard);
+    }
+}
+
+/**
+ * @def DEBUG_MEMORY_COUNTED_HEADER_SIZE
+ * @brief Size of the header counted_malloc keeps in front of a block, a size_t padded to keep 16-byte alignment.
+ */
+#define DEBUG_MEMORY_COUNTED_HEADER_SIZE 16
+
+static atomic_uint_least64_t memory_counted_allocations;
+static atomic_uint_least64_t memory_counted_frees;
+static atomic_uint_least64_t memory_counted_live_bytes;
+static atomic_uint_least64_t memory_counted_peak_live_bytes;
+
+/**
+ * @brief Helper function to count a new block and raise the peak if needed.
+ * 
+ * @param size The size of the block.
+ */
+static inline void count_allocation(size_t size) {
+    atomic_fetch_add_explicit(&memory_counted_allocations, 1, memory_order_relaxed);
+    uint64_t live = atomic_fetch_add_explicit(&memory_counted_live_bytes, size, memory_order_relaxed) + size;
+    uint64_t peak = atomic_load_explicit(&memory_counted_peak_live_bytes, memory_order_relaxed);
+    while (live > peak && !atomic_compare_exchange_weak_explicit(&memory_counted_peak_live_bytes, &peak, live, memory_order_relaxed, memory_order_relaxed))
+        ;
+}
+
+void * counted_malloc(size_t size) {
+    uint8_t * block = (uint8_t *)malloc(DEBUG_MEMORY_COUNTED_HEADER_SIZE + size);
+    if (!block)
+        return NULL;
+    *(size_t *)block = size;
+    count_allocation(size);
+    return block + DEBUG_MEMORY_COUNTED_HEADER_SIZE;
+}
+
+void * counted_realloc(void * address, size_t size) {
+    if (!address)
+        return counted_malloc(size);
+
+    uint8_t * block = (uint8_t *)address - DEBUG_MEMORY_COUNTED_HEADER_SIZE;
+    size_t old_size = *(size_t *)block;
+    block = (uint8_t *)realloc(block, DEBUG_MEMORY_COUNTED_HEADER_SIZE + size);
+    if (!block)
+        return NULL;
+    *(size_t *)block = size;
+    atomic_fetch_add_explicit(&memory_counted_frees, 1, memory_order_relaxed);
+    atomic_fetch_sub_explicit(&memory_counted_live_bytes, old_size, memory_order_relaxed);
+    count_allocation(size);
+    return block + DEBUG_MEMORY_COUNTED_HEADER_SIZE;
+}
+
+void * counted_calloc(size_t count, size_t size) {
+    void * address = counted_malloc(count * size);
+    if (address)
+        memset(address, 0, count * size);
+    return address;
+}
+
+void counted_free(void * address) {
+    if (!address)
+        return;
+    uint8_t * block = (uint8_t *)address - DEBUG_MEMORY_COUNTED_HEADER_SIZE;
+    atomic_fetch_add_explicit(&memory_counted_frees, 1, memory_order_relaxed);
+    atomic_fetch_sub_explicit(&memory_counted_live_bytes, *(size_t *)block, memory_order_relaxed);
+    free(block);
+}
+
+void get_memory_counters(MemoryCounters * counters) {
+    counters->allocation_count = atomic_load_explicit(&memory_counted_allocations, memory_order_relaxed);
+    counters->free_count = atomic_load_explicit(&memory_counted_frees, memory_order_relaxed);
+    counters->live_bytes = atomic_load_explicit(&memory_counted_live_bytes, memory_order_relaxed);
+    counters->peak_live_bytes = atomic_load_explicit(&memory_counted_peak_live_bytes, memory_order_relaxed);
+}
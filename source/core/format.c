@@ -0,0 +1,473 @@
+#include "core/format.h"
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <wchar.h>
+
+#define FORMAT_MAX_FAST_PRECISION 9
+#define FORMAT_MAX_FAST_SCALED 9007199254740992.0   /* 2^53, the scaled value and its rounding stay exact below it. */
+#define FORMAT_MAX_SPECIFICATION 48
+
+/**
+ * @brief Length modifier of a conversion.
+ */
+typedef enum format_length {
+    FORMAT_LENGTH_NONE,
+    FORMAT_LENGTH_CHAR,         /**< hh */
+    FORMAT_LENGTH_SHORT,        /**< h */
+    FORMAT_LENGTH_LONG,         /**< l */
+    FORMAT_LENGTH_LONG_LONG,    /**< ll */
+    FORMAT_LENGTH_SIZE,         /**< z */
+    FORMAT_LENGTH_INTMAX,       /**< j */
+    FORMAT_LENGTH_PTRDIFF,      /**< t */
+    FORMAT_LENGTH_LONG_DOUBLE   /**< L */
+} FORMAT_LENGTH;
+
+/**
+ * @brief One parsed conversion specification, '*' widths and precisions already read.
+ */
+typedef struct FormatSpecification {
+    bool left;                  /** '-', pad on the right. */
+    bool plus;                  /** '+', always print a sign. */
+    bool space;                 /** ' ', print a space for positive values. */
+    bool alternate;             /** '#', alternate form. */
+    bool zero;                  /** '0', pad with zeros. */
+    int width;                  /** Minimum field width, 0 for none. */
+    int precision;              /** Precision, -1 for none. */
+    FORMAT_LENGTH length;       /** Length modifier. */
+    char conversion;            /** Conversion character. */
+} FormatSpecification;
+
+/**
+ * @brief Where formatted text goes.
+ */
+typedef struct FormatOutput {
+    char * buffer;              /** Output, NULL when the capacity is 0. */
+    size_t room;                /** Characters that fit before the terminator. */
+    size_t length;              /** Length of the whole text so far, written or not. */
+} FormatOutput;
+
+static const char FORMAT_DIGIT_PAIRS[] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839404142434445464748495051525354555657585960616263646566676869707172737475767778798081828384858687888990919293949596979899";
+
+static const double FORMAT_POWERS_OF_TEN[FORMAT_MAX_FAST_PRECISION + 1] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9
+};
+
+static const uint64_t FORMAT_INTEGER_POWERS_OF_TEN[FORMAT_MAX_FAST_PRECISION + 1] = {
+    1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL, 100000000ULL, 1000000000ULL
+};
+
+/**
+ * @brief Helper function to append bytes, counting the ones that do not fit.
+ */
+static inline void write_format_bytes(FormatOutput * output, const char * bytes, size_t count) {
+    if (output->length < output->room) {
+        size_t fit = output->room - output->length;
+        memcpy(output->buffer + output->length, bytes, count < fit ? count : fit);
+    }
+    output->length += count;
+}
+
+/**
+ * @brief Helper function to append a character several times, counting the ones that do not fit.
+ */
+static inline void write_format_repeat(FormatOutput * output, char character, size_t count) {
+    if (output->length < output->room) {
+        size_t fit = output->room - output->length;
+        memset(output->buffer + output->length, character, count < fit ? count : fit);
+    }
+    output->length += count;
+}
+
+/**
+ * @brief Helper function to write a field made of a prefix, leading zeros and a body, padded to the width.
+ *
+ * @param output The output.
+ * @param specification The conversion, for its width and flags.
+ * @param prefix Sign or radix prefix.
+ * @param prefix_length Length of prefix.
+ * @param zeros Zeros required between the prefix and body, from the precision.
+ * @param body The digits or characters.
+ * @param body_length Length of body.
+ * @param zero_pad true if the '0' flag applies to this conversion.
+ */
+static void write_format_field(FormatOutput * output, const FormatSpecification * specification, const char * prefix, size_t prefix_length, size_t zeros, const char * body, size_t body_length, bool zero_pad) {
+    size_t total = prefix_length + zeros + body_length;
+    size_t padding = (size_t)specification->width > total ? (size_t)specification->width - total : 0;
+    if (specification->left) {
+        write_format_bytes(output, prefix, prefix_length);
+        write_format_repeat(output, '0', zeros);
+        write_format_bytes(output, body, body_length);
+        write_format_repeat(output, ' ', padding);
+    } else if (zero_pad) {
+        write_format_bytes(output, prefix, prefix_length);
+        write_format_repeat(output, '0', zeros + padding);
+        write_format_bytes(output, body, body_length);
+    } else {
+        write_format_repeat(output, ' ', padding);
+        write_format_bytes(output, prefix, prefix_length);
+        write_format_repeat(output, '0', zeros);
+        write_format_bytes(output, body, body_length);
+    }
+}
+
+/**
+ * @brief Helper function to write decimal digits ending at end, two at a time.
+ *
+ * @return char * The first digit.
+ */
+static inline char * write_decimal_digits(char * end, uint64_t value) {
+    char * cursor = end;
+    while (value >= 100) {
+        uint64_t pair = value % 100;
+        value /= 100;
+        cursor -= 2;
+        memcpy(cursor, &FORMAT_DIGIT_PAIRS[pair * 2], 2);
+    }
+    if (value >= 10) {
+        cursor -= 2;
+        memcpy(cursor, &FORMAT_DIGIT_PAIRS[value * 2], 2);
+    } else {
+        *--cursor = (char)('0' + value);
+    }
+    return cursor;
+}
+
+/**
+ * @brief Helper function to write an integer conversion, d, i, u, x, X or o.
+ *
+ * @param output The output.
+ * @param specification The conversion.
+ * @param value The magnitude of the value.
+ * @param negative true if the value is negative.
+ */
+static void write_format_integer(FormatOutput * output, const FormatSpecification * specification, uint64_t value, bool negative) {
+    static const char LOWER_DIGITS[] = "0123456789abcdef";
+    static const char UPPER_DIGITS[] = "0123456789ABCDEF";
+    char digits[24];
+    char * end = digits + sizeof(digits);
+    char * cursor = end;
+    char prefix[2];
+    size_t prefix_length = 0;
+    char conversion = specification->conversion;
+
+    if (conversion == 'x' || conversion == 'X') {
+        const char * table = conversion == 'x' ? LOWER_DIGITS : UPPER_DIGITS;
+        uint64_t remaining = value;
+        do {
+            *--cursor = table[remaining & 0xF];
+            remaining >>= 4;
+        } while (remaining);
+        if (specification->alternate && value) {
+            prefix[prefix_length++] = '0';
+            prefix[prefix_length++] = conversion;
+        }
+    } else if (conversion == 'o') {
+        uint64_t remaining = value;
+        do {
+            *--cursor = (char)('0' + (remaining & 7));
+            remaining >>= 3;
+        } while (remaining);
+    } else {
+        cursor = write_decimal_digits(end, value);
+        if (negative)
+            prefix[prefix_length++] = '-';
+        else if (specification->plus && conversion != 'u')
+            prefix[prefix_length++] = '+';
+        else if (specification->space && conversion != 'u')
+            prefix[prefix_length++] = ' ';
+    }
+
+    size_t digit_count = (size_t)(end - cursor);
+    if (specification->precision == 0 && value == 0)
+        digit_count = 0;
+    size_t zeros = specification->precision > 0 && (size_t)specification->precision > digit_count ? (size_t)specification->precision - digit_count : 0;
+    // The alternate octal form starts with a 0, it may already come from the precision.
+    if (conversion == 'o' && specification->alternate && zeros == 0 && (digit_count == 0 || *cursor != '0'))
+        zeros = 1;
+    write_format_field(output, specification, prefix, prefix_length, zeros, end - digit_count, digit_count, specification->zero && specification->precision < 0);
+}
+
+/**
+ * @brief Helper function to write %f without libc.
+ *
+ * @param output The output.
+ * @param specification The conversion.
+ * @param value The value.
+ * @return true if it was written,
+ * @return false if the value or precision is outside the fast path, nothing was written.
+ */
+static bool write_format_fixed(FormatOutput * output, const FormatSpecification * specification, double value) {
+    int precision = specification->precision < 0 ? 6 : specification->precision;
+    if (!isfinite(value) || precision > FORMAT_MAX_FAST_PRECISION)
+        return false;
+    double magnitude = fabs(value);
+    double scaled = magnitude * FORMAT_POWERS_OF_TEN[precision];
+    if (scaled >= FORMAT_MAX_FAST_SCALED)
+        return false;
+    double whole = floor(scaled);
+    double fraction = scaled - whole;
+    // The product is off by up to half an ulp, too close to a tie to know which way printf rounds.
+    if (fabs(fraction - 0.5) <= scaled * 2.3e-16)
+        return false;
+
+    uint64_t rounded = (uint64_t)whole + (fraction > 0.5);
+    uint64_t integer = rounded / FORMAT_INTEGER_POWERS_OF_TEN[precision];
+    uint64_t decimals = rounded % FORMAT_INTEGER_POWERS_OF_TEN[precision];
+    char digits[40];
+    char * end = digits + sizeof(digits);
+    char * cursor = end;
+    for (int index = 0; index < precision; index++) {
+        *--cursor = (char)('0' + decimals % 10);
+        decimals /= 10;
+    }
+    if (precision > 0 || specification->alternate)
+        *--cursor = '.';
+    cursor = write_decimal_digits(cursor, integer);
+
+    char prefix[1];
+    size_t prefix_length = 0;
+    if (signbit(value))
+        prefix[prefix_length++] = '-';
+    else if (specification->plus)
+        prefix[prefix_length++] = '+';
+    else if (specification->space)
+        prefix[prefix_length++] = ' ';
+    write_format_field(output, specification, prefix, prefix_length, 0, cursor, (size_t)(end - cursor), specification->zero);
+    return true;
+}
+
+/**
+ * @brief Helper function to rebuild a conversion specification for snprintf, with '*' replaced by the values read.
+ *
+ * @param specification The conversion.
+ * @param text Receives the terminated specification, FORMAT_MAX_SPECIFICATION bytes.
+ */
+static void build_format_specification(const FormatSpecification * specification, char * text) {
+    static const char * LENGTHS[] = { "", "hh", "h", "l", "ll", "z", "j", "t", "L" };
+    char * cursor = text;
+    *cursor++ = '%';
+    if (specification->left) *cursor++ = '-';
+    if (specification->plus) *cursor++ = '+';
+    if (specification->space) *cursor++ = ' ';
+    if (specification->alternate) *cursor++ = '#';
+    if (specification->zero) *cursor++ = '0';
+    if (specification->width > 0)
+        cursor += snprintf(cursor, 12, "%d", specification->width);
+    if (specification->precision >= 0)
+        cursor += snprintf(cursor, 13, ".%d", specification->precision);
+    const char * length = LENGTHS[specification->length];
+    while (*length)
+        *cursor++ = *length++;
+    *cursor++ = specification->conversion;
+    *cursor = '\0';
+}
+
+/**
+ * @brief Helper function to get the output space for snprintf at the current position.
+ *
+ * @return size_t The size to pass to snprintf, terminator included, 0 if nothing fits.
+ */
+static inline size_t get_format_fallback_size(const FormatOutput * output) {
+    return output->buffer && output->length <= output->room ? output->room - output->length + 1 : 0;
+}
+
+/**
+ * @brief Helper function to hand one conversion to snprintf, writing in place.
+ */
+#define WRITE_FORMAT_FALLBACK(output, specification, value) do { \
+        char fallback_specification[FORMAT_MAX_SPECIFICATION]; \
+        build_format_specification((specification), fallback_specification); \
+        size_t fallback_size = get_format_fallback_size(output); \
+        int fallback_written = snprintf(fallback_size ? (output)->buffer + (output)->length : NULL, fallback_size, fallback_specification, (value)); \
+        if (fallback_written > 0) \
+            (output)->length += (size_t)fallback_written; \
+    } while (0)
+
+size_t format_string_va(char * buffer, size_t capacity, const char * format, va_list arguments) {
+    FormatOutput output = { capacity ? buffer : NULL, capacity ? capacity - 1 : 0, 0 };
+    va_list list;
+    va_copy(list, arguments);
+
+    const char * cursor = format;
+    for (;;) {
+        const char * percent = strchr(cursor, '%');
+        if (!percent) {
+            write_format_bytes(&output, cursor, strlen(cursor));
+            break;
+        }
+        write_format_bytes(&output, cursor, (size_t)(percent - cursor));
+        const char * start = percent;
+        cursor = percent + 1;
+
+        FormatSpecification specification = { 0 };
+        specification.precision = -1;
+        for (;; cursor++) {
+            if (*cursor == '-') specification.left = true;
+            else if (*cursor == '+') specification.plus = true;
+            else if (*cursor == ' ') specification.space = true;
+            else if (*cursor == '#') specification.alternate = true;
+            else if (*cursor == '0') specification.zero = true;
+            else if (*cursor != '\'') break;
+        }
+        if (*cursor == '*') {
+            specification.width = va_arg(list, int);
+            if (specification.width < 0) {
+                specification.left = true;
+                specification.width = -specification.width;
+            }
+            cursor++;
+        } else {
+            while (*cursor >= '0' && *cursor <= '9')
+                specification.width = specification.width * 10 + (*cursor++ - '0');
+        }
+        if (*cursor == '.') {
+            cursor++;
+            specification.precision = 0;
+            if (*cursor == '*') {
+                specification.precision = va_arg(list, int);
+                if (specification.precision < 0)
+                    specification.precision = -1;
+                cursor++;
+            } else {
+                while (*cursor >= '0' && *cursor <= '9')
+                    specification.precision = specification.precision * 10 + (*cursor++ - '0');
+            }
+        }
+        switch (*cursor) {
+            case 'h': cursor++; specification.length = *cursor == 'h' ? (cursor++, FORMAT_LENGTH_CHAR) : FORMAT_LENGTH_SHORT; break;
+            case 'l': cursor++; specification.length = *cursor == 'l' ? (cursor++, FORMAT_LENGTH_LONG_LONG) : FORMAT_LENGTH_LONG; break;
+            case 'z': cursor++; specification.length = FORMAT_LENGTH_SIZE; break;
+            case 'j': cursor++; specification.length = FORMAT_LENGTH_INTMAX; break;
+            case 't': cursor++; specification.length = FORMAT_LENGTH_PTRDIFF; break;
+            case 'L': cursor++; specification.length = FORMAT_LENGTH_LONG_DOUBLE; break;
+            default: break;
+        }
+        specification.conversion = *cursor;
+        if (!*cursor) {
+            // A lone '%' at the end is printed as written.
+            write_format_bytes(&output, start, (size_t)(cursor - start));
+            break;
+        }
+        cursor++;
+
+        switch (specification.conversion) {
+            case '%':
+                write_format_bytes(&output, "%", 1);
+                break;
+            case 'd':
+            case 'i': {
+                long long value;
+                switch (specification.length) {
+                    case FORMAT_LENGTH_CHAR:      value = (signed char)va_arg(list, int); break;
+                    case FORMAT_LENGTH_SHORT:     value = (short)va_arg(list, int); break;
+                    case FORMAT_LENGTH_LONG:      value = va_arg(list, long); break;
+                    case FORMAT_LENGTH_LONG_LONG: value = va_arg(list, long long); break;
+                    case FORMAT_LENGTH_SIZE:
+                    case FORMAT_LENGTH_PTRDIFF:   value = va_arg(list, ptrdiff_t); break;
+                    case FORMAT_LENGTH_INTMAX:    value = va_arg(list, intmax_t); break;
+                    default:                      value = va_arg(list, int); break;
+                }
+                bool negative = value < 0;
+                write_format_integer(&output, &specification, negative ? 0 - (uint64_t)value : (uint64_t)value, negative);
+                break;
+            }
+            case 'u':
+            case 'x':
+            case 'X':
+            case 'o': {
+                unsigned long long value;
+                switch (specification.length) {
+                    case FORMAT_LENGTH_CHAR:      value = (unsigned char)va_arg(list, unsigned int); break;
+                    case FORMAT_LENGTH_SHORT:     value = (unsigned short)va_arg(list, unsigned int); break;
+                    case FORMAT_LENGTH_LONG:      value = va_arg(list, unsigned long); break;
+                    case FORMAT_LENGTH_LONG_LONG: value = va_arg(list, unsigned long long); break;
+                    case FORMAT_LENGTH_SIZE:
+                    case FORMAT_LENGTH_PTRDIFF:   value = va_arg(list, size_t); break;
+                    case FORMAT_LENGTH_INTMAX:    value = va_arg(list, uintmax_t); break;
+                    default:                      value = va_arg(list, unsigned int); break;
+                }
+                write_format_integer(&output, &specification, value, false);
+                break;
+            }
+            case 'p': {
+                void * pointer = va_arg(list, void *);
+                if (!pointer) {
+                    write_format_field(&output, &specification, "", 0, 0, "(nil)", 5, false);
+                    break;
+                }
+                specification.conversion = 'x';
+                specification.alternate = true;
+                write_format_integer(&output, &specification, (uintptr_t)pointer, false);
+                break;
+            }
+            case 'c':
+                if (specification.length == FORMAT_LENGTH_LONG) {
+                    WRITE_FORMAT_FALLBACK(&output, &specification, va_arg(list, wint_t));
+                } else {
+                    char character = (char)va_arg(list, int);
+                    write_format_field(&output, &specification, "", 0, 0, &character, 1, false);
+                }
+                break;
+            case 's': {
+                if (specification.length == FORMAT_LENGTH_LONG) {
+                    WRITE_FORMAT_FALLBACK(&output, &specification, va_arg(list, const wchar_t *));
+                    break;
+                }
+                const char * string = va_arg(list, const char *);
+                if (!string)
+                    string = "(null)";
+                size_t length;
+                if (specification.precision >= 0) {
+                    const char * terminator = (const char *)memchr(string, '\0', (size_t)specification.precision);
+                    length = terminator ? (size_t)(terminator - string) : (size_t)specification.precision;
+                } else {
+                    length = strlen(string);
+                }
+                write_format_field(&output, &specification, "", 0, 0, string, length, false);
+                break;
+            }
+            case 'f':
+            case 'F':
+            case 'e':
+            case 'E':
+            case 'g':
+            case 'G':
+            case 'a':
+            case 'A': {
+                if (specification.length == FORMAT_LENGTH_LONG_DOUBLE) {
+                    WRITE_FORMAT_FALLBACK(&output, &specification, va_arg(list, long double));
+                    break;
+                }
+                double value = va_arg(list, double);
+                if ((specification.conversion == 'f' || specification.conversion == 'F') && write_format_fixed(&output, &specification, value))
+                    break;
+                WRITE_FORMAT_FALLBACK(&output, &specification, value);
+                break;
+            }
+            case 'n':
+                (void)va_arg(list, void *);
+                break;
+            default:
+                // Unknown conversions are printed as written.
+                write_format_bytes(&output, start, (size_t)(cursor - start));
+                break;
+        }
+    }
+    va_end(list);
+
+    if (capacity)
+        buffer[output.length < output.room ? output.length : output.room] = '\0';
+    return output.length;
+}
+
+size_t format_string(char * buffer, size_t capacity, const char * format, ...) {
+    va_list arguments;
+    va_start(arguments, format);
+    size_t length = format_string_va(buffer, capacity, format, arguments);
+    va_end(arguments);
+    return length;
+}
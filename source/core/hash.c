@@ -0,0 +1,387 @@
+#include "core/hash.h"
+#include "core/context.h"
+#include <stdatomic.h>
+#include <string.h>
+
+#if ARCH_X64
+    #include <immintrin.h>
+#elif ARCH_ARM64
+    #include <arm_neon.h>
+#endif
+
+#if COMPILER_CL
+    #include <intrin.h>
+    #define HASH_TARGET_AVX2
+#else
+    #define HASH_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+#define HASH_BLOCK_STRIPES (HASH_BLOCK_BYTES / HASH_STRIPE_BYTES)
+#define HASH_SECRET_SCRAMBLE 23         /** Secret words of the scramble, after the 23 the stripes of a block use. */
+#define HASH_SECRET_LAST_STRIPE 31      /** Secret words of the last stripe. */
+#define HASH_SECRET_MERGE 39            /** Secret words of the merge of the lanes. */
+#define HASH_SECRET_LANES 47            /** Secret words the lanes start from. */
+#define HASH_GOLDEN 0x9E3779B97F4A7C15ULL
+#define HASH_SCRAMBLE_PRIME 0x9E3779B1ULL
+
+/**
+ * Random words mixed into the input, so that zeros in the data do not zero the products.
+ * Stripe s of a block uses words s to s + 7, the other ranges are named above.
+ */
+static const uint64_t HASH_SECRET[56] = {
+    0x94b5e598df81a449ULL, 0xabac6da53e5dd491ULL, 0x6b9dbb2ad109881aULL, 0x296cab76c5a9947bULL,
+    0x67970885b3d7a916ULL, 0x1289b474c6c814e0ULL, 0xc8015f692d23eb7fULL, 0x6a0fed08e1fafa0cULL,
+    0x9f9bbafea78e1a91ULL, 0xf405f1b46529f0a0ULL, 0x1abb77b17d45b646ULL, 0x4d9ebc0299fca031ULL,
+    0x119ce7492662214fULL, 0x1bc47b29dcf2f00bULL, 0x221440e90a369ab0ULL, 0xcb8ab970b937c303ULL,
+    0xd9d5838e8c5ddf65ULL, 0x90f325cb6911169eULL, 0x5d1f395477236f73ULL, 0xbf19a8bd62fe27d0ULL,
+    0xb8cc644dcb3132bdULL, 0x7bdf4ad651449413ULL, 0x90d6847cb03e04d5ULL, 0x410c74e825837d07ULL,
+    0xb059e3252d20bdefULL, 0x38c6086f8700d41eULL, 0xb8b93161513750ccULL, 0xf80f41276f3454a0ULL,
+    0xe4a2b4d8a88dffc4ULL, 0xa9f10ddc706f8029ULL, 0x73f4ae76ccb45090ULL, 0x5417d10d4960f691ULL,
+    0x0fc3178d0039e16cULL, 0xc54d5bd9a3d6fb7fULL, 0x6d191abde04c3343ULL, 0xc8c173305641d596ULL,
+    0xf7a6c991986dea8bULL, 0x0fade8dc2aa2cdfcULL, 0xabb41b38fd265fa4ULL, 0xe82cf1f33c051498ULL,
+    0x3e986b1292f4e6f0ULL, 0x86cdc44da646153bULL, 0x4d013425787f97c9ULL, 0x862bd532adf39cdcULL,
+    0x846ed074384d59f8ULL, 0xe853a584a7a84394ULL, 0x6581953aa363746aULL, 0x938b0fb9a4a4144dULL,
+    0xc2aae60b6902a0bbULL, 0x995d1e6ab17dd2d3ULL, 0x9197b81b90cfe6cdULL, 0x009ab75a4f0942b8ULL,
+    0xb36de97945671d30ULL, 0x50e54efa95dbffc2ULL, 0xa9388c1cbc069d26ULL, 0x4f6bb474a381241fULL
+};
+
+/** Multipliers of the short path, those of wyhash. */
+static const uint64_t HASH_SHORT_SECRET[4] = {
+    0xa0761d6478bd642fULL, 0xe7037ed1a0b428dbULL, 0x8ebc6af09c88c6e3ULL, 0x589965cc75374cc3ULL
+};
+
+typedef void (*HashStripesFunction)(uint64_t lanes[8], const unsigned char * data, size_t stripes, const uint64_t * secret);
+
+static void select_hash_stripes(uint64_t lanes[8], const unsigned char * data, size_t stripes, const uint64_t * secret);
+
+static _Atomic(HashStripesFunction) hash_stripes_function = select_hash_stripes;
+static atomic_int hash_simd_in_use = -1;
+
+/**
+ * @brief Helper function to read 8 bytes at any alignment.
+ */
+static inline uint64_t read_hash_u64(const unsigned char * data) {
+    uint64_t value;
+    memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+/**
+ * @brief Helper function to read 4 bytes at any alignment.
+ */
+static inline uint64_t read_hash_u32(const unsigned char * data) {
+    uint32_t value;
+    memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+/**
+ * @brief Helper function to multiply two words to 128 bits, setting them to its low and high halves.
+ */
+static inline void multiply_hash_words(uint64_t * one, uint64_t * two) {
+#if COMPILER_CL
+    uint64_t low = *one * *two;
+    *two = __umulh(*one, *two);
+    *one = low;
+#else
+    __uint128_t product = (__uint128_t)*one * *two;
+    *one = (uint64_t)product;
+    *two = (uint64_t)(product >> 64);
+#endif
+}
+
+/**
+ * @brief Helper function to fold the 128-bit product of two words to 64 bits.
+ */
+static inline uint64_t mix_hash_words(uint64_t one, uint64_t two) {
+    multiply_hash_words(&one, &two);
+    return one ^ two;
+}
+
+/**
+ * @brief Helper function to hash up to HASH_SHORT_BYTES, 16 bytes per 128-bit multiply.
+ */
+static uint64_t hash_short_bytes(const unsigned char * data, size_t length, uint64_t seed) {
+    const uint64_t * secret = HASH_SHORT_SECRET;
+    uint64_t one = 0;
+    uint64_t two = 0;
+    seed ^= mix_hash_words(seed ^ secret[0], secret[1]);
+    if (length <= 16) {
+        if (length >= 4) {
+            // Two reads from each end, overlapping when there are fewer than 8 bytes.
+            size_t middle = (length >> 3) << 2;
+            one = (read_hash_u32(data) << 32) | read_hash_u32(data + middle);
+            two = (read_hash_u32(data + length - 4) << 32) | read_hash_u32(data + length - 4 - middle);
+        } else if (length > 0) {
+            one = ((uint64_t)data[0] << 16) | ((uint64_t)data[length >> 1] << 8) | data[length - 1];
+        }
+    } else {
+        size_t remaining = length;
+        if (remaining > 48) {
+            uint64_t lane_one = seed;
+            uint64_t lane_two = seed;
+            do {
+                seed = mix_hash_words(read_hash_u64(data) ^ secret[1], read_hash_u64(data + 8) ^ seed);
+                lane_one = mix_hash_words(read_hash_u64(data + 16) ^ secret[2], read_hash_u64(data + 24) ^ lane_one);
+                lane_two = mix_hash_words(read_hash_u64(data + 32) ^ secret[3], read_hash_u64(data + 40) ^ lane_two);
+                data += 48;
+                remaining -= 48;
+            } while (remaining > 48);
+            seed ^= lane_one ^ lane_two;
+        }
+        while (remaining > 16) {
+            seed = mix_hash_words(read_hash_u64(data) ^ secret[1], read_hash_u64(data + 8) ^ seed);
+            data += 16;
+            remaining -= 16;
+        }
+        // The last 16 bytes, overlapping the ones already mixed.
+        one = read_hash_u64(data + remaining - 16);
+        two = read_hash_u64(data + remaining - 8);
+    }
+    one ^= secret[1];
+    two ^= seed;
+    multiply_hash_words(&one, &two);
+    return mix_hash_words(one ^ secret[0] ^ length, two ^ secret[1]);
+}
+
+/**
+ * Each lane takes the product of the low and high halves of its input word mixed with the secret,
+ * and the plain word of its neighbour, so no input bit is lost when a product is zero.
+ */
+static void hash_stripes_scalar(uint64_t lanes[8], const unsigned char * data, size_t stripes, const uint64_t * secret) {
+    for (size_t stripe = 0; stripe < stripes; stripe++, data += HASH_STRIPE_BYTES) {
+        for (int lane = 0; lane < 8; lane++) {
+            uint64_t word = read_hash_u64(data + lane * 8);
+            uint64_t key = word ^ secret[stripe + lane];
+            lanes[lane ^ 1] += word;
+            lanes[lane] += (key & 0xffffffff) * (key >> 32);
+        }
+    }
+}
+
+#if ARCH_X64
+static void hash_stripes_sse2(uint64_t lanes[8], const unsigned char * data, size_t stripes, const uint64_t * secret) {
+    __m128i accumulators[4];
+    for (int pair = 0; pair < 4; pair++)
+        accumulators[pair] = _mm_loadu_si128((const __m128i *)lanes + pair);
+    for (size_t stripe = 0; stripe < stripes; stripe++, data += HASH_STRIPE_BYTES) {
+        for (int pair = 0; pair < 4; pair++) {
+            __m128i words = _mm_loadu_si128((const __m128i *)data + pair);
+            __m128i keys = _mm_xor_si128(words, _mm_loadu_si128((const __m128i *)(secret + stripe + pair * 2)));
+            __m128i products = _mm_mul_epu32(keys, _mm_srli_epi64(keys, 32));
+            __m128i swapped = _mm_shuffle_epi32(words, _MM_SHUFFLE(1, 0, 3, 2));
+            accumulators[pair] = _mm_add_epi64(accumulators[pair], _mm_add_epi64(products, swapped));
+        }
+    }
+    for (int pair = 0; pair < 4; pair++)
+        _mm_storeu_si128((__m128i *)lanes + pair, accumulators[pair]);
+}
+
+static HASH_TARGET_AVX2 void hash_stripes_avx2(uint64_t lanes[8], const unsigned char * data, size_t stripes, const uint64_t * secret) {
+    __m256i low = _mm256_loadu_si256((const __m256i *)lanes);
+    __m256i high = _mm256_loadu_si256((const __m256i *)lanes + 1);
+    for (size_t stripe = 0; stripe < stripes; stripe++, data += HASH_STRIPE_BYTES) {
+        __m256i words_low = _mm256_loadu_si256((const __m256i *)data);
+        __m256i words_high = _mm256_loadu_si256((const __m256i *)data + 1);
+        __m256i keys_low = _mm256_xor_si256(words_low, _mm256_loadu_si256((const __m256i *)(secret + stripe)));
+        __m256i keys_high = _mm256_xor_si256(words_high, _mm256_loadu_si256((const __m256i *)(secret + stripe + 4)));
+        // The shuffle swaps the words within each 128-bit half, lane ^ 1.
+        low = _mm256_add_epi64(low, _mm256_add_epi64(_mm256_mul_epu32(keys_low, _mm256_srli_epi64(keys_low, 32)), _mm256_shuffle_epi32(words_low, _MM_SHUFFLE(1, 0, 3, 2))));
+        high = _mm256_add_epi64(high, _mm256_add_epi64(_mm256_mul_epu32(keys_high, _mm256_srli_epi64(keys_high, 32)), _mm256_shuffle_epi32(words_high, _MM_SHUFFLE(1, 0, 3, 2))));
+    }
+    _mm256_storeu_si256((__m256i *)lanes, low);
+    _mm256_storeu_si256((__m256i *)lanes + 1, high);
+}
+#endif
+
+#if ARCH_ARM64
+static void hash_stripes_neon(uint64_t lanes[8], const unsigned char * data, size_t stripes, const uint64_t * secret) {
+    uint64x2_t accumulators[4];
+    for (int pair = 0; pair < 4; pair++)
+        accumulators[pair] = vld1q_u64(lanes + pair * 2);
+    for (size_t stripe = 0; stripe < stripes; stripe++, data += HASH_STRIPE_BYTES) {
+        for (int pair = 0; pair < 4; pair++) {
+            uint64x2_t words = vreinterpretq_u64_u8(vld1q_u8(data + pair * 16));
+            uint64x2_t keys = veorq_u64(words, vld1q_u64(secret + stripe + pair * 2));
+            uint64x2_t products = vmull_u32(vmovn_u64(keys), vshrn_n_u64(keys, 32));
+            accumulators[pair] = vaddq_u64(accumulators[pair], vaddq_u64(products, vextq_u64(words, words, 1)));
+        }
+    }
+    for (int pair = 0; pair < 4; pair++)
+        vst1q_u64(lanes + pair * 2, accumulators[pair]);
+}
+#endif
+
+/**
+ * @brief Helper function to scramble the lanes after a block, so the sums of blocks do not cancel.
+ */
+static inline void scramble_hash_lanes(uint64_t lanes[8]) {
+    for (int lane = 0; lane < 8; lane++) {
+        uint64_t value = lanes[lane];
+        value ^= value >> 47;
+        value ^= HASH_SECRET[HASH_SECRET_SCRAMBLE + lane];
+        lanes[lane] = value * HASH_SCRAMBLE_PRIME;
+    }
+}
+
+/**
+ * @brief Helper function to set the lanes a long hash starts from.
+ */
+static inline void init_hash_lanes(uint64_t lanes[8], uint64_t seed) {
+    for (int lane = 0; lane < 8; lane++)
+        lanes[lane] = HASH_SECRET[HASH_SECRET_LANES + lane] ^ seed;
+}
+
+/**
+ * @brief Helper function to run the stripes of whole blocks through the lanes.
+ */
+static inline void hash_long_blocks(uint64_t lanes[8], const unsigned char * data, size_t blocks) {
+    HashStripesFunction stripes = atomic_load_explicit(&hash_stripes_function, memory_order_relaxed);
+    for (size_t block = 0; block < blocks; block++, data += HASH_BLOCK_BYTES) {
+        stripes(lanes, data, HASH_BLOCK_STRIPES, HASH_SECRET);
+        scramble_hash_lanes(lanes);
+    }
+}
+
+/**
+ * @brief Helper function to finish a long hash, from the lanes after the whole blocks.
+ *
+ * @param rest The 1 to HASH_BLOCK_BYTES bytes of the last block.
+ * @param last_stripe The last HASH_STRIPE_BYTES bytes of the input, which may begin before rest.
+ */
+static uint64_t finish_long_hash(uint64_t lanes[8], const unsigned char * rest, size_t rest_length, const unsigned char * last_stripe, uint64_t length, uint64_t seed) {
+    HashStripesFunction stripes = atomic_load_explicit(&hash_stripes_function, memory_order_relaxed);
+    stripes(lanes, rest, (rest_length - 1) / HASH_STRIPE_BYTES, HASH_SECRET);
+    stripes(lanes, last_stripe, 1, HASH_SECRET + HASH_SECRET_LAST_STRIPE);
+    uint64_t result = length * HASH_GOLDEN + seed;
+    for (int lane = 0; lane < 8; lane += 2)
+        result += mix_hash_words(lanes[lane] ^ HASH_SECRET[HASH_SECRET_MERGE + lane], lanes[lane + 1] ^ HASH_SECRET[HASH_SECRET_MERGE + lane + 1]);
+    return hash_u64(result);
+}
+
+uint64_t hash_bytes(const void * data, size_t length, uint64_t seed) {
+    const unsigned char * bytes = (const unsigned char *)data;
+    if (length <= HASH_SHORT_BYTES)
+        return hash_short_bytes(bytes, length, seed);
+    uint64_t lanes[8];
+    init_hash_lanes(lanes, seed);
+    // The last block is never empty, it is finished with the last stripe.
+    size_t blocks = (length - 1) / HASH_BLOCK_BYTES;
+    hash_long_blocks(lanes, bytes, blocks);
+    size_t offset = blocks * HASH_BLOCK_BYTES;
+    return finish_long_hash(lanes, bytes + offset, length - offset, bytes + length - HASH_STRIPE_BYTES, length, seed);
+}
+
+uint64_t hash_string(const char * string) {
+    return string ? hash_bytes(string, strlen(string), 0) : hash_bytes(NULL, 0, 0);
+}
+
+void hash_stream_init(HashState * state, uint64_t seed) {
+    init_hash_lanes(state->lanes, seed);
+    state->seed = seed;
+    state->length = 0;
+    state->pending = 0;
+}
+
+void hash_stream_update(HashState * state, const void * data, size_t length) {
+    const unsigned char * bytes = (const unsigned char *)data;
+    unsigned char * block = state->buffer + HASH_STRIPE_BYTES;
+    state->length += length;
+    while (length > 0) {
+        // A full block is hashed only once more bytes arrive, the last one is finished differently.
+        if (state->pending == HASH_BLOCK_BYTES) {
+            hash_long_blocks(state->lanes, block, 1);
+            memcpy(state->buffer, block + HASH_BLOCK_BYTES - HASH_STRIPE_BYTES, HASH_STRIPE_BYTES);
+            state->pending = 0;
+        }
+        if (state->pending == 0 && length > HASH_BLOCK_BYTES) {
+            // Whole blocks followed by more bytes are hashed in place, without a copy.
+            size_t blocks = (length - 1) / HASH_BLOCK_BYTES;
+            hash_long_blocks(state->lanes, bytes, blocks);
+            bytes += blocks * HASH_BLOCK_BYTES;
+            length -= blocks * HASH_BLOCK_BYTES;
+            memcpy(state->buffer, bytes - HASH_STRIPE_BYTES, HASH_STRIPE_BYTES);
+        }
+        size_t count = HASH_BLOCK_BYTES - state->pending;
+        count = count < length ? count : length;
+        memcpy(block + state->pending, bytes, count);
+        state->pending += count;
+        bytes += count;
+        length -= count;
+    }
+}
+
+uint64_t hash_stream_final(const HashState * state) {
+    const unsigned char * block = state->buffer + HASH_STRIPE_BYTES;
+    if (state->length <= HASH_BLOCK_BYTES)
+        return hash_bytes(block, state->pending, state->seed);
+    // The history before the block holds the end of the previous one, the last stripe may begin there.
+    uint64_t lanes[8];
+    memcpy(lanes, state->lanes, sizeof(lanes));
+    return finish_long_hash(lanes, block, state->pending, block + state->pending - HASH_STRIPE_BYTES, state->length, state->seed);
+}
+
+uint64_t hash_fnv1a(const void * data, size_t length) {
+    const unsigned char * bytes = (const unsigned char *)data;
+    uint64_t hash = HASH_FNV_OFFSET;
+    for (size_t index = 0; index < length; index++)
+        hash = (hash ^ bytes[index]) * HASH_FNV_PRIME;
+    return hash;
+}
+
+/**
+ * @brief Helper function to find the best instructions the CPU supports.
+ */
+static STRING_SIMD detect_hash_simd(void) {
+#if ARCH_X64
+    return string_simd_supported(STRING_SIMD_AVX2) ? STRING_SIMD_AVX2 : STRING_SIMD_SSE2;
+#elif ARCH_ARM64
+    return STRING_SIMD_NEON;
+#else
+    return STRING_SIMD_NONE;
+#endif
+}
+
+bool hash_set_simd(STRING_SIMD simd) {
+    HashStripesFunction stripes = hash_stripes_scalar;
+    if (!string_simd_supported(simd))
+        return false;
+    switch (simd) {
+        case STRING_SIMD_NONE:
+            break;
+#if ARCH_X64
+        case STRING_SIMD_SSE2:
+            stripes = hash_stripes_sse2;
+            break;
+        case STRING_SIMD_AVX2:
+            stripes = hash_stripes_avx2;
+            break;
+#elif ARCH_ARM64
+        case STRING_SIMD_NEON:
+            stripes = hash_stripes_neon;
+            break;
+#endif
+        default:
+            return false;
+    }
+    atomic_store_explicit(&hash_stripes_function, stripes, memory_order_relaxed);
+    atomic_store_explicit(&hash_simd_in_use, (int)simd, memory_order_relaxed);
+    return true;
+}
+
+STRING_SIMD hash_simd(void) {
+    int simd = atomic_load_explicit(&hash_simd_in_use, memory_order_relaxed);
+    if (simd < 0) {
+        simd = (int)detect_hash_simd();
+        hash_set_simd((STRING_SIMD)simd);
+    }
+    return (STRING_SIMD)simd;
+}
+
+/**
+ * @brief Helper function to pick the instructions on the first long hash, the function pointer starts here.
+ */
+static void select_hash_stripes(uint64_t lanes[8], const unsigned char * data, size_t stripes, const uint64_t * secret) {
+    hash_simd();
+    atomic_load_explicit(&hash_stripes_function, memory_order_relaxed)(lanes, data, stripes, secret);
+}
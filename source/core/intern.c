@@ -0,0 +1,230 @@
+#include "core/intern.h"
+#include "core/arena.h"
+#include "core/hash.h"
+#include "core/thread.h"
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define INTERN_ARENA_CHUNK_SIZE (64 * 1024)
+#define INTERN_FIRST_SLOTS 256
+#define INTERN_STATIC_PROBES 16
+
+/**
+ * @brief An interned string, found in the directory by its handle.
+ */
+typedef struct InternEntry {
+    const char * string;                /** The bytes in the arena, terminated. */
+    uint32_t length;                    /** Number of bytes, without the terminator. */
+    uint32_t hash;                      /** Hash of the bytes, compared before them and kept to rehash. */
+} InternEntry;
+
+/**
+ * @brief An open-addressing table of handles, at most half full.
+ */
+typedef struct InternTable {
+    struct InternTable * retired;       /** The table this one replaced, kept for readers still probing it. */
+    size_t mask;                        /** Number of slots minus one. */
+    _Atomic(InternHandle) slots[];      /** Handles, INTERN_NONE in free slots. */
+} InternTable;
+
+/**
+ * @brief A remembered address of intern_static.
+ */
+typedef struct InternStaticSlot {
+    _Atomic(const char *) address;      /** The string, NULL while the slot is free. */
+    _Atomic(InternHandle) handle;       /** Its handle, INTERN_NONE until it is written. */
+} InternStaticSlot;
+
+static Once intern_once = ONCE_INITIALIZER;
+static Mutex intern_lock;
+static Arena intern_arena;
+static _Atomic(InternTable *) intern_table;
+static _Atomic(InternEntry *) intern_pages[INTERN_MAX_PAGES];
+static atomic_uint intern_string_count;
+static atomic_size_t intern_bytes;
+static InternStaticSlot intern_static_slots[INTERN_STATIC_SLOTS];
+
+/**
+ * @brief Helper function to set up the lock and the arena, once.
+ */
+static void initialize_intern(void) {
+    mutex_init(&intern_lock);
+    arena_init(&intern_arena, INTERN_ARENA_CHUNK_SIZE);
+}
+
+/**
+ * @brief Helper function to get the entry of a handle, which must have been given out.
+ */
+static inline const InternEntry * get_intern_entry(InternHandle handle) {
+    uint32_t index = handle - 1;
+    return &atomic_load_explicit(&intern_pages[index / INTERN_PAGE_STRINGS], memory_order_relaxed)[index % INTERN_PAGE_STRINGS];
+}
+
+/**
+ * @brief Helper function to find bytes in a table, without a lock.
+ *
+ * @return InternHandle Their handle, or INTERN_NONE if the table does not have them.
+ */
+static InternHandle find_intern_handle(const InternTable * table, const char * data, size_t length, uint32_t hash) {
+    // The table is never full, a free slot ends every probe.
+    for (size_t slot = hash & table->mask;; slot = (slot + 1) & table->mask) {
+        InternHandle handle = atomic_load_explicit(&table->slots[slot], memory_order_acquire);
+        if (handle == INTERN_NONE)
+            return INTERN_NONE;
+        const InternEntry * entry = get_intern_entry(handle);
+        if (entry->hash == hash && entry->length == length && memcmp(entry->string, data, length) == 0)
+            return handle;
+    }
+}
+
+/**
+ * @brief Helper function to put a handle in the first free slot of its probe, intern_lock must be held.
+ */
+static void place_intern_handle(InternTable * table, InternHandle handle, uint32_t hash) {
+    size_t slot = hash & table->mask;
+    while (atomic_load_explicit(&table->slots[slot], memory_order_relaxed) != INTERN_NONE)
+        slot = (slot + 1) & table->mask;
+    atomic_store_explicit(&table->slots[slot], handle, memory_order_release);
+}
+
+/**
+ * @brief Helper function to replace the table by one twice as large, intern_lock must be held.
+ *
+ * @return InternTable * The new table, published, or NULL if memory ran out.
+ */
+static InternTable * grow_intern_table(InternTable * table) {
+    size_t slot_count = table ? (table->mask + 1) * 2 : INTERN_FIRST_SLOTS;
+    size_t size = sizeof(InternTable) + slot_count * sizeof(_Atomic(InternHandle));
+    InternTable * grown = (InternTable *)calloc(1, size);
+    if (!grown)
+        return NULL;
+    grown->retired = table;
+    grown->mask = slot_count - 1;
+    if (table) {
+        for (size_t slot = 0; slot <= table->mask; slot++) {
+            InternHandle handle = atomic_load_explicit(&table->slots[slot], memory_order_relaxed);
+            if (handle != INTERN_NONE)
+                place_intern_handle(grown, handle, get_intern_entry(handle)->hash);
+        }
+    }
+    atomic_fetch_add_explicit(&intern_bytes, size, memory_order_relaxed);
+    atomic_store_explicit(&intern_table, grown, memory_order_release);
+    return grown;
+}
+
+/**
+ * @brief Helper function to intern bytes that a lookup without the lock missed.
+ *
+ * @return InternHandle Their handle, or INTERN_NONE if memory ran out or the directory is full.
+ */
+static InternHandle insert_intern_string(const char * data, size_t length, uint32_t hash) {
+    thread_once(&intern_once, initialize_intern);
+    mutex_lock(&intern_lock);
+    // Another thread may have added them since the lookup.
+    InternTable * table = atomic_load_explicit(&intern_table, memory_order_relaxed);
+    InternHandle handle = table ? find_intern_handle(table, data, length, hash) : INTERN_NONE;
+    uint32_t count = atomic_load_explicit(&intern_string_count, memory_order_relaxed);
+    if (handle != INTERN_NONE || length > UINT32_MAX || count >= (uint32_t)INTERN_PAGE_STRINGS * INTERN_MAX_PAGES)
+        goto unlock;
+    if (!table || (size_t)(count + 1) * 2 > table->mask + 1) {
+        table = grow_intern_table(table);
+        if (!table)
+            goto unlock;
+    }
+
+    InternEntry * page = atomic_load_explicit(&intern_pages[count / INTERN_PAGE_STRINGS], memory_order_relaxed);
+    if (!page) {
+        page = (InternEntry *)malloc(INTERN_PAGE_STRINGS * sizeof(InternEntry));
+        if (!page)
+            goto unlock;
+        atomic_fetch_add_explicit(&intern_bytes, INTERN_PAGE_STRINGS * sizeof(InternEntry), memory_order_relaxed);
+        atomic_store_explicit(&intern_pages[count / INTERN_PAGE_STRINGS], page, memory_order_relaxed);
+    }
+    char * copy = (char *)arena_push_aligned(&intern_arena, length + 1, 1);
+    if (!copy)
+        goto unlock;
+    memcpy(copy, data, length);
+    copy[length] = '\0';
+    atomic_fetch_add_explicit(&intern_bytes, length + 1, memory_order_relaxed);
+
+    // The entry is written before the handle is published, readers that see the handle see the entry.
+    InternEntry * entry = &page[count % INTERN_PAGE_STRINGS];
+    entry->string = copy;
+    entry->length = (uint32_t)length;
+    entry->hash = hash;
+    handle = count + 1;
+    atomic_store_explicit(&intern_string_count, handle, memory_order_release);
+    place_intern_handle(table, handle, hash);
+
+unlock:
+    mutex_unlock(&intern_lock);
+    return handle;
+}
+
+InternHandle intern_view(StringView view) {
+    const char * data = view.data ? view.data : "";
+    uint32_t hash = (uint32_t)hash_bytes(data, view.length, 0);
+    InternTable * table = atomic_load_explicit(&intern_table, memory_order_acquire);
+    InternHandle handle = table ? find_intern_handle(table, data, view.length, hash) : INTERN_NONE;
+    return handle != INTERN_NONE ? handle : insert_intern_string(data, view.length, hash);
+}
+
+InternHandle intern_string(const char * string) {
+    return string ? intern_view(string_view(string)) : INTERN_NONE;
+}
+
+InternHandle intern_static(const char * string) {
+    if (!string)
+        return INTERN_NONE;
+    size_t mask = INTERN_STATIC_SLOTS - 1;
+    size_t slot = (size_t)hash_pointer(string) & mask;
+    for (int probe = 0; probe < INTERN_STATIC_PROBES; probe++, slot = (slot + 1) & mask) {
+        InternStaticSlot * remembered = &intern_static_slots[slot];
+        const char * address = atomic_load_explicit(&remembered->address, memory_order_acquire);
+        if (!address) {
+            if (atomic_compare_exchange_strong_explicit(&remembered->address, &address, string, memory_order_acq_rel, memory_order_acquire)) {
+                InternHandle handle = intern_string(string);
+                atomic_store_explicit(&remembered->handle, handle, memory_order_release);
+                return handle;
+            }
+        }
+        if (address == string) {
+            // The handle may still be being written, interning by content gives the same one.
+            InternHandle handle = atomic_load_explicit(&remembered->handle, memory_order_acquire);
+            return handle != INTERN_NONE ? handle : intern_string(string);
+        }
+    }
+    return intern_string(string);
+}
+
+InternHandle intern_lookup(StringView view) {
+    const char * data = view.data ? view.data : "";
+    InternTable * table = atomic_load_explicit(&intern_table, memory_order_acquire);
+    return table ? find_intern_handle(table, data, view.length, (uint32_t)hash_bytes(data, view.length, 0)) : INTERN_NONE;
+}
+
+const char * intern_get(InternHandle handle) {
+    if (handle == INTERN_NONE || handle > atomic_load_explicit(&intern_string_count, memory_order_acquire))
+        return NULL;
+    return get_intern_entry(handle)->string;
+}
+
+StringView intern_get_view(InternHandle handle) {
+    StringView view = { NULL, 0 };
+    if (handle != INTERN_NONE && handle <= atomic_load_explicit(&intern_string_count, memory_order_acquire)) {
+        const InternEntry * entry = get_intern_entry(handle);
+        view.data = entry->string;
+        view.length = entry->length;
+    }
+    return view;
+}
+
+size_t intern_count(void) {
+    return atomic_load_explicit(&intern_string_count, memory_order_acquire);
+}
+
+size_t intern_memory_bytes(void) {
+    return atomic_load_explicit(&intern_bytes, memory_order_relaxed);
+}
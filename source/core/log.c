@@ -1,9 +1,95 @@
 #include "core/log.h"
+#include "core/log_encode.h"
+#include "core/log_flight.h"
 #include "core/string.h"
 #include "core/array.h"
 #include "core/color.h"
+#include "core/thread.h"
+#include "core/time.h"
 
 #include <stdio.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+
+#if OS_WINDOWS
+    #include <io.h>
+#else
+    #include <errno.h>
+    #include <unistd.h>
+    #include <sys/uio.h>
+#endif
+
+#define LOG_LINE_FORMAT "%s%s[%s]%s (%s: %s:%d) %.*s\n"
+#define LOG_SINK_PREFIX_FORMAT "[%s] (%s: %s:%d) "
+#define LOG_MAX_LINE_BYTES 1024
+#define LOG_ASYNC_LINE_BYTES 4096
+#define LOG_ESCAPED_BYTE_MAX_BYTES 6
+#define LOG_ASYNC_BATCH_RECORDS 256
+#define LOG_ASYNC_IDLE_YIELDS 64
+#define LOG_CONSOLE_LABEL(color, name) { TERMINAL_COLOR_BG_BLACK color "[" name "]" TERMINAL_MODIFIER_RESET, sizeof(TERMINAL_COLOR_BG_BLACK color "[" name "]" TERMINAL_MODIFIER_RESET) - 1 }
+
+/**
+ * @brief One cell of the asynchronous ring, a log call copied by value.
+ */
+typedef struct LogRecord {
+    atomic_size_t sequence;                     /** Vyukov sequence number, says whether the cell is free or published for its position. */
+    LOG_LEVEL level;                            /** Severity of the message. */
+    int line;                                   /** Line of the log call. */
+    uint64_t ticks;                             /** time_ticks at the log call. */
+    const char * func;                          /** Function of the log call, must outlive the write. */
+    const char * file;                          /** File of the log call, must outlive the write. */
+    uint32_t length;                            /** Number of bytes in message, fields included. */
+    uint32_t fields_length;                     /** Number of bytes of encoded fields at the end of message. */
+    char message[LOG_ASYNC_MESSAGE_CAPACITY];   /** Copy of the message followed by its encoded fields, not terminated. */
+} LogRecord;
+
+/**
+ * @brief Bounded multi-producer queue of log records drained by one writer thread.
+ * 
+ * Producers and the writer only meet on the sequence number of a cell, positions are claimed
+ * with a compare-and-swap, so no log call takes a lock. The two positions live on their own
+ * cache lines so producers and the writer do not false share.
+ */
+typedef struct LogAsyncQueue {
+    LogRecord * records;                            /** Ring of capacity cells. */
+    size_t mask;                                    /** Capacity minus one, capacity is a power of two. */
+    LOG_OVERFLOW_POLICY policy;                     /** What producers do when the ring is full. */
+    Thread writer;                                  /** Thread formatting and writing records. */
+    atomic_bool stopping;                           /** Tells the writer to exit once the ring is empty. */
+    _Alignas(64) atomic_size_t enqueue_position;    /** Next position producers claim. */
+    _Alignas(64) atomic_size_t dequeue_position;    /** Next position the writer, or a producer dropping the oldest record, claims. */
+    _Alignas(64) atomic_size_t completed_count;     /** Number of dequeued records that were written or dropped. */
+} LogAsyncQueue;
+
+LOG_LEVEL log_minimum_level = LOG_LEVEL_DEBUG;
+static bool log_timestamps;
+static LOG_ENCODING log_encoding;
+
+/**
+ * @brief The last line handed to the sinks while coalescing is on, and how many times it repeated since.
+ */
+typedef struct LogCoalescing {
+    Mutex lock;                         /** Guards the fields below, writers may be on several threads. */
+    char content[LOG_MAX_LINE_BYTES];   /** The line from its content_start. */
+    size_t length;                      /** Number of bytes in content, 0 if there is no line to compare to. */
+    LOG_LEVEL level;                    /** Level of the line. */
+    const char * func;                  /** Function of the line. */
+    const char * file;                  /** File of the line. */
+    int line;                           /** Line of the line. */
+    uint64_t repeated;                  /** Times the line was folded since it was written. */
+} LogCoalescing;
+
+static bool log_coalescing_enabled;
+static LogCoalescing log_coalescing;
+static Once log_coalescing_once = ONCE_INITIALIZER;
+static atomic_uint_least64_t log_coalesced;
+
+static LogAsyncQueue log_async_queue;
+static atomic_bool log_async_running;
+static atomic_uint_least64_t log_async_dropped;
+static bool log_async_exit_registered;
 
 
 static const char * LOG_LEVEL_STRING_LIST[] = {
@@ -15,6 +101,38 @@ static const char * LOG_LEVEL_STRING_LIST[] = {
     "FATAL"
 };
 
+/**
+ * @brief A level label with its colors, ready to be written as is.
+ */
+typedef struct LogConsoleLabel {
+    const char * text;      /** The colored label. */
+    size_t length;          /** Number of bytes in text. */
+} LogConsoleLabel;
+
+static const LogConsoleLabel LOG_CONSOLE_LABELS[] = {
+    LOG_CONSOLE_LABEL(TERMINAL_COLOR_FG_BLUE, "DEBUG"),
+    LOG_CONSOLE_LABEL(TERMINAL_COLOR_FG_WHITE, "INFO"),
+    LOG_CONSOLE_LABEL(TERMINAL_COLOR_FG_GREEN, "SUCCESS"),
+    LOG_CONSOLE_LABEL(TERMINAL_COLOR_FG_YELLOW, "WARNING"),
+    LOG_CONSOLE_LABEL(TERMINAL_COLOR_FG_RED, "ERROR"),
+    LOG_CONSOLE_LABEL(TERMINAL_COLOR_FG_MAGENTA, "FATAL")
+};
+
+static Once log_console_once = ONCE_INITIALIZER;
+static bool log_console_terminal;
+static bool log_console_colors;
+static bool log_console_colors_forced;
+
+static const char * log_level_to_color(LOG_LEVEL level);
+static void write_console_line(LogSink * sink, const LogLine * line);
+static void flush_console(LogSink * sink);
+
+LogSink log_console_sink = { write_console_line, flush_console, LOG_LEVEL_DEBUG };
+
+static LogSink * log_sinks[LOG_MAX_SINKS] = { &log_console_sink };
+static size_t log_sink_count = 1;
+static bool log_sinks_exit_registered;
+
 static const char * log_level_to_color(LOG_LEVEL level) {
     switch (level) {
         case LOG_LEVEL_DEBUG:   return TERMINAL_COLOR_FG_BLUE;
@@ -59,15 +177,680 @@ LOG_LEVEL string_to_log_level(const char * string) {
     return LOG_LEVEL_UNKNOWN;
 }
 
-void log_message_to_console(LOG_LEVEL level, const char * func, const char * file, int line, const char * message) {
+void log_set_level(LOG_LEVEL level) {
+    log_minimum_level = level;
+}
+
+void log_set_timestamps(bool enabled) {
+    log_timestamps = enabled;
+}
+
+void log_set_encoding(LOG_ENCODING encoding) {
+    log_encoding = encoding;
+}
+
+bool log_set_level_from_environment(const char * variable) {
+    LOG_LEVEL level = string_to_log_level(getenv(variable));
+    if (level == LOG_LEVEL_UNKNOWN)
+        return false;
+    log_set_level(level);
+    return true;
+}
+
+/**
+ * @brief Helper function to check once whether stdout is a terminal, only a terminal gets colors unless NO_COLOR is set.
+ */
+static void initialize_log_console(void) {
+#if OS_WINDOWS
+    log_console_terminal = _isatty(_fileno(stdout));
+#else
+    log_console_terminal = isatty(STDOUT_FILENO);
+#endif
+    if (!log_console_colors_forced)
+        log_console_colors = log_console_terminal && !getenv("NO_COLOR");
+}
+
+void log_set_console_colors(bool enabled) {
+    log_console_colors_forced = true;
+    log_console_colors = enabled;
+}
+
+/**
+ * @brief Helper function to write bytes to the stdout descriptor, retrying partial and interrupted writes. Errors drop the rest.
+ */
+static void write_console_bytes(const char * data, size_t length) {
+    while (length > 0) {
+#if OS_WINDOWS
+        int written = _write(1, data, length > 0x40000000 ? 0x40000000 : (unsigned int)length);
+        if (written <= 0)
+            return;
+#else
+        ssize_t written = write(STDOUT_FILENO, data, length);
+        if (written < 0 && errno == EINTR)
+            continue;
+        if (written <= 0)
+            return;
+#endif
+        data += written;
+        length -= (size_t)written;
+    }
+}
+
+/**
+ * @brief Helper function to write the console sink's lines.
+ * 
+ * A colored label replaces the plain one with the precomputed one from LOG_CONSOLE_LABELS. On a
+ * terminal each line is gathered with writev, or copied together on Windows, and written at once
+ * with a single system call, unbuffered so it shows immediately and lines from several threads do
+ * not interleave. Anywhere else nobody watches line by line, the lines go through stdio's buffer,
+ * which hands many of them to the OS in one write.
+ */
+static void write_console_line(LogSink * sink, const LogLine * line) {
+    (void)sink;
+    thread_once(&log_console_once, initialize_log_console);
+    bool colored = log_console_colors && line->label_length && line->level >= 0 && line->level <= LOG_LEVEL_FATAL;
+    const LogConsoleLabel * label = colored ? &LOG_CONSOLE_LABELS[line->level] : NULL;
+    size_t label_end = line->label_start + line->label_length;
+    size_t rest = line->length - label_end;
+    if (!log_console_terminal) {
+        if (!colored) {
+            fwrite(line->text, 1, line->length, stdout);
+            return;
+        }
+        fwrite(line->text, 1, line->label_start, stdout);
+        fwrite(label->text, 1, label->length, stdout);
+        fwrite(line->text + label_end, 1, rest, stdout);
+        return;
+    }
+
+    // Text printed to stdout before the line must come out before it.
+    fflush(stdout);
+    if (!colored) {
+        write_console_bytes(line->text, line->length);
+        return;
+    }
+#if OS_WINDOWS
+    char buffer[LOG_ASYNC_LINE_BYTES];
+    if (line->label_start + label->length + rest <= sizeof(buffer)) {
+        memcpy(buffer, line->text, line->label_start);
+        memcpy(buffer + line->label_start, label->text, label->length);
+        memcpy(buffer + line->label_start + label->length, line->text + label_end, rest);
+        write_console_bytes(buffer, line->label_start + label->length + rest);
+    } else {
+        write_console_bytes(line->text, line->label_start);
+        write_console_bytes(label->text, label->length);
+        write_console_bytes(line->text + label_end, rest);
+    }
+#else
+    struct iovec pieces[3] = {
+        { (void *)line->text, line->label_start },
+        { (void *)label->text, label->length },
+        { (void *)(line->text + label_end), rest }
+    };
+    struct iovec * piece = pieces;
+    int count = 3;
+    while (count > 0) {
+        ssize_t written = writev(STDOUT_FILENO, piece, count);
+        if (written < 0 && errno == EINTR)
+            continue;
+        if (written <= 0)
+            return;
+        // Skip what a partial write took and go on from there.
+        while (count > 0 && (size_t)written >= piece->iov_len) {
+            written -= (ssize_t)piece->iov_len;
+            piece++;
+            count--;
+        }
+        if (count > 0) {
+            piece->iov_base = (char *)piece->iov_base + written;
+            piece->iov_len -= (size_t)written;
+        }
+    }
+#endif
+}
+
+/**
+ * @brief Helper function to flush the console sink, lines written to a terminal already are.
+ */
+static void flush_console(LogSink * sink) {
+    (void)sink;
+    fflush(stdout);
+}
+
+/**
+ * @brief Helper function to format a message into a sink line, in the current encoding.
+ * 
+ * Text lines are formatted in a single pass over the buffer. JSON and logfmt messages are
+ * formatted aside first, on the stack up to LOG_MAX_LINE_BYTES and on the heap past that,
+ * to be escaped into the line.
+ * 
+ * @param log_line Receives the line, pointing into buffer.
+ * @param buffer Where the text is formatted.
+ * @param capacity Size of buffer, more than TIME_TIMESTAMP_LENGTH + 1.
+ * @param ticks time_ticks at the log call.
+ * @param fields Fields encoded with log_encode_fields in the current encoding, may be NULL.
+ * @param fields_length Number of bytes in fields.
+ * @param format The printf format string of the message.
+ * @param arguments The arguments of the format string, consumed.
+ * @return size_t The full length of the line, the text is incomplete if it is capacity or more.
+ */
+static size_t format_log_line_va(LogLine * log_line, char * buffer, size_t capacity, uint64_t ticks, LOG_LEVEL level, const char * func, const char * file, int line, 
+    const char * fields, size_t fields_length, const char * format, va_list arguments) {
+    LOG_ENCODING encoding = log_encoding;
+    size_t total;
+    log_line->timestamp = time_ticks_to_wall_ns(ticks);
+    log_line->level = level;
+    log_line->text = buffer;
+    log_line->label_start = 0;
+    log_line->label_length = 0;
+    log_line->func = func;
+    log_line->file = file;
+    log_line->line = line;
+
+    if (encoding == LOG_ENCODING_TEXT) {
+        const char * log_level_string = log_level_to_string(level);
+        size_t prefix = 0;
+        if (log_timestamps) {
+            prefix = time_format_wall(log_line->timestamp, buffer);
+            buffer[prefix++] = ' ';
+        }
+        total = prefix + format_string(buffer + prefix, capacity - prefix, LOG_SINK_PREFIX_FORMAT, log_level_string, func, file, line);
+        total += format_string_va(total < capacity ? buffer + total : NULL, total < capacity ? capacity - total : 0, format, arguments);
+        if (fields_length && total < capacity)
+            memcpy(buffer + total, fields, fields_length < capacity - total ? fields_length : capacity - total);
+        total += fields_length;
+        if (total + 1 < capacity) {
+            buffer[total] = '\n';
+            buffer[total + 1] = '\0';
+        }
+        total++;
+        log_line->label_start = prefix;
+        log_line->label_length = strlen(log_level_string) + 2;
+        log_line->content_start = prefix;
+    } else {
+        char message_buffer[LOG_MAX_LINE_BYTES];
+        StringBuilder message;
+        string_builder_init(&message, message_buffer, sizeof(message_buffer));
+        string_builder_append_format_va(&message, format, arguments);
+        LogEncoder encoder;
+        log_encoder_init(&encoder, buffer, capacity);
+        log_encode_record(&encoder, encoding, log_line->timestamp, level, func, file, line, message.data, message.length, fields, fields_length);
+        string_builder_destroy(&message);
+        total = encoder.length;
+        log_line->content_start = log_encode_time_length(encoding);
+    }
+    log_line->length = total < capacity ? total : capacity - 1;
+    return total;
+}
+
+/**
+ * @brief Helper function to format a message into a sink line, see format_log_line_va.
+ */
+static size_t format_log_line(LogLine * log_line, char * buffer, size_t capacity, uint64_t ticks, LOG_LEVEL level, const char * func, const char * file, int line, 
+    const char * fields, size_t fields_length, const char * format, ...) {
+    va_list arguments;
+    va_start(arguments, format);
+    size_t total = format_log_line_va(log_line, buffer, capacity, ticks, level, func, file, line, fields, fields_length, format, arguments);
+    va_end(arguments);
+    return total;
+}
+
+/**
+ * @brief Helper function to hand a line to every sink that takes its level.
+ */
+static void dispatch_log_line(const LogLine * line) {
+    for (size_t index = 0; index < log_sink_count; index++) {
+        LogSink * sink = log_sinks[index];
+        if (line->level >= sink->minimum_level)
+            sink->write(sink, line);
+    }
+}
+
+/**
+ * @brief Helper function to write the summary of a folded line.
+ * 
+ * @param coalescing The state the line was taken from, copied out of the lock.
+ */
+static void write_log_repeated(const LogCoalescing * coalescing) {
+    char buffer[LOG_MAX_LINE_BYTES];
+    LogLine summary;
+    if (format_log_line(&summary, buffer, sizeof(buffer), time_ticks(), coalescing->level, coalescing->func, coalescing->file, coalescing->line, 
+            NULL, 0, "Last message repeated %llu times.", (unsigned long long)coalescing->repeated) >= sizeof(buffer))
+        buffer[summary.length - 1] = '\n';
+    dispatch_log_line(&summary);
+}
+
+/**
+ * @brief Helper function to fold a line into the previous one if they are equal.
+ * 
+ * @return true if the line was folded and must not be written,
+ * @return false if it is new, the summary of the previous line was written first if it repeated.
+ */
+static bool coalesce_log_line(const LogLine * line) {
+    LogCoalescing * coalescing = &log_coalescing;
+    const char * content = line->text + line->content_start;
+    size_t length = line->length - line->content_start;
+    mutex_lock(&coalescing->lock);
+    if (length == coalescing->length && line->level == coalescing->level && memcmp(content, coalescing->content, length) == 0) {
+        coalescing->repeated++;
+        mutex_unlock(&coalescing->lock);
+        atomic_fetch_add_explicit(&log_coalesced, 1, memory_order_relaxed);
+        return true;
+    }
+
+    LogCoalescing previous = { .level = coalescing->level, .func = coalescing->func, .file = coalescing->file, .line = coalescing->line, .repeated = coalescing->repeated };
+    coalescing->length = length <= sizeof(coalescing->content) ? length : 0;
+    memcpy(coalescing->content, content, coalescing->length);
+    coalescing->level = line->level;
+    coalescing->func = line->func;
+    coalescing->file = line->file;
+    coalescing->line = line->line;
+    coalescing->repeated = 0;
+    mutex_unlock(&coalescing->lock);
+
+    if (previous.repeated)
+        write_log_repeated(&previous);
+    return false;
+}
+
+/**
+ * @brief Helper function to write the summary of the last line if it repeated since it was written.
+ */
+static void flush_log_coalescing(void) {
+    LogCoalescing * coalescing = &log_coalescing;
+    mutex_lock(&coalescing->lock);
+    LogCoalescing previous = { .level = coalescing->level, .func = coalescing->func, .file = coalescing->file, .line = coalescing->line, .repeated = coalescing->repeated };
+    coalescing->repeated = 0;
+    mutex_unlock(&coalescing->lock);
+
+    if (previous.repeated)
+        write_log_repeated(&previous);
+}
+
+/**
+ * @brief Helper function to hand a line to the sinks, unless it is folded into the previous one.
+ */
+static void write_log_line_to_sinks(const LogLine * line) {
+    if (log_coalescing_enabled && coalesce_log_line(line))
+        return;
+    dispatch_log_line(line);
+}
+
+/**
+ * @brief Helper function to flush every sink.
+ */
+static void flush_log_sinks(void) {
+    if (log_coalescing_enabled)
+        flush_log_coalescing();
+    for (size_t index = 0; index < log_sink_count; index++)
+        log_sinks[index]->flush(log_sinks[index]);
+}
+
+/**
+ * @brief Helper function to create the coalescing lock.
+ */
+static void initialize_log_coalescing(void) {
+    mutex_init(&log_coalescing.lock);
+}
+
+void log_set_coalescing(bool enabled) {
+    thread_once(&log_coalescing_once, initialize_log_coalescing);
+    if (!enabled && log_coalescing_enabled) {
+        flush_log_coalescing();
+        log_coalescing.length = 0;
+    }
+    log_coalescing_enabled = enabled;
+}
+
+uint64_t log_coalesced_count(void) {
+    return atomic_load_explicit(&log_coalesced, memory_order_relaxed);
+}
+
+bool log_add_sink(LogSink * sink) {
+    if (log_sink_count == LOG_MAX_SINKS)
+        return false;
+    for (size_t index = 0; index < log_sink_count; index++)
+        if (log_sinks[index] == sink)
+            return false;
+    log_sinks[log_sink_count++] = sink;
+
+    if (!log_sinks_exit_registered) {
+        atexit(flush_log_sinks);
+        log_sinks_exit_registered = true;
+    }
+    return true;
+}
+
+bool log_remove_sink(LogSink * sink) {
+    for (size_t index = 0; index < log_sink_count; index++) {
+        if (log_sinks[index] != sink)
+            continue;
+        sink->flush(sink);
+        memmove(&log_sinks[index], &log_sinks[index + 1], (log_sink_count - index - 1) * sizeof(LogSink *));
+        log_sink_count--;
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Helper function to claim the cell at the enqueue position.
+ * 
+ * @param queue The queue.
+ * @param position Receives the claimed position.
+ * @return LogRecord * The cell to fill, or NULL if the ring is full.
+ */
+static LogRecord * claim_log_record_to_write(LogAsyncQueue * queue, size_t * position) {
+    size_t current = atomic_load_explicit(&queue->enqueue_position, memory_order_relaxed);
+    for (;;) {
+        LogRecord * record = &queue->records[current & queue->mask];
+        size_t sequence = atomic_load_explicit(&record->sequence, memory_order_acquire);
+        intptr_t difference = (intptr_t)sequence - (intptr_t)current;
+        if (difference == 0) {
+            if (atomic_compare_exchange_weak_explicit(&queue->enqueue_position, &current, current + 1, memory_order_relaxed, memory_order_relaxed)) {
+                *position = current;
+                return record;
+            }
+        } else if (difference < 0) {
+            return NULL;
+        } else {
+            current = atomic_load_explicit(&queue->enqueue_position, memory_order_relaxed);
+        }
+    }
+}
+
+/**
+ * @brief Helper function to claim the published cell at the dequeue position.
+ * 
+ * @param queue The queue.
+ * @param position Receives the claimed position.
+ * @return LogRecord * The cell to read, or NULL if the ring is empty or its oldest cell is still being filled.
+ */
+static LogRecord * claim_log_record_to_read(LogAsyncQueue * queue, size_t * position) {
+    size_t current = atomic_load_explicit(&queue->dequeue_position, memory_order_relaxed);
+    for (;;) {
+        LogRecord * record = &queue->records[current & queue->mask];
+        size_t sequence = atomic_load_explicit(&record->sequence, memory_order_acquire);
+        intptr_t difference = (intptr_t)sequence - (intptr_t)(current + 1);
+        if (difference == 0) {
+            if (atomic_compare_exchange_weak_explicit(&queue->dequeue_position, &current, current + 1, memory_order_relaxed, memory_order_relaxed)) {
+                *position = current;
+                return record;
+            }
+        } else if (difference < 0) {
+            return NULL;
+        } else {
+            current = atomic_load_explicit(&queue->dequeue_position, memory_order_relaxed);
+        }
+    }
+}
+
+/**
+ * @brief Helper function to hand a read cell back to producers for the next lap of the ring.
+ * 
+ * @param queue The queue.
+ * @param record The cell.
+ * @param position The position it was claimed at.
+ */
+static inline void release_log_record(LogAsyncQueue * queue, LogRecord * record, size_t position) {
+    atomic_store_explicit(&record->sequence, position + queue->mask + 1, memory_order_release);
+}
+
+/**
+ * @brief Helper function to format a log call straight into the ring, applying the overflow policy when it is full.
+ * 
+ * @param fields Encoded fields copied after the message, at most LOG_MAX_FIELDS_BYTES.
+ * @param fields_length Number of bytes in fields.
+ */
+static void push_log_record(LOG_LEVEL level, const char * func, const char * file, int line, const char * fields, size_t fields_length, const char * format, va_list arguments) {
+    uint64_t ticks = time_ticks();
+    LogAsyncQueue * queue = &log_async_queue;
+    size_t position;
+    LogRecord * record;
+    while (!(record = claim_log_record_to_write(queue, &position))) {
+        if (queue->policy == LOG_OVERFLOW_DROP_NEWEST) {
+            atomic_fetch_add_explicit(&log_async_dropped, 1, memory_order_relaxed);
+            return;
+        }
+        if (queue->policy == LOG_OVERFLOW_DROP_OLDEST) {
+            size_t oldest_position;
+            LogRecord * oldest = claim_log_record_to_read(queue, &oldest_position);
+            if (oldest) {
+                release_log_record(queue, oldest, oldest_position);
+                atomic_fetch_add_explicit(&log_async_dropped, 1, memory_order_relaxed);
+                atomic_fetch_add_explicit(&queue->completed_count, 1, memory_order_release);
+                continue;
+            }
+        }
+        thread_yield();
+    }
+
+    size_t room = LOG_ASYNC_MESSAGE_CAPACITY - fields_length;
+    size_t length = format_string_va(record->message, room, format, arguments);
+    if (length >= room)
+        length = room - 1;
+    if (fields_length)
+        memcpy(record->message + length, fields, fields_length);
+    record->length = (uint32_t)(length + fields_length);
+    record->fields_length = (uint32_t)fields_length;
+    record->level = level;
+    record->func = func;
+    record->file = file;
+    record->line = line;
+    record->ticks = ticks;
+    atomic_store_explicit(&record->sequence, position + 1, memory_order_release);
+}
+
+/**
+ * @brief Helper function to format up to a batch of records and hand them to the sinks.
+ * 
+ * @param queue The queue.
+ * @return size_t The number of records written.
+ */
+static size_t write_log_records(LogAsyncQueue * queue) {
+    // Escaping can grow a record several times over in JSON and logfmt.
+    char buffer[LOG_ASYNC_LINE_BYTES];
+    size_t count = 0;
+    size_t position;
+    LogRecord * record;
+    while (count < LOG_ASYNC_BATCH_RECORDS && (record = claim_log_record_to_read(queue, &position))) {
+        LogLine line;
+        const char * fields = record->message + (record->length - record->fields_length);
+        int message_length = (int)(record->length - record->fields_length);
+        size_t total;
+        while ((total = format_log_line(&line, buffer, sizeof(buffer), record->ticks, record->level, record->func, record->file, record->line, 
+                fields, record->fields_length, "%.*s", message_length, record->message)) >= sizeof(buffer)) {
+            if (log_encoding == LOG_ENCODING_TEXT || message_length == 0) {
+                // Keep the truncated line on its own line.
+                buffer[line.length - 1] = '\n';
+                break;
+            }
+            // A cut JSON or logfmt record would not parse, shorten the message and encode it again. A byte escapes to
+            // at most LOG_ESCAPED_BYTE_MAX_BYTES, so this never drops more than needed and ends in a few passes.
+            size_t excess = total - sizeof(buffer) + 1;
+            size_t cut = (excess + LOG_ESCAPED_BYTE_MAX_BYTES - 1) / LOG_ESCAPED_BYTE_MAX_BYTES;
+            message_length = cut < (size_t)message_length ? message_length - (int)cut : 0;
+            while (message_length > 0 && ((unsigned char)record->message[message_length] & 0xC0) == 0x80)
+                message_length--;
+        }
+        release_log_record(queue, record, position);
+        write_log_line_to_sinks(&line);
+        count++;
+    }
+    if (count)
+        atomic_fetch_add_explicit(&queue->completed_count, count, memory_order_release);
+    return count;
+}
+
+/**
+ * @brief Entry point of the writer thread, drains the ring until it is empty and asked to stop.
+ * 
+ * @param argument The queue.
+ */
+static void run_log_writer(void * argument) {
+    LogAsyncQueue * queue = (LogAsyncQueue *)argument;
+    unsigned int idle = 0;
+    for (;;) {
+        if (write_log_records(queue)) {
+            idle = 0;
+            continue;
+        }
+        // Sinks buffer while records keep coming and are flushed once the ring runs empty.
+        if (idle == 0)
+            flush_log_sinks();
+        if (atomic_load_explicit(&queue->stopping, memory_order_acquire) && 
+            atomic_load_explicit(&queue->dequeue_position, memory_order_relaxed) == atomic_load_explicit(&queue->enqueue_position, memory_order_relaxed))
+            break;
+
+        // Stay responsive right after a burst, then back off so an idle logger costs nothing.
+        if (++idle < LOG_ASYNC_IDLE_YIELDS)
+            thread_yield();
+        else
+            thread_sleep(1);
+    }
+}
+
+bool log_async_start(size_t capacity, LOG_OVERFLOW_POLICY policy) {
+    LogAsyncQueue * queue = &log_async_queue;
+    if (atomic_load_explicit(&log_async_running, memory_order_acquire))
+        return false;
+
+    size_t rounded_capacity = 2;
+    while (rounded_capacity < capacity)
+        rounded_capacity <<= 1;
+    queue->records = (LogRecord *)malloc(rounded_capacity * sizeof(LogRecord));
+    if (!queue->records)
+        return false;
+    for (size_t index = 0; index < rounded_capacity; index++)
+        atomic_init(&queue->records[index].sequence, index);
+    queue->mask = rounded_capacity - 1;
+    queue->policy = policy;
+    atomic_store(&queue->stopping, false);
+    atomic_store(&queue->enqueue_position, 0);
+    atomic_store(&queue->dequeue_position, 0);
+    atomic_store(&queue->completed_count, 0);
+    if (!thread_create(&queue->writer, run_log_writer, queue)) {
+        free(queue->records);
+        queue->records = NULL;
+        return false;
+    }
+
+    if (!log_async_exit_registered) {
+        atexit(log_async_stop);
+        log_async_exit_registered = true;
+    }
+    atomic_store_explicit(&log_async_running, true, memory_order_release);
+    return true;
+}
+
+void log_async_stop(void) {
+    LogAsyncQueue * queue = &log_async_queue;
+    if (!atomic_load_explicit(&log_async_running, memory_order_acquire))
+        return;
+
+    atomic_store_explicit(&queue->stopping, true, memory_order_release);
+    thread_join(&queue->writer);
+    atomic_store_explicit(&log_async_running, false, memory_order_release);
+    free(queue->records);
+    queue->records = NULL;
+}
+
+void log_async_flush(void) {
+    LogAsyncQueue * queue = &log_async_queue;
+    if (atomic_load_explicit(&log_async_running, memory_order_acquire)) {
+        // Every position claimed so far is written or dropped once the completed count reaches it.
+        size_t target = atomic_load_explicit(&queue->enqueue_position, memory_order_relaxed);
+        while (atomic_load_explicit(&queue->completed_count, memory_order_acquire) < target)
+            thread_yield();
+    }
+    flush_log_sinks();
+}
+
+uint64_t log_async_dropped_count(void) {
+    return atomic_load_explicit(&log_async_dropped, memory_order_relaxed);
+}
+
+void log_message_to_stream(FILE * stream, LOG_LEVEL level, const char * func, const char * file, int line, const char * message) {
     const char * log_level_string = log_level_to_string(level);
     const char * foreground_color = log_level_to_color(level);
     const char * background_color = TERMINAL_COLOR_BG_BLACK;
 
-    printf("%s%s[%s]%s (%s: %s:%d) %s\n", 
+    fprintf(stream, LOG_LINE_FORMAT, 
         background_color, 
         foreground_color, 
         log_level_string, 
         TERMINAL_MODIFIER_RESET, 
-        func, file, line, message);
-}
\ No newline at end of file
+        func, file, line, (int)strlen(message), message);
+}
+
+void log_message_to_console(LOG_LEVEL level, const char * func, const char * file, int line, const char * message) {
+    log_format_to_console(level, func, file, line, "%s", message);
+}
+
+void log_format_to_console(LOG_LEVEL level, const char * func, const char * file, int line, const char * format, ...) {
+    va_list arguments;
+    va_start(arguments, format);
+    log_format_to_console_va(level, func, file, line, format, arguments);
+    va_end(arguments);
+}
+
+/**
+ * @brief Helper function to log a formatted message with encoded fields, synchronously or through the ring.
+ */
+static void log_to_console_va(LOG_LEVEL level, const char * func, const char * file, int line, const char * fields, size_t fields_length, const char * format, va_list arguments) {
+#if LOG_FLIGHT_RECORDER
+    log_flight_record_va(level, func, file, line, format, arguments);
+#endif
+    if (atomic_load_explicit(&log_async_running, memory_order_acquire)) {
+        push_log_record(level, func, file, line, fields, fields_length, format, arguments);
+        // A fatal message usually precedes the end of the process, so it must reach the output first.
+        if (level == LOG_LEVEL_FATAL)
+            log_async_flush();
+        return;
+    }
+
+    uint64_t ticks = time_ticks();
+    char buffer[LOG_MAX_LINE_BYTES];
+    LogLine log_line;
+    va_list retry_arguments;
+    va_copy(retry_arguments, arguments);
+    size_t needed = format_log_line_va(&log_line, buffer, sizeof(buffer), ticks, level, func, file, line, fields, fields_length, format, arguments);
+    if (needed < sizeof(buffer)) {
+        write_log_line_to_sinks(&log_line);
+    } else {
+        char * large_buffer = (char *)malloc(needed + 1);
+        if (!large_buffer) {
+            buffer[log_line.length - 1] = '\n';
+            write_log_line_to_sinks(&log_line);
+        } else {
+            format_log_line_va(&log_line, large_buffer, needed + 1, ticks, level, func, file, line, fields, fields_length, format, retry_arguments);
+            write_log_line_to_sinks(&log_line);
+            free(large_buffer);
+        }
+    }
+    va_end(retry_arguments);
+    if (level == LOG_LEVEL_FATAL)
+        flush_log_sinks();
+}
+
+/**
+ * @brief Helper function to log a message with encoded fields, see log_to_console_va.
+ */
+static void log_to_console(LOG_LEVEL level, const char * func, const char * file, int line, const char * fields, size_t fields_length, const char * format, ...) {
+    va_list arguments;
+    va_start(arguments, format);
+    log_to_console_va(level, func, file, line, fields, fields_length, format, arguments);
+    va_end(arguments);
+}
+
+void log_format_to_console_va(LOG_LEVEL level, const char * func, const char * file, int line, const char * format, va_list arguments) {
+    log_to_console_va(level, func, file, line, NULL, 0, format, arguments);
+}
+
+void log_fields_to_console(LOG_LEVEL level, const char * func, const char * file, int line, const char * message, const LogField * fields, size_t field_count) {
+    char encoded[LOG_MAX_FIELDS_BYTES];
+    LogEncoder encoder;
+    log_encoder_init(&encoder, encoded, sizeof(encoded));
+    log_encode_fields(&encoder, log_encoding, fields, field_count);
+    log_to_console(level, func, file, line, encoded, encoder.length, "%s", message);
+}
@@ -0,0 +1,313 @@
+#include "core/log_encode.h"
+#include "core/time.h"
+#include <math.h>
+#include <string.h>
+
+#if ARCH_X64
+    #include <emmintrin.h>
+#endif
+#if COMPILER_CL
+    #include <intrin.h>
+#endif
+
+#define LOG_ENCODE_NUMBER_BYTES 48
+#define LOG_ENCODE_FLOAT_SCALE 1000000000.0
+#define LOG_ENCODE_FLOAT_DECIMALS 9
+#define LOG_ENCODE_MAX_EXACT 9007199254740992.0     /* 2^53, doubles below it hold every integer. */
+
+static const char LOG_ENCODE_HEX_DIGITS[] = "0123456789abcdef";
+
+/**
+ * @brief Helper function to append bytes, counting the ones that do not fit.
+ */
+static inline void write_log_encoder_bytes(LogEncoder * encoder, const char * bytes, size_t count) {
+    if (encoder->length < encoder->capacity) {
+        size_t fit = encoder->capacity - encoder->length;
+        memcpy(encoder->buffer + encoder->length, bytes, count < fit ? count : fit);
+    }
+    encoder->length += count;
+}
+
+/**
+ * @brief Helper function to append a null terminated string.
+ */
+static inline void write_log_encoder_string(LogEncoder * encoder, const char * string) {
+    write_log_encoder_bytes(encoder, string, strlen(string));
+}
+
+/**
+ * @brief Helper function to append a number formatted with format_string.
+ */
+static void write_log_encoder_number(LogEncoder * encoder, const char * format, ...) {
+    char text[LOG_ENCODE_NUMBER_BYTES];
+    va_list arguments;
+    va_start(arguments, format);
+    size_t length = format_string_va(text, sizeof(text), format, arguments);
+    va_end(arguments);
+    write_log_encoder_bytes(encoder, text, length < sizeof(text) ? length : sizeof(text) - 1);
+}
+
+/**
+ * @brief Helper function to append an integer, without going through a format string.
+ *
+ * @param encoder The encoder.
+ * @param magnitude The absolute value.
+ * @param negative true to write a minus sign first.
+ */
+static void write_log_encoder_integer(LogEncoder * encoder, uint64_t magnitude, bool negative) {
+    char digits[24];
+    char * cursor = digits + sizeof(digits);
+    do {
+        *--cursor = (char)('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude);
+    if (negative)
+        *--cursor = '-';
+    write_log_encoder_bytes(encoder, cursor, (size_t)(digits + sizeof(digits) - cursor));
+}
+
+/**
+ * @brief Helper function to append a float as %.15g would, but without libc for whole numbers of billionths.
+ *
+ * Most logged values, durations, ratios and sizes, are within a rounding of at most 9 decimals,
+ * those are written as their shortest such decimal, e.g. 0.1 and 16.5. The rest go through %.15g.
+ */
+static void write_log_encoder_float(LogEncoder * encoder, double value) {
+    double scaled = value * LOG_ENCODE_FLOAT_SCALE;
+    if (!(fabs(scaled) < LOG_ENCODE_MAX_EXACT) || scaled != (double)(int64_t)scaled) {
+        write_log_encoder_number(encoder, "%.15g", value);
+        return;
+    }
+    int64_t billionths = (int64_t)scaled;
+    uint64_t magnitude = billionths < 0 ? 0 - (uint64_t)billionths : (uint64_t)billionths;
+    uint64_t fraction = magnitude % (uint64_t)LOG_ENCODE_FLOAT_SCALE;
+    write_log_encoder_integer(encoder, magnitude / (uint64_t)LOG_ENCODE_FLOAT_SCALE, billionths < 0);
+    if (!fraction)
+        return;
+
+    char decimals[LOG_ENCODE_FLOAT_DECIMALS + 1];
+    decimals[0] = '.';
+    for (int index = LOG_ENCODE_FLOAT_DECIMALS; index > 0; index--) {
+        decimals[index] = (char)('0' + fraction % 10);
+        fraction /= 10;
+    }
+    size_t length = LOG_ENCODE_FLOAT_DECIMALS + 1;
+    while (decimals[length - 1] == '0')
+        length--;
+    write_log_encoder_bytes(encoder, decimals, length);
+}
+
+/**
+ * @brief Helper function to find the index of the lowest set bit of a non-zero mask.
+ */
+static inline unsigned int find_lowest_bit(unsigned int mask) {
+#if COMPILER_CL
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return (unsigned int)index;
+#else
+    return (unsigned int)__builtin_ctz(mask);
+#endif
+}
+
+/**
+ * @brief Helper function to check whether a byte must be escaped in a JSON string.
+ */
+static inline bool is_log_escape_byte(unsigned char byte) {
+    return byte < 0x20 || byte == '"' || byte == '\\';
+}
+
+/**
+ * @brief Helper function to find the first byte that must be escaped, a control byte, '"' or '\\'.
+ *
+ * @return size_t Its index, or length if there is none.
+ */
+static size_t find_log_escape(const char * text, size_t length) {
+    size_t index = 0;
+#if ARCH_X64
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i last_control = _mm_set1_epi8(0x1F);
+    for (; index + 16 <= length; index += 16) {
+        __m128i bytes = _mm_loadu_si128((const __m128i *)(text + index));
+        // A byte is a control byte when the unsigned minimum with 0x1F leaves it unchanged.
+        __m128i matches = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(bytes, quote), _mm_cmpeq_epi8(bytes, backslash)),
+            _mm_cmpeq_epi8(_mm_min_epu8(bytes, last_control), bytes));
+        unsigned int mask = (unsigned int)_mm_movemask_epi8(matches);
+        if (mask)
+            return index + find_lowest_bit(mask);
+    }
+#else
+    const uint64_t ones = 0x0101010101010101ULL;
+    const uint64_t highs = 0x8080808080808080ULL;
+    for (; index + 8 <= length; index += 8) {
+        uint64_t word;
+        memcpy(&word, text + index, sizeof(word));
+        // Classic has-zero-byte and has-less-than tests, a block with a hit is searched byte by byte.
+        uint64_t quotes = word ^ (ones * '"');
+        uint64_t backslashes = word ^ (ones * '\\');
+        uint64_t hits = ((quotes - ones) & ~quotes) | ((backslashes - ones) & ~backslashes) | ((word - ones * 0x20) & ~word);
+        if (hits & highs)
+            break;
+    }
+#endif
+    for (; index < length; index++)
+        if (is_log_escape_byte((unsigned char)text[index]))
+            return index;
+    return length;
+}
+
+/**
+ * @brief Helper function to append a string escaped for JSON, without the quotes.
+ */
+static void write_log_escaped(LogEncoder * encoder, const char * text, size_t length) {
+    size_t index = 0;
+    while (index < length) {
+        size_t run = find_log_escape(text + index, length - index);
+        write_log_encoder_bytes(encoder, text + index, run);
+        index += run;
+        if (index == length)
+            break;
+
+        unsigned char byte = (unsigned char)text[index++];
+        char escape[6] = { '\\', 0 };
+        size_t escape_length = 2;
+        switch (byte) {
+            case '"':  escape[1] = '"'; break;
+            case '\\': escape[1] = '\\'; break;
+            case '\b': escape[1] = 'b'; break;
+            case '\f': escape[1] = 'f'; break;
+            case '\n': escape[1] = 'n'; break;
+            case '\r': escape[1] = 'r'; break;
+            case '\t': escape[1] = 't'; break;
+            default:
+                escape[1] = 'u';
+                escape[2] = '0';
+                escape[3] = '0';
+                escape[4] = LOG_ENCODE_HEX_DIGITS[byte >> 4];
+                escape[5] = LOG_ENCODE_HEX_DIGITS[byte & 0xF];
+                escape_length = 6;
+                break;
+        }
+        write_log_encoder_bytes(encoder, escape, escape_length);
+    }
+}
+
+void log_encoder_init(LogEncoder * encoder, char * buffer, size_t capacity) {
+    encoder->buffer = buffer;
+    encoder->capacity = buffer ? capacity : 0;
+    encoder->length = 0;
+}
+
+void log_encode_json_string(LogEncoder * encoder, const char * text, size_t length) {
+    write_log_encoder_bytes(encoder, "\"", 1);
+    write_log_escaped(encoder, text, length);
+    write_log_encoder_bytes(encoder, "\"", 1);
+}
+
+void log_encode_logfmt_value(LogEncoder * encoder, const char * text, size_t length) {
+    bool quoted = length == 0 || memchr(text, ' ', length) || memchr(text, '=', length) || find_log_escape(text, length) < length;
+    if (quoted)
+        log_encode_json_string(encoder, text, length);
+    else
+        write_log_encoder_bytes(encoder, text, length);
+}
+
+/**
+ * @brief Helper function to append a field's value, in JSON or logfmt.
+ */
+static void write_log_field_value(LogEncoder * encoder, bool json, const LogField * field) {
+    switch (field->type) {
+        case LOG_FIELD_TYPE_STRING: {
+            const char * string = field->string ? field->string : "";
+            if (json)
+                log_encode_json_string(encoder, string, strlen(string));
+            else
+                log_encode_logfmt_value(encoder, string, strlen(string));
+            break;
+        }
+        case LOG_FIELD_TYPE_INTEGER:
+            write_log_encoder_integer(encoder, field->integer < 0 ? 0 - (uint64_t)field->integer : (uint64_t)field->integer, field->integer < 0);
+            break;
+        case LOG_FIELD_TYPE_UNSIGNED:
+            write_log_encoder_integer(encoder, field->unsigned_integer, false);
+            break;
+        case LOG_FIELD_TYPE_FLOAT:
+            if (json && !isfinite(field->floating))
+                write_log_encoder_string(encoder, "null");
+            else
+                write_log_encoder_float(encoder, field->floating);
+            break;
+        case LOG_FIELD_TYPE_BOOLEAN:
+            write_log_encoder_string(encoder, field->boolean ? "true" : "false");
+            break;
+    }
+}
+
+void log_encode_fields(LogEncoder * encoder, LOG_ENCODING encoding, const LogField * fields, size_t count) {
+    bool json = encoding == LOG_ENCODING_JSON;
+    for (size_t index = 0; index < count; index++) {
+        size_t field_start = encoder->length;
+        const LogField * field = &fields[index];
+        if (json) {
+            write_log_encoder_bytes(encoder, ",", 1);
+            log_encode_json_string(encoder, field->key, strlen(field->key));
+            write_log_encoder_bytes(encoder, ":", 1);
+        } else {
+            write_log_encoder_bytes(encoder, " ", 1);
+            write_log_encoder_string(encoder, field->key);
+            write_log_encoder_bytes(encoder, "=", 1);
+        }
+        write_log_field_value(encoder, json, field);
+
+        if (encoder->length > encoder->capacity) {
+            encoder->length = field_start;
+            break;
+        }
+    }
+}
+
+size_t log_encode_time_length(LOG_ENCODING encoding) {
+    return encoding == LOG_ENCODING_JSON ? sizeof("{\"time\":\"\"") - 1 + TIME_UTC_TIMESTAMP_LENGTH : sizeof("time=") - 1 + TIME_UTC_TIMESTAMP_LENGTH;
+}
+
+void log_encode_record(LogEncoder * encoder, LOG_ENCODING encoding, uint64_t wall_ns, LOG_LEVEL level, const char * func, const char * file, int line,
+    const char * message, size_t message_length, const char * fields, size_t fields_length) {
+    char timestamp[TIME_UTC_TIMESTAMP_LENGTH + 1];
+    time_format_utc(wall_ns, timestamp);
+
+    if (encoding == LOG_ENCODING_JSON) {
+        write_log_encoder_bytes(encoder, "{\"time\":\"", 9);
+        write_log_encoder_bytes(encoder, timestamp, TIME_UTC_TIMESTAMP_LENGTH);
+        write_log_encoder_bytes(encoder, "\",\"level\":\"", 11);
+        write_log_encoder_string(encoder, log_level_to_string(level));
+        write_log_encoder_bytes(encoder, "\",\"func\":", 9);
+        log_encode_json_string(encoder, func, strlen(func));
+        write_log_encoder_bytes(encoder, ",\"file\":", 8);
+        log_encode_json_string(encoder, file, strlen(file));
+        write_log_encoder_bytes(encoder, ",\"line\":", 8);
+        write_log_encoder_integer(encoder, line < 0 ? 0 - (uint64_t)line : (uint64_t)line, line < 0);
+        write_log_encoder_bytes(encoder, ",\"message\":", 11);
+        log_encode_json_string(encoder, message, message_length);
+        if (fields_length)
+            write_log_encoder_bytes(encoder, fields, fields_length);
+        write_log_encoder_bytes(encoder, "}\n", 2);
+    } else {
+        write_log_encoder_bytes(encoder, "time=", 5);
+        write_log_encoder_bytes(encoder, timestamp, TIME_UTC_TIMESTAMP_LENGTH);
+        write_log_encoder_bytes(encoder, " level=", 7);
+        write_log_encoder_string(encoder, log_level_to_string(level));
+        write_log_encoder_bytes(encoder, " func=", 6);
+        log_encode_logfmt_value(encoder, func, strlen(func));
+        write_log_encoder_bytes(encoder, " file=", 6);
+        log_encode_logfmt_value(encoder, file, strlen(file));
+        write_log_encoder_bytes(encoder, " line=", 6);
+        write_log_encoder_integer(encoder, line < 0 ? 0 - (uint64_t)line : (uint64_t)line, line < 0);
+        write_log_encoder_bytes(encoder, " message=", 9);
+        log_encode_logfmt_value(encoder, message, message_length);
+        if (fields_length)
+            write_log_encoder_bytes(encoder, fields, fields_length);
+        write_log_encoder_bytes(encoder, "\n", 1);
+    }
+}
@@ -0,0 +1,293 @@
+#include "core/log_file.h"
+#include "core/context.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if OS_WINDOWS
+    #include <io.h>
+    #include <fcntl.h>
+    #include <sys/stat.h>
+#else
+    #include <errno.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+#define LOG_FILE_ROTATE_SUFFIX_BYTES 16
+
+/**
+ * @brief Helper function to open a log file for writing.
+ *
+ * @param path The path of the file.
+ * @param truncate true to empty the file, false to append to it.
+ * @return int The file descriptor, or -1 on failure.
+ */
+static int open_log_file(const char * path, bool truncate) {
+#if OS_WINDOWS
+    return _open(path, _O_WRONLY | _O_CREAT | _O_BINARY | (truncate ? _O_TRUNC : _O_APPEND), _S_IREAD | _S_IWRITE);
+#else
+    return open(path, O_WRONLY | O_CREAT | O_CLOEXEC | (truncate ? O_TRUNC : O_APPEND), 0644);
+#endif
+}
+
+/**
+ * @brief Helper function to get the size of an open file.
+ */
+static uint64_t get_log_file_size(int file) {
+#if OS_WINDOWS
+    long long size = _lseeki64(file, 0, SEEK_END);
+#else
+    off_t size = lseek(file, 0, SEEK_END);
+#endif
+    return size > 0 ? (uint64_t)size : 0;
+}
+
+/**
+ * @brief Helper function to write all bytes, retrying partial and interrupted writes. Errors drop the rest.
+ */
+static void write_log_file_bytes(int file, const char * data, size_t length) {
+    while (length > 0) {
+#if OS_WINDOWS
+        int written = _write(file, data, length > 0x40000000 ? 0x40000000 : (unsigned int)length);
+        if (written <= 0)
+            return;
+#else
+        ssize_t written = write(file, data, length);
+        if (written < 0 && errno == EINTR)
+            continue;
+        if (written <= 0)
+            return;
+#endif
+        data += written;
+        length -= (size_t)written;
+    }
+}
+
+/**
+ * @brief Helper function to ask the OS to put the written data of a file on disk.
+ */
+static void sync_log_file(int file) {
+#if OS_WINDOWS
+    _commit(file);
+#elif OS_MAC || OS_IOS
+    fsync(file);
+#else
+    fdatasync(file);
+#endif
+}
+
+/**
+ * @brief Helper function to close a file.
+ */
+static void close_log_file(int file) {
+#if OS_WINDOWS
+    _close(file);
+#else
+    close(file);
+#endif
+}
+
+/**
+ * @brief Helper function to get the wall clock in milliseconds.
+ */
+static uint64_t get_log_file_milliseconds(void) {
+    struct timespec now;
+    timespec_get(&now, TIME_UTC);
+    return (uint64_t)now.tv_sec * 1000 + (uint64_t)now.tv_nsec / 1000000;
+}
+
+/**
+ * @brief Helper function to move the current file to path.1, shifting older files up and deleting the oldest, and open a new one.
+ *
+ * Only called by the thread that owns the file.
+ *
+ * @param sink The sink.
+ */
+static void rotate_log_file(LogFileSink * sink) {
+    if (sink->file >= 0) {
+        if (sink->options.sync_policy != LOG_FILE_SYNC_NEVER)
+            sync_log_file(sink->file);
+        close_log_file(sink->file);
+    }
+
+    unsigned int keep_count = sink->options.keep_count;
+    if (keep_count) {
+        size_t capacity = strlen(sink->path) + LOG_FILE_ROTATE_SUFFIX_BYTES;
+        char * source = sink->rotate_path;
+        char * destination = sink->rotate_path + capacity;
+        snprintf(destination, capacity, "%s.%u", sink->path, keep_count);
+        remove(destination);
+        for (unsigned int index = keep_count - 1; index > 0; index--) {
+            snprintf(source, capacity, "%s.%u", sink->path, index);
+            snprintf(destination, capacity, "%s.%u", sink->path, index + 1);
+            rename(source, destination);
+        }
+        snprintf(destination, capacity, "%s.1", sink->path);
+        rename(sink->path, destination);
+    }
+
+    sink->file = open_log_file(sink->path, true);
+    sink->file_size = 0;
+    sink->file_opened = (uint64_t)time(NULL);
+}
+
+/**
+ * @brief Helper function to write bytes to the file, rotating it first when they would make it too large or it is too old.
+ *
+ * Only called by the thread that owns the file.
+ *
+ * @param sink The sink.
+ * @param data The bytes.
+ * @param length Number of bytes.
+ */
+static void write_log_file(LogFileSink * sink, const char * data, size_t length) {
+    const LogFileSinkOptions * options = &sink->options;
+    bool too_large = options->rotate_size && sink->file_size > 0 && sink->file_size + length > options->rotate_size;
+    bool too_old = options->rotate_interval && (uint64_t)time(NULL) >= sink->file_opened + options->rotate_interval;
+    if (sink->file < 0) {
+        // Opening the file failed at the last rotation, try again without rotating.
+        sink->file = open_log_file(sink->path, false);
+        if (sink->file < 0)
+            return;
+        sink->file_size = get_log_file_size(sink->file);
+    } else if (too_large || too_old) {
+        rotate_log_file(sink);
+        if (sink->file < 0)
+            return;
+    }
+    write_log_file_bytes(sink->file, data, length);
+    sink->file_size += length;
+}
+
+/**
+ * @brief Helper function to write the buffered lines, then an optional line too long for the buffer.
+ *
+ * Called with the lock held and returns with it held. The buffer is swapped for the spare one and
+ * written with the lock released, so other threads keep appending while the file is written,
+ * synced or rotated. Waits first if another thread is writing, which keeps lines in order.
+ *
+ * @param sink The sink.
+ * @param extra A line to write after the buffered ones, or NULL.
+ * @param extra_length Number of bytes in extra.
+ * @param sync true to sync the file after writing, whatever the policy.
+ */
+static void write_log_file_buffer(LogFileSink * sink, const char * extra, size_t extra_length, bool sync) {
+    while (sink->writing) {
+        mutex_unlock(&sink->lock);
+        thread_yield();
+        mutex_lock(&sink->lock);
+    }
+    if (!sink->used && !extra_length && !sync)
+        return;
+
+    char * full = sink->buffer;
+    size_t length = sink->used;
+    sink->buffer = sink->spare;
+    sink->spare = NULL;
+    sink->used = 0;
+    sink->flush_deadline = 0;
+    sink->writing = true;
+    mutex_unlock(&sink->lock);
+
+    if (length)
+        write_log_file(sink, full, length);
+    if (extra_length)
+        write_log_file(sink, extra, extra_length);
+    if ((sync || sink->options.sync_policy == LOG_FILE_SYNC_ALWAYS) && sink->file >= 0)
+        sync_log_file(sink->file);
+
+    mutex_lock(&sink->lock);
+    sink->spare = full;
+    sink->writing = false;
+}
+
+/**
+ * @brief Helper function implementing LogSink write, appends a line to the buffer.
+ */
+static void write_log_file_line(LogSink * base, const LogLine * line) {
+    LogFileSink * sink = (LogFileSink *)base;
+    const LogFileSinkOptions * options = &sink->options;
+    bool urgent = options->sync_policy >= LOG_FILE_SYNC_ON_ERROR && line->level >= LOG_LEVEL_ERROR;
+    uint64_t now = options->flush_interval ? get_log_file_milliseconds() : 0;
+
+    mutex_lock(&sink->lock);
+    while (sink->used + line->length > options->buffer_size) {
+        if (line->length > options->buffer_size) {
+            write_log_file_buffer(sink, line->text, line->length, urgent);
+            mutex_unlock(&sink->lock);
+            return;
+        }
+        write_log_file_buffer(sink, NULL, 0, false);
+    }
+
+    memcpy(sink->buffer + sink->used, line->text, line->length);
+    sink->used += line->length;
+    if (options->flush_interval && !sink->flush_deadline)
+        sink->flush_deadline = now + options->flush_interval;
+
+    if (urgent || (sink->flush_deadline && now >= sink->flush_deadline))
+        write_log_file_buffer(sink, NULL, 0, urgent);
+    mutex_unlock(&sink->lock);
+}
+
+/**
+ * @brief Helper function implementing LogSink flush.
+ */
+static void flush_log_file(LogSink * base) {
+    LogFileSink * sink = (LogFileSink *)base;
+    mutex_lock(&sink->lock);
+    write_log_file_buffer(sink, NULL, 0, false);
+    mutex_unlock(&sink->lock);
+}
+
+bool log_file_sink_open(LogFileSink * sink, const char * path, const LogFileSinkOptions * options) {
+    memset(sink, 0, sizeof(*sink));
+    if (options)
+        sink->options = *options;
+    if (!sink->options.buffer_size)
+        sink->options.buffer_size = LOG_FILE_DEFAULT_BUFFER_SIZE;
+
+    size_t path_length = strlen(path);
+    sink->path = (char *)malloc(path_length + 1);
+    sink->rotate_path = (char *)malloc(2 * (path_length + LOG_FILE_ROTATE_SUFFIX_BYTES));
+    sink->buffer = (char *)malloc(sink->options.buffer_size);
+    sink->spare = (char *)malloc(sink->options.buffer_size);
+    sink->file = open_log_file(path, false);
+    if (!sink->path || !sink->rotate_path || !sink->buffer || !sink->spare || sink->file < 0) {
+        if (sink->file >= 0)
+            close_log_file(sink->file);
+        free(sink->path);
+        free(sink->rotate_path);
+        free(sink->buffer);
+        free(sink->spare);
+        return false;
+    }
+    memcpy(sink->path, path, path_length + 1);
+    sink->file_size = get_log_file_size(sink->file);
+    sink->file_opened = (uint64_t)time(NULL);
+    mutex_init(&sink->lock);
+
+    sink->sink.write = write_log_file_line;
+    sink->sink.flush = flush_log_file;
+    sink->sink.minimum_level = LOG_LEVEL_DEBUG;
+    return true;
+}
+
+void log_file_sink_close(LogFileSink * sink) {
+    mutex_lock(&sink->lock);
+    write_log_file_buffer(sink, NULL, 0, sink->options.sync_policy != LOG_FILE_SYNC_NEVER);
+    mutex_unlock(&sink->lock);
+
+    if (sink->file >= 0)
+        close_log_file(sink->file);
+    sink->file = -1;
+    mutex_destroy(&sink->lock);
+    free(sink->path);
+    free(sink->rotate_path);
+    free(sink->buffer);
+    free(sink->spare);
+    sink->path = sink->rotate_path = sink->buffer = sink->spare = NULL;
+}
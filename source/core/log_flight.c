@@ -0,0 +1,341 @@
+#include "core/log_flight.h"
+#include "core/format.h"
+#include "core/thread.h"
+#include "core/time.h"
+#include <signal.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <string.h>
+
+#if OS_WINDOWS
+    #include <io.h>
+    #include <fcntl.h>
+    #include <sys/stat.h>
+#else
+    #include <errno.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+#define LOG_FLIGHT_LINE_BYTES 512
+#define LOG_FLIGHT_FREE 0
+#define LOG_FLIGHT_TAKEN 1
+
+/**
+ * @brief One recorded log call.
+ */
+typedef struct LogFlightRecord {
+    uint64_t ticks;                     /** time_ticks of the call. */
+    const char * func;                  /** Function of the call. */
+    const char * file;                  /** File of the call. */
+    int line;                           /** Line of the call. */
+    uint32_t thread;                    /** Number of the recording thread, from 1 in the order threads first logged. */
+    uint16_t level;                     /** Severity of the message. */
+    uint16_t length;                    /** Bytes of text in use. */
+    const char * literal;               /** The message if it is a string literal, NULL if it was copied to text. */
+    char text[LOG_FLIGHT_TEXT_BYTES];   /** The message, not terminated. */
+} LogFlightRecord;
+
+/**
+ * @brief A thread's records, written only by the thread that took it.
+ */
+typedef struct LogFlightRing {
+    atomic_int state;                               /** LOG_FLIGHT_FREE or LOG_FLIGHT_TAKEN. */
+    atomic_uint_least64_t position;                 /** Records written so far, the next goes to position % LOG_FLIGHT_RECORDS. */
+    LogFlightRecord records[LOG_FLIGHT_RECORDS];    /** The latest records. */
+} LogFlightRing;
+
+static LogFlightRing log_flight_rings[LOG_FLIGHT_MAX_THREADS];
+static Once log_flight_once = ONCE_INITIALIZER;
+static atomic_uint log_flight_thread_count;
+static atomic_flag log_flight_crashed = ATOMIC_FLAG_INIT;
+static char log_flight_path[LOG_FLIGHT_PATH_BYTES];
+static THREAD_LOCAL LogFlightRing * log_flight_thread_ring;
+static THREAD_LOCAL uint32_t log_flight_thread_number;
+
+#if OS_WINDOWS
+static const int LOG_FLIGHT_SIGNALS[] = { SIGSEGV, SIGILL, SIGFPE, SIGABRT };
+static void (*log_flight_previous_handlers[sizeof(LOG_FLIGHT_SIGNALS) / sizeof(LOG_FLIGHT_SIGNALS[0])])(int);
+static DWORD log_flight_key;
+#else
+static const int LOG_FLIGHT_SIGNALS[] = { SIGSEGV, SIGBUS, SIGILL, SIGFPE, SIGABRT };
+static struct sigaction log_flight_previous_handlers[sizeof(LOG_FLIGHT_SIGNALS) / sizeof(LOG_FLIGHT_SIGNALS[0])];
+static pthread_key_t log_flight_key;
+#endif
+
+#define LOG_FLIGHT_SIGNAL_COUNT (sizeof(LOG_FLIGHT_SIGNALS) / sizeof(LOG_FLIGHT_SIGNALS[0]))
+
+/**
+ * @brief Helper function to dump the records on a crash signal, then hand the signal to the handler that was there before.
+ *
+ * A fault happens again once the handler returns, an abort has to be raised again.
+ */
+static void handle_log_flight_signal(int signal_number) {
+    log_flight_crash();
+    for (size_t index = 0; index < LOG_FLIGHT_SIGNAL_COUNT; index++) {
+        if (LOG_FLIGHT_SIGNALS[index] != signal_number)
+            continue;
+#if OS_WINDOWS
+        signal(signal_number, log_flight_previous_handlers[index]);
+#else
+        sigaction(signal_number, &log_flight_previous_handlers[index], NULL);
+#endif
+    }
+    if (signal_number == SIGABRT)
+        raise(signal_number);
+}
+
+/**
+ * @brief Helper function to give a thread's ring back when the thread exits, its records stay until another thread takes it.
+ */
+#if OS_WINDOWS
+static VOID WINAPI release_log_flight_ring(PVOID ring) {
+#else
+static void release_log_flight_ring(void * ring) {
+#endif
+    if (ring)
+        atomic_store_explicit(&((LogFlightRing *)ring)->state, LOG_FLIGHT_FREE, memory_order_release);
+}
+
+static void initialize_log_flight(void) {
+    // Calibrate the clock now, so the dump only reads the frequency.
+    time_ticks_per_second();
+#if OS_WINDOWS
+    log_flight_key = FlsAlloc(release_log_flight_ring);
+    for (size_t index = 0; index < LOG_FLIGHT_SIGNAL_COUNT; index++)
+        log_flight_previous_handlers[index] = signal(LOG_FLIGHT_SIGNALS[index], handle_log_flight_signal);
+#else
+    pthread_key_create(&log_flight_key, release_log_flight_ring);
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = handle_log_flight_signal;
+    action.sa_flags = SA_ONSTACK;
+    sigemptyset(&action.sa_mask);
+    for (size_t index = 0; index < LOG_FLIGHT_SIGNAL_COUNT; index++)
+        sigaction(LOG_FLIGHT_SIGNALS[index], &action, &log_flight_previous_handlers[index]);
+#endif
+}
+
+/**
+ * @brief Helper function to take a free ring for the calling thread, once per thread.
+ *
+ * @return LogFlightRing* The ring, or NULL if every ring was taken when the thread first logged.
+ */
+static LogFlightRing * take_log_flight_ring(void) {
+    if (log_flight_thread_number)
+        return NULL;
+    thread_once(&log_flight_once, initialize_log_flight);
+    log_flight_thread_number = atomic_fetch_add_explicit(&log_flight_thread_count, 1, memory_order_relaxed) + 1;
+    for (size_t index = 0; index < LOG_FLIGHT_MAX_THREADS; index++) {
+        LogFlightRing * ring = &log_flight_rings[index];
+        int expected = LOG_FLIGHT_FREE;
+        if (atomic_load_explicit(&ring->state, memory_order_relaxed) == LOG_FLIGHT_FREE &&
+            atomic_compare_exchange_strong_explicit(&ring->state, &expected, LOG_FLIGHT_TAKEN, memory_order_acquire, memory_order_relaxed)) {
+#if OS_WINDOWS
+            FlsSetValue(log_flight_key, ring);
+#else
+            pthread_setspecific(log_flight_key, ring);
+#endif
+            log_flight_thread_ring = ring;
+            return ring;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Helper function to fill in a record whose text is written and publish it to dumps.
+ */
+static inline void commit_log_flight_record(LogFlightRing * ring, uint64_t position, LOG_LEVEL level, const char * func, const char * file, int line,
+    const char * literal, size_t length) {
+    LogFlightRecord * record = &ring->records[position & (LOG_FLIGHT_RECORDS - 1)];
+    record->ticks = time_ticks();
+    record->literal = literal;
+    record->func = func;
+    record->file = file;
+    record->line = line;
+    record->thread = log_flight_thread_number;
+    record->level = (uint16_t)level;
+    record->length = (uint16_t)length;
+    atomic_store_explicit(&ring->position, position + 1, memory_order_release);
+}
+
+void log_flight_record(LOG_LEVEL level, const char * func, const char * file, int line, const char * message) {
+    LogFlightRing * ring = log_flight_thread_ring;
+    if (!ring && !(ring = take_log_flight_ring()))
+        return;
+    uint64_t position = atomic_load_explicit(&ring->position, memory_order_relaxed);
+    char * text = ring->records[position & (LOG_FLIGHT_RECORDS - 1)].text;
+    const char * end = (const char *)memchr(message, '\0', LOG_FLIGHT_TEXT_BYTES);
+    size_t length = end ? (size_t)(end - message) : LOG_FLIGHT_TEXT_BYTES;
+    memcpy(text, message, length);
+    commit_log_flight_record(ring, position, level, func, file, line, NULL, length);
+}
+
+void log_flight_record_literal(LOG_LEVEL level, const char * func, const char * file, int line, const char * message) {
+    LogFlightRing * ring = log_flight_thread_ring;
+    if (!ring && !(ring = take_log_flight_ring()))
+        return;
+    uint64_t position = atomic_load_explicit(&ring->position, memory_order_relaxed);
+    commit_log_flight_record(ring, position, level, func, file, line, message, 0);
+}
+
+void log_flight_record_va(LOG_LEVEL level, const char * func, const char * file, int line, const char * format, va_list arguments) {
+    LogFlightRing * ring = log_flight_thread_ring;
+    if (!ring && !(ring = take_log_flight_ring()))
+        return;
+    uint64_t position = atomic_load_explicit(&ring->position, memory_order_relaxed);
+    char * text = ring->records[position & (LOG_FLIGHT_RECORDS - 1)].text;
+    va_list copy;
+    va_copy(copy, arguments);
+    size_t length = format_string_va(text, LOG_FLIGHT_TEXT_BYTES, format, copy);
+    va_end(copy);
+    if (length >= LOG_FLIGHT_TEXT_BYTES)
+        length = LOG_FLIGHT_TEXT_BYTES - 1;
+    commit_log_flight_record(ring, position, level, func, file, line, NULL, length);
+}
+
+void log_flight_set_path(const char * path) {
+    size_t length = path ? strlen(path) : 0;
+    if (length >= sizeof(log_flight_path))
+        return;
+    if (length)
+        memcpy(log_flight_path, path, length);
+    log_flight_path[length] = '\0';
+}
+
+/**
+ * @brief Helper function to write bytes to a descriptor, retrying partial and interrupted writes. Errors drop the rest.
+ */
+static void write_log_flight_bytes(int descriptor, const char * data, size_t length) {
+    while (length > 0) {
+#if OS_WINDOWS
+        int written = _write(descriptor, data, (unsigned int)length);
+        if (written <= 0)
+            return;
+#else
+        ssize_t written = write(descriptor, data, length);
+        if (written < 0 && errno == EINTR)
+            continue;
+        if (written <= 0)
+            return;
+#endif
+        data += written;
+        length -= (size_t)written;
+    }
+}
+
+/**
+ * @brief Helper function to append bytes to a dump line, as many as fit.
+ */
+static size_t append_log_flight_text(char * line, size_t length, const char * text, size_t text_length) {
+    size_t room = LOG_FLIGHT_LINE_BYTES - 1 - length;
+    if (text_length > room)
+        text_length = room;
+    memcpy(line + length, text, text_length);
+    return length + text_length;
+}
+
+/**
+ * @brief Helper function to append a terminated string to a dump line, read no further than LOG_FLIGHT_LINE_BYTES.
+ */
+static size_t append_log_flight_string(char * line, size_t length, const char * text) {
+    if (!text)
+        return length;
+    const char * end = (const char *)memchr(text, '\0', LOG_FLIGHT_LINE_BYTES);
+    return append_log_flight_text(line, length, text, end ? (size_t)(end - text) : LOG_FLIGHT_LINE_BYTES);
+}
+
+/**
+ * @brief Helper function to append a decimal number to a dump line, snprintf is not async-signal-safe.
+ */
+static size_t append_log_flight_number(char * line, size_t length, uint64_t value) {
+    char digits[20];
+    size_t count = 0;
+    do {
+        digits[sizeof(digits) - 1 - count++] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value);
+    return append_log_flight_text(line, length, digits + sizeof(digits) - count, count);
+}
+
+size_t log_flight_dump(int descriptor) {
+    static const char HEADER[] = "Flight recorder, latest log records of every thread, oldest first:\n";
+    uint64_t now = time_ticks();
+    // Read at dump time, the frequency is refined while the process runs.
+    uint64_t ticks_per_us = time_ticks_per_second() / 1000000;
+    if (!ticks_per_us)
+        ticks_per_us = 1;
+    uint64_t cursors[LOG_FLIGHT_MAX_THREADS];
+    uint64_t ends[LOG_FLIGHT_MAX_THREADS];
+    for (size_t index = 0; index < LOG_FLIGHT_MAX_THREADS; index++) {
+        ends[index] = atomic_load_explicit(&log_flight_rings[index].position, memory_order_acquire);
+        cursors[index] = ends[index] > LOG_FLIGHT_RECORDS ? ends[index] - LOG_FLIGHT_RECORDS : 0;
+    }
+    write_log_flight_bytes(descriptor, HEADER, sizeof(HEADER) - 1);
+
+    // Merge the rings by time, each is in order already.
+    size_t count = 0;
+    for (;;) {
+        const LogFlightRecord * oldest = NULL;
+        size_t oldest_ring = 0;
+        for (size_t index = 0; index < LOG_FLIGHT_MAX_THREADS; index++) {
+            if (cursors[index] == ends[index])
+                continue;
+            const LogFlightRecord * record = &log_flight_rings[index].records[cursors[index] & (LOG_FLIGHT_RECORDS - 1)];
+            if (!oldest || record->ticks < oldest->ticks) {
+                oldest = record;
+                oldest_ring = index;
+            }
+        }
+        if (!oldest)
+            break;
+        cursors[oldest_ring]++;
+
+        char line[LOG_FLIGHT_LINE_BYTES];
+        size_t length = append_log_flight_text(line, 0, "  -", 3);
+        length = append_log_flight_number(line, length, oldest->ticks < now ? (now - oldest->ticks) / ticks_per_us : 0);
+        length = append_log_flight_text(line, length, " us [thread ", 12);
+        length = append_log_flight_number(line, length, oldest->thread);
+        length = append_log_flight_text(line, length, "] [", 3);
+        length = append_log_flight_string(line, length, log_level_to_string((LOG_LEVEL)oldest->level));
+        length = append_log_flight_text(line, length, "] (", 3);
+        length = append_log_flight_string(line, length, oldest->func);
+        length = append_log_flight_text(line, length, ": ", 2);
+        length = append_log_flight_string(line, length, oldest->file);
+        length = append_log_flight_text(line, length, ":", 1);
+        length = append_log_flight_number(line, length, (uint64_t)(oldest->line > 0 ? oldest->line : 0));
+        length = append_log_flight_text(line, length, ") ", 2);
+        if (oldest->literal)
+            length = append_log_flight_string(line, length, oldest->literal);
+        else
+            length = append_log_flight_text(line, length, oldest->text, oldest->length < LOG_FLIGHT_TEXT_BYTES ? oldest->length : LOG_FLIGHT_TEXT_BYTES);
+        line[length++] = '\n';
+        write_log_flight_bytes(descriptor, line, length);
+        count++;
+    }
+    return count;
+}
+
+void log_flight_crash(void) {
+    if (atomic_flag_test_and_set(&log_flight_crashed))
+        return;
+    int descriptor = 2;
+    if (log_flight_path[0]) {
+#if OS_WINDOWS
+        int file = _open(log_flight_path, _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY, _S_IREAD | _S_IWRITE);
+#else
+        int file = open(log_flight_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+#endif
+        if (file >= 0)
+            descriptor = file;
+    }
+    log_flight_dump(descriptor);
+    if (descriptor != 2) {
+#if OS_WINDOWS
+        _close(descriptor);
+#else
+        close(descriptor);
+#endif
+    }
+}
@@ -0,0 +1,41 @@
+#include "core/log_limit.h"
+#include "core/time.h"
+#include <stdarg.h>
+
+static atomic_uint_least64_t log_rate_limited;
+
+bool log_rate_limit_acquire(LogRateLimit * limit) {
+    uint64_t now = time_now_coarse_ns();
+    uint64_t next = atomic_load_explicit(&limit->next_ns, memory_order_relaxed);
+    for (;;) {
+        // The bucket is empty once the next free slot is a whole burst ahead of now.
+        uint64_t start = next > now ? next : now;
+        if (start + limit->interval_ns - now > limit->burst_ns) {
+            // The only atomic write of a flood, the global total is added to with the summary.
+            atomic_fetch_add_explicit(&limit->suppressed, 1, memory_order_relaxed);
+            return false;
+        }
+        if (atomic_compare_exchange_weak_explicit(&limit->next_ns, &next, start + limit->interval_ns, memory_order_relaxed, memory_order_relaxed))
+            return true;
+    }
+}
+
+void log_limited_to_console(LogRateLimit * limit, LOG_LEVEL level, const char * func, const char * file, int line, const char * format, ...) {
+    // A plain load keeps the common case, nothing suppressed, free of a second atomic write.
+    if (atomic_load_explicit(&limit->suppressed, memory_order_relaxed)) {
+        uint64_t suppressed = atomic_exchange_explicit(&limit->suppressed, 0, memory_order_relaxed);
+        if (suppressed) {
+            atomic_fetch_add_explicit(&log_rate_limited, suppressed, memory_order_relaxed);
+            log_format_to_console(level, func, file, line, "Suppressed %llu messages from this call site.", (unsigned long long)suppressed);
+        }
+    }
+
+    va_list arguments;
+    va_start(arguments, format);
+    log_format_to_console_va(level, func, file, line, format, arguments);
+    va_end(arguments);
+}
+
+uint64_t log_rate_limited_count(void) {
+    return atomic_load_explicit(&log_rate_limited, memory_order_relaxed);
+}
@@ -0,0 +1,120 @@
+#include "core/pool.h"
+#include "core/debug.h"
+#include <string.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+/**
+ * @def POOL_SLAB_HEADER_SIZE
+ * @brief Size of the slab header, rounded up so the first slot is POOL_SLOT_ALIGNMENT aligned.
+ */
+#define POOL_SLAB_HEADER_SIZE ((sizeof(PoolSlab) + POOL_SLOT_ALIGNMENT - 1) & ~(size_t)(POOL_SLOT_ALIGNMENT - 1))
+
+/**
+ * @brief Helper function to check that a free slot still holds its poison past the free-list link.
+ * 
+ * @param pool The pool the slot belongs to.
+ * @param slot The free slot.
+ * @return true if the poison is intact,
+ * @return false if the slot was written after it was freed.
+ */
+static bool is_pool_slot_poison_intact(const Pool * pool, const void * slot) {
+    const uint8_t * bytes = (const uint8_t *)slot;
+    for (size_t index = sizeof(void *); index < pool->slot_size; index++) {
+        if (bytes[index] != DEBUG_MEMORY_FREE_VALUE)
+            return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Helper function to allocate a new slab and make it the bump region.
+ * 
+ * @param pool The pool to grow.
+ * @return true if the slab was allocated,
+ * @return false on failure.
+ */
+static bool grow_pool(Pool * pool) {
+    PoolSlab * slab = (PoolSlab *)malloc(POOL_SLAB_HEADER_SIZE + pool->stride * pool->slots_per_slab);
+    if (!slab)
+        return false;
+
+    slab->next = pool->slabs;
+    pool->slabs = slab;
+    pool->bump = (unsigned char *)slab + POOL_SLAB_HEADER_SIZE;
+    pool->bump_end = pool->bump + pool->stride * pool->slots_per_slab;
+    return true;
+}
+
+void pool_init(Pool * pool, size_t slot_size, size_t slots_per_slab) {
+    // A free slot must be able to hold the free-list link.
+    if (slot_size < sizeof(void *))
+        slot_size = sizeof(void *);
+
+    pool->free_list = NULL;
+    pool->bump = NULL;
+    pool->bump_end = NULL;
+    pool->slabs = NULL;
+    pool->slot_size = slot_size;
+    pool->stride = (slot_size + POOL_SLOT_ALIGNMENT - 1) & ~(size_t)(POOL_SLOT_ALIGNMENT - 1);
+    pool->slots_per_slab = slots_per_slab ? slots_per_slab : POOL_DEFAULT_SLOTS_PER_SLAB;
+    pool->count = 0;
+    pool->debug = false;
+}
+
+void pool_init_debug(Pool * pool, size_t slot_size, size_t slots_per_slab) {
+    pool_init(pool, slot_size, slots_per_slab);
+    pool->stride = (pool->slot_size + DEBUG_MEMORY_GUARD_SIZE + POOL_SLOT_ALIGNMENT - 1) & ~(size_t)(POOL_SLOT_ALIGNMENT - 1);
+    pool->debug = true;
+}
+
+void pool_destroy(Pool * pool) {
+    PoolSlab * slab = pool->slabs;
+    while (slab) {
+        PoolSlab * next = slab->next;
+        free(slab);
+        slab = next;
+    }
+    pool->free_list = NULL;
+    pool->bump = NULL;
+    pool->bump_end = NULL;
+    pool->slabs = NULL;
+    pool->count = 0;
+}
+
+void * pool_alloc(Pool * pool) {
+    void * slot = pool->free_list;
+    if (slot) {
+        // Recycle the most recently freed slot, it is the most likely to still be in cache.
+        memcpy(&pool->free_list, slot, sizeof(void *));
+        if (pool->debug && !is_pool_slot_poison_intact(pool, slot))
+            LOG_CONSOLE_ERROR("Pool slot was written after it was freed.");
+    } else {
+        // Carve a never-used slot from the newest slab, growing the pool when it is exhausted.
+        if (pool->bump == pool->bump_end && !grow_pool(pool))
+            return NULL;
+        slot = pool->bump;
+        pool->bump += pool->stride;
+    }
+
+    if (pool->debug) {
+        memset(slot, DEBUG_MEMORY_INIT_VALUE, pool->slot_size);
+        set_memory_guard_bytes(slot, pool->slot_size);
+    }
+    pool->count++;
+    return slot;
+}
+
+void pool_free(Pool * pool, void * slot) {
+    if (!slot) return;
+
+    if (pool->debug) {
+        if (!is_memory_guard_intact(slot, pool->slot_size))
+            LOG_CONSOLE_ERROR("Buffer overrun detected before pool free.");
+        memset(slot, DEBUG_MEMORY_FREE_VALUE, pool->slot_size);
+    }
+
+    memcpy(slot, &pool->free_list, sizeof(void *));
+    pool->free_list = slot;
+    pool->count--;
+}
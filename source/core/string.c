@@ -1,6 +1,47 @@
 #include "core/string.h"
+#include "core/context.h"
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
 
-int string_compare(const char * string_one, const char * string_two) {
+#if ARCH_X64
+    #include <immintrin.h>
+#elif ARCH_ARM64
+    #include <arm_neon.h>
+#endif
+
+#if COMPILER_CL
+    #include <intrin.h>
+#endif
+
+#define STRING_PAGE_SIZE 4096
+#define STRING_BUILDER_MINIMUM_CAPACITY 64
+
+/**
+ * Vector loads may read bytes past the terminator, never past its page. Sanitizers would report
+ * them, the SIMD functions are left out of their instrumentation.
+ */
+#if COMPILER_CL
+    #define STRING_TARGET_AVX2
+    #define STRING_NO_SANITIZE
+#else
+    #define STRING_TARGET_AVX2 __attribute__((target("avx2")))
+    #define STRING_NO_SANITIZE __attribute__((no_sanitize_address))
+#endif
+
+typedef int (*StringLengthFunction)(const char * string);
+typedef int (*StringCompareFunction)(const char * string_one, const char * string_two);
+
+static int select_string_length(const char * string);
+static int select_string_compare(const char * string_one, const char * string_two);
+
+static _Atomic(StringLengthFunction) string_length_function = select_string_length;
+static _Atomic(StringCompareFunction) string_compare_function = select_string_compare;
+static atomic_int string_simd_in_use = -1;
+
+static int string_compare_scalar(const char * string_one, const char * string_two) {
     while (*string_one && (*string_one == *string_two)) {
         string_one++;
         string_two++;
@@ -8,10 +49,586 @@ int string_compare(const char * string_one, const char * string_two) {
     return *(unsigned char *)string_one - *(unsigned char *)string_two;
 }
 
-int string_length(const char * string) {
+static int string_length_scalar(const char * string) {
     int length = 0;
     while (*string++)
         length++;
     return length;
 }
 
+/**
+ * @brief Helper function to get how many bytes both strings can be read from before one of them reaches the end of its page.
+ */
+static inline size_t get_string_page_room(const char * string_one, const char * string_two) {
+    size_t room_one = STRING_PAGE_SIZE - ((uintptr_t)string_one & (STRING_PAGE_SIZE - 1));
+    size_t room_two = STRING_PAGE_SIZE - ((uintptr_t)string_two & (STRING_PAGE_SIZE - 1));
+    return room_one < room_two ? room_one : room_two;
+}
+
+/**
+ * @brief Helper function to compare up to count bytes one at a time, where a vector load would cross a page.
+ *
+ * @return true if the strings differ or end in those bytes, result is then set,
+ * @return false if they are all equal.
+ */
+static inline bool compare_string_bytes(const char * string_one, const char * string_two, size_t count, int * result) {
+    for (size_t index = 0; index < count; index++) {
+        unsigned char one = (unsigned char)string_one[index];
+        unsigned char two = (unsigned char)string_two[index];
+        if (one != two || !one) {
+            *result = one - two;
+            return true;
+        }
+    }
+    return false;
+}
+
+#if ARCH_X64 || ARCH_ARM64
+/**
+ * @brief Helper function to find the index of the lowest set bit of a non-zero mask.
+ */
+static inline unsigned int find_lowest_bit(uint64_t mask) {
+#if COMPILER_CL
+    unsigned long index;
+    _BitScanForward64(&index, mask);
+    return (unsigned int)index;
+#else
+    return (unsigned int)__builtin_ctzll(mask);
+#endif
+}
+#endif
+
+#if ARCH_X64
+static STRING_NO_SANITIZE int string_length_sse2(const char * string) {
+    // Aligned loads never cross a page, the bytes before the string are shifted out of the first one.
+    const char * block = (const char *)((uintptr_t)string & ~(uintptr_t)15);
+    __m128i zero = _mm_setzero_si128();
+    uint32_t mask = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_load_si128((const __m128i *)block), zero)) >> ((uintptr_t)string & 15);
+    if (mask)
+        return (int)find_lowest_bit(mask);
+    // One vector at a time up to a 64-byte boundary, then four at once.
+    for (block += 16; (uintptr_t)block & 63; block += 16) {
+        mask = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_load_si128((const __m128i *)block), zero));
+        if (mask)
+            return (int)(block - string + find_lowest_bit(mask));
+    }
+    for (;; block += 64) {
+        __m128i first = _mm_load_si128((const __m128i *)block);
+        __m128i second = _mm_load_si128((const __m128i *)(block + 16));
+        __m128i third = _mm_load_si128((const __m128i *)(block + 32));
+        __m128i fourth = _mm_load_si128((const __m128i *)(block + 48));
+        __m128i least = _mm_min_epu8(_mm_min_epu8(first, second), _mm_min_epu8(third, fourth));
+        if (!_mm_movemask_epi8(_mm_cmpeq_epi8(least, zero)))
+            continue;
+        uint64_t masks = (uint64_t)(uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(first, zero)) |
+            (uint64_t)(uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(second, zero)) << 16 |
+            (uint64_t)(uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(third, zero)) << 32 |
+            (uint64_t)(uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(fourth, zero)) << 48;
+        return (int)(block - string + find_lowest_bit(masks));
+    }
+}
+
+static STRING_NO_SANITIZE int string_compare_sse2(const char * string_one, const char * string_two) {
+    __m128i zero = _mm_setzero_si128();
+    size_t offset = 0;
+    for (;;) {
+        size_t room = get_string_page_room(string_one + offset, string_two + offset);
+        int result;
+        if (room < 16) {
+            if (offset < 16) {
+                if (compare_string_bytes(string_one + offset, string_two + offset, room, &result))
+                    return result;
+                offset += room;
+                continue;
+            }
+            // The bytes before offset are equal and not zero, so the vector ending at the page end may go back over them.
+            offset -= 16 - room;
+            room = 16;
+        }
+        size_t end = offset + (room & ~(size_t)15);
+        // Two vectors at a time while they fit before the page end, with one test for both.
+        for (; offset + 32 <= end; offset += 32) {
+            __m128i first = _mm_loadu_si128((const __m128i *)(string_one + offset));
+            __m128i second = _mm_loadu_si128((const __m128i *)(string_one + offset + 16));
+            __m128i first_stop = _mm_min_epu8(_mm_cmpeq_epi8(first, _mm_loadu_si128((const __m128i *)(string_two + offset))), first);
+            __m128i second_stop = _mm_min_epu8(_mm_cmpeq_epi8(second, _mm_loadu_si128((const __m128i *)(string_two + offset + 16))), second);
+            if (!_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_min_epu8(first_stop, second_stop), zero)))
+                continue;
+            uint32_t stop = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(first_stop, zero)) |
+                (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(second_stop, zero)) << 16;
+            size_t index = offset + find_lowest_bit(stop);
+            return (unsigned char)string_one[index] - (unsigned char)string_two[index];
+        }
+        for (; offset < end; offset += 16) {
+            __m128i one = _mm_loadu_si128((const __m128i *)(string_one + offset));
+            __m128i two = _mm_loadu_si128((const __m128i *)(string_two + offset));
+            // Equal bytes keep their value and the others become zero, so a zero marks where to stop.
+            uint32_t stop = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_min_epu8(_mm_cmpeq_epi8(one, two), one), zero));
+            if (stop) {
+                size_t index = offset + find_lowest_bit(stop);
+                return (unsigned char)string_one[index] - (unsigned char)string_two[index];
+            }
+        }
+    }
+}
+
+static STRING_TARGET_AVX2 STRING_NO_SANITIZE int string_length_avx2(const char * string) {
+    const char * block = (const char *)((uintptr_t)string & ~(uintptr_t)31);
+    __m256i zero = _mm256_setzero_si256();
+    uint32_t mask = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_load_si256((const __m256i *)block), zero)) >> ((uintptr_t)string & 31);
+    if (mask)
+        return (int)find_lowest_bit(mask);
+    for (block += 32; (uintptr_t)block & 127; block += 32) {
+        mask = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_load_si256((const __m256i *)block), zero));
+        if (mask)
+            return (int)(block - string + find_lowest_bit(mask));
+    }
+    for (;; block += 128) {
+        __m256i first = _mm256_load_si256((const __m256i *)block);
+        __m256i second = _mm256_load_si256((const __m256i *)(block + 32));
+        __m256i third = _mm256_load_si256((const __m256i *)(block + 64));
+        __m256i fourth = _mm256_load_si256((const __m256i *)(block + 96));
+        __m256i least = _mm256_min_epu8(_mm256_min_epu8(first, second), _mm256_min_epu8(third, fourth));
+        if (!_mm256_movemask_epi8(_mm256_cmpeq_epi8(least, zero)))
+            continue;
+        uint64_t masks = (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(first, zero)) |
+            (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(second, zero)) << 32;
+        if (masks)
+            return (int)(block - string + find_lowest_bit(masks));
+        masks = (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(third, zero)) |
+            (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(fourth, zero)) << 32;
+        return (int)(block + 64 - string + find_lowest_bit(masks));
+    }
+}
+
+static STRING_TARGET_AVX2 STRING_NO_SANITIZE int string_compare_avx2(const char * string_one, const char * string_two) {
+    __m256i zero = _mm256_setzero_si256();
+    size_t offset = 0;
+    for (;;) {
+        size_t room = get_string_page_room(string_one + offset, string_two + offset);
+        int result;
+        if (room < 32) {
+            if (offset < 32) {
+                if (compare_string_bytes(string_one + offset, string_two + offset, room, &result))
+                    return result;
+                offset += room;
+                continue;
+            }
+            offset -= 32 - room;
+            room = 32;
+        }
+        size_t end = offset + (room & ~(size_t)31);
+        for (; offset + 64 <= end; offset += 64) {
+            __m256i first = _mm256_loadu_si256((const __m256i *)(string_one + offset));
+            __m256i second = _mm256_loadu_si256((const __m256i *)(string_one + offset + 32));
+            __m256i first_stop = _mm256_min_epu8(_mm256_cmpeq_epi8(first, _mm256_loadu_si256((const __m256i *)(string_two + offset))), first);
+            __m256i second_stop = _mm256_min_epu8(_mm256_cmpeq_epi8(second, _mm256_loadu_si256((const __m256i *)(string_two + offset + 32))), second);
+            if (!_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_min_epu8(first_stop, second_stop), zero)))
+                continue;
+            uint64_t stop = (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(first_stop, zero)) |
+                (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(second_stop, zero)) << 32;
+            size_t index = offset + find_lowest_bit(stop);
+            return (unsigned char)string_one[index] - (unsigned char)string_two[index];
+        }
+        for (; offset < end; offset += 32) {
+            __m256i one = _mm256_loadu_si256((const __m256i *)(string_one + offset));
+            __m256i two = _mm256_loadu_si256((const __m256i *)(string_two + offset));
+            uint32_t stop = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_min_epu8(_mm256_cmpeq_epi8(one, two), one), zero));
+            if (stop) {
+                size_t index = offset + find_lowest_bit(stop);
+                return (unsigned char)string_one[index] - (unsigned char)string_two[index];
+            }
+        }
+    }
+}
+
+/**
+ * @brief Helper function to check whether the CPU and the OS support AVX2.
+ */
+static bool is_avx2_supported(void) {
+#if COMPILER_CL
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7)
+        return false;
+    // The OS must save the YMM registers, OSXSAVE and AVX, then XCR0 bits 1 and 2.
+    __cpuid(info, 1);
+    if ((info[2] & (1 << 27 | 1 << 28)) != (1 << 27 | 1 << 28) || (_xgetbv(0) & 6) != 6)
+        return false;
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+#endif
+
+#if ARCH_ARM64
+/**
+ * @brief Helper function to narrow a byte mask to 4 bits per byte, NEON has no movemask.
+ */
+static inline uint64_t get_neon_nibble_mask(uint8x16_t matches) {
+    return vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(matches), 4)), 0);
+}
+
+static STRING_NO_SANITIZE int string_length_neon(const char * string) {
+    const char * block = (const char *)((uintptr_t)string & ~(uintptr_t)15);
+    uint8x16_t zero = vdupq_n_u8(0);
+    uint64_t mask = get_neon_nibble_mask(vceqq_u8(vld1q_u8((const uint8_t *)block), zero)) >> (((uintptr_t)string & 15) * 4);
+    if (mask)
+        return (int)(find_lowest_bit(mask) / 4);
+    for (block += 16; (uintptr_t)block & 63; block += 16) {
+        mask = get_neon_nibble_mask(vceqq_u8(vld1q_u8((const uint8_t *)block), zero));
+        if (mask)
+            return (int)(block - string + find_lowest_bit(mask) / 4);
+    }
+    for (;; block += 64) {
+        uint8x16_t first = vld1q_u8((const uint8_t *)block);
+        uint8x16_t second = vld1q_u8((const uint8_t *)(block + 16));
+        uint8x16_t third = vld1q_u8((const uint8_t *)(block + 32));
+        uint8x16_t fourth = vld1q_u8((const uint8_t *)(block + 48));
+        if (vminvq_u8(vminq_u8(vminq_u8(first, second), vminq_u8(third, fourth))))
+            continue;
+        const uint8x16_t blocks[4] = { first, second, third, fourth };
+        for (int index = 0;; index++) {
+            mask = get_neon_nibble_mask(vceqq_u8(blocks[index], zero));
+            if (mask)
+                return (int)(block + index * 16 - string + find_lowest_bit(mask) / 4);
+        }
+    }
+}
+
+static STRING_NO_SANITIZE int string_compare_neon(const char * string_one, const char * string_two) {
+    uint8x16_t zero = vdupq_n_u8(0);
+    size_t offset = 0;
+    for (;;) {
+        size_t room = get_string_page_room(string_one + offset, string_two + offset);
+        int result;
+        if (room < 16) {
+            if (offset < 16) {
+                if (compare_string_bytes(string_one + offset, string_two + offset, room, &result))
+                    return result;
+                offset += room;
+                continue;
+            }
+            offset -= 16 - room;
+            room = 16;
+        }
+        for (size_t end = offset + (room & ~(size_t)15); offset < end; offset += 16) {
+            uint8x16_t one = vld1q_u8((const uint8_t *)(string_one + offset));
+            uint8x16_t two = vld1q_u8((const uint8_t *)(string_two + offset));
+            uint64_t stop = get_neon_nibble_mask(vceqq_u8(vminq_u8(vceqq_u8(one, two), one), zero));
+            if (stop) {
+                size_t index = offset + find_lowest_bit(stop) / 4;
+                return (unsigned char)string_one[index] - (unsigned char)string_two[index];
+            }
+        }
+    }
+}
+#endif
+
+/**
+ * @brief Helper function to find the best instructions the CPU supports.
+ */
+static STRING_SIMD detect_string_simd(void) {
+#if ARCH_X64
+    return is_avx2_supported() ? STRING_SIMD_AVX2 : STRING_SIMD_SSE2;
+#elif ARCH_ARM64
+    return STRING_SIMD_NEON;
+#else
+    return STRING_SIMD_NONE;
+#endif
+}
+
+bool string_simd_supported(STRING_SIMD simd) {
+    switch (simd) {
+        case STRING_SIMD_NONE:
+            return true;
+#if ARCH_X64
+        case STRING_SIMD_SSE2:
+            return true;
+        case STRING_SIMD_AVX2:
+            return is_avx2_supported();
+#elif ARCH_ARM64
+        case STRING_SIMD_NEON:
+            return true;
+#endif
+        default:
+            return false;
+    }
+}
+
+bool string_set_simd(STRING_SIMD simd) {
+    StringLengthFunction length = string_length_scalar;
+    StringCompareFunction compare = string_compare_scalar;
+    if (!string_simd_supported(simd))
+        return false;
+    switch (simd) {
+        case STRING_SIMD_NONE:
+            break;
+#if ARCH_X64
+        case STRING_SIMD_SSE2:
+            length = string_length_sse2;
+            compare = string_compare_sse2;
+            break;
+        case STRING_SIMD_AVX2:
+            length = string_length_avx2;
+            compare = string_compare_avx2;
+            break;
+#elif ARCH_ARM64
+        case STRING_SIMD_NEON:
+            length = string_length_neon;
+            compare = string_compare_neon;
+            break;
+#endif
+        default:
+            return false;
+    }
+    atomic_store_explicit(&string_length_function, length, memory_order_relaxed);
+    atomic_store_explicit(&string_compare_function, compare, memory_order_relaxed);
+    atomic_store_explicit(&string_simd_in_use, (int)simd, memory_order_relaxed);
+    return true;
+}
+
+STRING_SIMD string_simd(void) {
+    int simd = atomic_load_explicit(&string_simd_in_use, memory_order_relaxed);
+    if (simd < 0) {
+        simd = (int)detect_string_simd();
+        string_set_simd((STRING_SIMD)simd);
+    }
+    return (STRING_SIMD)simd;
+}
+
+/**
+ * @brief Helper function to pick the instructions on the first string_length call, the function pointers start here.
+ */
+static int select_string_length(const char * string) {
+    string_simd();
+    return atomic_load_explicit(&string_length_function, memory_order_relaxed)(string);
+}
+
+/**
+ * @brief Helper function to pick the instructions on the first string_compare call.
+ */
+static int select_string_compare(const char * string_one, const char * string_two) {
+    string_simd();
+    return atomic_load_explicit(&string_compare_function, memory_order_relaxed)(string_one, string_two);
+}
+
+int string_compare(const char * string_one, const char * string_two) {
+    return atomic_load_explicit(&string_compare_function, memory_order_relaxed)(string_one, string_two);
+}
+
+int string_length(const char * string) {
+    return atomic_load_explicit(&string_length_function, memory_order_relaxed)(string);
+}
+
+StringView string_view(const char * string) {
+    StringView view = { string, string ? (size_t)string_length(string) : 0 };
+    return view;
+}
+
+StringView string_view_slice(StringView view, size_t start, size_t length) {
+    if (start > view.length)
+        start = view.length;
+    if (length > view.length - start)
+        length = view.length - start;
+    StringView slice = { view.data ? view.data + start : NULL, length };
+    return slice;
+}
+
+int string_view_compare(StringView view_one, StringView view_two) {
+    size_t shorter = view_one.length < view_two.length ? view_one.length : view_two.length;
+    int result = shorter ? memcmp(view_one.data, view_two.data, shorter) : 0;
+    if (result)
+        return result;
+    return (view_one.length > view_two.length) - (view_one.length < view_two.length);
+}
+
+bool string_view_equal(StringView view_one, StringView view_two) {
+    return view_one.length == view_two.length && (!view_one.length || memcmp(view_one.data, view_two.data, view_one.length) == 0);
+}
+
+bool string_view_starts_with(StringView view, StringView prefix) {
+    return prefix.length <= view.length && (!prefix.length || memcmp(view.data, prefix.data, prefix.length) == 0);
+}
+
+bool string_view_ends_with(StringView view, StringView suffix) {
+    return suffix.length <= view.length && (!suffix.length || memcmp(view.data + view.length - suffix.length, suffix.data, suffix.length) == 0);
+}
+
+size_t string_view_find(StringView view, char character) {
+    const char * found = view.length ? (const char *)memchr(view.data, (unsigned char)character, view.length) : NULL;
+    return found ? (size_t)(found - view.data) : STRING_VIEW_NOT_FOUND;
+}
+
+bool string_view_split(StringView * rest, char delimiter, StringView * token) {
+    if (!rest->data)
+        return false;
+    size_t index = string_view_find(*rest, delimiter);
+    if (index == STRING_VIEW_NOT_FOUND) {
+        // The last token, a NULL view marks the split as done.
+        *token = *rest;
+        rest->data = NULL;
+        rest->length = 0;
+        return true;
+    }
+    token->data = rest->data;
+    token->length = index;
+    rest->data += index + 1;
+    rest->length -= index + 1;
+    return true;
+}
+
+void string_builder_init(StringBuilder * builder, char * buffer, size_t capacity) {
+    builder->data = capacity ? buffer : NULL;
+    builder->length = 0;
+    builder->capacity = builder->data ? capacity : 0;
+    builder->arena = NULL;
+    builder->pool = NULL;
+    builder->memory = STRING_BUILDER_MEMORY_CALLER;
+    builder->truncated = false;
+    if (builder->data)
+        builder->data[0] = '\0';
+}
+
+void string_builder_init_arena(StringBuilder * builder, Arena * arena) {
+    string_builder_init(builder, NULL, 0);
+    builder->arena = arena;
+}
+
+void string_builder_init_pool(StringBuilder * builder, Pool * pool) {
+    string_builder_init(builder, (char *)pool_alloc(pool), pool->slot_size);
+    builder->pool = pool;
+    if (builder->data)
+        builder->memory = STRING_BUILDER_MEMORY_POOL;
+}
+
+void string_builder_destroy(StringBuilder * builder) {
+    if (builder->memory == STRING_BUILDER_MEMORY_HEAP)
+        free(builder->data);
+    else if (builder->memory == STRING_BUILDER_MEMORY_POOL)
+        pool_free(builder->pool, builder->data);
+    builder->data = NULL;
+    builder->length = 0;
+    builder->capacity = 0;
+    builder->memory = STRING_BUILDER_MEMORY_CALLER;
+}
+
+void string_builder_clear(StringBuilder * builder) {
+    builder->length = 0;
+    builder->truncated = false;
+    if (builder->data)
+        builder->data[0] = '\0';
+}
+
+/**
+ * @brief Helper function to make room for more bytes and the terminator, at least doubling the capacity.
+ *
+ * @param builder The builder.
+ * @param count The number of bytes about to be appended.
+ * @return true if there is room,
+ * @return false if memory ran out, nothing changes.
+ */
+static bool reserve_string_builder(StringBuilder * builder, size_t count) {
+    if (count < builder->capacity - builder->length)
+        return true;
+    if (count > SIZE_MAX / 2 - builder->length)
+        return false;
+    size_t needed = builder->length + count + 1;
+    size_t capacity = builder->capacity < STRING_BUILDER_MINIMUM_CAPACITY / 2 ? STRING_BUILDER_MINIMUM_CAPACITY : builder->capacity * 2;
+    if (capacity < needed)
+        capacity = needed;
+
+    char * data;
+    if (builder->arena) {
+        // Text at the top of the arena grows in place, otherwise it moves up and the old copy is left behind.
+        if (builder->data && arena_extend(builder->arena, builder->data, builder->capacity, capacity)) {
+            builder->capacity = capacity;
+            return true;
+        }
+        data = (char *)arena_push(builder->arena, capacity);
+        if (!data)
+            return false;
+        if (builder->data)
+            memcpy(data, builder->data, builder->length + 1);
+        builder->memory = STRING_BUILDER_MEMORY_ARENA;
+    } else if (builder->memory == STRING_BUILDER_MEMORY_HEAP) {
+        data = (char *)realloc(builder->data, capacity);
+        if (!data)
+            return false;
+    } else {
+        data = (char *)malloc(capacity);
+        if (!data)
+            return false;
+        if (builder->data)
+            memcpy(data, builder->data, builder->length + 1);
+        if (builder->memory == STRING_BUILDER_MEMORY_POOL)
+            pool_free(builder->pool, builder->data);
+        builder->memory = STRING_BUILDER_MEMORY_HEAP;
+    }
+    builder->data = data;
+    builder->capacity = capacity;
+    return true;
+}
+
+bool string_builder_append(StringBuilder * builder, const char * data, size_t length) {
+    bool complete = reserve_string_builder(builder, length);
+    if (!complete) {
+        builder->truncated = true;
+        length = builder->capacity ? builder->capacity - 1 - builder->length : 0;
+    }
+    if (length)
+        memcpy(builder->data + builder->length, data, length);
+    builder->length += length;
+    if (builder->data)
+        builder->data[builder->length] = '\0';
+    return complete;
+}
+
+bool string_builder_append_view(StringBuilder * builder, StringView view) {
+    return string_builder_append(builder, view.data, view.length);
+}
+
+bool string_builder_append_string(StringBuilder * builder, const char * string) {
+    return string_builder_append(builder, string, string ? (size_t)string_length(string) : 0);
+}
+
+bool string_builder_append_char(StringBuilder * builder, char character) {
+    return string_builder_append(builder, &character, 1);
+}
+
+bool string_builder_append_format(StringBuilder * builder, const char * format, ...) {
+    va_list arguments;
+    va_start(arguments, format);
+    bool complete = string_builder_append_format_va(builder, format, arguments);
+    va_end(arguments);
+    return complete;
+}
+
+bool string_builder_append_format_va(StringBuilder * builder, const char * format, va_list arguments) {
+    // Format into the room left first, most texts fit and are formatted once.
+    va_list retry_arguments;
+    va_copy(retry_arguments, arguments);
+    size_t room = builder->capacity - builder->length;
+    size_t needed = format_string_va(room ? builder->data + builder->length : NULL, room, format, arguments);
+    bool complete = true;
+    if (needed >= room) {
+        if (reserve_string_builder(builder, needed)) {
+            format_string_va(builder->data + builder->length, needed + 1, format, retry_arguments);
+        } else {
+            complete = false;
+            builder->truncated = true;
+            needed = room ? room - 1 : 0;
+        }
+    }
+    builder->length += needed;
+    va_end(retry_arguments);
+    return complete;
+}
+
+StringView string_builder_view(const StringBuilder * builder) {
+    StringView view = { builder->data ? builder->data : "", builder->length };
+    return view;
+}
@@ -0,0 +1,125 @@
+#include "core/thread.h"
+#include <string.h>
+
+#if OS_WINDOWS
+
+void mutex_init(Mutex * mutex) {
+    InitializeSRWLock(&mutex->lock);
+}
+
+void mutex_destroy(Mutex * mutex) {
+    // SRW locks hold no resources.
+    (void)mutex;
+}
+
+void mutex_lock(Mutex * mutex) {
+    AcquireSRWLockExclusive(&mutex->lock);
+}
+
+void mutex_unlock(Mutex * mutex) {
+    ReleaseSRWLockExclusive(&mutex->lock);
+}
+
+/**
+ * @brief Adapts a plain void(void) function to the InitOnceExecuteOnce callback signature.
+ */
+static BOOL CALLBACK once_trampoline(PINIT_ONCE once, PVOID parameter, PVOID * context) {
+    (void)once;
+    (void)context;
+    void (*function)(void);
+    memcpy(&function, &parameter, sizeof(function));
+    function();
+    return TRUE;
+}
+
+void thread_once(Once * once, void (*function)(void)) {
+    PVOID parameter;
+    memcpy(&parameter, &function, sizeof(parameter));
+    InitOnceExecuteOnce(once, once_trampoline, parameter, NULL);
+}
+
+/**
+ * @brief Adapts a ThreadFunction to the Win32 thread entry point signature.
+ */
+static DWORD WINAPI thread_trampoline(LPVOID parameter) {
+    Thread * thread = (Thread *)parameter;
+    thread->function(thread->argument);
+    return 0;
+}
+
+bool thread_create(Thread * thread, ThreadFunction function, void * argument) {
+    thread->function = function;
+    thread->argument = argument;
+    thread->handle = CreateThread(NULL, 0, thread_trampoline, thread, 0, NULL);
+    return thread->handle != NULL;
+}
+
+void thread_join(Thread * thread) {
+    WaitForSingleObject(thread->handle, INFINITE);
+    CloseHandle(thread->handle);
+}
+
+void thread_yield(void) {
+    SwitchToThread();
+}
+
+void thread_sleep(unsigned int milliseconds) {
+    Sleep(milliseconds);
+}
+
+#else
+
+#include <sched.h>
+#include <time.h>
+
+void mutex_init(Mutex * mutex) {
+    pthread_mutex_init(&mutex->lock, NULL);
+}
+
+void mutex_destroy(Mutex * mutex) {
+    pthread_mutex_destroy(&mutex->lock);
+}
+
+void mutex_lock(Mutex * mutex) {
+    pthread_mutex_lock(&mutex->lock);
+}
+
+void mutex_unlock(Mutex * mutex) {
+    pthread_mutex_unlock(&mutex->lock);
+}
+
+void thread_once(Once * once, void (*function)(void)) {
+    pthread_once(once, function);
+}
+
+/**
+ * @brief Adapts a ThreadFunction to the pthread entry point signature.
+ */
+static void * thread_trampoline(void * parameter) {
+    Thread * thread = (Thread *)parameter;
+    thread->function(thread->argument);
+    return NULL;
+}
+
+bool thread_create(Thread * thread, ThreadFunction function, void * argument) {
+    thread->function = function;
+    thread->argument = argument;
+    return pthread_create(&thread->handle, NULL, thread_trampoline, thread) == 0;
+}
+
+void thread_join(Thread * thread) {
+    pthread_join(thread->handle, NULL);
+}
+
+void thread_yield(void) {
+    sched_yield();
+}
+
+void thread_sleep(unsigned int milliseconds) {
+    struct timespec duration;
+    duration.tv_sec = milliseconds / 1000;
+    duration.tv_nsec = (long)(milliseconds % 1000) * 1000000L;
+    nanosleep(&duration, NULL);
+}
+
+#endif
@@ -0,0 +1,219 @@
+#include "core/time.h"
+#include "core/thread.h"
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+
+#if OS_WINDOWS
+    #include <windows.h>
+#endif
+
+#define TIME_NS_PER_SECOND 1000000000ULL
+#define TIME_CALIBRATION_NS 1000000ULL
+#define TIME_REFINEMENT_LIMIT_SECONDS 1024
+
+/**
+ * @brief Whether time_ticks reads a counter that needs calibrating, rather than the monotonic clock or a counter of known frequency.
+ */
+#define TIME_TICKS_NEED_CALIBRATION (ARCH_X64 || ARCH_X86)
+
+/**
+ * @brief A tick count and the clocks read right after it, the origin of every conversion.
+ */
+typedef struct TimeAnchor {
+    uint64_t ticks;     /** time_ticks at the anchor. */
+    uint64_t ns;        /** time_now_ns at the anchor. */
+    uint64_t wall_ns;   /** time_now_wall_ns at the anchor. */
+} TimeAnchor;
+
+static Once time_once = ONCE_INITIALIZER;
+static TimeAnchor time_anchor;
+static atomic_uint_least64_t time_frequency;
+static atomic_uint_least64_t time_next_refinement;
+static THREAD_LOCAL int64_t time_cached_second = -1;
+static THREAD_LOCAL char time_cached_prefix[20];
+static THREAD_LOCAL int64_t time_cached_utc_second = -1;
+static THREAD_LOCAL char time_cached_utc_prefix[20];
+
+uint64_t time_now_ns(void) {
+#if OS_WINDOWS
+    static LARGE_INTEGER frequency;
+    LARGE_INTEGER counter;
+    if (!frequency.QuadPart)
+        QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    uint64_t value = (uint64_t)counter.QuadPart;
+    uint64_t rate = (uint64_t)frequency.QuadPart;
+    return value / rate * TIME_NS_PER_SECOND + value % rate * TIME_NS_PER_SECOND / rate;
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * TIME_NS_PER_SECOND + (uint64_t)now.tv_nsec;
+#endif
+}
+
+uint64_t time_now_coarse_ns(void) {
+#if OS_WINDOWS
+    return (uint64_t)GetTickCount64() * 1000000ULL;
+#elif defined(CLOCK_MONOTONIC_COARSE)
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &now);
+    return (uint64_t)now.tv_sec * TIME_NS_PER_SECOND + (uint64_t)now.tv_nsec;
+#else
+    return time_now_ns();
+#endif
+}
+
+uint64_t time_now_wall_ns(void) {
+    struct timespec now;
+    timespec_get(&now, TIME_UTC);
+    return (uint64_t)now.tv_sec * TIME_NS_PER_SECOND + (uint64_t)now.tv_nsec;
+}
+
+/**
+ * @brief Helper function to read the ticks and the monotonic clock at the same instant.
+ *
+ * The tick count is read between two clock reads and paired with their midpoint, so the
+ * time the clock call takes does not skew the frequency measured from two such pairs.
+ *
+ * @param ns Receives time_now_ns at the tick count.
+ * @return uint64_t The tick count.
+ */
+static uint64_t read_time_pair(uint64_t * ns) {
+    uint64_t before = time_now_ns();
+    uint64_t ticks = time_ticks();
+    uint64_t after = time_now_ns();
+    *ns = before + (after - before) / 2;
+    return ticks;
+}
+
+/**
+ * @brief Helper function to take the anchor and measure the tick frequency, run once.
+ */
+static void initialize_time(void) {
+    // The first calls of a process are slow, on Linux the vDSO pages are not mapped yet, so they must not be timed.
+    time_now_ns();
+    time_now_wall_ns();
+    time_anchor.ticks = read_time_pair(&time_anchor.ns);
+    time_anchor.wall_ns = time_now_wall_ns();
+#if TIME_TICKS_NEED_CALIBRATION
+    // A short first measurement, refined later over longer intervals at no cost to the caller.
+    uint64_t ticks, ns;
+    do {
+        ticks = read_time_pair(&ns);
+    } while (ns - time_anchor.ns < TIME_CALIBRATION_NS);
+    uint64_t frequency = (uint64_t)((double)(ticks - time_anchor.ticks) * (double)TIME_NS_PER_SECOND / (double)(ns - time_anchor.ns) + 0.5);
+    atomic_store(&time_frequency, frequency ? frequency : 1);
+    atomic_store(&time_next_refinement, frequency);
+#elif ARCH_ARM64 && !COMPILER_CL
+    uint64_t frequency;
+    __asm__ volatile("mrs %0, cntfrq_el0" : "=r"(frequency));
+    atomic_store(&time_frequency, frequency);
+    atomic_store(&time_next_refinement, UINT64_MAX);
+#else
+    atomic_store(&time_frequency, TIME_NS_PER_SECOND);
+    atomic_store(&time_next_refinement, UINT64_MAX);
+#endif
+}
+
+/**
+ * @brief Helper function to measure the tick frequency again over the whole time since the anchor.
+ *
+ * Runs when a conversion sees a tick count 1, 4, 16... seconds past the anchor, up to
+ * TIME_REFINEMENT_LIMIT_SECONDS, so each measurement has a longer baseline and less error.
+ *
+ * @param ticks The tick count being converted.
+ */
+static void refine_time_frequency(uint64_t ticks) {
+    uint64_t next = atomic_load_explicit(&time_next_refinement, memory_order_relaxed);
+    if (ticks - time_anchor.ticks < next || (int64_t)(ticks - time_anchor.ticks) < 0)
+        return;
+    if (!atomic_compare_exchange_strong(&time_next_refinement, &next, UINT64_MAX))
+        return;
+
+    uint64_t now_ns;
+    uint64_t now_ticks = read_time_pair(&now_ns);
+    uint64_t frequency = (uint64_t)((double)(now_ticks - time_anchor.ticks) * (double)TIME_NS_PER_SECOND / (double)(now_ns - time_anchor.ns) + 0.5);
+    atomic_store_explicit(&time_frequency, frequency, memory_order_relaxed);
+    if (now_ns - time_anchor.ns < TIME_REFINEMENT_LIMIT_SECONDS * TIME_NS_PER_SECOND)
+        atomic_store_explicit(&time_next_refinement, (now_ticks - time_anchor.ticks) * 4, memory_order_relaxed);
+}
+
+uint64_t time_ticks_per_second(void) {
+    thread_once(&time_once, initialize_time);
+    return atomic_load_explicit(&time_frequency, memory_order_relaxed);
+}
+
+uint64_t time_ticks_to_ns(uint64_t ticks) {
+    thread_once(&time_once, initialize_time);
+    refine_time_frequency(ticks);
+    uint64_t frequency = atomic_load_explicit(&time_frequency, memory_order_relaxed);
+
+    // Split into seconds and a remainder so the multiplication cannot overflow.
+    bool before = (int64_t)(ticks - time_anchor.ticks) < 0;
+    uint64_t delta = before ? time_anchor.ticks - ticks : ticks - time_anchor.ticks;
+    uint64_t ns = delta / frequency * TIME_NS_PER_SECOND + delta % frequency * TIME_NS_PER_SECOND / frequency;
+    return before ? time_anchor.ns - ns : time_anchor.ns + ns;
+}
+
+uint64_t time_ticks_to_wall_ns(uint64_t ticks) {
+    uint64_t ns = time_ticks_to_ns(ticks);
+    return time_anchor.wall_ns + (ns - time_anchor.ns);
+}
+
+/**
+ * @brief Helper function to write ".uuuuuu" after the 19 characters of a date and time.
+ *
+ * @param wall_ns Nanoseconds since the Unix epoch.
+ * @param buffer The timestamp being written.
+ */
+static void write_time_microseconds(uint64_t wall_ns, char * buffer) {
+    buffer[sizeof(time_cached_prefix) - 1] = '.';
+    uint32_t microseconds = (uint32_t)(wall_ns % TIME_NS_PER_SECOND / 1000);
+    for (int index = TIME_TIMESTAMP_LENGTH - 1; index >= (int)sizeof(time_cached_prefix); index--) {
+        buffer[index] = (char)('0' + microseconds % 10);
+        microseconds /= 10;
+    }
+}
+
+size_t time_format_wall(uint64_t wall_ns, char * buffer) {
+    int64_t second = (int64_t)(wall_ns / TIME_NS_PER_SECOND);
+    if (second != time_cached_second) {
+        time_t calendar_time = (time_t)second;
+        struct tm calendar;
+#if OS_WINDOWS
+        localtime_s(&calendar, &calendar_time);
+#else
+        localtime_r(&calendar_time, &calendar);
+#endif
+        strftime(time_cached_prefix, sizeof(time_cached_prefix), "%Y-%m-%d %H:%M:%S", &calendar);
+        time_cached_second = second;
+    }
+
+    memcpy(buffer, time_cached_prefix, sizeof(time_cached_prefix) - 1);
+    write_time_microseconds(wall_ns, buffer);
+    buffer[TIME_TIMESTAMP_LENGTH] = '\0';
+    return TIME_TIMESTAMP_LENGTH;
+}
+
+size_t time_format_utc(uint64_t wall_ns, char * buffer) {
+    int64_t second = (int64_t)(wall_ns / TIME_NS_PER_SECOND);
+    if (second != time_cached_utc_second) {
+        time_t calendar_time = (time_t)second;
+        struct tm calendar;
+#if OS_WINDOWS
+        gmtime_s(&calendar, &calendar_time);
+#else
+        gmtime_r(&calendar_time, &calendar);
+#endif
+        strftime(time_cached_utc_prefix, sizeof(time_cached_utc_prefix), "%Y-%m-%dT%H:%M:%S", &calendar);
+        time_cached_utc_second = second;
+    }
+
+    memcpy(buffer, time_cached_utc_prefix, sizeof(time_cached_utc_prefix) - 1);
+    write_time_microseconds(wall_ns, buffer);
+    buffer[TIME_TIMESTAMP_LENGTH] = 'Z';
+    buffer[TIME_UTC_TIMESTAMP_LENGTH] = '\0';
+    return TIME_UTC_TIMESTAMP_LENGTH;
+}
@@ -0,0 +1,156 @@
+#include "core/arena.h"
+#include "core/debug.h"
+#include "core/log.h"
+#include <stdint.h>
+#include <string.h>
+
+void test_arena_push(void);
+void test_arena_push_aligned(void);
+void test_arena_extend(void);
+void test_arena_save_restore(void);
+void test_arena_reset(void);
+
+int main(void) {
+    test_arena_push();
+    LOG_CONSOLE_SUCCESS("test_arena_push passed.");
+    test_arena_push_aligned();
+    LOG_CONSOLE_SUCCESS("test_arena_push_aligned passed.");
+    test_arena_extend();
+    LOG_CONSOLE_SUCCESS("test_arena_extend passed.");
+    test_arena_save_restore();
+    LOG_CONSOLE_SUCCESS("test_arena_save_restore passed.");
+    test_arena_reset();
+    LOG_CONSOLE_SUCCESS("test_arena_reset passed.");
+    return 0;
+}
+
+void test_arena_push(void) {
+    LOG_CONSOLE_INFO("Testing arena_push...");
+    Arena arena;
+    arena_init(&arena, 256);
+
+    // Consecutive Push Test.
+    uint8_t * first = (uint8_t *)arena_push(&arena, 10);
+    uint8_t * second = (uint8_t *)arena_push(&arena, 10);
+    ASSERT(first && second, "arena_push returned NULL.");
+    ASSERT(second == first + 16, "arena_push did not bump the position by the aligned size.");
+    ASSERT(arena_position(&arena) == 26, "arena_position did not account for alignment padding.");
+
+    // Chunk Growth Test, pushes larger than the chunk size still succeed.
+    first[0] = 0x5A;
+    uint8_t * large = (uint8_t *)arena_push(&arena, 1000);
+    ASSERT(large != NULL, "arena_push failed to grow past the chunk size.");
+    large[999] = 0xAB;
+    ASSERT(first[0] == 0x5A, "arena_push invalidated earlier memory.");
+
+    // Zeroed Push Test.
+    uint8_t * zeroed = (uint8_t *)arena_push_zero(&arena, 64);
+    for (int index = 0; index < 64; index++)
+        ASSERT(zeroed[index] == 0, "arena_push_zero did not zero the memory.");
+
+    arena_destroy(&arena);
+}
+
+void test_arena_push_aligned(void) {
+    LOG_CONSOLE_INFO("Testing arena_push_aligned...");
+    Arena arena;
+    arena_init(&arena, 512);
+
+    arena_push(&arena, 3);
+    void * aligned = arena_push_aligned(&arena, 8, 64);
+    ASSERT(((uintptr_t)aligned & 63) == 0, "arena_push_aligned did not honour a 64-byte alignment.");
+
+    // Alignment larger than what the chunk guarantees, forced into a new chunk.
+    void * page = arena_push_aligned(&arena, 400, 4096);
+    ASSERT(((uintptr_t)page & 4095) == 0, "arena_push_aligned did not honour a 4096-byte alignment in a new chunk.");
+
+    // Overflow Test, sizes that would wrap the offset or the chunk size fail instead.
+    size_t position = arena_position(&arena);
+    ASSERT(arena_push(&arena, SIZE_MAX) == NULL, "arena_push accepted a size that wraps.");
+    ASSERT(arena_push_aligned(&arena, SIZE_MAX - 100, 4096) == NULL, "arena_push_aligned accepted a size that wraps with its padding.");
+    ASSERT(arena_push(&arena, SIZE_MAX - 8) == NULL, "arena_push accepted a size that wraps with the chunk header.");
+    ASSERT(arena_position(&arena) == position, "A failed push moved the arena position.");
+
+    arena_destroy(&arena);
+}
+
+void test_arena_extend(void) {
+    LOG_CONSOLE_INFO("Testing arena_extend...");
+    Arena arena;
+    arena_init(&arena, 256);
+
+    uint8_t * first = (uint8_t *)arena_push(&arena, 16);
+    uint8_t * last = (uint8_t *)arena_push(&arena, 32);
+    ASSERT(arena_extend(&arena, last, 32, 100), "arena_extend did not grow the last push.");
+    ASSERT(arena_position(&arena) == 116, "arena_extend did not move the position.");
+    ASSERT(arena_extend(&arena, last, 100, 40) && arena_position(&arena) == 56, "arena_extend did not shrink the last push.");
+
+    // Only the last push grows, and only inside its chunk.
+    ASSERT(!arena_extend(&arena, first, 16, 64), "arena_extend grew memory that is not the last push.");
+    ASSERT(!arena_extend(&arena, last, 40, 1000), "arena_extend grew past the end of the chunk.");
+    ASSERT(arena_position(&arena) == 56, "A failed arena_extend moved the position.");
+
+    arena_destroy(&arena);
+}
+
+void test_arena_save_restore(void) {
+    LOG_CONSOLE_INFO("Testing arena_save and arena_restore...");
+    Arena arena;
+    arena_init(&arena, 128);
+
+    arena_push(&arena, 32);
+    ArenaMarker marker = arena_save(&arena);
+    uint8_t * scratch = (uint8_t *)arena_push(&arena, 16);
+
+    // Restore Across Chunks Test.
+    for (int index = 0; index < 20; index++)
+        ASSERT(arena_push(&arena, 100) != NULL, "arena_push returned NULL.");
+    arena_restore(&arena, marker);
+    ASSERT(arena_position(&arena) == marker.position, "arena_restore did not rewind to the saved position.");
+    ASSERT(arena_push(&arena, 16) == scratch, "arena_restore did not make the released memory reusable.");
+
+    // Pop Test.
+    arena_pop(&arena, 16);
+    ASSERT(arena_position(&arena) == marker.position, "arena_pop did not rewind by the popped size.");
+
+    arena_destroy(&arena);
+}
+
+#if DEBUG_MEMORY_PROFILER
+/**
+ * Live bytes of the memory profile entry for a line of this file, or UINT64_MAX if it has none.
+ */
+static uint64_t get_arena_callsite_live_bytes(int line) {
+    MemoryCallsiteStats stats[64];
+    size_t count = debug_memory_profile_snapshot(stats, sizeof(stats) / sizeof(stats[0]));
+    for (size_t index = 0; index < count && index < sizeof(stats) / sizeof(stats[0]); index++)
+        if (stats[index].line == line && strcmp(stats[index].file, __FILE__) == 0)
+            return stats[index].live_bytes;
+    return UINT64_MAX;
+}
+#endif
+
+void test_arena_reset(void) {
+    LOG_CONSOLE_INFO("Testing arena_reset...");
+    Arena arena;
+    ARENA_INIT_TRACKED(&arena, 128);
+    const int init_line = __LINE__ - 1;
+
+    uint8_t * first = (uint8_t *)arena_push(&arena, 8);
+    for (int index = 0; index < 10; index++)
+        arena_push(&arena, 100);
+    arena_reset(&arena);
+    ASSERT(arena_position(&arena) == 0, "arena_reset did not rewind to the start.");
+    ASSERT(arena_push(&arena, 8) == first, "arena_reset did not keep the first chunk.");
+
+#if DEBUG_MEMORY_PROFILER
+    // Tracked chunks are allocated through debug_malloc under the callsite of ARENA_INIT_TRACKED, and all released by arena_destroy.
+    uint64_t live_bytes = get_arena_callsite_live_bytes(init_line);
+    ASSERT(live_bytes > 0 && live_bytes != UINT64_MAX, "The tracked chunks were not counted under the arena callsite.");
+    arena_destroy(&arena);
+    ASSERT(get_arena_callsite_live_bytes(init_line) == 0, "arena_destroy left tracked chunks allocated.");
+#else
+    (void)init_line;
+    arena_destroy(&arena);
+#endif
+}
@@ -0,0 +1,134 @@
+#include "core/binlog.h"
+#include "core/debug.h"
+#include "core/log.h"
+#include "core/thread.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BINLOG_TEST_PATH "binlog_test.binlog"
+
+void test_binlog_round_trip(void);
+void test_binlog_threads(void);
+
+int main(void) {
+    test_binlog_round_trip();
+    LOG_CONSOLE_SUCCESS("test_binlog_round_trip passed.");
+    test_binlog_threads();
+    LOG_CONSOLE_SUCCESS("test_binlog_threads passed.");
+    return 0;
+}
+
+/**
+ * Reads a whole stream into a terminated string, the caller frees it.
+ */
+static char * read_stream(FILE * stream) {
+    long size = ftell(stream);
+    rewind(stream);
+    char * text = (char *)calloc((size_t)size + 1, 1);
+    fread(text, 1, (size_t)size, stream);
+    return text;
+}
+
+void test_binlog_round_trip(void) {
+    ASSERT(binlog_open(BINLOG_TEST_PATH), "binlog_open failed to create the log file.");
+    ASSERT(!binlog_open(BINLOG_TEST_PATH), "binlog_open opened a second file.");
+
+    // Every kind of argument, written twice so the second message reuses the dictionary record.
+    FILE * expected = tmpfile();
+    int line = 0;
+    for (int round = 0; round < 2; round++) {
+        BINLOG_INFO("Loaded %d assets in %.3f ms from %s.", 42 + round, 12.5, "textures.pak"); line = __LINE__;
+        log_message_to_stream(expected, LOG_LEVEL_INFO, __FUNCTION__, __FILE__, line, round ? "Loaded 43 assets in 12.500 ms from textures.pak." : "Loaded 42 assets in 12.500 ms from textures.pak.");
+    }
+    BINLOG_WARNING("Sizes %zu %hhu %hd %ld %lld %llx %c 100%% [%*d] [%-6.2s]", (size_t)123456789, 300, -2, -70000L, -1LL, 0xABCDEFULL, 'z', 5, 7, "wide"); line = __LINE__;
+    char message[256];
+    snprintf(message, sizeof(message), "Sizes %zu %hhu %hd %ld %lld %llx %c 100%% [%*d] [%-6.2s]", (size_t)123456789, (unsigned char)300, (short)-2, -70000L, -1LL, 0xABCDEFULL, 'z', 5, 7, "wide");
+    log_message_to_stream(expected, LOG_LEVEL_WARNING, __FUNCTION__, __FILE__, line, message);
+    BINLOG_ERROR("No arguments at all."); line = __LINE__;
+    log_message_to_stream(expected, LOG_LEVEL_ERROR, __FUNCTION__, __FILE__, line, "No arguments at all.");
+    binlog_close();
+
+    // Decoding gives back exactly what the console logger would have written.
+    FILE * input = fopen(BINLOG_TEST_PATH, "rb");
+    FILE * decoded = tmpfile();
+    ASSERT(input && decoded, "Failed to open the files to decode.");
+    ASSERT(binlog_decode(input, decoded, false), "binlog_decode reported a damaged file.");
+    fclose(input);
+    char * expected_text = read_stream(expected);
+    char * decoded_text = read_stream(decoded);
+    ASSERT(strcmp(expected_text, decoded_text) == 0, "The decoded binary log does not match the console format.");
+    free(expected_text);
+    free(decoded_text);
+    fclose(expected);
+    fclose(decoded);
+    LOG_CONSOLE_SUCCESS("Binary log passed round trip test.");
+
+    // Damage Test, a truncated file is reported.
+    input = fopen(BINLOG_TEST_PATH, "rb");
+    fseek(input, 0, SEEK_END);
+    long size = ftell(input);
+    rewind(input);
+    char * bytes = (char *)malloc((size_t)size);
+    fread(bytes, 1, (size_t)size, input);
+    fclose(input);
+    FILE * truncated = tmpfile();
+    fwrite(bytes, 1, (size_t)size - 3, truncated);
+    rewind(truncated);
+    decoded = tmpfile();
+    ASSERT(!binlog_decode(truncated, decoded, false), "binlog_decode accepted a truncated file.");
+    fclose(truncated);
+    fclose(decoded);
+    free(bytes);
+    remove(BINLOG_TEST_PATH);
+
+    // A "%s" callsite and a chunk holding a 10000-byte string, longer than any record, are reported.
+    static const uint8_t DICTIONARY[] = { 'O', 'R', 'I', 'G', 'B', 'L', 'G', '2', 0x01, 1, 1, 1, 2, '%', 's', 3, 'f', '.', 'c', 1, 'f' };
+    static const uint8_t CHUNK[] = { 0x02, 0x94, 0x4E, 1, 0, 0x90, 0x4E };
+    FILE * crafted = tmpfile();
+    fwrite(DICTIONARY, 1, sizeof(DICTIONARY), crafted);
+    fwrite(CHUNK, 1, sizeof(CHUNK), crafted);
+    for (int index = 0; index < 10000; index++)
+        fputc('s', crafted);
+    rewind(crafted);
+    decoded = tmpfile();
+    ASSERT(!binlog_decode(crafted, decoded, false), "binlog_decode accepted a string longer than a record.");
+    fclose(crafted);
+    fclose(decoded);
+    LOG_CONSOLE_SUCCESS("Binary log passed damage test.");
+}
+
+static void binlog_producer(void * argument) {
+    for (int index = 0; index < 10000; index++)
+        BINLOG_DEBUG("Producer %d message %d.", (int)(intptr_t)argument, index);
+}
+
+void test_binlog_threads(void) {
+    ASSERT(binlog_open(BINLOG_TEST_PATH), "binlog_open failed to reopen the log file.");
+    Thread producers[4];
+    for (int index = 0; index < 4; index++)
+        thread_create(&producers[index], binlog_producer, (void *)(intptr_t)index);
+    for (int index = 0; index < 4; index++)
+        thread_join(&producers[index]);
+    binlog_close();
+
+    // Every message of every thread is decoded, in order within a thread.
+    FILE * input = fopen(BINLOG_TEST_PATH, "rb");
+    FILE * decoded = tmpfile();
+    ASSERT(binlog_decode(input, decoded, true), "binlog_decode reported a damaged file.");
+    fclose(input);
+    rewind(decoded);
+    int next[4] = { 0, 0, 0, 0 };
+    char line[512];
+    while (fgets(line, sizeof(line), decoded)) {
+        int producer, index;
+        const char * message = strstr(line, "Producer ");
+        ASSERT(message && sscanf(message, "Producer %d message %d.", &producer, &index) == 2, "A decoded line is not a producer message.");
+        ASSERT(producer >= 0 && producer < 4 && next[producer] == index, "Messages of a thread were decoded out of order.");
+        next[producer]++;
+    }
+    fclose(decoded);
+    for (int index = 0; index < 4; index++)
+        ASSERT(next[index] == 10000, "Messages of a thread were lost.");
+    remove(BINLOG_TEST_PATH);
+}
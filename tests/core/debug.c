@@ -1,12 +1,27 @@
 #include "core/debug.h"
 #include "core/log.h"
+#include "core/array.h"
+#include "core/context.h"
+#include "core/hash.h"
 #include <stdint.h>
 #include <stdbool.h>
+#include <string.h>
+
+#if OS_LINUX || OS_MAC
+    #include <signal.h>
+    #include <unistd.h>
+    #include <sys/wait.h>
+#endif
 
 void test_debug_malloc(void);
 //void test_debug_calloc(void);
-//void test_debug_realloc(void);
-//void test_debug_free(void);
+void test_debug_realloc(void);
+void test_debug_free(void);
+void test_memory_profile(void);
+void test_memory_sampling(void);
+void test_memory_page_guard(void);
+void test_memory_quarantine(void);
+void test_memory_tracking_modes(void);
 //void test_report_memory_leaks(void);
 //void test_assert_macros(void);
  
@@ -15,8 +30,22 @@ int main(void) {
     test_debug_malloc();
     LOG_CONSOLE_SUCCESS("test_debug_malloc passed.");
     //test_debug_calloc();
-    //test_debug_realloc();
-    //test_debug_free();
+    test_debug_realloc();
+    LOG_CONSOLE_SUCCESS("test_debug_realloc passed.");
+    test_debug_free();
+    LOG_CONSOLE_SUCCESS("test_debug_free passed.");
+#if DEBUG_MEMORY_PROFILER
+    test_memory_profile();
+    LOG_CONSOLE_SUCCESS("test_memory_profile passed.");
+#endif
+    test_memory_sampling();
+    LOG_CONSOLE_SUCCESS("test_memory_sampling passed.");
+    test_memory_page_guard();
+    LOG_CONSOLE_SUCCESS("test_memory_page_guard passed.");
+    test_memory_quarantine();
+    LOG_CONSOLE_SUCCESS("test_memory_quarantine passed.");
+    test_memory_tracking_modes();
+    LOG_CONSOLE_SUCCESS("test_memory_tracking_modes passed.");
     //test_report_memory_leaks();
     //test_assert_macros();
     return 0;
@@ -28,8 +57,8 @@ void test_debug_malloc(void) {
     // Basic Allocation Test.
     int * int_ptr = (int *)debug_malloc(sizeof(int), __FILE__, __LINE__);
     ASSERT(int_ptr != NULL, "debug_malloc returned NULL.");
-    printf("malloc returned: %x | expected %x\n", int_ptr, DEBUG_MEMORY_INIT_VALUE);
-    ASSERT(*int_ptr == DEBUG_MEMORY_INIT_VALUE, "debug_malloc did not initialize memory to DEBUG_MEMORY_INIT_VALUE.");
+    printf("malloc returned: %x | expected %x\n", *(uint8_t *)int_ptr, DEBUG_MEMORY_INIT_VALUE);
+    ASSERT(*(uint8_t *)int_ptr == DEBUG_MEMORY_INIT_VALUE, "debug_malloc did not initialize memory to DEBUG_MEMORY_INIT_VALUE.");
     LOG_CONSOLE_SUCCESS("debug_malloc passed basic allocation test.");
 
     // Reassignment Test.
@@ -43,5 +72,347 @@ void test_debug_malloc(void) {
     ASSERT(!is_memory_guard_intact(int_ptr, sizeof(int)), "Memory guard check did not detect an overrun when it should have.");
     LOG_CONSOLE_SUCCESS("debug_malloc passed memory guard overrun test.");
 
+#if DEBUG_MEMORY_INLINE_HEADERS
+    // Memory Guard Underrun Test.
+    *byte_ptr = 0x00;
+    ASSERT(is_memory_guard_intact(int_ptr, sizeof(int)), "Memory guard could not be restored.");
+    ((uint8_t *)int_ptr)[-1] = 0xEE; // Simulating an underrun.
+    ASSERT(!is_memory_front_guard_intact(int_ptr), "Front memory guard check did not detect an underrun when it should have.");
+    LOG_CONSOLE_SUCCESS("debug_malloc passed memory guard underrun test.");
+#endif
+
     debug_free(int_ptr);
-}
\ No newline at end of file
+}
+
+void test_debug_realloc(void) {
+    LOG_CONSOLE_INFO("Testing debug_realloc...");
+
+    // Contents Preserved Test.
+    uint8_t * bytes = (uint8_t *)debug_malloc(8, __FILE__, __LINE__);
+    ASSERT(bytes != NULL, "debug_malloc returned NULL.");
+    for (int index = 0; index < 8; index++)
+        bytes[index] = (uint8_t)index;
+    bytes = (uint8_t *)debug_realloc(bytes, 64, __FILE__, __LINE__);
+    ASSERT(bytes != NULL, "debug_realloc returned NULL.");
+    for (int index = 0; index < 8; index++)
+        ASSERT(bytes[index] == index, "debug_realloc did not preserve the block contents.");
+    ASSERT(is_memory_guard_intact(bytes, 64), "debug_realloc did not set the memory guard at the new size.");
+    LOG_CONSOLE_SUCCESS("debug_realloc passed contents preserved test.");
+
+    // Reallocated Block Tracked Test, a second realloc must still find the block.
+    bytes = (uint8_t *)debug_realloc(bytes, 16, __FILE__, __LINE__);
+    ASSERT(bytes != NULL, "debug_realloc lost track of a reallocated block.");
+    LOG_CONSOLE_SUCCESS("debug_realloc passed reallocated block tracked test.");
+
+    // In Place Test, shrinking keeps the block and growing back fits in the slack it leaves.
+    uint8_t * shrunk = (uint8_t *)debug_realloc(bytes, 8, __FILE__, __LINE__);
+    ASSERT(shrunk == bytes, "debug_realloc moved a block that was shrinking.");
+    ASSERT(is_memory_guard_intact(shrunk, 8), "debug_realloc did not move the memory guard to the new end.");
+    ASSERT(shrunk[7] == 7, "debug_realloc did not preserve the contents when shrinking.");
+#if OS_LINUX || OS_WINDOWS || OS_MAC
+    bytes = (uint8_t *)debug_realloc(shrunk, 16, __FILE__, __LINE__);
+    ASSERT(bytes == shrunk, "debug_realloc moved a block that had room to grow.");
+    ASSERT(bytes[8] == DEBUG_MEMORY_INIT_VALUE, "debug_realloc did not initialize the grown bytes.");
+    ASSERT(is_memory_guard_intact(bytes, 16), "debug_realloc did not move the memory guard when growing in place.");
+#else
+    bytes = shrunk;
+#endif
+    LOG_CONSOLE_SUCCESS("debug_realloc passed in place test.");
+
+    debug_free(bytes);
+}
+
+void test_debug_free(void) {
+    LOG_CONSOLE_INFO("Testing debug_free...");
+
+    // Many Live Blocks Test, frees in an interleaved order so removals shift table entries.
+    enum { BLOCK_COUNT = 5000 };
+    static int * blocks[BLOCK_COUNT];
+    for (int index = 0; index < BLOCK_COUNT; index++) {
+        blocks[index] = (int *)debug_malloc(sizeof(int), __FILE__, __LINE__);
+        ASSERT(blocks[index] != NULL, "debug_malloc returned NULL.");
+        *blocks[index] = index;
+    }
+    for (int index = 0; index < BLOCK_COUNT; index += 2)
+        debug_free(blocks[index]);
+    for (int index = 1; index < BLOCK_COUNT; index += 2) {
+        ASSERT(*blocks[index] == index, "debug_free corrupted a live block.");
+        blocks[index] = (int *)debug_realloc(blocks[index], 2 * sizeof(int), __FILE__, __LINE__);
+        ASSERT(blocks[index] != NULL, "debug_realloc could not find a live block after neighbouring frees.");
+    }
+    for (int index = BLOCK_COUNT - 1; index >= 1; index -= 2)
+        debug_free(blocks[index]);
+    LOG_CONSOLE_SUCCESS("debug_free passed many live blocks test.");
+}
+
+void test_memory_profile(void) {
+    LOG_CONSOLE_INFO("Testing the memory profile...");
+
+    // Allocate twice from one callsite and free one block.
+    void * blocks[2];
+    for (int index = 0; index < 2; index++)
+        blocks[index] = debug_malloc(100, __FILE__, __LINE__);
+    const int callsite_line = __LINE__ - 1;
+    debug_free(blocks[0]);
+
+    // A copy of the file name, as another translation unit has it, counts to the same callsite.
+    static const char FILE_COPY[] = __FILE__;
+    void * copied = debug_malloc(100, FILE_COPY, callsite_line);
+
+    MemoryCallsiteStats stats[64];
+    size_t count = debug_memory_profile_snapshot(stats, ARRAY_COUNT(stats));
+    ASSERT(count <= ARRAY_COUNT(stats), "debug_memory_profile_snapshot reported more callsites than this test makes.");
+
+    const MemoryCallsiteStats * entry = NULL;
+    for (size_t index = 0; index < count; index++) {
+        if (stats[index].line == callsite_line)
+            entry = &stats[index];
+    }
+    ASSERT(entry != NULL, "debug_memory_profile_snapshot did not record the callsite.");
+    ASSERT(entry->allocation_count == 3, "Callsite allocation count is wrong.");
+    ASSERT(entry->total_bytes == 300, "Callsite total bytes are wrong.");
+    ASSERT(entry->live_bytes == 200, "Callsite live bytes were not reduced by debug_free.");
+    ASSERT(entry->peak_live_bytes == 200, "Callsite peak live bytes are wrong.");
+    ASSERT(entry->size_histogram[3] == 3, "Callsite size histogram put 100 bytes in the wrong bucket.");
+    ASSERT(strcmp(entry->file, __FILE__) == 0, "Callsite file is wrong.");
+    LOG_CONSOLE_SUCCESS("Memory profile passed callsite statistics test.");
+
+    debug_memory_profile_dump(stdout, MEMORY_PROFILE_FORMAT_TABLE, MEMORY_PROFILE_SORT_TOTAL_BYTES);
+    debug_memory_profile_dump(stdout, MEMORY_PROFILE_FORMAT_CSV, MEMORY_PROFILE_SORT_LIVE_BYTES);
+    debug_free(blocks[1]);
+    debug_free(copied);
+
+    // More callsites than the table holds, the ones past it are counted together.
+    const int overflow_callsites = DEBUG_MEMORY_CALLSITE_CAPACITY + 1000;
+    for (int line = 1; line <= overflow_callsites; line++)
+        debug_free(debug_malloc(8, "overflow.c", line));
+    size_t recorded = debug_memory_profile_snapshot(NULL, 0);
+    MemoryCallsiteStats * all_stats = (MemoryCallsiteStats *)malloc(recorded * sizeof(MemoryCallsiteStats));
+    ASSERT(all_stats != NULL, "malloc failed.");
+    recorded = debug_memory_profile_snapshot(all_stats, recorded);
+    const MemoryCallsiteStats * other = &all_stats[recorded - 1];
+    ASSERT(recorded <= DEBUG_MEMORY_CALLSITE_CAPACITY + 1, "debug_memory_profile_snapshot reported more callsites than the table holds.");
+    ASSERT(strcmp(other->file, "(other callsites)") == 0 && other->line == 0, "Callsites past the table were not counted together.");
+    ASSERT(other->allocation_count >= 1000 && other->live_bytes == 0, "The shared entry of callsites past the table is wrong.");
+    free(all_stats);
+    LOG_CONSOLE_SUCCESS("Memory profile passed full table test.");
+}
+
+void test_memory_sampling(void) {
+    LOG_CONSOLE_INFO("Testing the sampling heap profiler...");
+
+    // A one byte rate samples every allocation after the thread's counter is armed.
+    debug_memory_set_sample_rate(1);
+    void * blocks[5];
+    for (int index = 0; index < 5; index++)
+        blocks[index] = debug_malloc(64, __FILE__, __LINE__);
+
+    FILE * profile = tmpfile();
+    ASSERT(profile != NULL, "tmpfile failed.");
+    debug_memory_write_heap_profile(profile);
+    rewind(profile);
+    unsigned int sample_count = 0, sample_bytes = 0, sample_rate = 0;
+    int matched = fscanf(profile, "heap profile: %u: %u [%*u: %*u] @ heap_v2/%u", &sample_count, &sample_bytes, &sample_rate);
+    fclose(profile);
+    ASSERT(matched == 3, "debug_memory_write_heap_profile did not write a heap_v2 header.");
+    ASSERT(sample_count >= 4 && sample_bytes == sample_count * 64, "Heap profile is missing live samples.");
+    ASSERT(sample_rate == 1, "Heap profile header does not carry the sample rate.");
+    debug_memory_write_collapsed_stacks(stdout);
+    LOG_CONSOLE_SUCCESS("Sampling heap profiler passed live samples test.");
+
+    // Freed blocks leave the profile.
+    for (int index = 0; index < 5; index++)
+        debug_free(blocks[index]);
+    profile = tmpfile();
+    debug_memory_write_heap_profile(profile);
+    rewind(profile);
+    matched = fscanf(profile, "heap profile: %u:", &sample_count);
+    fclose(profile);
+    ASSERT(matched == 1 && sample_count == 0, "Freed blocks were left in the heap profile.");
+    debug_memory_set_sample_rate(0);
+    LOG_CONSOLE_SUCCESS("Sampling heap profiler passed freed samples test.");
+}
+
+#if OS_LINUX || OS_MAC
+/**
+ * Writes to an address in a child process and reports whether the write faulted.
+ */
+static bool does_write_fault(uint8_t * address) {
+    pid_t child = fork();
+    if (child == 0) {
+        // The expected fault is not a crash worth a flight recorder dump.
+        signal(SIGSEGV, SIG_DFL);
+        signal(SIGBUS, SIG_DFL);
+        *(volatile uint8_t *)address = 0;
+        _exit(0);
+    }
+    int status = 0;
+    waitpid(child, &status, 0);
+    return WIFSIGNALED(status) && (WTERMSIG(status) == SIGSEGV || WTERMSIG(status) == SIGBUS);
+}
+#endif
+
+void test_memory_page_guard(void) {
+    debug_memory_set_page_guard(4096, 0);
+
+    // Allocation Test, the whole block is usable and initialized.
+    uint8_t * block = (uint8_t *)debug_malloc(5000, __FILE__, __LINE__);
+    ASSERT(block != NULL, "debug_malloc failed to allocate a page-guarded block.");
+    ASSERT(((uintptr_t)block & 15) == 0, "A page-guarded block is not 16-byte aligned.");
+    ASSERT(block[0] == DEBUG_MEMORY_INIT_VALUE && block[4999] == DEBUG_MEMORY_INIT_VALUE, "A page-guarded block was not initialized.");
+    for (int index = 0; index < 5000; index++)
+        block[index] = (uint8_t)index;
+#if OS_LINUX || OS_MAC
+    ASSERT(!does_write_fault(block + 4999), "Writing the last byte of a page-guarded block faulted.");
+    ASSERT(does_write_fault(block + 5008), "Writing past a page-guarded block did not fault.");
+#endif
+    LOG_CONSOLE_SUCCESS("Page guard passed allocation test.");
+
+    // Realloc Test, growing moves to new guarded pages and keeps the contents.
+    block = (uint8_t *)debug_realloc(block, 9000, __FILE__, __LINE__);
+    ASSERT(block != NULL, "debug_realloc failed to move a page-guarded block.");
+    ASSERT(block[4999] == (uint8_t)4999 && block[5000] == DEBUG_MEMORY_INIT_VALUE, "debug_realloc did not preserve a page-guarded block.");
+#if OS_LINUX || OS_MAC
+    ASSERT(does_write_fault(block + 9008), "Writing past a reallocated page-guarded block did not fault.");
+#endif
+    LOG_CONSOLE_SUCCESS("Page guard passed realloc test.");
+
+    // Reuse Test, a freed mapping is cached, inaccessible while cached, and handed out again.
+    uint8_t * freed = block;
+    debug_free(block);
+#if OS_LINUX || OS_MAC
+    ASSERT(does_write_fault(freed), "Writing to a freed page-guarded block did not fault.");
+#endif
+    block = (uint8_t *)debug_malloc(9000, __FILE__, __LINE__);
+    ASSERT(block == freed, "A freed page-guard mapping was not reused.");
+    ASSERT(block[0] == DEBUG_MEMORY_INIT_VALUE, "A reused page-guarded block was not initialized.");
+    debug_free(block);
+    LOG_CONSOLE_SUCCESS("Page guard passed reuse test.");
+
+    // Small blocks below the threshold still come from the C allocator.
+    uint8_t * small = (uint8_t *)debug_malloc(64, __FILE__, __LINE__);
+    ASSERT(is_memory_guard_intact(small, 64), "A block below the page guard threshold lost its guard bytes.");
+    debug_free(small);
+    debug_memory_set_page_guard(0, 0);
+}
+
+/**
+ * Keeps whether a line holding the expected text reached the sinks.
+ */
+typedef struct ReportSink {
+    LogSink sink;
+    char expected[128];
+    bool found;
+} ReportSink;
+
+static void write_report_line(LogSink * sink, const LogLine * line) {
+    ReportSink * report = (ReportSink *)sink;
+    size_t length = strlen(report->expected);
+    for (size_t index = 0; index + length <= line->length; index++)
+        if (memcmp(line->text + index, report->expected, length) == 0)
+            report->found = true;
+}
+
+static void flush_report(LogSink * sink) {
+    (void)sink;
+}
+
+void test_memory_quarantine(void) {
+    const size_t budget = 1024 * 1024;
+    debug_memory_set_quarantine_size(budget);
+
+    // Poison Test, a freed block is held back and filled with DEBUG_MEMORY_FREE_VALUE.
+    uint8_t * block = (uint8_t *)debug_malloc(100, __FILE__, __LINE__);
+    debug_free(block);
+    ASSERT(block[0] == DEBUG_MEMORY_FREE_VALUE && block[99] == DEBUG_MEMORY_FREE_VALUE, "A quarantined block was not poisoned.");
+    ASSERT(debug_memory_flush_quarantine() == 0, "An untouched quarantined block was reported as damaged.");
+    LOG_CONSOLE_SUCCESS("Quarantine passed poison test.");
+
+    // Use After Free Test, a write to a held block is found when the quarantine releases it.
+    block = (uint8_t *)debug_malloc(100, __FILE__, __LINE__);
+    debug_free(block);
+    block[42] = 0;
+    ASSERT(debug_memory_flush_quarantine() == 1, "A write to a quarantined block was not detected.");
+    LOG_CONSOLE_SUCCESS("Quarantine passed use after free test.");
+
+    // Budget Test, churn far beyond the budget keeps evicting, never holds more than the budget, without reporting damage.
+    for (int index = 0; index < 100000; index++) {
+        debug_free(debug_malloc(64 + (size_t)(index & 255), __FILE__, __LINE__));
+        ASSERT(debug_memory_quarantine_bytes() <= budget, "The quarantine held more than its budget.");
+    }
+    ASSERT(debug_memory_flush_quarantine() == 0, "Churning through the quarantine reported damage.");
+    ASSERT(debug_memory_quarantine_bytes() == 0, "A flushed quarantine still holds bytes.");
+    LOG_CONSOLE_SUCCESS("Quarantine passed budget test.");
+
+    // Eviction Test, a write to a held block is reported with its callsite once frees in its shard push it out.
+    uint8_t * victim = (uint8_t *)debug_malloc(100, __FILE__, __LINE__);
+    const int victim_line = __LINE__ - 1;
+    // The shard of a block is picked by the top 6 bits of its address hash, one of 64.
+    uint64_t victim_shard = hash_pointer(victim) >> 58;
+    debug_free(victim);
+    victim[7] = 0;
+
+    ReportSink report = { .sink = { write_report_line, flush_report, LOG_LEVEL_DEBUG } };
+    snprintf(report.expected, sizeof(report.expected), "allocated at %s:%d.", __FILE__, victim_line);
+    ASSERT(log_add_sink(&report.sink), "The report sink could not be added.");
+    // Blocks of other shards are kept until the end, so the C allocator does not hand the same addresses back.
+    enum { EVICTION_ATTEMPTS = 64 * 1024 };
+    void ** others = (void **)malloc(EVICTION_ATTEMPTS * sizeof(void *));
+    ASSERT(others != NULL, "malloc failed.");
+    size_t other_count = 0;
+    size_t shard_bytes = 0;
+    for (int index = 0; index < EVICTION_ATTEMPTS && !report.found; index++) {
+        uint8_t * churn = (uint8_t *)debug_malloc(256, __FILE__, __LINE__);
+        if (hash_pointer(churn) >> 58 != victim_shard) {
+            others[other_count++] = churn;
+            continue;
+        }
+        shard_bytes += 256;
+        debug_free(churn);
+    }
+    log_remove_sink(&report.sink);
+    for (size_t index = 0; index < other_count; index++)
+        debug_free(others[index]);
+    free(others);
+    ASSERT(report.found, "A write to a quarantined block was not reported with its callsite when it was evicted.");
+    ASSERT(shard_bytes > budget / 64 - 100 && shard_bytes <= budget / 64 + 256, "The block was not evicted once its shard went over its share of the budget.");
+    ASSERT(debug_memory_flush_quarantine() == 0, "An evicted block was reported again by the flush.");
+    LOG_CONSOLE_SUCCESS("Quarantine passed eviction test.");
+
+    debug_memory_set_quarantine_size(0);
+}
+
+void test_memory_tracking_modes(void) {
+    // Counters Test, counted blocks update the process-wide counters.
+    MemoryCounters before, after;
+    get_memory_counters(&before);
+    uint8_t * first = (uint8_t *)counted_malloc(100);
+    uint64_t * second = (uint64_t *)counted_calloc(8, sizeof(uint64_t));
+    ASSERT(first && second, "counted_malloc failed to allocate memory.");
+    ASSERT(((uintptr_t)first & 15) == 0 && ((uintptr_t)second & 15) == 0, "counted_malloc returned a block that is not 16-byte aligned.");
+    ASSERT(second[7] == 0, "counted_calloc did not zero the memory.");
+    first[99] = 99;
+    first = (uint8_t *)counted_realloc(first, 1000);
+    ASSERT(first[99] == 99, "counted_realloc did not preserve the contents.");
+    get_memory_counters(&after);
+    ASSERT(after.allocation_count - before.allocation_count == 3, "The allocation counter is wrong.");
+    ASSERT(after.live_bytes - before.live_bytes == 1000 + 8 * sizeof(uint64_t), "The live bytes counter is wrong.");
+    ASSERT(after.peak_live_bytes >= after.live_bytes, "The peak live bytes counter is below the live bytes.");
+    counted_free(first);
+    counted_free(second);
+    get_memory_counters(&after);
+    ASSERT(after.live_bytes == before.live_bytes && after.free_count - before.free_count == 3, "Freed blocks were left in the counters.");
+    LOG_CONSOLE_SUCCESS("Memory counters passed counters test.");
+
+    // Macro Test, the MEMORY_* macros map to the allocator of the selected mode.
+    uint8_t * block = (uint8_t *)MEMORY_ALLOC(32);
+    block = (uint8_t *)MEMORY_REALLOC(block, 64);
+#if MEMORY_TRACKING_MODE == MEMORY_TRACKING_FULL
+    ASSERT(is_memory_guard_intact(block, 64), "MEMORY_REALLOC did not use the debug allocator in full tracking mode.");
+#endif
+    MEMORY_FREE(block);
+    block = (uint8_t *)MEMORY_CALLOC(4, 16);
+    ASSERT(block[63] == 0, "MEMORY_CALLOC did not zero the memory.");
+    MEMORY_FREE(block);
+    LOG_CONSOLE_SUCCESS("Memory tracking passed macro test.");
+}
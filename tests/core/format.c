@@ -0,0 +1,108 @@
+#include "core/format.h"
+#include "core/debug.h"
+#include "core/log.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+void test_format_matches_snprintf(void);
+void test_format_truncation(void);
+void test_format_log_macros(void);
+
+int main(void) {
+    test_format_matches_snprintf();
+    LOG_CONSOLE_SUCCESS("test_format_matches_snprintf passed.");
+    test_format_truncation();
+    LOG_CONSOLE_SUCCESS("test_format_truncation passed.");
+    test_format_log_macros();
+    LOG_CONSOLE_SUCCESS("test_format_log_macros passed.");
+    return 0;
+}
+
+/**
+ * Formats with both format_string and snprintf and checks they agree on the text and the length.
+ */
+#define CHECK_FORMAT(...) do { \
+        char actual[512]; \
+        char expected[512]; \
+        size_t actual_length = format_string(actual, sizeof(actual), __VA_ARGS__); \
+        int expected_length = snprintf(expected, sizeof(expected), __VA_ARGS__); \
+        ASSERT_FORMAT(strcmp(actual, expected) == 0 && actual_length == (size_t)expected_length, \
+            "format_string gave \"%s\", snprintf gave \"%s\".", actual, expected); \
+    } while (0)
+
+void test_format_matches_snprintf(void) {
+    // Integers with every flag, width, precision and length modifier.
+    CHECK_FORMAT("plain text without conversions");
+    CHECK_FORMAT("%d %i %u %x %X %o", 0, -1, 4000000000u, 0xBEEFu, 0xBEEFu, 0755u);
+    CHECK_FORMAT("[%5d] [%-5d] [%05d] [%+d] [% d] [%.3d] [%8.3d] [%-8.3d]", 42, 42, -42, 42, 42, 7, -7, 7);
+    CHECK_FORMAT("[%.0d] [%5.0d] [%#x] [%#X] [%#o] [%#o] [%#.3o] [%#x]", 0, 0, 255u, 255u, 8u, 0u, 8u, 0u);
+    CHECK_FORMAT("%hhd %hhu %hd %hu %ld %lu %lld %llu", 300, 300, -70000, 70000, -123456789L, 123456789UL, (long long)INT64_MIN, (unsigned long long)UINT64_MAX);
+    CHECK_FORMAT("%zu %zd %jd %ju %td %llx %#llX", (size_t)1 << 40, (ptrdiff_t)-5, (intmax_t)INT64_MAX, (uintmax_t)1, (ptrdiff_t)-9, 0xDEADBEEFCAFEULL, 0xDEADBEEFCAFEULL);
+    CHECK_FORMAT("[%*d] [%-*d] [%.*d] [%*.*d]", 6, 1, 6, 1, 4, 1, -8, 3, 1);
+
+    // Characters, strings and pointers.
+    CHECK_FORMAT("[%c] [%3c] [%-3c] [%%] [%s] [%10s] [%-10s] [%.3s] [%10.2s]", 'a', 'b', 'c', "text", "right", "left", "truncated", "ab");
+    char unterminated[4] = { 'a', 'b', 'c', 'd' };
+    CHECK_FORMAT("[%.4s] [%.*s] [%s]", unterminated, 2, unterminated, "");
+    int value;
+    CHECK_FORMAT("[%p] [%20p] [%-20p]", (void *)&value, (void *)&value, (void *)&value);
+    CHECK_FORMAT("[%p]", (void *)0);
+
+    // Floating point, the fast %f path and the snprintf ones.
+    const double values[] = { 0.0, -0.0, 1.0, -1.5, 0.125, 0.375, 2.675, 1.005, 3.14159265358979, 123456.789, -9876543.21, 1e-7, 0.5, 1.5, 2.5, 1e15, 1e300, 4503599627370495.5 };
+    for (size_t index = 0; index < sizeof(values) / sizeof(values[0]); index++) {
+        double number = values[index];
+        CHECK_FORMAT("%f %.0f %.1f %.2f %.3f %.9f %.12f", number, number, number, number, number, number, number);
+        CHECK_FORMAT("[%12.3f] [%-12.3f] [%012.3f] [%+.2f] [% .2f] [%#.0f] [%F]", number, number, number, number, number, number, number);
+        CHECK_FORMAT("%e %.3E %g %G %a", number, number, number, number, number);
+    }
+    double infinity = 1e308 * 10.0;
+    CHECK_FORMAT("%f %f %5.1f %Lf %.2Lf", infinity, -infinity, infinity - infinity, (long double)1.25, (long double)-3.999);
+
+    // Seeded sweep of %f against snprintf.
+    uint64_t state = 0x9E3779B97F4A7C15ULL;
+    for (int index = 0; index < 100000; index++) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        double number = (double)(int64_t)(state >> 11) / (double)(1ULL << (state & 31));
+        CHECK_FORMAT("%.*f", (int)(state % 10), index & 1 ? number : -number);
+    }
+
+    // A lone percent is printed as written.
+    char text[32];
+    const char * trailing_percent = "100%";
+    format_string(text, sizeof(text), trailing_percent);
+    ASSERT(strcmp(text, "100%") == 0, "A trailing percent was not printed.");
+}
+
+void test_format_truncation(void) {
+    char buffer[8];
+    memset(buffer, 'x', sizeof(buffer));
+    size_t length = format_string(buffer, sizeof(buffer), "%s %d", "truncated", 12345);
+    ASSERT(length == 15 && strcmp(buffer, "truncat") == 0, "Truncated output is not terminated or its length is wrong.");
+
+    length = format_string(buffer, sizeof(buffer), "%.3f|%e", 1.0, 2.0);
+    ASSERT(length == 18 && strcmp(buffer, "1.000|2") == 0, "A truncated snprintf conversion overran the buffer.");
+
+    length = format_string(NULL, 0, "%d-%f", 100, 0.5);
+    ASSERT(length == 12, "format_string did not count the length without a buffer.");
+}
+
+void test_format_log_macros(void) {
+    int count = 3;
+    const char * name = "textures.pak";
+    LOG_CONSOLE_DEBUGF("Loaded %d assets from %s.", count, name);
+    LOG_CONSOLE_INFOF("Frame took %.3f ms.", 16.667);
+    LOG_CONSOLE_SUCCESSF("Pointer %p, size %zu.", (void *)name, sizeof(count));
+    LOG_CONSOLE_WARNINGF("Hex %#010x.", 0xBEEFu);
+    LOG_CONSOLE_ERRORF("No arguments.");
+
+    // Arguments of filtered macros are not evaluated.
+    int evaluated = 0;
+    log_set_level(LOG_LEVEL_WARNING);
+    LOG_CONSOLE_INFOF("Filtered %d.", ++evaluated);
+    log_set_level(LOG_LEVEL_DEBUG);
+    ASSERT(evaluated == 0, "A filtered LOG_CONSOLE_INFOF evaluated its arguments.");
+}
@@ -0,0 +1,249 @@
+#include "core/hash.h"
+#include "core/debug.h"
+#include "core/log.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define HASH_TEST_LENGTH 3000
+#define AVALANCHE_KEYS 100
+#define AVALANCHE_BITS 256
+#define AVALANCHE_TRIALS 25600
+#define COLLISION_KEYS 200000
+
+void test_hash_simd(void);
+void test_hash_stream(void);
+void test_hash_seed(void);
+void test_hash_avalanche(void);
+void test_hash_collisions(void);
+void test_hash_literal(void);
+
+static const STRING_SIMD SIMD_LEVELS[] = { STRING_SIMD_NONE, STRING_SIMD_SSE2, STRING_SIMD_AVX2, STRING_SIMD_NEON };
+static const char * SIMD_NAMES[] = { "scalar", "SSE2", "AVX2", "NEON" };
+
+static unsigned char test_data[HASH_TEST_LENGTH + 64];
+static uint64_t scalar_hashes[HASH_TEST_LENGTH + 1];
+
+/**
+ * A xorshift generator, the tests see the same bytes on every run.
+ */
+static uint64_t next_random(uint64_t * state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+int main(void) {
+    uint64_t random = 0x2545F4914F6CDD1DULL;
+    for (size_t index = 0; index < sizeof(test_data); index++)
+        test_data[index] = (unsigned char)next_random(&random);
+
+    // Every instruction set must give the hashes of the scalar code.
+    STRING_SIMD detected = hash_simd();
+    hash_set_simd(STRING_SIMD_NONE);
+    for (size_t length = 0; length <= HASH_TEST_LENGTH; length++)
+        scalar_hashes[length] = hash_bytes(test_data, length, 0);
+    for (size_t level = 0; level < sizeof(SIMD_LEVELS) / sizeof(SIMD_LEVELS[0]); level++) {
+        if (!hash_set_simd(SIMD_LEVELS[level]))
+            continue;
+        test_hash_simd();
+        test_hash_stream();
+        LOG_CONSOLE_SUCCESSF("Hash tests passed with %s.", SIMD_NAMES[level]);
+    }
+    hash_set_simd(detected);
+
+    test_hash_seed();
+    LOG_CONSOLE_SUCCESS("test_hash_seed passed.");
+    test_hash_avalanche();
+    LOG_CONSOLE_SUCCESS("test_hash_avalanche passed.");
+    test_hash_collisions();
+    LOG_CONSOLE_SUCCESS("test_hash_collisions passed.");
+    test_hash_literal();
+    LOG_CONSOLE_SUCCESS("test_hash_literal passed.");
+    return 0;
+}
+
+void test_hash_simd(void) {
+    for (size_t length = 0; length <= HASH_TEST_LENGTH; length++)
+        ASSERT_FORMAT(hash_bytes(test_data, length, 0) == scalar_hashes[length], "The hash of %zu bytes differs from the scalar one.", length);
+    // Unaligned input hashes the same as aligned.
+    static unsigned char moved[HASH_TEST_LENGTH + 8];
+    for (size_t offset = 1; offset < 8; offset++) {
+        memcpy(moved + offset, test_data, HASH_TEST_LENGTH);
+        ASSERT_FORMAT(hash_bytes(moved + offset, HASH_TEST_LENGTH, 0) == scalar_hashes[HASH_TEST_LENGTH], "The hash at offset %zu differs.", offset);
+    }
+}
+
+void test_hash_stream(void) {
+    // Pieces of one byte, of odd sizes and of more than a block, around every block boundary.
+    static const size_t PIECES[] = { 1, 7, 64, 100, 1024, 1500 };
+    HashState state;
+    for (size_t piece = 0; piece < sizeof(PIECES) / sizeof(PIECES[0]); piece++) {
+        for (size_t length = 0; length <= HASH_TEST_LENGTH; length++) {
+            hash_stream_init(&state, 0);
+            for (size_t offset = 0; offset < length; offset += PIECES[piece])
+                hash_stream_update(&state, test_data + offset, length - offset < PIECES[piece] ? length - offset : PIECES[piece]);
+            ASSERT_FORMAT(hash_stream_final(&state) == scalar_hashes[length], "Streaming %zu bytes in pieces of %zu gave another hash.", length, PIECES[piece]);
+        }
+    }
+
+    // Pieces of varying sizes, and a state that keeps being fed after a final.
+    uint64_t random = 42;
+    hash_stream_init(&state, 7);
+    hash_stream_update(&state, NULL, 0);
+    size_t offset = 0;
+    while (offset < HASH_TEST_LENGTH) {
+        size_t count = next_random(&random) % 300;
+        count = count < HASH_TEST_LENGTH - offset ? count : HASH_TEST_LENGTH - offset;
+        hash_stream_update(&state, test_data + offset, count);
+        offset += count;
+        ASSERT_FORMAT(hash_stream_final(&state) == hash_bytes(test_data, offset, 7), "Streaming %zu bytes in random pieces gave another hash.", offset);
+    }
+}
+
+void test_hash_seed(void) {
+    static const size_t LENGTHS[] = { 0, 3, 8, 16, 17, 100, 256, 257, 1024, 3000 };
+    for (size_t index = 0; index < sizeof(LENGTHS) / sizeof(LENGTHS[0]); index++) {
+        size_t length = LENGTHS[index];
+        uint64_t hash = hash_bytes(test_data, length, 0);
+        ASSERT_FORMAT(hash_bytes(test_data, length, 1) != hash && hash_bytes(test_data, length, 1ULL << 63) != hash, "The seed did not change the hash of %zu bytes.", length);
+        ASSERT_FORMAT(length == 0 || hash_bytes(test_data + 1, length, 0) != hash, "Other bytes of length %zu gave the same hash.", length);
+    }
+    ASSERT(hash_string("hash me") == hash_bytes("hash me", 7, 0), "hash_string is not hash_bytes of the string.");
+    ASSERT(hash_string(NULL) == hash_bytes(NULL, 0, 0) && hash_string("") == hash_string(NULL), "NULL is not the empty string.");
+    // Zeros are bytes like any other, lengths made of zeros must differ.
+    static const unsigned char ZEROS[32] = { 0 };
+    for (size_t length = 0; length < 32; length++)
+        ASSERT_FORMAT(hash_bytes(ZEROS, length, 0) != hash_bytes(ZEROS, length + 1, 0), "%zu and %zu zeros gave the same hash.", length, length + 1);
+    ASSERT(hash_pointer(&test_data[0]) != hash_pointer(&test_data[8]) && hash_pointer(NULL) == hash_u64(0), "hash_pointer did not mix the address.");
+}
+
+/**
+ * Flips input bits of random keys and checks that each output bit flips half the time,
+ * and that each input bit flips half the output bits.
+ *
+ * @param length The key length in bytes, 0 tests hash_u64 on 8 bytes.
+ */
+static void check_hash_avalanche(size_t length) {
+    static unsigned char key[HASH_TEST_LENGTH];
+    static uint32_t output_flips[64];
+    size_t key_length = length ? length : 8;
+    size_t bits = key_length * 8 < AVALANCHE_BITS ? key_length * 8 : AVALANCHE_BITS;
+    size_t stride = key_length * 8 / bits;
+    size_t keys = AVALANCHE_TRIALS / bits;
+    uint64_t random = 1234567 + length;
+    memset(output_flips, 0, sizeof(output_flips));
+    for (size_t sample = 0; sample < keys; sample++) {
+        for (size_t index = 0; index < key_length; index++)
+            key[index] = (unsigned char)next_random(&random);
+        uint64_t word;
+        memcpy(&word, key, 8);
+        uint64_t hash = length ? hash_bytes(key, length, 0) : hash_u64(word);
+        for (size_t bit = 0; bit < bits; bit++) {
+            size_t flipped = bit * stride + (size_t)(next_random(&random) % stride);
+            key[flipped / 8] ^= (unsigned char)(1 << (flipped % 8));
+            memcpy(&word, key, 8);
+            uint64_t difference = hash ^ (length ? hash_bytes(key, length, 0) : hash_u64(word));
+            key[flipped / 8] ^= (unsigned char)(1 << (flipped % 8));
+            for (int output = 0; output < 64; output++)
+                output_flips[output] += (difference >> output) & 1;
+        }
+    }
+    // Half of AVALANCHE_TRIALS flip, with a standard deviation of 0.3% when keys have more than 256 values.
+    for (int output = 0; output < 64; output++) {
+        double rate = output_flips[output] / (double)(keys * bits);
+        ASSERT_FORMAT(rate > 0.47 && rate < 0.53, "Output bit %d of a %zu-byte hash flipped %.3f of the time.", output, length, rate);
+    }
+}
+
+/**
+ * Checks that every input bit of a key changes about half the output bits, none is ignored.
+ */
+static void check_hash_bit_use(size_t length) {
+    static unsigned char key[HASH_TEST_LENGTH];
+    uint64_t random = 7654321 + length;
+    for (size_t bit = 0; bit < length * 8; bit += length > 64 ? 61 : 1) {
+        uint32_t flips = 0;
+        for (int sample = 0; sample < AVALANCHE_KEYS; sample++) {
+            for (size_t index = 0; index < length; index++)
+                key[index] = (unsigned char)next_random(&random);
+            uint64_t hash = hash_bytes(key, length, 0);
+            key[bit / 8] ^= (unsigned char)(1 << (bit % 8));
+            uint64_t difference = hash ^ hash_bytes(key, length, 0);
+            for (int output = 0; output < 64; output++)
+                flips += (difference >> output) & 1;
+        }
+        double average = (double)flips / AVALANCHE_KEYS;
+        ASSERT_FORMAT(average > 28.0 && average < 36.0, "Bit %zu of a %zu-byte key flipped %.1f output bits on average.", bit, length, average);
+    }
+}
+
+void test_hash_avalanche(void) {
+    static const size_t LENGTHS[] = { 0, 2, 3, 4, 8, 12, 16, 24, 48, 100, 256, 257, 1100, 2100 };
+    for (size_t index = 0; index < sizeof(LENGTHS) / sizeof(LENGTHS[0]); index++)
+        check_hash_avalanche(LENGTHS[index]);
+    static const size_t BIT_LENGTHS[] = { 1, 5, 16, 33, 200, 300, 1025 };
+    for (size_t index = 0; index < sizeof(BIT_LENGTHS) / sizeof(BIT_LENGTHS[0]); index++)
+        check_hash_bit_use(BIT_LENGTHS[index]);
+}
+
+/**
+ * Orders hashes for qsort.
+ */
+static int compare_hashes(const void * one, const void * two) {
+    uint64_t first = *(const uint64_t *)one;
+    uint64_t second = *(const uint64_t *)two;
+    return (first > second) - (first < second);
+}
+
+/**
+ * Counts the hashes equal to the one before them, in place.
+ *
+ * @param mask The bits compared.
+ */
+static size_t count_hash_collisions(uint64_t * hashes, size_t count, uint64_t mask) {
+    for (size_t index = 0; index < count; index++)
+        hashes[index] &= mask;
+    qsort(hashes, count, sizeof(uint64_t), compare_hashes);
+    size_t collisions = 0;
+    for (size_t index = 1; index < count; index++)
+        collisions += hashes[index] == hashes[index - 1];
+    return collisions;
+}
+
+void test_hash_collisions(void) {
+    // 200000 keys make about 4.7 collisions in 32 bits by chance, and none in 64.
+    static uint64_t hashes[COLLISION_KEYS];
+    static uint64_t low_hashes[COLLISION_KEYS];
+    char name[32];
+    for (int kind = 0; kind < 3; kind++) {
+        for (uint64_t index = 0; index < COLLISION_KEYS; index++) {
+            if (kind == 0) {
+                hashes[index] = hash_bytes(&index, sizeof(index), 0);
+            } else if (kind == 1) {
+                int length = snprintf(name, sizeof(name), "entity.%llu.name", (unsigned long long)index);
+                hashes[index] = hash_bytes(name, (size_t)length, 0);
+            } else {
+                hashes[index] = hash_u64(index << 12);
+            }
+        }
+        memcpy(low_hashes, hashes, sizeof(hashes));
+        size_t collisions = count_hash_collisions(hashes, COLLISION_KEYS, UINT64_MAX);
+        size_t low_collisions = count_hash_collisions(low_hashes, COLLISION_KEYS, UINT32_MAX);
+        ASSERT_FORMAT(collisions == 0 && low_collisions < 20, "Key set %d made %zu collisions, %zu in the low 32 bits.", kind, collisions, low_collisions);
+    }
+}
+
+// Hashed by the compiler, in a static initializer.
+static const uint64_t LITERAL_HASHES[] = { HASH_LITERAL(""), HASH_LITERAL("a"), HASH_LITERAL("log.level"), HASH_LITERAL("0123456789abcdef0123456789abcdef0123456789abcdef0123456789abcdef") };
+static const char * LITERALS[] = { "", "a", "log.level", "0123456789abcdef0123456789abcdef0123456789abcdef0123456789abcdef" };
+
+void test_hash_literal(void) {
+    for (size_t index = 0; index < sizeof(LITERALS) / sizeof(LITERALS[0]); index++)
+        ASSERT_FORMAT(LITERAL_HASHES[index] == hash_fnv1a(LITERALS[index], strlen(LITERALS[index])), "HASH_LITERAL(\"%s\") is not hash_fnv1a.", LITERALS[index]);
+    ASSERT(HASH_LITERAL("") == HASH_FNV_OFFSET && HASH_LITERAL("a") == 0xaf63dc4c8601ec8cULL, "HASH_LITERAL is not FNV-1a.");
+    // A zero inside the literal is hashed, the terminator is not.
+    ASSERT(HASH_LITERAL("a\0b") == hash_fnv1a("a\0b", 3), "HASH_LITERAL dropped the bytes after a zero.");
+}
@@ -0,0 +1,126 @@
+#include "core/intern.h"
+#include "core/debug.h"
+#include "core/log.h"
+#include "core/thread.h"
+#include <stdio.h>
+#include <string.h>
+
+#define INTERN_THREADS 4
+#define INTERN_THREAD_STRINGS 5000
+
+void test_intern_string(void);
+void test_intern_view(void);
+void test_intern_static(void);
+void test_intern_growth(void);
+void test_intern_threads(void);
+
+int main(void) {
+    test_intern_string();
+    LOG_CONSOLE_SUCCESS("test_intern_string passed.");
+    test_intern_view();
+    LOG_CONSOLE_SUCCESS("test_intern_view passed.");
+    test_intern_static();
+    LOG_CONSOLE_SUCCESS("test_intern_static passed.");
+    test_intern_growth();
+    LOG_CONSOLE_SUCCESS("test_intern_growth passed.");
+    test_intern_threads();
+    LOG_CONSOLE_SUCCESS("test_intern_threads passed.");
+    return 0;
+}
+
+void test_intern_string(void) {
+    char copy[16];
+    strcpy(copy, "intern me");
+    InternHandle first = intern_string("intern me");
+    InternHandle second = intern_string(copy);
+    ASSERT(first != INTERN_NONE && first == second, "Equal strings got different handles.");
+    ASSERT(intern_string("intern you") != first, "Different strings got the same handle.");
+
+    // The string is a copy, changing the original does not change it.
+    copy[0] = 'I';
+    ASSERT(strcmp(intern_get(first), "intern me") == 0 && intern_get(first) != copy, "The interned string is not a copy.");
+    ASSERT(intern_get(first) == intern_get(second), "Equal handles gave different strings.");
+    ASSERT(intern_string(NULL) == INTERN_NONE && intern_get(INTERN_NONE) == NULL, "NULL was interned.");
+    ASSERT(intern_get(first + 100000) == NULL, "A handle never given out gave a string.");
+}
+
+void test_intern_view(void) {
+    // Views are interned by their bytes, zeros included, and terminated.
+    StringView part = string_view_slice(STRING_VIEW_LITERAL("config.key=value"), 0, 10);
+    InternHandle handle = intern_view(part);
+    ASSERT(handle == intern_string("config.key"), "A view and the equal string got different handles.");
+    ASSERT(intern_get(handle)[10] == '\0', "The interned view is not terminated.");
+    InternHandle zeros = intern_view(STRING_VIEW_LITERAL("a\0b"));
+    ASSERT(zeros != intern_string("a") && intern_get_view(zeros).length == 3, "Bytes after a zero were dropped.");
+    ASSERT(intern_view(string_view(NULL)) == intern_string(""), "The empty view is not the empty string.");
+
+    // Lookups never intern.
+    size_t count = intern_count();
+    ASSERT(intern_lookup(STRING_VIEW_LITERAL("never interned")) == INTERN_NONE && intern_count() == count, "intern_lookup interned a string.");
+    ASSERT(intern_lookup(STRING_VIEW_LITERAL("config.key")) == handle, "intern_lookup did not find an interned string.");
+}
+
+void test_intern_static(void) {
+    // The same file name at two addresses, as two translation units would have it.
+    static const char FILE_COPY[] = __FILE__;
+    InternHandle handle = intern_static(__FILE__);
+    ASSERT(handle != INTERN_NONE && intern_static(__FILE__) == handle, "intern_static did not remember the address.");
+    ASSERT(intern_static(FILE_COPY) == handle && intern_string(__FILE__) == handle, "intern_static did not merge equal strings.");
+    ASSERT(intern_static(NULL) == INTERN_NONE, "intern_static interned NULL.");
+}
+
+void test_intern_growth(void) {
+    // Enough strings to grow the table and fill several directory pages, with their handles checked after.
+    char name[32];
+    static InternHandle handles[INTERN_PAGE_STRINGS * 3];
+    for (size_t index = 0; index < sizeof(handles) / sizeof(handles[0]); index++) {
+        snprintf(name, sizeof(name), "growth.%zu", index);
+        handles[index] = intern_string(name);
+    }
+    for (size_t index = 0; index < sizeof(handles) / sizeof(handles[0]); index++) {
+        snprintf(name, sizeof(name), "growth.%zu", index);
+        ASSERT_FORMAT(intern_lookup(string_view(name)) == handles[index] && strcmp(intern_get(handles[index]), name) == 0, "String %zu was lost growing the table.", index);
+    }
+    ASSERT(intern_memory_bytes() > INTERN_PAGE_STRINGS * 3 * sizeof(InternHandle), "intern_memory_bytes did not count the tables.");
+}
+
+typedef struct InternWorker {
+    Thread thread;
+    int number;
+    InternHandle handles[INTERN_THREAD_STRINGS];
+} InternWorker;
+
+/**
+ * Interns strings shared by every worker and a few of its own, while the others grow the table.
+ */
+static void run_intern_worker(void * argument) {
+    InternWorker * worker = (InternWorker *)argument;
+    char name[32];
+    for (int index = 0; index < INTERN_THREAD_STRINGS; index++) {
+        if (index % 10)
+            snprintf(name, sizeof(name), "shared.%d", index);
+        else
+            snprintf(name, sizeof(name), "own.%d.%d", worker->number, index);
+        worker->handles[index] = intern_string(name);
+    }
+}
+
+void test_intern_threads(void) {
+    static InternWorker workers[INTERN_THREADS];
+    for (int index = 0; index < INTERN_THREADS; index++) {
+        workers[index].number = index;
+        ASSERT(thread_create(&workers[index].thread, run_intern_worker, &workers[index]), "Could not start an interning thread.");
+    }
+    for (int index = 0; index < INTERN_THREADS; index++)
+        thread_join(&workers[index].thread);
+
+    // Every thread got the same handle for a shared string, and its own strings are distinct.
+    for (int index = 0; index < INTERN_THREAD_STRINGS; index++) {
+        for (int worker = 1; worker < INTERN_THREADS; worker++) {
+            if (index % 10)
+                ASSERT(workers[worker].handles[index] == workers[0].handles[index], "Threads got different handles for a string.");
+            else
+                ASSERT(workers[worker].handles[index] != workers[0].handles[index], "Threads got the same handle for different strings.");
+        }
+    }
+}
@@ -1,16 +1,23 @@
 #include "core/log.h"
 #include "core/string.h"
+#include "core/thread.h"
+#include "core/context.h"
+#include <stdlib.h>
 
 void test_log_message_to_console(void);
 void test_log_macros(void);
 void test_string_to_log_level(void);
 void test_log_level_to_string(void);
+void test_log_async(void);
+void test_log_levels(void);
 
 int main(int argc, char ** argv) {
     test_log_message_to_console();
     test_log_macros();
     test_string_to_log_level();
     test_log_level_to_string();
+    test_log_async();
+    test_log_levels();
     return 0;
 }
 
@@ -106,4 +113,72 @@ void test_log_level_to_string(void) {
         LOG_CONSOLE_SUCCESS("Converison from LOG_LEVEL_FATAL to string 'FATAL' was successful.");
     else
         LOG_CONSOLE_ERROR("Conversion from LOG_LEVEL_FATAL to string 'FATAL' has failed.");
-}
\ No newline at end of file
+}
+
+static void log_async_producer(void * argument) {
+    (void)argument;
+    for (int index = 0; index < 50; index++)
+        LOG_CONSOLE_INFO("This is an asynchronous INFO message from a producer thread.");
+}
+
+void test_log_async(void) {
+    if (!log_async_start(64, LOG_OVERFLOW_BLOCK)) {
+        LOG_CONSOLE_ERROR("Asynchronous logging failed to start.");
+        return;
+    }
+    if (log_async_start(64, LOG_OVERFLOW_BLOCK))
+        LOG_CONSOLE_ERROR("Asynchronous logging started twice.");
+
+    Thread producers[4];
+    for (int index = 0; index < 4; index++)
+        thread_create(&producers[index], log_async_producer, NULL);
+    for (int index = 0; index < 4; index++)
+        thread_join(&producers[index]);
+    log_async_flush();
+    if (log_async_dropped_count() == 0)
+        LOG_CONSOLE_SUCCESS("Asynchronous logging with the block policy wrote every message.");
+    else
+        LOG_CONSOLE_ERROR("Asynchronous logging with the block policy dropped messages.");
+    log_async_stop();
+
+    if (!log_async_start(4, LOG_OVERFLOW_DROP_OLDEST)) {
+        LOG_CONSOLE_ERROR("Asynchronous logging failed to restart.");
+        return;
+    }
+    for (int index = 0; index < 50; index++)
+        LOG_CONSOLE_DEBUG("This is an asynchronous DEBUG message that may be dropped.");
+    log_async_stop();
+    LOG_CONSOLE_SUCCESS("Asynchronous logging stopped and returned to synchronous mode.");
+}
+
+static int log_argument_evaluations = 0;
+
+static const char * count_log_argument(const char * message) {
+    log_argument_evaluations++;
+    return message;
+}
+
+void test_log_levels(void) {
+    log_set_level(LOG_LEVEL_WARNING);
+    LOG_CONSOLE_DEBUG(count_log_argument("This DEBUG message is below the minimum level."));
+    LOG_CONSOLE_INFO(count_log_argument("This INFO message is below the minimum level."));
+    LOG_CONSOLE_WARNING(count_log_argument("This WARNING message is at the minimum level."));
+    log_set_level(LOG_LEVEL_DEBUG);
+    if (log_argument_evaluations == 1)
+        LOG_CONSOLE_SUCCESS("Messages below the minimum level were filtered before their arguments were evaluated.");
+    else
+        LOG_CONSOLE_ERROR("Messages below the minimum level were not filtered.");
+
+#if OS_WINDOWS
+    _putenv_s("ORIGINALIS_TEST_LOG_LEVEL", "ERROR");
+#else
+    setenv("ORIGINALIS_TEST_LOG_LEVEL", "ERROR", 1);
+#endif
+    bool applied = log_set_level_from_environment("ORIGINALIS_TEST_LOG_LEVEL");
+    LOG_LEVEL level = log_minimum_level;
+    log_set_level(LOG_LEVEL_DEBUG);
+    if (applied && level == LOG_LEVEL_ERROR && !log_set_level_from_environment("ORIGINALIS_TEST_UNSET_LOG_LEVEL"))
+        LOG_CONSOLE_SUCCESS("The minimum level was read from the environment.");
+    else
+        LOG_CONSOLE_ERROR("The minimum level was not read from the environment.");
+}
@@ -0,0 +1,261 @@
+#include "core/log_encode.h"
+#include "core/debug.h"
+#include "core/log.h"
+#include "core/time.h"
+#include <stdio.h>
+#include <string.h>
+
+void test_log_encode_json_string(void);
+void test_log_encode_logfmt_value(void);
+void test_log_encode_fields(void);
+void test_log_encode_record(void);
+void test_log_structured_lines(void);
+
+int main(void) {
+    test_log_encode_json_string();
+    LOG_CONSOLE_SUCCESS("test_log_encode_json_string passed.");
+    test_log_encode_logfmt_value();
+    LOG_CONSOLE_SUCCESS("test_log_encode_logfmt_value passed.");
+    test_log_encode_fields();
+    LOG_CONSOLE_SUCCESS("test_log_encode_fields passed.");
+    test_log_encode_record();
+    LOG_CONSOLE_SUCCESS("test_log_encode_record passed.");
+    test_log_structured_lines();
+    LOG_CONSOLE_SUCCESS("test_log_structured_lines passed.");
+    return 0;
+}
+
+/**
+ * Escapes one byte at a time, the reference for the vectorized scan.
+ */
+static size_t escape_json_reference(char * output, const char * text, size_t length) {
+    size_t written = 0;
+    output[written++] = '"';
+    for (size_t index = 0; index < length; index++) {
+        unsigned char byte = (unsigned char)text[index];
+        if (byte == '"' || byte == '\\') {
+            output[written++] = '\\';
+            output[written++] = (char)byte;
+        } else if (byte == '\n') {
+            written += (size_t)sprintf(output + written, "\\n");
+        } else if (byte == '\t') {
+            written += (size_t)sprintf(output + written, "\\t");
+        } else if (byte == '\r') {
+            written += (size_t)sprintf(output + written, "\\r");
+        } else if (byte == '\b') {
+            written += (size_t)sprintf(output + written, "\\b");
+        } else if (byte == '\f') {
+            written += (size_t)sprintf(output + written, "\\f");
+        } else if (byte < 0x20) {
+            written += (size_t)sprintf(output + written, "\\u%04x", byte);
+        } else {
+            output[written++] = (char)byte;
+        }
+    }
+    output[written++] = '"';
+    return written;
+}
+
+void test_log_encode_json_string(void) {
+    char text[100];
+    char actual[700];
+    char expected[700];
+    LogEncoder encoder;
+
+    // Every byte that needs escaping, at every offset of a string longer than one vector.
+    const char SPECIALS[] = { '"', '\\', '\n', '\t', '\r', '\b', '\f', '\x01', '\x1F', '\x7F', '\x80', (char)0xC3 };
+    for (size_t special = 0; special < sizeof(SPECIALS); special++) {
+        for (size_t offset = 0; offset < 40; offset++) {
+            memset(text, 'a', sizeof(text));
+            text[offset] = SPECIALS[special];
+            text[offset + 17] = SPECIALS[special];
+            size_t length = 41 + offset % 23;
+
+            log_encoder_init(&encoder, actual, sizeof(actual));
+            log_encode_json_string(&encoder, text, length);
+            size_t expected_length = escape_json_reference(expected, text, length);
+            ASSERT_FORMAT(encoder.length == expected_length && memcmp(actual, expected, expected_length) == 0,
+                "Byte 0x%02x at %zu was not escaped as \"%.*s\".", (unsigned char)SPECIALS[special], offset, (int)expected_length, expected);
+        }
+    }
+
+    // Strings shorter than a vector, and the length counted past the end of a small buffer.
+    log_encoder_init(&encoder, actual, sizeof(actual));
+    log_encode_json_string(&encoder, "", 0);
+    log_encode_json_string(&encoder, "a\"b", 3);
+    ASSERT(encoder.length == 8 && memcmp(actual, "\"\"\"a\\\"b\"", 8) == 0, "Short strings were not escaped.");
+
+    char small[4];
+    log_encoder_init(&encoder, small, sizeof(small));
+    log_encode_json_string(&encoder, "line\nbreak", 10);
+    ASSERT(encoder.length == 13 && memcmp(small, "\"lin", 4) == 0, "A truncated string was not counted whole.");
+}
+
+void test_log_encode_logfmt_value(void) {
+    char actual[64];
+    LogEncoder encoder;
+    log_encoder_init(&encoder, actual, sizeof(actual));
+    log_encode_logfmt_value(&encoder, "plain", 5);
+    log_encode_logfmt_value(&encoder, " ", 0);
+    log_encode_logfmt_value(&encoder, "two words", 9);
+    log_encode_logfmt_value(&encoder, "a=b", 3);
+    log_encode_logfmt_value(&encoder, "tab\t", 4);
+    const char expected[] = "plain\"\"\"two words\"\"a=b\"\"tab\\t\"";
+    ASSERT_FORMAT(encoder.length == sizeof(expected) - 1 && memcmp(actual, expected, sizeof(expected) - 1) == 0,
+        "logfmt values were encoded as \"%.*s\".", (int)encoder.length, actual);
+}
+
+void test_log_encode_fields(void) {
+    const LogField fields[] = {
+        LOG_FIELD_STRING("pack", "textures \"hd\".pak"),
+        LOG_FIELD_INTEGER("count", -42),
+        LOG_FIELD_UNSIGNED("bytes", 18446744073709551615ULL),
+        LOG_FIELD_FLOAT("ratio", 0.1),
+        LOG_FIELD_BOOLEAN("cached", true),
+        LOG_FIELD_FLOAT("missing", 1e308 * 10.0),
+    };
+    char actual[256];
+    LogEncoder encoder;
+
+    log_encoder_init(&encoder, actual, sizeof(actual));
+    log_encode_fields(&encoder, LOG_ENCODING_JSON, fields, sizeof(fields) / sizeof(fields[0]));
+    const char json[] = ",\"pack\":\"textures \\\"hd\\\".pak\",\"count\":-42,\"bytes\":18446744073709551615,\"ratio\":0.1,\"cached\":true,\"missing\":null";
+    ASSERT_FORMAT(encoder.length == sizeof(json) - 1 && memcmp(actual, json, sizeof(json) - 1) == 0,
+        "JSON fields were encoded as \"%.*s\".", (int)encoder.length, actual);
+
+    log_encoder_init(&encoder, actual, sizeof(actual));
+    log_encode_fields(&encoder, LOG_ENCODING_LOGFMT, fields, 5);
+    const char logfmt[] = " pack=\"textures \\\"hd\\\".pak\" count=-42 bytes=18446744073709551615 ratio=0.1 cached=true";
+    ASSERT_FORMAT(encoder.length == sizeof(logfmt) - 1 && memcmp(actual, logfmt, sizeof(logfmt) - 1) == 0,
+        "logfmt fields were encoded as \"%.*s\".", (int)encoder.length, actual);
+
+    // Floats within a rounding of 9 decimals are written short, the others as %.15g.
+    const LogField floats[] = {
+        LOG_FIELD_FLOAT("a", -2.25), LOG_FIELD_FLOAT("b", 1e-7), LOG_FIELD_FLOAT("c", 1.0 / 3.0), LOG_FIELD_FLOAT("d", 1e20), LOG_FIELD_FLOAT("e", 4096.0),
+    };
+    log_encoder_init(&encoder, actual, sizeof(actual));
+    log_encode_fields(&encoder, LOG_ENCODING_LOGFMT, floats, sizeof(floats) / sizeof(floats[0]));
+    const char float_text[] = " a=-2.25 b=0.0000001 c=0.333333333333333 d=1e+20 e=4096";
+    ASSERT_FORMAT(encoder.length == sizeof(float_text) - 1 && memcmp(actual, float_text, sizeof(float_text) - 1) == 0,
+        "Float fields were encoded as \"%.*s\".", (int)encoder.length, actual);
+
+    // A field that does not fit is dropped whole, with the ones after it.
+    log_encoder_init(&encoder, actual, 40);
+    log_encode_fields(&encoder, LOG_ENCODING_JSON, fields + 1, 3);
+    ASSERT(encoder.length == 12 && memcmp(actual, ",\"count\":-42", 12) == 0, "A field that overflowed was kept.");
+}
+
+void test_log_encode_record(void) {
+    uint64_t wall = 1700000000123456000ULL;
+    char timestamp[TIME_UTC_TIMESTAMP_LENGTH + 1];
+    time_format_utc(wall, timestamp);
+    ASSERT(strcmp(timestamp, "2023-11-14T22:13:20.123456Z") == 0, "The record time is not UTC.");
+
+    char fields[64];
+    LogEncoder encoder;
+    LogField field = LOG_FIELD_INTEGER("count", 3);
+    log_encoder_init(&encoder, fields, sizeof(fields));
+    log_encode_fields(&encoder, LOG_ENCODING_JSON, &field, 1);
+    size_t fields_length = encoder.length;
+
+    char actual[512];
+    char expected[512];
+    log_encoder_init(&encoder, actual, sizeof(actual));
+    log_encode_record(&encoder, LOG_ENCODING_JSON, wall, LOG_LEVEL_WARNING, "load_pack", "source/pack.c", 12, "Loaded \"pack\".", 14, fields, fields_length);
+    int expected_length = snprintf(expected, sizeof(expected),
+        "{\"time\":\"%s\",\"level\":\"WARNING\",\"func\":\"load_pack\",\"file\":\"source/pack.c\",\"line\":12,\"message\":\"Loaded \\\"pack\\\".\",\"count\":3}\n", timestamp);
+    ASSERT_FORMAT(encoder.length == (size_t)expected_length && memcmp(actual, expected, encoder.length) == 0,
+        "The JSON record was encoded as \"%.*s\".", (int)encoder.length, actual);
+
+    log_encoder_init(&encoder, fields, sizeof(fields));
+    log_encode_fields(&encoder, LOG_ENCODING_LOGFMT, &field, 1);
+    fields_length = encoder.length;
+    log_encoder_init(&encoder, actual, sizeof(actual));
+    log_encode_record(&encoder, LOG_ENCODING_LOGFMT, wall, LOG_LEVEL_INFO, "load_pack", "source/pack.c", 12, "Loaded.", 7, fields, fields_length);
+    expected_length = snprintf(expected, sizeof(expected), "time=%s level=INFO func=load_pack file=source/pack.c line=12 message=Loaded. count=3\n", timestamp);
+    ASSERT_FORMAT(encoder.length == (size_t)expected_length && memcmp(actual, expected, encoder.length) == 0,
+        "The logfmt record was encoded as \"%.*s\".", (int)encoder.length, actual);
+}
+
+/**
+ * Keeps the last line written to it.
+ */
+typedef struct CaptureSink {
+    LogSink sink;
+    char text[4096];
+    size_t length;
+    size_t label_length;
+} CaptureSink;
+
+static void write_capture_line(LogSink * sink, const LogLine * line) {
+    CaptureSink * capture = (CaptureSink *)sink;
+    capture->length = line->length < sizeof(capture->text) ? line->length : sizeof(capture->text);
+    memcpy(capture->text, line->text, capture->length);
+    capture->label_length = line->label_length;
+}
+
+static void flush_capture(LogSink * sink) {
+    (void)sink;
+}
+
+static bool capture_contains(const CaptureSink * capture, const char * text) {
+    size_t length = strlen(text);
+    for (size_t index = 0; index + length <= capture->length; index++)
+        if (memcmp(capture->text + index, text, length) == 0)
+            return true;
+    return false;
+}
+
+void test_log_structured_lines(void) {
+    CaptureSink capture = { .sink = { write_capture_line, flush_capture, LOG_LEVEL_DEBUG } };
+    ASSERT(log_add_sink(&capture.sink), "The capture sink could not be added.");
+
+    // Text lines carry the fields after the message.
+    LOG_CONSOLE_FIELDS(LOG_LEVEL_INFO, "Loaded.", LOG_FIELD_STRING("pack", "ui.pak"), LOG_FIELD_INTEGER("count", 7));
+    ASSERT(capture_contains(&capture, "[INFO]") && capture_contains(&capture, "Loaded. pack=ui.pak count=7\n"), "The text line is missing its fields.");
+    ASSERT(capture.label_length > 0, "The text line has no label.");
+
+    log_set_encoding(LOG_ENCODING_JSON);
+    LOG_CONSOLE_FIELDS(LOG_LEVEL_WARNING, "Slow \"frame\".", LOG_FIELD_FLOAT("ms", 33.5), LOG_FIELD_BOOLEAN("vsync", false));
+    ASSERT(capture.text[0] == '{' && capture.text[capture.length - 2] == '}' && capture.text[capture.length - 1] == '\n', "The JSON line is not an object on one line.");
+    ASSERT(capture_contains(&capture, "\"level\":\"WARNING\"") && capture_contains(&capture, "\"message\":\"Slow \\\"frame\\\".\",\"ms\":33.5,\"vsync\":false}"),
+        "The JSON line is missing its message or fields.");
+    ASSERT(capture.label_length == 0, "A JSON line has a label to color.");
+
+    LOG_CONSOLE_INFOF("Formatted %d.", 5);
+    ASSERT(capture_contains(&capture, "\"message\":\"Formatted 5.\"}"), "A formatted message was not encoded.");
+
+    // Messages past the stack buffer they are formatted in are encoded whole.
+    char long_message[1500];
+    memset(long_message, 'm', sizeof(long_message) - 1);
+    long_message[sizeof(long_message) - 1] = '\0';
+    LOG_CONSOLE_INFOF("%s!", long_message);
+    ASSERT(capture.length > sizeof(long_message) && capture_contains(&capture, "mmm!\"}\n"), "A long JSON message was cut.");
+
+    // Asynchronous records carry the encoded fields to the writer.
+    log_set_encoding(LOG_ENCODING_LOGFMT);
+    ASSERT(log_async_start(64, LOG_OVERFLOW_BLOCK), "The asynchronous logger did not start.");
+    LOG_CONSOLE_FIELDS(LOG_LEVEL_ERROR, "Disk full.", LOG_FIELD_STRING("path", "C:\\saves"), LOG_FIELD_UNSIGNED("free", 0));
+    log_async_flush();
+    log_async_stop();
+    ASSERT(capture.text[0] == 't' && capture_contains(&capture, " level=ERROR ") && capture_contains(&capture, " message=\"Disk full.\" path=\"C:\\\\saves\" free=0\n"),
+        "The asynchronous logfmt line is missing its fields.");
+
+    // Asynchronous records that escape past the writer line are shortened, still closed and parsable.
+    char control_message[LOG_ASYNC_MESSAGE_CAPACITY];
+    memset(control_message, '\x01', sizeof(control_message) - 1);
+    control_message[sizeof(control_message) - 1] = '\0';
+    char long_file[2048];
+    memset(long_file, 'f', sizeof(long_file) - 1);
+    long_file[sizeof(long_file) - 1] = '\0';
+    log_set_encoding(LOG_ENCODING_JSON);
+    ASSERT(log_async_start(64, LOG_OVERFLOW_BLOCK), "The asynchronous logger did not start.");
+    log_message_to_console(LOG_LEVEL_INFO, __FUNCTION__, long_file, __LINE__, control_message);
+    log_async_flush();
+    log_async_stop();
+    ASSERT(capture.text[0] == '{' && capture.length > 2 && capture.length < sizeof(capture.text) && memcmp(capture.text + capture.length - 3, "\"}\n", 3) == 0 &&
+        capture_contains(&capture, "\"message\":\"\\u0001"), "A long asynchronous JSON record was not shortened into a closed object.");
+
+    log_set_encoding(LOG_ENCODING_TEXT);
+    log_remove_sink(&capture.sink);
+}
@@ -0,0 +1,182 @@
+#include "core/log_file.h"
+#include "core/debug.h"
+#include "core/log.h"
+#include "core/thread.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define LOG_FILE_TEST_PATH "log_file_test.log"
+#define LOG_FILE_TEST_THREADS 4
+#define LOG_FILE_TEST_MESSAGES 5000
+
+void test_log_file_sink(void);
+void test_log_file_rotation(void);
+void test_log_file_timestamps(void);
+
+int main(void) {
+    test_log_file_sink();
+    LOG_CONSOLE_SUCCESS("test_log_file_sink passed.");
+    test_log_file_rotation();
+    LOG_CONSOLE_SUCCESS("test_log_file_rotation passed.");
+    test_log_file_timestamps();
+    LOG_CONSOLE_SUCCESS("test_log_file_timestamps passed.");
+    return 0;
+}
+
+/**
+ * Reads a whole file into a terminated string, the caller frees it. Returns NULL if it does not exist.
+ */
+static char * read_file(const char * path) {
+    FILE * file = fopen(path, "rb");
+    if (!file)
+        return NULL;
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    rewind(file);
+    char * text = (char *)calloc((size_t)size + 1, 1);
+    fread(text, 1, (size_t)size, file);
+    fclose(file);
+    return text;
+}
+
+/**
+ * Counts the lines of a string.
+ */
+static size_t count_lines(const char * text) {
+    size_t count = 0;
+    for (; *text; text++)
+        count += *text == '\n';
+    return count;
+}
+
+static void run_log_file_producer(void * argument) {
+    (void)argument;
+    for (int index = 0; index < LOG_FILE_TEST_MESSAGES; index++)
+        LOG_CONSOLE_INFO("Message from a producer thread, written through the file sink.");
+}
+
+void test_log_file_sink(void) {
+    remove(LOG_FILE_TEST_PATH);
+    LogFileSink sink;
+    ASSERT(log_file_sink_open(&sink, LOG_FILE_TEST_PATH, NULL), "log_file_sink_open failed to create the file.");
+    ASSERT(log_add_sink(&sink.sink), "log_add_sink failed to add the file sink.");
+    ASSERT(!log_add_sink(&sink.sink), "log_add_sink added the same sink twice.");
+    ASSERT(log_remove_sink(&log_console_sink), "The console sink was not registered.");
+
+    // Lines are plain text in the file, below the sink's level they are skipped.
+    sink.sink.minimum_level = LOG_LEVEL_INFO;
+    LOG_CONSOLE_DEBUG("Skipped by the sink level.");
+    LOG_CONSOLE_WARNING("Written to the file."); int line = __LINE__;
+    char * text = read_file(LOG_FILE_TEST_PATH);
+    ASSERT(text && text[0] == '\0', "The file sink wrote before its buffer was flushed.");
+    free(text);
+    log_async_flush();
+    char expected[256];
+    snprintf(expected, sizeof(expected), "[WARNING] (%s: %s:%d) Written to the file.\n", __FUNCTION__, __FILE__, line);
+    text = read_file(LOG_FILE_TEST_PATH);
+    ASSERT(text && strcmp(text, expected) == 0, "The file sink did not write the expected line.");
+    free(text);
+
+    // A line longer than the stack buffer of the logger is written whole.
+    size_t long_length = 3000;
+    char * long_message = (char *)malloc(long_length + 1);
+    memset(long_message, 'x', long_length);
+    long_message[long_length] = '\0';
+    LOG_CONSOLE_ERROR(long_message);
+    free(long_message);
+    log_async_flush();
+    text = read_file(LOG_FILE_TEST_PATH);
+    ASSERT(count_lines(text) == 2 && strlen(text) > strlen(expected) + long_length, "The long line was truncated.");
+    free(text);
+    LOG_CONSOLE_SUCCESS("File sink passed level and long line test.");
+
+    // Thread Test, the asynchronous writer feeds the sink from several producers.
+    log_async_start(1024, LOG_OVERFLOW_BLOCK);
+    Thread threads[LOG_FILE_TEST_THREADS];
+    for (int index = 0; index < LOG_FILE_TEST_THREADS; index++)
+        thread_create(&threads[index], run_log_file_producer, NULL);
+    for (int index = 0; index < LOG_FILE_TEST_THREADS; index++)
+        thread_join(&threads[index]);
+    log_async_stop();
+    text = read_file(LOG_FILE_TEST_PATH);
+    // The two lines above and the success message are already in the file.
+    ASSERT(count_lines(text) == 3 + LOG_FILE_TEST_THREADS * LOG_FILE_TEST_MESSAGES, "The file sink lost lines from producer threads.");
+    free(text);
+
+    ASSERT(log_remove_sink(&sink.sink), "log_remove_sink did not find the file sink.");
+    log_add_sink(&log_console_sink);
+    log_file_sink_close(&sink);
+    remove(LOG_FILE_TEST_PATH);
+    LOG_CONSOLE_SUCCESS("File sink passed thread test.");
+}
+
+void test_log_file_rotation(void) {
+    char path[64];
+    for (int index = 0; index <= 3; index++) {
+        snprintf(path, sizeof(path), index ? LOG_FILE_TEST_PATH ".%d" : LOG_FILE_TEST_PATH, index);
+        remove(path);
+    }
+
+    LogFileSinkOptions options = { 0 };
+    options.buffer_size = 512;
+    options.rotate_size = 4096;
+    options.keep_count = 2;
+    options.sync_policy = LOG_FILE_SYNC_ON_ROTATE;
+    LogFileSink sink;
+    ASSERT(log_file_sink_open(&sink, LOG_FILE_TEST_PATH, &options), "log_file_sink_open failed to create the file.");
+    log_remove_sink(&log_console_sink);
+    log_add_sink(&sink.sink);
+    for (int index = 0; index < 1000; index++)
+        LOG_CONSOLE_INFO("A line long enough that a thousand of them rotate the file many times.");
+    log_remove_sink(&sink.sink);
+    log_add_sink(&log_console_sink);
+    log_file_sink_close(&sink);
+
+    // Every file stays under the size limit, only keep_count rotated files are left and they hold the newest lines.
+    size_t lines = 0;
+    for (int index = 0; index <= 3; index++) {
+        snprintf(path, sizeof(path), index ? LOG_FILE_TEST_PATH ".%d" : LOG_FILE_TEST_PATH, index);
+        char * text = read_file(path);
+        if (index == 3) {
+            ASSERT(!text, "More rotated files were kept than keep_count.");
+            break;
+        }
+        ASSERT(text, "A rotated file is missing.");
+        ASSERT(strlen(text) <= options.rotate_size, "A log file grew past the rotation size.");
+        ASSERT(text[0] == '[' && text[strlen(text) - 1] == '\n', "A line was split across files.");
+        lines += count_lines(text);
+        free(text);
+        remove(path);
+    }
+    ASSERT(lines > 0 && lines < 1000, "The rotated files do not hold the newest lines.");
+    LOG_CONSOLE_SUCCESS("File sink passed rotation test.");
+}
+
+void test_log_file_timestamps(void) {
+    remove(LOG_FILE_TEST_PATH);
+    LogFileSink sink;
+    ASSERT(log_file_sink_open(&sink, LOG_FILE_TEST_PATH, NULL), "log_file_sink_open failed to create the file.");
+    log_remove_sink(&log_console_sink);
+    log_add_sink(&sink.sink);
+    log_set_timestamps(true);
+    LOG_CONSOLE_INFO("Line with a timestamp.");
+    log_async_start(16, LOG_OVERFLOW_BLOCK);
+    LOG_CONSOLE_INFO("Asynchronous line with a timestamp.");
+    log_async_stop();
+    log_set_timestamps(false);
+    log_remove_sink(&sink.sink);
+    log_add_sink(&log_console_sink);
+    log_file_sink_close(&sink);
+
+    // Both lines start with "YYYY-MM-DD HH:MM:SS.uuuuuu [INFO]".
+    char * text = read_file(LOG_FILE_TEST_PATH);
+    ASSERT(text && count_lines(text) == 2, "The file sink did not write both lines.");
+    for (const char * line = text; *line; line = strchr(line, '\n') + 1) {
+        int year, month, day, hour, minute, second, microseconds, consumed = 0;
+        sscanf(line, "%4d-%2d-%2d %2d:%2d:%2d.%6d [INFO]%n", &year, &month, &day, &hour, &minute, &second, &microseconds, &consumed);
+        ASSERT(consumed == 33 && year >= 2023 && month >= 1 && month <= 12, "A line does not start with a timestamp.");
+    }
+    free(text);
+    remove(LOG_FILE_TEST_PATH);
+}
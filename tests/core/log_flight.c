@@ -0,0 +1,183 @@
+#include "core/log_flight.h"
+#include "core/debug.h"
+#include "core/format.h"
+#include "core/log.h"
+#include "core/thread.h"
+#include "core/context.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if OS_LINUX || OS_MAC
+    #include <signal.h>
+    #include <unistd.h>
+    #include <sys/wait.h>
+#endif
+
+#define DUMP_BYTES (1024 * 1024)
+
+void test_log_flight_filtered(void);
+void test_log_flight_wrap(void);
+void test_log_flight_threads(void);
+void test_log_flight_crash(void);
+
+int main(void) {
+    test_log_flight_filtered();
+    LOG_CONSOLE_SUCCESS("test_log_flight_filtered passed.");
+    test_log_flight_wrap();
+    LOG_CONSOLE_SUCCESS("test_log_flight_wrap passed.");
+    test_log_flight_threads();
+    LOG_CONSOLE_SUCCESS("test_log_flight_threads passed.");
+    test_log_flight_crash();
+    LOG_CONSOLE_SUCCESS("test_log_flight_crash passed.");
+    return 0;
+}
+
+/**
+ * Dumps the flight recorder into a terminated string, free it after use.
+ */
+static char * dump_flight_recorder(size_t * count) {
+    FILE * file = tmpfile();
+    ASSERT(file != NULL, "Could not create a file for the dump.");
+    fflush(file);
+    *count = log_flight_dump(fileno(file));
+    char * text = (char *)malloc(DUMP_BYTES);
+    fseek(file, 0, SEEK_SET);
+    size_t length = fread(text, 1, DUMP_BYTES - 1, file);
+    text[length] = '\0';
+    fclose(file);
+    return text;
+}
+
+static int flight_argument_evaluations = 0;
+
+static const char * count_flight_argument(const char * message) {
+    flight_argument_evaluations++;
+    return message;
+}
+
+void test_log_flight_filtered(void) {
+    log_set_level(LOG_LEVEL_ERROR);
+    LOG_CONSOLE_DEBUG("Filtered flight message.");
+    LOG_CONSOLE_INFOF("Filtered format %d.", 3);
+    LOG_CONSOLE_INFO(count_flight_argument("Filtered expression."));
+    log_set_level(LOG_LEVEL_DEBUG);
+    LOG_CONSOLE_WARNINGF("Written format %d.", 7);
+
+    size_t count = 0;
+    char * dump = dump_flight_recorder(&count);
+    ASSERT(flight_argument_evaluations == 0 && !strstr(dump, "Filtered expression."), "A filtered message that is not a literal was evaluated.");
+    ASSERT(strstr(dump, "[WARNING]") && strstr(dump, ") Written format 7.\n"), "A written message was not recorded formatted.");
+#if COMPILER_GCC || COMPILER_CLANG
+    ASSERT(count >= 3, "The dump did not count the records.");
+    ASSERT(strstr(dump, "[DEBUG] (test_log_flight_filtered: ") && strstr(dump, ") Filtered flight message.\n"), "A filtered message was not recorded.");
+    ASSERT(strstr(dump, ") Filtered format %d.\n"), "A filtered format was not recorded as written.");
+#endif
+    free(dump);
+}
+
+void test_log_flight_wrap(void) {
+    char message[LOG_FLIGHT_TEXT_BYTES * 2];
+    for (int index = 0; index < LOG_FLIGHT_RECORDS + 10; index++) {
+        format_string(message, sizeof(message), "Wrap %d", index);
+        log_flight_record(LOG_LEVEL_DEBUG, __FUNCTION__, __FILE__, __LINE__, message);
+    }
+    memset(message, 'x', sizeof(message) - 1);
+    message[sizeof(message) - 1] = '\0';
+    log_flight_record(LOG_LEVEL_DEBUG, __FUNCTION__, __FILE__, __LINE__, message);
+
+    size_t count = 0;
+    char * dump = dump_flight_recorder(&count);
+    // The ring keeps the long message and the LOG_FLIGHT_RECORDS - 1 wraps before it.
+    char dropped[32], first[32], last[32];
+    format_string(dropped, sizeof(dropped), ") Wrap %d\n", 10);
+    format_string(first, sizeof(first), ") Wrap %d\n", 11);
+    format_string(last, sizeof(last), ") Wrap %d\n", LOG_FLIGHT_RECORDS + 9);
+    ASSERT(!strstr(dump, dropped), "A record older than the ring was kept.");
+    char * oldest = strstr(dump, first);
+    char * newest = strstr(dump, last);
+    ASSERT(oldest && newest && oldest < newest, "The latest records were not dumped oldest first.");
+
+    char expected[LOG_FLIGHT_TEXT_BYTES + 4] = ") ";
+    memset(expected + 2, 'x', LOG_FLIGHT_TEXT_BYTES);
+    expected[LOG_FLIGHT_TEXT_BYTES + 2] = '\n';
+    ASSERT(strstr(dump, expected), "A long message was not truncated to LOG_FLIGHT_TEXT_BYTES.");
+    free(dump);
+}
+
+static void run_flight_thread(void * argument) {
+    (void)argument;
+    LOG_CONSOLE_DEBUG("Recorded on another thread.");
+}
+
+void test_log_flight_threads(void) {
+    // The minimum level is not atomic, it is set before the threads start and restored after they end.
+    log_set_level(LOG_LEVEL_ERROR);
+    Thread threads[4];
+    for (int index = 0; index < 4; index++)
+        thread_create(&threads[index], run_flight_thread, NULL);
+    for (int index = 0; index < 4; index++)
+        thread_join(&threads[index]);
+    log_set_level(LOG_LEVEL_DEBUG);
+
+    // Rings of threads that exited keep their records.
+    size_t count = 0;
+    char * dump = dump_flight_recorder(&count);
+    int found = 0;
+    for (char * cursor = dump; (cursor = strstr(cursor, ") Recorded on another thread.\n")); cursor++)
+        found++;
+    ASSERT_FORMAT(found == 4, "%d of 4 threads' records were dumped.", found);
+    free(dump);
+}
+
+#if OS_LINUX || OS_MAC
+/**
+ * Records a message in a child process and crashes it, with a failed assertion or an abort.
+ */
+static int crash_child(const char * path, bool assertion) {
+    pid_t child = fork();
+    if (child == 0) {
+        log_set_level(LOG_LEVEL_FATAL);
+        log_flight_set_path(path);
+        LOG_CONSOLE_DEBUG("Last words before the crash.");
+        if (assertion)
+            ASSERT(path == NULL, "Failed on purpose.");
+        else
+            abort();
+        _exit(0);
+    }
+    int status = 0;
+    waitpid(child, &status, 0);
+    return WIFSIGNALED(status) ? WTERMSIG(status) : 0;
+}
+
+/**
+ * Reads a whole file into a terminated string, free it after use.
+ */
+static char * read_dump_file(const char * path) {
+    char * text = (char *)calloc(DUMP_BYTES, 1);
+    FILE * file = fopen(path, "rb");
+    if (file) {
+        fread(text, 1, DUMP_BYTES - 1, file);
+        fclose(file);
+    }
+    remove(path);
+    return text;
+}
+#endif
+
+void test_log_flight_crash(void) {
+#if OS_LINUX || OS_MAC
+    const char * path = "log_flight_test.dump";
+    ASSERT(crash_child(path, true) == SIGSEGV, "A failed assertion did not end the process with SIGSEGV.");
+    char * dump = read_dump_file(path);
+    ASSERT(strstr(dump, ") Last words before the crash.\n") && strstr(dump, "[ERROR]") && strstr(dump, ") Failed on purpose.\n"),
+        "ASSERT_BREAK did not dump the flight recorder.");
+    free(dump);
+
+    ASSERT(crash_child(path, false) == SIGABRT, "The abort handler did not let the process abort.");
+    dump = read_dump_file(path);
+    ASSERT(strstr(dump, ") Last words before the crash.\n"), "The SIGABRT handler did not dump the flight recorder.");
+    free(dump);
+#endif
+}
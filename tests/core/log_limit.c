@@ -0,0 +1,155 @@
+#include "core/log_limit.h"
+#include "core/debug.h"
+#include "core/log.h"
+#include "core/thread.h"
+#include <stdatomic.h>
+#include <string.h>
+
+void test_log_rate_limit_acquire(void);
+void test_log_rate_limit_threads(void);
+void test_log_limited_macros(void);
+void test_log_coalescing(void);
+
+int main(void) {
+    test_log_rate_limit_acquire();
+    LOG_CONSOLE_SUCCESS("test_log_rate_limit_acquire passed.");
+    test_log_rate_limit_threads();
+    LOG_CONSOLE_SUCCESS("test_log_rate_limit_threads passed.");
+    test_log_limited_macros();
+    LOG_CONSOLE_SUCCESS("test_log_limited_macros passed.");
+    test_log_coalescing();
+    LOG_CONSOLE_SUCCESS("test_log_coalescing passed.");
+    return 0;
+}
+
+void test_log_rate_limit_acquire(void) {
+    LogRateLimit limit = LOG_RATE_LIMIT_INIT(10, 5);
+    uint64_t limited = log_rate_limited_count();
+    for (int index = 0; index < 5; index++)
+        ASSERT(log_rate_limit_acquire(&limit), "The burst was not let through.");
+    ASSERT(!log_rate_limit_acquire(&limit) && !log_rate_limit_acquire(&limit), "A message past the burst was let through.");
+    ASSERT(atomic_load(&limit.suppressed) == 2 && log_rate_limited_count() == limited, "Suppressed messages were not counted in the bucket alone.");
+
+    // One token comes back every 100 milliseconds, the summary before the next message adds to the total.
+    thread_sleep(150);
+    ASSERT(log_rate_limit_acquire(&limit), "A token did not come back.");
+    log_limited_to_console(&limit, LOG_LEVEL_DEBUG, __FUNCTION__, __FILE__, __LINE__, "Let through after %d suppressed.", 2);
+    ASSERT(atomic_load(&limit.suppressed) == 0 && log_rate_limited_count() == limited + 2, "The summary did not add to the suppressed total.");
+}
+
+typedef struct RateLimitWorker {
+    Thread thread;
+    LogRateLimit * limit;
+    int allowed;
+} RateLimitWorker;
+
+static void run_rate_limit_worker(void * argument) {
+    RateLimitWorker * worker = (RateLimitWorker *)argument;
+    for (int index = 0; index < 10000; index++)
+        worker->allowed += log_rate_limit_acquire(worker->limit);
+}
+
+void test_log_rate_limit_threads(void) {
+    // A token every 10 seconds, so the threads share the burst and nothing more.
+    static LogRateLimit limit = LOG_RATE_LIMIT_INIT(1, 50);
+    limit.interval_ns *= 10;
+    limit.burst_ns *= 10;
+    RateLimitWorker workers[4] = { 0 };
+    for (int index = 0; index < 4; index++) {
+        workers[index].limit = &limit;
+        thread_create(&workers[index].thread, run_rate_limit_worker, &workers[index]);
+    }
+    int allowed = 0;
+    for (int index = 0; index < 4; index++) {
+        thread_join(&workers[index].thread);
+        allowed += workers[index].allowed;
+    }
+    ASSERT_FORMAT(allowed == 50, "Threads were let through %d messages from a burst of 50.", allowed);
+    ASSERT(atomic_load(&limit.suppressed) == 40000 - 50, "Suppressed messages from several threads were not all counted.");
+}
+
+/**
+ * Counts the lines written to it and keeps the last two.
+ */
+typedef struct CaptureSink {
+    LogSink sink;
+    int count;
+    char previous[512];
+    char last[512];
+} CaptureSink;
+
+static void write_capture_line(LogSink * sink, const LogLine * line) {
+    CaptureSink * capture = (CaptureSink *)sink;
+    size_t length = line->length < sizeof(capture->last) - 1 ? line->length : sizeof(capture->last) - 1;
+    memcpy(capture->previous, capture->last, sizeof(capture->last));
+    memcpy(capture->last, line->text, length);
+    capture->last[length] = '\0';
+    capture->count++;
+}
+
+static void flush_capture(LogSink * sink) {
+    (void)sink;
+}
+
+/**
+ * One call site, logging a message for every index below count.
+ */
+static void flood_log(int count) {
+    for (int index = 0; index < count; index++)
+        LOG_CONSOLE_LIMITED_RATE(LOG_LEVEL_WARNING, 20, 3, "Flood %d.", index);
+}
+
+void test_log_limited_macros(void) {
+    CaptureSink capture = { .sink = { write_capture_line, flush_capture, LOG_LEVEL_DEBUG } };
+    log_add_sink(&capture.sink);
+
+    flood_log(100);
+    ASSERT_FORMAT(capture.count == 3 && strstr(capture.last, "Flood 2.\n"), "A flooding call site wrote %d lines instead of its burst of 3.", capture.count);
+
+    // The next message let through says how many were suppressed.
+    thread_sleep(60);
+    flood_log(2);
+    ASSERT(capture.count == 5 && strstr(capture.previous, "[WARNING]") && strstr(capture.previous, "Suppressed 97 messages from this call site.\n"),
+        "The suppressed summary was not written before the next message.");
+
+    // Filtered levels do not take tokens.
+    log_set_level(LOG_LEVEL_ERROR);
+    LOG_CONSOLE_INFO_LIMITED("Filtered.");
+    log_set_level(LOG_LEVEL_DEBUG);
+    ASSERT(capture.count == 5, "A filtered limited message was written.");
+
+    log_remove_sink(&capture.sink);
+}
+
+void test_log_coalescing(void) {
+    CaptureSink capture = { .sink = { write_capture_line, flush_capture, LOG_LEVEL_DEBUG } };
+    log_add_sink(&capture.sink);
+    log_set_coalescing(true);
+    uint64_t coalesced = log_coalesced_count();
+
+    for (int index = 0; index < 5; index++)
+        LOG_CONSOLE_WARNING("The same message again.");
+    ASSERT(capture.count == 1, "Repeated lines were not folded.");
+    LOG_CONSOLE_WARNING("A different message.");
+    ASSERT(capture.count == 3 && strstr(capture.previous, "Last message repeated 4 times.\n") && strstr(capture.last, "A different message.\n"),
+        "The repeated summary was not written before the next line.");
+    ASSERT(log_coalesced_count() == coalesced + 4, "Folded lines were not counted.");
+
+    // Lines from other call sites, or at other levels, are different lines.
+    LOG_CONSOLE_INFOF("A different message.");
+    ASSERT(capture.count == 4, "Lines from different call sites were folded.");
+
+    // Flushing writes a pending summary, in asynchronous mode too.
+    log_async_start(64, LOG_OVERFLOW_BLOCK);
+    for (int index = 0; index < 3; index++)
+        LOG_CONSOLE_ERROR("Repeated in the ring.");
+    log_async_flush();
+    log_async_stop();
+    ASSERT(capture.count == 6 && strstr(capture.last, "[ERROR]") && strstr(capture.last, "Last message repeated 2 times.\n"), "Flushing did not write the repeated summary.");
+
+    log_set_coalescing(false);
+    for (int index = 0; index < 2; index++)
+        LOG_CONSOLE_WARNING("Not folded.");
+    ASSERT(capture.count == 8, "Lines were folded after coalescing was turned off.");
+    log_remove_sink(&capture.sink);
+}
@@ -0,0 +1,77 @@
+#include "core/pool.h"
+#include "core/debug.h"
+#include "core/log.h"
+#include <stdint.h>
+
+void test_pool_alloc(void);
+void test_pool_free_list(void);
+void test_pool_debug(void);
+
+int main(void) {
+    test_pool_alloc();
+    LOG_CONSOLE_SUCCESS("test_pool_alloc passed.");
+    test_pool_free_list();
+    LOG_CONSOLE_SUCCESS("test_pool_free_list passed.");
+    test_pool_debug();
+    LOG_CONSOLE_SUCCESS("test_pool_debug passed.");
+    return 0;
+}
+
+void test_pool_alloc(void) {
+    LOG_CONSOLE_INFO("Testing pool_alloc...");
+    Pool pool;
+    pool_init(&pool, 24, 4);
+
+    // Slot Layout Test, slots are aligned and do not overlap across several slabs.
+    uint8_t * slots[10];
+    for (int index = 0; index < 10; index++) {
+        slots[index] = (uint8_t *)pool_alloc(&pool);
+        ASSERT(slots[index] != NULL, "pool_alloc returned NULL.");
+        ASSERT(((uintptr_t)slots[index] & (POOL_SLOT_ALIGNMENT - 1)) == 0, "pool_alloc returned a misaligned slot.");
+        for (int byte = 0; byte < 24; byte++)
+            slots[index][byte] = (uint8_t)index;
+    }
+    for (int index = 0; index < 10; index++)
+        ASSERT(slots[index][0] == index && slots[index][23] == index, "pool_alloc returned overlapping slots.");
+    ASSERT(pool.count == 10, "pool count does not match the number of allocated slots.");
+
+    pool_destroy(&pool);
+}
+
+void test_pool_free_list(void) {
+    LOG_CONSOLE_INFO("Testing pool_free recycling...");
+    Pool pool;
+    pool_init(&pool, 8, 0);
+
+    void * first = pool_alloc(&pool);
+    void * second = pool_alloc(&pool);
+    pool_free(&pool, first);
+    pool_free(&pool, second);
+
+    // The free list is LIFO, the most recently freed slot comes back first.
+    ASSERT(pool_alloc(&pool) == second, "pool_alloc did not recycle the most recently freed slot.");
+    ASSERT(pool_alloc(&pool) == first, "pool_alloc did not recycle the remaining freed slot.");
+    ASSERT(pool.count == 2, "pool count does not match the number of allocated slots.");
+
+    pool_destroy(&pool);
+}
+
+void test_pool_debug(void) {
+    LOG_CONSOLE_INFO("Testing pool debug mode...");
+    Pool pool;
+    pool_init_debug(&pool, 20, 0);
+
+    // Initialization And Guard Test.
+    uint8_t * slot = (uint8_t *)pool_alloc(&pool);
+    ASSERT(slot[0] == DEBUG_MEMORY_INIT_VALUE && slot[19] == DEBUG_MEMORY_INIT_VALUE, "pool_alloc did not initialize a debug slot.");
+    ASSERT(is_memory_guard_intact(slot, 20), "pool_alloc did not stamp the guard bytes.");
+    slot[20] = 0xEE; // Simulating an overrun.
+    ASSERT(!is_memory_guard_intact(slot, 20), "Memory guard check did not detect an overrun in a pool slot.");
+    set_memory_guard_bytes(slot, 20);
+
+    // Poison Test.
+    pool_free(&pool, slot);
+    ASSERT(slot[sizeof(void *)] == DEBUG_MEMORY_FREE_VALUE && slot[19] == DEBUG_MEMORY_FREE_VALUE, "pool_free did not poison the freed slot.");
+
+    pool_destroy(&pool);
+}
@@ -0,0 +1,261 @@
+#include "core/string.h"
+#include "core/arena.h"
+#include "core/debug.h"
+#include "core/log.h"
+#include "core/pool.h"
+#include <stdint.h>
+#include <string.h>
+
+#define GUARDED_BYTES 4096
+
+void test_string_length(void);
+void test_string_compare(void);
+void test_string_page_end(void);
+void test_string_to_log_level_simd(void);
+void test_string_view(void);
+void test_string_view_split(void);
+void test_string_builder(void);
+void test_string_builder_arena(void);
+void test_string_builder_pool(void);
+
+static const STRING_SIMD SIMD_LEVELS[] = { STRING_SIMD_NONE, STRING_SIMD_SSE2, STRING_SIMD_AVX2, STRING_SIMD_NEON };
+static const char * SIMD_NAMES[] = { "scalar", "SSE2", "AVX2", "NEON" };
+
+int main(void) {
+    STRING_SIMD detected = string_simd();
+    for (size_t level = 0; level < sizeof(SIMD_LEVELS) / sizeof(SIMD_LEVELS[0]); level++) {
+        if (!string_set_simd(SIMD_LEVELS[level]))
+            continue;
+        test_string_length();
+        test_string_compare();
+        test_string_page_end();
+        test_string_to_log_level_simd();
+        LOG_CONSOLE_SUCCESSF("String tests passed with %s.", SIMD_NAMES[level]);
+    }
+    string_set_simd(detected);
+
+    test_string_view();
+    LOG_CONSOLE_SUCCESS("test_string_view passed.");
+    test_string_view_split();
+    LOG_CONSOLE_SUCCESS("test_string_view_split passed.");
+    test_string_builder();
+    LOG_CONSOLE_SUCCESS("test_string_builder passed.");
+    test_string_builder_arena();
+    LOG_CONSOLE_SUCCESS("test_string_builder_arena passed.");
+    test_string_builder_pool();
+    LOG_CONSOLE_SUCCESS("test_string_builder_pool passed.");
+    return 0;
+}
+
+/**
+ * The result string_compare must give, the difference of the first bytes that differ.
+ */
+static int compare_expected(const char * string_one, const char * string_two) {
+    size_t index = 0;
+    while (string_one[index] && string_one[index] == string_two[index])
+        index++;
+    return (unsigned char)string_one[index] - (unsigned char)string_two[index];
+}
+
+void test_string_length(void) {
+    char buffer[512];
+    memset(buffer, 'a', sizeof(buffer));
+    for (int offset = 0; offset < 64; offset++) {
+        for (int length = 0; length < 300; length++) {
+            buffer[offset + length] = '\0';
+            int measured = string_length(buffer + offset);
+            ASSERT_FORMAT(measured == length, "string_length gave %d for %d bytes at offset %d.", measured, length, offset);
+            buffer[offset + length] = 'a';
+        }
+    }
+    // A zero byte before the string does not end it.
+    buffer[3] = '\0';
+    buffer[40] = '\0';
+    ASSERT(string_length(buffer + 4) == 36, "string_length saw a terminator before the string.");
+}
+
+void test_string_compare(void) {
+    char one[256];
+    char two[256];
+    for (int offset = 0; offset < 40; offset++) {
+        for (int length = 0; length < 200; length++) {
+            memset(one, 'k', sizeof(one));
+            memset(two, 'k', sizeof(two));
+            one[offset + length] = '\0';
+            two[length] = '\0';
+            ASSERT_FORMAT(string_compare(one + offset, two) == 0, "Equal strings of %d bytes compared different.", length);
+
+            if (!length)
+                continue;
+            // A difference in the last byte, either way, and with bytes from 0x80 up.
+            two[length - 1] = 'z';
+            ASSERT(string_compare(one + offset, two) == compare_expected(one + offset, two), "A smaller string compared wrong.");
+            ASSERT(string_compare(two, one + offset) == compare_expected(two, one + offset), "A larger string compared wrong.");
+            two[length - 1] = (char)0xE9;
+            ASSERT(string_compare(one + offset, two) < 0, "Bytes from 0x80 up did not compare as unsigned.");
+
+            // A prefix is smaller.
+            two[length - 1] = 'k';
+            two[length] = 'k';
+            two[length + 1] = '\0';
+            ASSERT(string_compare(one + offset, two) == -'k' && string_compare(two, one + offset) == 'k', "A prefix did not compare smaller.");
+        }
+    }
+}
+
+void test_string_page_end(void) {
+    // Blocks of GUARDED_BYTES end right against an inaccessible page, a load past them faults.
+    debug_memory_set_page_guard(GUARDED_BYTES, 0);
+    char * one = (char *)debug_malloc(GUARDED_BYTES, __FILE__, __LINE__);
+    char * two = (char *)debug_malloc(GUARDED_BYTES, __FILE__, __LINE__);
+    debug_memory_set_page_guard(0, 0);
+    ASSERT(one && two, "Could not allocate page-guarded strings.");
+    memset(one, 'p', GUARDED_BYTES);
+    memset(two, 'p', GUARDED_BYTES);
+    one[GUARDED_BYTES - 1] = '\0';
+    two[GUARDED_BYTES - 1] = '\0';
+
+    for (int length = 0; length < 100; length++) {
+        const char * end_one = one + GUARDED_BYTES - 1 - length;
+        ASSERT_FORMAT(string_length(end_one) == length, "string_length failed on %d bytes at the end of a page.", length);
+        for (int shift = 0; shift < 40; shift++) {
+            const char * end_two = two + GUARDED_BYTES - 1 - length - shift;
+            ASSERT(string_compare(end_one, end_two) == compare_expected(end_one, end_two) && string_compare(end_two, end_one) == compare_expected(end_two, end_one),
+                "string_compare failed on strings at the end of a page.");
+        }
+    }
+    debug_free(one);
+    debug_free(two);
+}
+
+void test_string_to_log_level_simd(void) {
+    ASSERT(string_to_log_level("DEBUG") == LOG_LEVEL_DEBUG && string_to_log_level("FATAL") == LOG_LEVEL_FATAL, "string_to_log_level did not find a level.");
+    ASSERT(string_to_log_level("WARNINGS") == LOG_LEVEL_UNKNOWN, "string_to_log_level matched a longer string.");
+}
+
+void test_string_view(void) {
+    StringView view = string_view("originalis core");
+    ASSERT(view.length == 15, "string_view did not measure the string.");
+    ASSERT(string_view(NULL).data == NULL && string_view(NULL).length == 0, "string_view of NULL is not empty.");
+
+    // Slices are clamped to the end of the view.
+    StringView core = string_view_slice(view, 11, 100);
+    ASSERT(string_view_equal(core, STRING_VIEW_LITERAL("core")), "string_view_slice did not clamp the length.");
+    ASSERT(string_view_slice(view, 40, 2).length == 0, "string_view_slice past the end is not empty.");
+
+    ASSERT(string_view_compare(STRING_VIEW_LITERAL("abc"), STRING_VIEW_LITERAL("abd")) < 0, "string_view_compare did not order the views.");
+    ASSERT(string_view_compare(STRING_VIEW_LITERAL("ab"), STRING_VIEW_LITERAL("abc")) < 0, "A prefix did not sort first.");
+    ASSERT(string_view_compare(STRING_VIEW_LITERAL("\xE9"), STRING_VIEW_LITERAL("e")) > 0, "string_view_compare did not compare unsigned bytes.");
+    ASSERT(string_view_compare(string_view(NULL), STRING_VIEW_LITERAL("")) == 0, "Empty views did not compare equal.");
+    ASSERT(!string_view_equal(STRING_VIEW_LITERAL("core"), STRING_VIEW_LITERAL("cora")), "string_view_equal matched different views.");
+
+    ASSERT(string_view_starts_with(view, STRING_VIEW_LITERAL("origin")) && !string_view_starts_with(core, view), "string_view_starts_with failed.");
+    ASSERT(string_view_ends_with(view, STRING_VIEW_LITERAL(" core")) && string_view_ends_with(view, STRING_VIEW_LITERAL("")), "string_view_ends_with failed.");
+    ASSERT(string_view_find(view, ' ') == 10 && string_view_find(view, 'z') == STRING_VIEW_NOT_FOUND, "string_view_find failed.");
+
+    char buffer[32];
+    format_string(buffer, sizeof(buffer), "[" STRING_VIEW_FORMAT "]", STRING_VIEW_ARGUMENTS(core));
+    ASSERT(strcmp(buffer, "[core]") == 0, "STRING_VIEW_FORMAT did not print the view.");
+}
+
+void test_string_view_split(void) {
+    static const char * EXPECTED[] = { "a", "", "bc", "" };
+    StringView rest = STRING_VIEW_LITERAL("a,,bc,");
+    StringView token;
+    size_t count = 0;
+    while (string_view_split(&rest, ',', &token)) {
+        ASSERT(count < 4, "string_view_split gave too many tokens.");
+        ASSERT_FORMAT(string_view_equal(token, string_view(EXPECTED[count])), "Token %zu is \"" STRING_VIEW_FORMAT "\".", count, STRING_VIEW_ARGUMENTS(token));
+        count++;
+    }
+    ASSERT(count == 4, "string_view_split missed tokens.");
+
+    // The empty string has one empty token, no string has none.
+    rest = STRING_VIEW_LITERAL("");
+    ASSERT(string_view_split(&rest, ',', &token) && token.length == 0 && !string_view_split(&rest, ',', &token), "The empty string did not split into one token.");
+    rest = string_view(NULL);
+    ASSERT(!string_view_split(&rest, ',', &token), "No string split into a token.");
+}
+
+void test_string_builder(void) {
+    // Short text stays in the caller buffer.
+    char buffer[16];
+    StringBuilder builder;
+    string_builder_init(&builder, buffer, sizeof(buffer));
+    string_builder_append_string(&builder, "level=");
+    string_builder_append_format(&builder, "%d", 42);
+    string_builder_append_char(&builder, '!');
+    ASSERT(builder.data == buffer && builder.memory == STRING_BUILDER_MEMORY_CALLER, "Short text left the caller buffer.");
+    ASSERT(strcmp(builder.data, "level=42!") == 0 && builder.length == 9, "The appends did not build the text.");
+
+    // Longer text moves to the heap, including a format that does not fit the room left.
+    string_builder_append_format(&builder, " %s %05d", "a long formatted tail", 7);
+    ASSERT(builder.memory == STRING_BUILDER_MEMORY_HEAP, "Long text did not move to the heap.");
+    ASSERT(strcmp(builder.data, "level=42! a long formatted tail 00007") == 0, "A format past the buffer was not appended whole.");
+    for (int index = 0; index < 1000; index++)
+        string_builder_append(&builder, "0123456789", 10);
+    ASSERT(builder.length == 37 + 10000 && builder.data[builder.length] == '\0' && builder.capacity < 2 * (builder.length + 1) + 64, "Appends did not grow the text.");
+    ASSERT(!builder.truncated, "The builder reported a truncation.");
+    ASSERT(string_view_ends_with(string_builder_view(&builder), STRING_VIEW_LITERAL("89")), "string_builder_view is not the text.");
+
+    string_builder_clear(&builder);
+    ASSERT(builder.length == 0 && builder.data[0] == '\0' && builder.capacity > 10000, "string_builder_clear did not keep the memory.");
+    string_builder_destroy(&builder);
+
+    // A builder without a buffer is empty until its first append.
+    string_builder_init(&builder, NULL, 0);
+    ASSERT(string_builder_view(&builder).length == 0, "An empty builder has text.");
+    string_builder_append_format(&builder, "%s", "");
+    string_builder_append_view(&builder, STRING_VIEW_LITERAL("view"));
+    ASSERT(strcmp(builder.data, "view") == 0, "A builder without a buffer did not build the text.");
+    string_builder_destroy(&builder);
+}
+
+void test_string_builder_arena(void) {
+    Arena arena;
+    arena_init(&arena, 4096);
+    StringBuilder builder;
+    string_builder_init_arena(&builder, &arena);
+    string_builder_append_string(&builder, "arena");
+    char * first = builder.data;
+    ASSERT(builder.memory == STRING_BUILDER_MEMORY_ARENA && arena_position(&arena) == builder.capacity, "The text was not pushed to the arena.");
+
+    // At the top of the arena the text grows in place.
+    for (int index = 0; index < 100; index++)
+        string_builder_append_char(&builder, 'x');
+    ASSERT(builder.data == first && builder.length == 105, "Text at the top of the arena did not grow in place.");
+
+    // With something pushed after it, the text moves up the arena.
+    char * after = (char *)arena_push(&arena, 8);
+    memset(after, 'y', 8);
+    for (int index = 0; index < 300; index++)
+        string_builder_append_char(&builder, 'z');
+    ASSERT(builder.data != first && builder.length == 405 && memcmp(builder.data, "arenaxx", 7) == 0, "The text did not move up the arena.");
+    ASSERT(memcmp(after, "yyyyyyyy", 8) == 0, "Growing the text overwrote a later push.");
+
+    // Destroying leaves the memory to the arena.
+    string_builder_destroy(&builder);
+    arena_destroy(&arena);
+}
+
+void test_string_builder_pool(void) {
+    Pool pool;
+    pool_init(&pool, 64, 0);
+    StringBuilder builder;
+    string_builder_init_pool(&builder, &pool);
+    string_builder_append_string(&builder, "pooled text");
+    ASSERT(builder.memory == STRING_BUILDER_MEMORY_POOL && builder.capacity == 64 && pool.count == 1, "The text did not start in a pool slot.");
+
+    // Outgrowing the slot moves the text to the heap and gives the slot back.
+    for (int index = 0; index < 10; index++)
+        string_builder_append_string(&builder, " and more");
+    ASSERT(builder.memory == STRING_BUILDER_MEMORY_HEAP && pool.count == 0, "Outgrowing the slot did not give it back.");
+    ASSERT(builder.length == 101 && strncmp(builder.data, "pooled text and more", 20) == 0, "The text was lost leaving the slot.");
+    string_builder_destroy(&builder);
+
+    string_builder_init_pool(&builder, &pool);
+    string_builder_append_string(&builder, "short");
+    string_builder_destroy(&builder);
+    ASSERT(pool.count == 0, "string_builder_destroy did not give the slot back.");
+    pool_destroy(&pool);
+}
@@ -0,0 +1,96 @@
+#include "core/time.h"
+#include "core/debug.h"
+#include "core/log.h"
+#include "core/thread.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+void test_time_clocks(void);
+void test_time_ticks(void);
+void test_time_format_wall(void);
+void test_time_format_utc(void);
+
+int main(void) {
+    test_time_clocks();
+    LOG_CONSOLE_SUCCESS("test_time_clocks passed.");
+    test_time_ticks();
+    LOG_CONSOLE_SUCCESS("test_time_ticks passed.");
+    test_time_format_wall();
+    LOG_CONSOLE_SUCCESS("test_time_format_wall passed.");
+    test_time_format_utc();
+    LOG_CONSOLE_SUCCESS("test_time_format_utc passed.");
+    return 0;
+}
+
+void test_time_clocks(void) {
+    uint64_t start = time_now_ns();
+    uint64_t coarse_start = time_now_coarse_ns();
+    thread_sleep(20);
+    uint64_t elapsed = time_now_ns() - start;
+    uint64_t coarse_elapsed = time_now_coarse_ns() - coarse_start;
+    ASSERT(elapsed >= 19000000, "time_now_ns advanced less than the sleep.");
+    ASSERT(coarse_elapsed >= 10000000 && coarse_elapsed < elapsed + 20000000, "time_now_coarse_ns does not follow the monotonic clock.");
+
+    uint64_t wall = time_now_wall_ns();
+    uint64_t seconds = (uint64_t)time(NULL);
+    ASSERT(wall / 1000000000ULL + 1 >= seconds && wall / 1000000000ULL <= seconds + 1, "time_now_wall_ns does not match time().");
+}
+
+void test_time_ticks(void) {
+    ASSERT(time_ticks_per_second() > 0, "The tick frequency is not calibrated.");
+
+    // Ticks convert to the monotonic and wall clocks within a millisecond.
+    uint64_t ticks = time_ticks();
+    uint64_t now = time_now_ns();
+    uint64_t wall = time_now_wall_ns();
+    uint64_t converted = time_ticks_to_ns(ticks);
+    uint64_t converted_wall = time_ticks_to_wall_ns(ticks);
+    ASSERT(converted <= now + 1000000 && converted + 1000000 >= now, "time_ticks_to_ns is off by more than a millisecond.");
+    ASSERT(converted_wall <= wall + 1000000 && converted_wall + 1000000 >= wall, "time_ticks_to_wall_ns is off by more than a millisecond.");
+
+    // An interval measured in ticks matches the monotonic clock.
+    uint64_t start_ticks = time_ticks();
+    uint64_t start = time_now_ns();
+    thread_sleep(50);
+    uint64_t elapsed = time_now_ns() - start;
+    uint64_t elapsed_ticks = time_ticks_to_ns(time_ticks()) - time_ticks_to_ns(start_ticks);
+    uint64_t difference = elapsed > elapsed_ticks ? elapsed - elapsed_ticks : elapsed_ticks - elapsed;
+    ASSERT(difference < elapsed / 100, "A tick interval differs from the monotonic clock by more than one percent.");
+}
+
+void test_time_format_wall(void) {
+    // The cached date matches strftime, before and after a change of second.
+    uint64_t base = 1700000000ULL;
+    for (uint64_t second = base; second < base + 3; second++) {
+        for (uint64_t microseconds = 0; microseconds < 1000000; microseconds += 333333) {
+            char text[TIME_TIMESTAMP_LENGTH + 1];
+            size_t length = time_format_wall(second * 1000000000ULL + microseconds * 1000 + 999, text);
+
+            char expected[64];
+            time_t calendar_time = (time_t)second;
+            struct tm * calendar = localtime(&calendar_time);
+            size_t date_length = strftime(expected, sizeof(expected), "%Y-%m-%d %H:%M:%S", calendar);
+            snprintf(expected + date_length, sizeof(expected) - date_length, ".%06llu", (unsigned long long)microseconds);
+            ASSERT(length == TIME_TIMESTAMP_LENGTH && strcmp(text, expected) == 0, "time_format_wall does not match strftime.");
+        }
+    }
+}
+
+void test_time_format_utc(void) {
+    // The cached date matches strftime of gmtime, before and after a change of second.
+    uint64_t base = 1700000000ULL;
+    for (uint64_t second = base; second < base + 3; second++) {
+        for (uint64_t microseconds = 0; microseconds < 1000000; microseconds += 333333) {
+            char text[TIME_UTC_TIMESTAMP_LENGTH + 1];
+            size_t length = time_format_utc(second * 1000000000ULL + microseconds * 1000 + 999, text);
+
+            char expected[64];
+            time_t calendar_time = (time_t)second;
+            struct tm * calendar = gmtime(&calendar_time);
+            size_t date_length = strftime(expected, sizeof(expected), "%Y-%m-%dT%H:%M:%S", calendar);
+            snprintf(expected + date_length, sizeof(expected) - date_length, ".%06lluZ", (unsigned long long)microseconds);
+            ASSERT(length == TIME_UTC_TIMESTAMP_LENGTH && strcmp(text, expected) == 0, "time_format_utc does not match strftime.");
+        }
+    }
+}
@@ -0,0 +1,49 @@
+#include "core/binlog.h"
+#include <stdio.h>
+#include <string.h>
+
+/**
+ * @author Ronald Tavarez
+ * @file binlog_decode.c
+ * @date 2026-10-17
+ * @brief Turns a binary log written with BINLOG back into console log text.
+ *
+ * Usage: binlog_decode [--timestamps] <input.binlog> [output.txt]
+ * Without an output path the text goes to stdout.
+ */
+
+int main(int argc, char ** argv) {
+    bool timestamps = false;
+    const char * paths[2] = { NULL, NULL };
+    int path_count = 0;
+    for (int index = 1; index < argc; index++) {
+        if (strcmp(argv[index], "--timestamps") == 0)
+            timestamps = true;
+        else if (path_count < 2)
+            paths[path_count++] = argv[index];
+    }
+    if (!path_count) {
+        fprintf(stderr, "Usage: %s [--timestamps] <input.binlog> [output.txt]\n", argv[0]);
+        return 2;
+    }
+
+    FILE * input = fopen(paths[0], "rb");
+    if (!input) {
+        fprintf(stderr, "Cannot open %s.\n", paths[0]);
+        return 1;
+    }
+    FILE * output = paths[1] ? fopen(paths[1], "w") : stdout;
+    if (!output) {
+        fprintf(stderr, "Cannot create %s.\n", paths[1]);
+        fclose(input);
+        return 1;
+    }
+
+    bool intact = binlog_decode(input, output, timestamps);
+    if (!intact)
+        fprintf(stderr, "%s is not a binary log or is damaged, the lines before the damage were decoded.\n", paths[0]);
+    fclose(input);
+    if (output != stdout)
+        fclose(output);
+    return intact ? 0 : 1;
+}